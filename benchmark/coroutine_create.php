@@ -0,0 +1,33 @@
+<?php
+/**
+ * This file is part of Swow
+ *
+ * @link     https://github.com/swow/swow
+ * @contact  twosee <twosee@php.net>
+ *
+ * For the full copyright and license information,
+ * please view the LICENSE file that was distributed with this source code
+ */
+
+declare(strict_types=1);
+
+use Swow\Coroutine;
+
+/* create + run + destroy of short-lived coroutines, without and with the executor pool */
+
+$times = 100 * 10000;
+$function = static function (): void { };
+
+foreach ([0, 128] as $poolSize) {
+    Coroutine::setExecutorPoolSize($poolSize);
+    $use = microtime(true);
+    for ($n = $times; $n--;) {
+        Coroutine::run($function);
+    }
+    $use = microtime(true) - $use;
+
+    $ns = $use * (1000 * 1000 * 1000) / $times;
+    $qps = $times * (1 / $use);
+
+    echo sprintf('[executor pool size=%d] Use %fs for %d times, %fns/t, qps=%f' . PHP_EOL, $poolSize, $use, $times, $ns, $qps);
+}
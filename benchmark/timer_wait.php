@@ -0,0 +1,48 @@
+<?php
+/**
+ * This file is part of Swow
+ *
+ * @link     https://github.com/swow/swow
+ * @contact  twosee <twosee@php.net>
+ *
+ * For the full copyright and license information,
+ * please view the LICENSE file that was distributed with this source code
+ */
+
+declare(strict_types=1);
+
+use Swow\Channel;
+use Swow\Coroutine;
+
+/* every pop() arms a timeout and every push() disarms it,
+ * just like timed socket operations do */
+$concurrency = (int) ($argv[1] ?? 100000);
+$rounds = (int) ($argv[2] ?? 10);
+
+$channels = [];
+for ($c = $concurrency; $c--;) {
+    $channel = new Channel();
+    Coroutine::run(function () use ($channel) {
+        while ($channel->pop(60 * 1000)) {
+            continue;
+        }
+    });
+    $channels[] = $channel;
+}
+
+$times = $concurrency * $rounds;
+$use = microtime(true);
+for ($n = $rounds; $n--;) {
+    foreach ($channels as $channel) {
+        $channel->push(true);
+    }
+}
+$use = microtime(true) - $use;
+foreach ($channels as $channel) {
+    $channel->push(false);
+}
+
+$ns = $use * (1000 * 1000 * 1000) / $times;
+$qps = $times * (1 / $use);
+
+echo sprintf('Use %fs for %d times with %d waiters, %fns/t, qps=%f' . PHP_EOL, $use, $times, $concurrency, $ns, $qps);
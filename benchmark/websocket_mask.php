@@ -0,0 +1,36 @@
+<?php
+/**
+ * This file is part of Swow
+ *
+ * @link     https://github.com/swow/swow
+ * @contact  twosee <twosee@php.net>
+ *
+ * For the full copyright and license information,
+ * please view the LICENSE file that was distributed with this source code
+ */
+
+declare(strict_types=1);
+
+use Swow\Buffer;
+use Swow\WebSocket\Frame;
+
+$maskKey = random_bytes(4);
+$defaultKernel = Frame::getMaskKernel();
+
+foreach ([16 * 1024, 64 * 1024] as $size) {
+    $buffer = new Buffer($size);
+    $buffer->write(random_bytes($size))->rewind();
+    $times = (int) ((4 * 1024 * 1024 * 1024) / $size);
+    foreach (Frame::getAvailableMaskKernels() as $kernel) {
+        Frame::setMaskKernel($kernel);
+        $use = microtime(true);
+        for ($n = $times; $n--;) {
+            Frame::mask($buffer, $buffer, $maskKey);
+        }
+        $use = microtime(true) - $use;
+        $gbps = ($size * $times) / $use / (1000 * 1000 * 1000);
+        echo sprintf('%-8s %6dKiB: use %fs for %d times, %.2fGB/s', $kernel, $size / 1024, $use, $times, $gbps) . PHP_EOL;
+    }
+}
+
+Frame::setMaskKernel($defaultKernel);
@@ -40,14 +40,20 @@ while (true) {
         $buffer = new Buffer();
         $parser = (new Parser())->setType(Parser::TYPE_REQUEST)->setEvents(Parser::EVENT_BODY);
         $body = null;
+        $keepAlive = true;
         try {
             while (true) {
                 $length = $client->recv($buffer);
                 if ($length === 0) {
                     break;
                 }
+                /* handle all (pipelined) requests we have received, and send their responses by one write */
+                $responses = [];
                 while (true) {
                     $event = $parser->execute($buffer);
+                    if ($event === Parser::EVENT_NONE) {
+                        break;
+                    }
                     if ($event === Parser::EVENT_BODY) {
                         if ($body === null) {
                             $body = new Buffer();
@@ -55,23 +61,30 @@ while (true) {
                         $body->write($buffer->toString(), $parser->getDataOffset(), $parser->getDataLength());
                     }
                     if ($parser->isCompleted()) {
-                        $response = sprintf(
+                        $keepAlive = $parser->shouldKeepAlive();
+                        $responses[] = sprintf(
                             "HTTP/1.1 200 OK\r\n" .
                             "Connection: %s\r\n" .
                             "Content-Length: %d\r\n\r\n" .
                             '%s',
-                            $parser->shouldKeepAlive() ? 'Keep-Alive' : 'Closed',
+                            $keepAlive ? 'Keep-Alive' : 'Closed',
                             $body ? $body->getLength() : 0,
                             $body ? $body->toString() : ''
                         );
-                        $client->sendString($response);
                         if ($body !== null) {
                             $body->clear();
                         }
-                        break;
+                        if (!$keepAlive) {
+                            break;
+                        }
                     }
                 }
-                if (!$parser->shouldKeepAlive()) {
+                /* all data has been consumed by the parser */
+                $buffer->clear();
+                if ($responses) {
+                    $client->write($responses);
+                }
+                if (!$keepAlive) {
                     break;
                 }
             }
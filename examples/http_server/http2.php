@@ -0,0 +1,89 @@
+<?php
+/**
+ * This file is part of Swow
+ *
+ * @link     https://github.com/swow/swow
+ * @contact  twosee <twosee@php.net>
+ *
+ * For the full copyright and license information,
+ * please view the LICENSE file that was distributed with this source code
+ */
+
+declare(strict_types=1);
+
+/*
+ * Try it with:
+ *   curl -v --http2-prior-knowledge http://127.0.0.1:9764/greeter
+ *   curl -v --http2 http://127.0.0.1:9764/echo -d 'Hello Swow'
+ *   h2load -n 10000 -c 10 -m 10 http://127.0.0.1:9764/
+ */
+
+require __DIR__ . '/../../tools/autoload.php';
+
+use Swow\Coroutine;
+use Swow\Coroutine\Exception as CoroutineException;
+use Swow\Http\Exception as HttpException;
+use Swow\Http\Server as HttpServer;
+use Swow\Http\Server\Request as HttpRequest;
+use Swow\Http\Status as HttpStatus;
+use Swow\Http2\Stream as Http2Stream;
+use Swow\Socket\Exception as SocketException;
+use const Swow\Errno\EMFILE;
+use const Swow\Errno\ENFILE;
+use const Swow\Errno\ENOMEM;
+
+/* it runs in the coroutine of each stream */
+$handler = static function (HttpRequest $request, Http2Stream $stream): void {
+    switch ($request->getPath()) {
+        case '/':
+            $stream->respond();
+            break;
+        case '/greeter':
+            $stream->respond('Hello Swow');
+            break;
+        case '/echo':
+            $stream->respond($request->getBodyAsString());
+            break;
+        default:
+            $stream->error(HttpStatus::NOT_FOUND);
+    }
+};
+
+$server = new HttpServer();
+$server->bind('0.0.0.0', 9764)->listen();
+while (true) {
+    try {
+        $session = $server->acceptSession();
+        Coroutine::run(static function () use ($session, $handler): void {
+            try {
+                while (true) {
+                    $request = null;
+                    try {
+                        $request = $session->recvHttpRequest();
+                        if ($request->getUpgrade() === $request::UPGRADE_H2C) {
+                            /* it returns after the HTTP/2 connection is closed */
+                            $session->upgradeToHttp2($request, $handler);
+                            break;
+                        }
+                        $session->respond('Please use HTTP/2');
+                    } catch (HttpException $exception) {
+                        $session->error($exception->getCode(), $exception->getMessage());
+                    }
+                    if (!$request || !$request->getKeepAlive()) {
+                        break;
+                    }
+                }
+            } catch (Exception $exception) {
+                // you can log error here
+            } finally {
+                $session->close();
+            }
+        });
+    } catch (SocketException | CoroutineException $exception) {
+        if (in_array($exception->getCode(), [EMFILE, ENFILE, ENOMEM], true)) {
+            sleep(1);
+        } else {
+            break;
+        }
+    }
+}
@@ -0,0 +1,50 @@
+<?php
+/**
+ * This file is part of Swow
+ *
+ * @link     https://github.com/swow/swow
+ * @contact  twosee <twosee@php.net>
+ *
+ * For the full copyright and license information,
+ * please view the LICENSE file that was distributed with this source code
+ */
+
+/* @noinspection PhpUnreachableStatementInspection */
+
+declare(strict_types=1);
+
+use Swow\Coroutine;
+use Swow\WatchDog;
+
+/* check every 1ms, coroutines are preempted after they have run for 10ms without yielding */
+WatchDog::run(1 * 1000 * 1000, 0, 0, 10 * 1000 * 1000);
+
+/* it looks like a connection handler, its latency should not be affected by the runaway loop */
+Coroutine::run(function () {
+    for ($n = 10; $n--;) {
+        $s = microtime(true);
+        usleep(1000);
+        $s = (microtime(true) - $s) * 1000;
+        echo "Latency is {$s} ms" . PHP_EOL;
+    }
+});
+
+/* this one can run for 50ms before it is preempted */
+Coroutine::run(function () {
+    Coroutine::getCurrent()->setTimeSlice(50 * 1000 * 1000);
+    $s = microtime(true);
+    while (microtime(true) - $s < 1) {
+        continue;
+    }
+    echo 'Slow job done' . PHP_EOL;
+});
+
+/* runaway loop */
+$count = 0;
+try {
+    while (true) {
+        $count++;
+    }
+} finally {
+    echo "Count is {$count}" . PHP_EOL;
+}
@@ -98,8 +98,11 @@ if test "${SWOW}" != "no"; then
     ${SWOW_SRC_DIR}/swow_stream.c
     ${SWOW_SRC_DIR}/swow_signal.c
     ${SWOW_SRC_DIR}/swow_watch_dog.c
+    ${SWOW_SRC_DIR}/swow_work.c
     ${SWOW_SRC_DIR}/swow_http.c
     ${SWOW_SRC_DIR}/swow_websocket.c
+    ${SWOW_SRC_DIR}/swow_http2.c
+    ${SWOW_SRC_DIR}/swow_metrics.c
   "
 
   if test "libcat" != ""; then
@@ -131,6 +134,7 @@ if test "${SWOW}" != "no"; then
         ${CAT_DIR}/src/cat_sync.c
         ${CAT_DIR}/src/cat_event.c
         ${CAT_DIR}/src/cat_time.c
+        ${CAT_DIR}/src/cat_io_uring.c
         ${CAT_DIR}/src/cat_socket.c
         ${CAT_DIR}/src/cat_dns.c
         ${CAT_DIR}/src/cat_work.c
@@ -140,6 +144,7 @@ if test "${SWOW}" != "no"; then
         ${CAT_DIR}/src/cat_watch_dog.c
         ${CAT_DIR}/src/cat_http.c
         ${CAT_DIR}/src/cat_websocket.c
+        ${CAT_DIR}/src/cat_http2.c
       "
 
       PHP_ADD_INCLUDE(${CAT_DIR}/include)
@@ -159,6 +164,32 @@ if test "${SWOW}" != "no"; then
         ])
       fi
 
+      dnl ====== Check io_uring ======
+
+      AC_MSG_CHECKING([for io_uring])
+      AC_COMPILE_IFELSE([AC_LANG_PROGRAM([[
+          #include <linux/io_uring.h>
+          #include <sys/syscall.h>
+      ]], [[
+          int features = IORING_FEAT_FAST_POLL | IORING_FEAT_RW_CUR_POS;
+          int opcodes[] = { IORING_OP_RECV, IORING_OP_READ, IORING_OP_WRITE, IORING_OP_ASYNC_CANCEL };
+          long setup = __NR_io_uring_setup, enter = __NR_io_uring_enter;
+      ]])],[
+          AC_DEFINE([HAVE_LINUX_IO_URING_H], 1, [Have io_uring])
+          AC_MSG_RESULT([yes])
+      ],[
+          AC_MSG_RESULT([no])
+      ])
+
+      dnl ====== Check zlib ======
+
+      PHP_CHECK_LIBRARY(z, deflateBound, [
+          AC_CHECK_HEADER([zlib.h], [
+              AC_DEFINE([HAVE_SWOW_ZLIB], 1, [Have zlib])
+              PHP_ADD_LIBRARY(z)
+          ])
+      ])
+
       dnl ====== Check boost context dependency ======
 
       AS_CASE([$host_os],
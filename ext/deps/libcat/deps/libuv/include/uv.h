@@ -1119,6 +1119,72 @@ UV_EXTERN int uv_queue_work(uv_loop_t* loop,
 
 UV_EXTERN int uv_cancel(uv_req_t* req);
 
+#ifdef HAVE_LIBCAT
+typedef struct uv_threadpool_s uv_threadpool_t;
+
+/* works are dispatched to thread pools of the loop by their kinds */
+typedef enum {
+  UV_THREADPOOL_KIND_CPU,     /* uv_queue_work() */
+  UV_THREADPOOL_KIND_FAST_IO, /* uv_fs_*() */
+  UV_THREADPOOL_KIND_SLOW_IO, /* uv_getaddrinfo(), uv_getnameinfo() */
+  UV_THREADPOOL_KIND_MAX
+} uv_threadpool_kind_t;
+
+#define UV_THREADPOOL_NAME_SIZE 32
+
+/* histogram[i] counts durations in [2^(i-1), 2^i) microseconds,
+ * the last one also counts all the longer ones */
+#define UV_THREADPOOL_HISTOGRAM_SIZE 24
+
+typedef struct uv_threadpool_stats_s {
+  unsigned int size;
+  unsigned int max_queue_size;
+  unsigned int queue_size;
+  unsigned int running;
+  uint64_t submitted;
+  uint64_t completed;
+  uint64_t canceled;
+  uint64_t rejected;
+  /* in nanoseconds */
+  uint64_t queue_wait_time;
+  uint64_t run_time;
+  uint64_t queue_wait_histogram[UV_THREADPOOL_HISTOGRAM_SIZE];
+  uint64_t run_time_histogram[UV_THREADPOOL_HISTOGRAM_SIZE];
+} uv_threadpool_stats_t;
+
+/* max_queue_size is 0 means unlimited, otherwise works are rejected
+ * with UV_EAGAIN when there are too many works waiting for threads;
+ * priority is the nice value of threads (Linux only) */
+UV_EXTERN int uv_threadpool_create(uv_threadpool_t** pool,
+                                   const char* name,
+                                   unsigned int size,
+                                   unsigned int max_queue_size,
+                                   int priority);
+/* pool must not be used by any loop, UV_EBUSY if there are works on it
+ * (including finished ones whose done callbacks have not been called yet) */
+UV_EXTERN int uv_threadpool_close(uv_threadpool_t* pool);
+UV_EXTERN uv_threadpool_t* uv_threadpool_default(void);
+UV_EXTERN const char* uv_threadpool_name(const uv_threadpool_t* pool);
+UV_EXTERN int uv_threadpool_priority(const uv_threadpool_t* pool);
+UV_EXTERN void uv_threadpool_set_max_queue_size(uv_threadpool_t* pool,
+                                                unsigned int max_queue_size);
+UV_EXTERN void uv_threadpool_get_stats(uv_threadpool_t* pool,
+                                       uv_threadpool_stats_t* stats);
+UV_EXTERN void uv_threadpool_reset_stats(uv_threadpool_t* pool);
+UV_EXTERN uv_threadpool_t* uv_loop_get_threadpool(const uv_loop_t* loop,
+                                                  uv_threadpool_kind_t kind);
+/* NULL means the default (shared) pool */
+UV_EXTERN void uv_loop_set_threadpool(uv_loop_t* loop,
+                                      uv_threadpool_kind_t kind,
+                                      uv_threadpool_t* pool);
+/* pool NULL means the pool of UV_THREADPOOL_KIND_CPU */
+UV_EXTERN int uv_queue_work_ex(uv_loop_t* loop,
+                               uv_work_t* req,
+                               uv_threadpool_t* pool,
+                               uv_work_cb work_cb,
+                               uv_after_work_cb after_work_cb);
+#endif
+
 
 struct uv_cpu_times_s {
   uint64_t user; /* milliseconds */
@@ -32,6 +32,10 @@ struct uv__work {
   void (*done)(struct uv__work *w, int status);
   struct uv_loop_s* loop;
   void* wq[2];
+#ifdef HAVE_LIBCAT
+  struct uv_threadpool_s* pool;
+  uint64_t queued_time;
+#endif
 };
 
 #endif /* UV_THREADPOOL_H_ */
@@ -26,24 +26,60 @@
 #endif
 
 #include <stdlib.h>
+#ifdef HAVE_LIBCAT
+# include <string.h>
+# if defined(__linux__)
+#  include <sys/resource.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+# endif
+#endif
 
 #define MAX_THREADPOOL_SIZE 1024
 
+struct uv_threadpool_s {
+  uv_cond_t cond;
+  uv_mutex_t mutex;
+  unsigned int idle_threads;
+  unsigned int slow_io_work_running;
+  unsigned int nthreads;
+  uv_thread_t* threads;
+  QUEUE exit_message;
+  QUEUE wq;
+  QUEUE run_slow_work_message;
+  QUEUE slow_io_pending_wq;
+#ifdef HAVE_LIBCAT
+  char name[UV_THREADPOOL_NAME_SIZE];
+  int priority;
+  unsigned int max_queue_size;
+  /* works which have been posted but not started yet */
+  unsigned int queue_size;
+  unsigned int running;
+  /* works whose done callbacks have not been called yet, uv_cancel() may
+   * still lock `mutex` for them, so the pool must outlive them */
+  unsigned int pending;
+  /* only counters are maintained here */
+  uv_threadpool_stats_t stats;
+#endif
+};
+
+struct uv__threadpool_worker_arg {
+  struct uv_threadpool_s* pool;
+  uv_sem_t* sem;
+};
+
 static uv_once_t once = UV_ONCE_INIT;
-static uv_cond_t cond;
-static uv_mutex_t mutex;
-static unsigned int idle_threads;
-static unsigned int slow_io_work_running;
-static unsigned int nthreads;
-static uv_thread_t* threads;
 static uv_thread_t default_threads[4];
-static QUEUE exit_message;
-static QUEUE wq;
-static QUEUE run_slow_work_message;
-static QUEUE slow_io_pending_wq;
+static struct uv_threadpool_s default_pool;
+
+#ifdef HAVE_LIBCAT
+# define UV__WORK_POOL(w) ((w)->pool)
+#else
+# define UV__WORK_POOL(w) (&default_pool)
+#endif
 
-static unsigned int slow_work_thread_threshold(void) {
-  return (nthreads + 1) / 2;
+static unsigned int slow_work_thread_threshold(struct uv_threadpool_s* pool) {
+  return (pool->nthreads + 1) / 2;
 }
 
 static void uv__cancelled(struct uv__work* w) {
@@ -51,36 +87,71 @@ static void uv__cancelled(struct uv__work* w) {
 }
 
 
+#ifdef HAVE_LIBCAT
+static void uv__threadpool_histogram_add(uint64_t* histogram, uint64_t ns) {
+  uint64_t us;
+  unsigned int i;
+
+  /* histogram[i] counts [2^(i-1), 2^i) us */
+  us = ns / 1000;
+  for (i = 0; us != 0 && i < UV_THREADPOOL_HISTOGRAM_SIZE - 1; i++)
+    us >>= 1;
+  histogram[i]++;
+}
+
+
+static void uv__threadpool_set_priority(struct uv_threadpool_s* pool) {
+  if (pool->priority == 0)
+    return;
+#if defined(__linux__)
+  /* threads have their own nice values on Linux,
+   * lowering the priority is always allowed, raising requires CAP_SYS_NICE */
+  (void) setpriority(PRIO_PROCESS, (id_t) syscall(SYS_gettid), pool->priority);
+#endif
+}
+#endif
+
+
 /* To avoid deadlock with uv_cancel() it's crucial that the worker
- * never holds the global mutex and the loop-local mutex at the same time.
+ * never holds the pool mutex and the loop-local mutex at the same time.
  */
 static void worker(void* arg) {
+  struct uv_threadpool_s* pool;
   struct uv__work* w;
   QUEUE* q;
   int is_slow_work;
+#ifdef HAVE_LIBCAT
+  uint64_t start_time;
+  uint64_t end_time;
+#endif
 
-  uv_sem_post((uv_sem_t*) arg);
+  pool = ((struct uv__threadpool_worker_arg*) arg)->pool;
+  uv_sem_post(((struct uv__threadpool_worker_arg*) arg)->sem);
   arg = NULL;
 
-  uv_mutex_lock(&mutex);
+#ifdef HAVE_LIBCAT
+  uv__threadpool_set_priority(pool);
+#endif
+
+  uv_mutex_lock(&pool->mutex);
   for (;;) {
     /* `mutex` should always be locked at this point. */
 
     /* Keep waiting while either no work is present or only slow I/O
        and we're at the threshold for that. */
-    while (QUEUE_EMPTY(&wq) ||
-           (QUEUE_HEAD(&wq) == &run_slow_work_message &&
-            QUEUE_NEXT(&run_slow_work_message) == &wq &&
-            slow_io_work_running >= slow_work_thread_threshold())) {
-      idle_threads += 1;
-      uv_cond_wait(&cond, &mutex);
-      idle_threads -= 1;
+    while (QUEUE_EMPTY(&pool->wq) ||
+           (QUEUE_HEAD(&pool->wq) == &pool->run_slow_work_message &&
+            QUEUE_NEXT(&pool->run_slow_work_message) == &pool->wq &&
+            pool->slow_io_work_running >= slow_work_thread_threshold(pool))) {
+      pool->idle_threads += 1;
+      uv_cond_wait(&pool->cond, &pool->mutex);
+      pool->idle_threads -= 1;
     }
 
-    q = QUEUE_HEAD(&wq);
-    if (q == &exit_message) {
-      uv_cond_signal(&cond);
-      uv_mutex_unlock(&mutex);
+    q = QUEUE_HEAD(&pool->wq);
+    if (q == &pool->exit_message) {
+      uv_cond_signal(&pool->cond);
+      uv_mutex_unlock(&pool->mutex);
       break;
     }
 
@@ -88,39 +159,61 @@ static void worker(void* arg) {
     QUEUE_INIT(q);  /* Signal uv_cancel() that the work req is executing. */
 
     is_slow_work = 0;
-    if (q == &run_slow_work_message) {
+    if (q == &pool->run_slow_work_message) {
       /* If we're at the slow I/O threshold, re-schedule until after all
          other work in the queue is done. */
-      if (slow_io_work_running >= slow_work_thread_threshold()) {
-        QUEUE_INSERT_TAIL(&wq, q);
+      if (pool->slow_io_work_running >= slow_work_thread_threshold(pool)) {
+        QUEUE_INSERT_TAIL(&pool->wq, q);
         continue;
       }
 
       /* If we encountered a request to run slow I/O work but there is none
          to run, that means it's cancelled => Start over. */
-      if (QUEUE_EMPTY(&slow_io_pending_wq))
+      if (QUEUE_EMPTY(&pool->slow_io_pending_wq))
         continue;
 
       is_slow_work = 1;
-      slow_io_work_running++;
+      pool->slow_io_work_running++;
 
-      q = QUEUE_HEAD(&slow_io_pending_wq);
+      q = QUEUE_HEAD(&pool->slow_io_pending_wq);
       QUEUE_REMOVE(q);
       QUEUE_INIT(q);
 
       /* If there is more slow I/O work, schedule it to be run as well. */
-      if (!QUEUE_EMPTY(&slow_io_pending_wq)) {
-        QUEUE_INSERT_TAIL(&wq, &run_slow_work_message);
-        if (idle_threads > 0)
-          uv_cond_signal(&cond);
+      if (!QUEUE_EMPTY(&pool->slow_io_pending_wq)) {
+        QUEUE_INSERT_TAIL(&pool->wq, &pool->run_slow_work_message);
+        if (pool->idle_threads > 0)
+          uv_cond_signal(&pool->cond);
       }
     }
 
-    uv_mutex_unlock(&mutex);
-
     w = QUEUE_DATA(q, struct uv__work, wq);
+#ifdef HAVE_LIBCAT
+    start_time = uv_hrtime();
+    pool->queue_size--;
+    pool->running++;
+    pool->stats.queue_wait_time += start_time - w->queued_time;
+    uv__threadpool_histogram_add(pool->stats.queue_wait_histogram,
+                                 start_time - w->queued_time);
+#endif
+
+    uv_mutex_unlock(&pool->mutex);
+
     w->work(w);
 
+#ifdef HAVE_LIBCAT
+    /* account it before `w` is handed to the loop, otherwise the done
+     * callback (or uv_threadpool_close()) may still see it running */
+    end_time = uv_hrtime();
+    uv_mutex_lock(&pool->mutex);
+    pool->running--;
+    pool->stats.completed++;
+    pool->stats.run_time += end_time - start_time;
+    uv__threadpool_histogram_add(pool->stats.run_time_histogram,
+                                 end_time - start_time);
+    uv_mutex_unlock(&pool->mutex);
+#endif
+
     uv_mutex_lock(&w->loop->wq_mutex);
     w->work = NULL;  /* Signal uv_cancel() that the work req is done
                         executing. */
@@ -130,65 +223,121 @@ static void worker(void* arg) {
 
     /* Lock `mutex` since that is expected at the start of the next
      * iteration. */
-    uv_mutex_lock(&mutex);
+    uv_mutex_lock(&pool->mutex);
     if (is_slow_work) {
       /* `slow_io_work_running` is protected by `mutex`. */
-      slow_io_work_running--;
+      pool->slow_io_work_running--;
     }
   }
 }
 
 
-static void post(QUEUE* q, enum uv__work_kind kind) {
-  uv_mutex_lock(&mutex);
-  if (kind == UV__WORK_SLOW_IO) {
+static void post(struct uv_threadpool_s* pool, QUEUE* q, enum uv__work_kind kind) {
+  uv_mutex_lock(&pool->mutex);
+#ifdef HAVE_LIBCAT
+  pool->queue_size++;
+  pool->pending++;
+  pool->stats.submitted++;
+#endif
+  /* only the shared pool reserves threads for fast works,
+   * dedicated pools run whatever they are given */
+  if (kind == UV__WORK_SLOW_IO && pool == &default_pool) {
     /* Insert into a separate queue. */
-    QUEUE_INSERT_TAIL(&slow_io_pending_wq, q);
-    if (!QUEUE_EMPTY(&run_slow_work_message)) {
+    QUEUE_INSERT_TAIL(&pool->slow_io_pending_wq, q);
+    if (!QUEUE_EMPTY(&pool->run_slow_work_message)) {
       /* Running slow I/O tasks is already scheduled => Nothing to do here.
          The worker that runs said other task will schedule this one as well. */
-      uv_mutex_unlock(&mutex);
+      uv_mutex_unlock(&pool->mutex);
       return;
     }
-    q = &run_slow_work_message;
+    q = &pool->run_slow_work_message;
   }
 
-  QUEUE_INSERT_TAIL(&wq, q);
-  if (idle_threads > 0)
-    uv_cond_signal(&cond);
-  uv_mutex_unlock(&mutex);
+  QUEUE_INSERT_TAIL(&pool->wq, q);
+  if (pool->idle_threads > 0)
+    uv_cond_signal(&pool->cond);
+  uv_mutex_unlock(&pool->mutex);
+}
+
+
+static void uv__threadpool_stop(struct uv_threadpool_s* pool) {
+  unsigned int i;
+
+  uv_mutex_lock(&pool->mutex);
+  QUEUE_INSERT_TAIL(&pool->wq, &pool->exit_message);
+  uv_cond_signal(&pool->cond);
+  uv_mutex_unlock(&pool->mutex);
+
+  for (i = 0; i < pool->nthreads; i++)
+    if (uv_thread_join(pool->threads + i))
+      abort();
+
+  uv_mutex_destroy(&pool->mutex);
+  uv_cond_destroy(&pool->cond);
 }
 
 
 void uv__threadpool_cleanup(void) {
 #ifndef _WIN32
+  if (default_pool.nthreads == 0)
+    return;
+
+  uv__threadpool_stop(&default_pool);
+
+  if (default_pool.threads != default_threads)
+    uv__free(default_pool.threads);
+
+  default_pool.threads = NULL;
+  default_pool.nthreads = 0;
+#endif
+}
+
+
+/* threads are created with pool->threads and pool->nthreads,
+ * pool->nthreads will be updated to the number of threads actually started */
+static int uv__threadpool_init(struct uv_threadpool_s* pool) {
+  struct uv__threadpool_worker_arg arg;
   unsigned int i;
+  uv_sem_t sem;
+  int err;
 
-  if (nthreads == 0)
-    return;
+  if (uv_cond_init(&pool->cond))
+    abort();
 
-  post(&exit_message, UV__WORK_CPU);
+  if (uv_mutex_init(&pool->mutex))
+    abort();
 
-  for (i = 0; i < nthreads; i++)
-    if (uv_thread_join(threads + i))
-      abort();
+  pool->idle_threads = 0;
+  pool->slow_io_work_running = 0;
+  QUEUE_INIT(&pool->wq);
+  QUEUE_INIT(&pool->slow_io_pending_wq);
+  QUEUE_INIT(&pool->run_slow_work_message);
+
+  if (uv_sem_init(&sem, 0))
+    abort();
+
+  arg.pool = pool;
+  arg.sem = &sem;
+  err = 0;
+  for (i = 0; i < pool->nthreads; i++) {
+    err = uv_thread_create(pool->threads + i, worker, &arg);
+    if (err)
+      break;
+  }
 
-  if (threads != default_threads)
-    uv__free(threads);
+  pool->nthreads = i;
+  for (i = 0; i < pool->nthreads; i++)
+    uv_sem_wait(&sem);
 
-  uv_mutex_destroy(&mutex);
-  uv_cond_destroy(&cond);
+  uv_sem_destroy(&sem);
 
-  threads = NULL;
-  nthreads = 0;
-#endif
+  return err;
 }
 
 
 static void init_threads(void) {
-  unsigned int i;
+  unsigned int nthreads;
   const char* val;
-  uv_sem_t sem;
 
   nthreads = ARRAY_SIZE(default_threads);
 #ifdef HAVE_LIBCAT
@@ -203,36 +352,21 @@ static void init_threads(void) {
   if (nthreads > MAX_THREADPOOL_SIZE)
     nthreads = MAX_THREADPOOL_SIZE;
 
-  threads = default_threads;
+  default_pool.threads = default_threads;
   if (nthreads > ARRAY_SIZE(default_threads)) {
-    threads = uv__malloc(nthreads * sizeof(threads[0]));
-    if (threads == NULL) {
+    default_pool.threads = uv__malloc(nthreads * sizeof(default_pool.threads[0]));
+    if (default_pool.threads == NULL) {
       nthreads = ARRAY_SIZE(default_threads);
-      threads = default_threads;
+      default_pool.threads = default_threads;
     }
   }
+  default_pool.nthreads = nthreads;
+#ifdef HAVE_LIBCAT
+  memcpy(default_pool.name, "default", sizeof("default"));
+#endif
 
-  if (uv_cond_init(&cond))
-    abort();
-
-  if (uv_mutex_init(&mutex))
-    abort();
-
-  QUEUE_INIT(&wq);
-  QUEUE_INIT(&slow_io_pending_wq);
-  QUEUE_INIT(&run_slow_work_message);
-
-  if (uv_sem_init(&sem, 0))
+  if (uv__threadpool_init(&default_pool))
     abort();
-
-  for (i = 0; i < nthreads; i++)
-    if (uv_thread_create(threads + i, worker, &sem))
-      abort();
-
-  for (i = 0; i < nthreads; i++)
-    uv_sem_wait(&sem);
-
-  uv_sem_destroy(&sem);
 }
 
 
@@ -257,31 +391,87 @@ static void init_once(void) {
 }
 
 
+static struct uv_threadpool_s* uv__work_pool(uv_loop_t* loop,
+                                             enum uv__work_kind kind) {
+#ifdef HAVE_LIBCAT
+  struct uv_threadpool_s* pool;
+
+  pool = uv__get_internal_fields(loop)->threadpools[kind];
+  if (pool != NULL)
+    return pool;
+#endif
+  uv_once(&once, init_once);
+  return &default_pool;
+}
+
+
+static void uv__work_submit_to(struct uv_threadpool_s* pool,
+                               uv_loop_t* loop,
+                               struct uv__work* w,
+                               enum uv__work_kind kind,
+                               void (*work)(struct uv__work* w),
+                               void (*done)(struct uv__work* w, int status)) {
+  w->loop = loop;
+  w->work = work;
+  w->done = done;
+#ifdef HAVE_LIBCAT
+  w->pool = pool;
+  w->queued_time = uv_hrtime();
+#endif
+  post(pool, &w->wq, kind);
+}
+
+
 void uv__work_submit(uv_loop_t* loop,
                      struct uv__work* w,
                      enum uv__work_kind kind,
                      void (*work)(struct uv__work* w),
                      void (*done)(struct uv__work* w, int status)) {
-  uv_once(&once, init_once);
-  w->loop = loop;
-  w->work = work;
-  w->done = done;
-  post(&w->wq, kind);
+  uv__work_submit_to(uv__work_pool(loop, kind), loop, w, kind, work, done);
+}
+
+
+#ifdef HAVE_LIBCAT
+static int uv__threadpool_check(struct uv_threadpool_s* pool) {
+  int err;
+
+  err = 0;
+  uv_mutex_lock(&pool->mutex);
+  if (pool->max_queue_size != 0 && pool->queue_size >= pool->max_queue_size) {
+    pool->stats.rejected++;
+    err = UV_EAGAIN;
+  }
+  uv_mutex_unlock(&pool->mutex);
+
+  return err;
+}
+
+
+int uv__work_check(uv_loop_t* loop, enum uv__work_kind kind) {
+  return uv__threadpool_check(uv__work_pool(loop, kind));
 }
+#endif
 
 
 static int uv__work_cancel(uv_loop_t* loop, uv_req_t* req, struct uv__work* w) {
+  struct uv_threadpool_s* pool;
   int cancelled;
 
-  uv_mutex_lock(&mutex);
+  pool = UV__WORK_POOL(w);
+  uv_mutex_lock(&pool->mutex);
   uv_mutex_lock(&w->loop->wq_mutex);
 
   cancelled = !QUEUE_EMPTY(&w->wq) && w->work != NULL;
-  if (cancelled)
+  if (cancelled) {
     QUEUE_REMOVE(&w->wq);
+#ifdef HAVE_LIBCAT
+    pool->queue_size--;
+    pool->stats.canceled++;
+#endif
+  }
 
   uv_mutex_unlock(&w->loop->wq_mutex);
-  uv_mutex_unlock(&mutex);
+  uv_mutex_unlock(&pool->mutex);
 
   if (!cancelled)
     return UV_EBUSY;
@@ -314,6 +504,12 @@ void uv__work_done(uv_async_t* handle) {
 
     w = container_of(q, struct uv__work, wq);
     err = (w->work == uv__cancelled) ? UV_ECANCELED : 0;
+#ifdef HAVE_LIBCAT
+    /* `w` may be freed by the done callback, settle it before */
+    uv_mutex_lock(&w->pool->mutex);
+    w->pool->pending--;
+    uv_mutex_unlock(&w->pool->mutex);
+#endif
     w->done(w, err);
   }
 }
@@ -343,6 +539,9 @@ int uv_queue_work(uv_loop_t* loop,
                   uv_work_t* req,
                   uv_work_cb work_cb,
                   uv_after_work_cb after_work_cb) {
+#ifdef HAVE_LIBCAT
+  return uv_queue_work_ex(loop, req, NULL, work_cb, after_work_cb);
+#else
   if (work_cb == NULL)
     return UV_EINVAL;
 
@@ -356,9 +555,42 @@ int uv_queue_work(uv_loop_t* loop,
                   uv__queue_work,
                   uv__queue_done);
   return 0;
+#endif
 }
 
 
+#ifdef HAVE_LIBCAT
+int uv_queue_work_ex(uv_loop_t* loop,
+                     uv_work_t* req,
+                     uv_threadpool_t* pool,
+                     uv_work_cb work_cb,
+                     uv_after_work_cb after_work_cb) {
+  int err;
+
+  if (work_cb == NULL)
+    return UV_EINVAL;
+
+  if (pool == NULL)
+    pool = uv__work_pool(loop, UV__WORK_CPU);
+  err = uv__threadpool_check(pool);
+  if (err)
+    return err;
+
+  uv__req_init(loop, req, UV_WORK);
+  req->loop = loop;
+  req->work_cb = work_cb;
+  req->after_work_cb = after_work_cb;
+  uv__work_submit_to(pool,
+                     loop,
+                     &req->work_req,
+                     UV__WORK_CPU,
+                     uv__queue_work,
+                     uv__queue_done);
+  return 0;
+}
+#endif
+
+
 int uv_cancel(uv_req_t* req) {
   struct uv__work* wreq;
   uv_loop_t* loop;
@@ -390,3 +622,127 @@ int uv_cancel(uv_req_t* req) {
 
   return uv__work_cancel(loop, req, wreq);
 }
+
+
+#ifdef HAVE_LIBCAT
+int uv_threadpool_create(uv_threadpool_t** pool_ptr,
+                         const char* name,
+                         unsigned int size,
+                         unsigned int max_queue_size,
+                         int priority) {
+  uv_threadpool_t* pool;
+  size_t name_length;
+  int err;
+
+  if (pool_ptr == NULL || name == NULL || size == 0)
+    return UV_EINVAL;
+  if (size > MAX_THREADPOOL_SIZE)
+    size = MAX_THREADPOOL_SIZE;
+
+  pool = uv__calloc(1, sizeof(*pool));
+  if (pool == NULL)
+    return UV_ENOMEM;
+  pool->threads = uv__malloc(size * sizeof(pool->threads[0]));
+  if (pool->threads == NULL) {
+    uv__free(pool);
+    return UV_ENOMEM;
+  }
+  name_length = strlen(name);
+  if (name_length > sizeof(pool->name) - 1)
+    name_length = sizeof(pool->name) - 1;
+  memcpy(pool->name, name, name_length);
+  pool->name[name_length] = '\0';
+  pool->priority = priority;
+  pool->max_queue_size = max_queue_size;
+  pool->nthreads = size;
+
+  err = uv__threadpool_init(pool);
+  if (err) {
+    uv__threadpool_stop(pool);
+    uv__free(pool->threads);
+    uv__free(pool);
+    return err;
+  }
+
+  *pool_ptr = pool;
+  return 0;
+}
+
+
+int uv_threadpool_close(uv_threadpool_t* pool) {
+  int busy;
+
+  if (pool == &default_pool)
+    return UV_EINVAL;
+
+  uv_mutex_lock(&pool->mutex);
+  busy = pool->pending != 0;
+  uv_mutex_unlock(&pool->mutex);
+  if (busy)
+    return UV_EBUSY;
+
+  uv__threadpool_stop(pool);
+  uv__free(pool->threads);
+  uv__free(pool);
+
+  return 0;
+}
+
+
+uv_threadpool_t* uv_threadpool_default(void) {
+  uv_once(&once, init_once);
+  return &default_pool;
+}
+
+
+const char* uv_threadpool_name(const uv_threadpool_t* pool) {
+  return pool->name;
+}
+
+
+int uv_threadpool_priority(const uv_threadpool_t* pool) {
+  return pool->priority;
+}
+
+
+void uv_threadpool_set_max_queue_size(uv_threadpool_t* pool,
+                                      unsigned int max_queue_size) {
+  uv_mutex_lock(&pool->mutex);
+  pool->max_queue_size = max_queue_size;
+  uv_mutex_unlock(&pool->mutex);
+}
+
+
+void uv_threadpool_get_stats(uv_threadpool_t* pool,
+                             uv_threadpool_stats_t* stats) {
+  uv_mutex_lock(&pool->mutex);
+  memcpy(stats, &pool->stats, sizeof(*stats));
+  stats->size = pool->nthreads;
+  stats->max_queue_size = pool->max_queue_size;
+  stats->queue_size = pool->queue_size;
+  stats->running = pool->running;
+  uv_mutex_unlock(&pool->mutex);
+}
+
+
+void uv_threadpool_reset_stats(uv_threadpool_t* pool) {
+  uv_mutex_lock(&pool->mutex);
+  memset(&pool->stats, 0, sizeof(pool->stats));
+  uv_mutex_unlock(&pool->mutex);
+}
+
+
+uv_threadpool_t* uv_loop_get_threadpool(const uv_loop_t* loop,
+                                        uv_threadpool_kind_t kind) {
+  return uv__work_pool((uv_loop_t*) loop, (enum uv__work_kind) kind);
+}
+
+
+void uv_loop_set_threadpool(uv_loop_t* loop,
+                            uv_threadpool_kind_t kind,
+                            uv_threadpool_t* pool) {
+  if (pool == &default_pool)
+    pool = NULL;
+  uv__get_internal_fields(loop)->threadpools[kind] = pool;
+}
+#endif
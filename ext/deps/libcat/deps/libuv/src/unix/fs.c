@@ -93,10 +93,25 @@
 extern char *mkdtemp(char *template); /* See issue #740 on AIX < 7 */
 #endif
 
+#ifdef HAVE_LIBCAT
+#define UV__FS_CHECK()                                                        \
+  do {                                                                        \
+    if (cb != NULL) {                                                         \
+      int check_err = uv__work_check(loop, UV__WORK_FAST_IO);                 \
+      if (check_err)                                                          \
+        return check_err;                                                     \
+    }                                                                         \
+  }                                                                           \
+  while (0)
+#else
+#define UV__FS_CHECK()
+#endif
+
 #define INIT(subtype)                                                         \
   do {                                                                        \
     if (req == NULL)                                                          \
       return UV_EINVAL;                                                       \
+    UV__FS_CHECK();                                                           \
     UV_REQ_INIT(req, UV_FS);                                                  \
     req->fs_type = UV_FS_ ## subtype;                                         \
     req->result = 0;                                                          \
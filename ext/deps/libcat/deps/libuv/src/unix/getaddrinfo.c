@@ -155,6 +155,14 @@ int uv_getaddrinfo(uv_loop_t* loop,
   if (req == NULL || (hostname == NULL && service == NULL))
     return UV_EINVAL;
 
+#ifdef HAVE_LIBCAT
+  if (cb != NULL) {
+    rc = uv__work_check(loop, UV__WORK_SLOW_IO);
+    if (rc)
+      return rc;
+  }
+#endif
+
   /* FIXME(bnoordhuis) IDNA does not seem to work z/OS,
    * probably because it uses EBCDIC rather than ASCII.
    */
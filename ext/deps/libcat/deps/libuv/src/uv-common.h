@@ -200,6 +200,11 @@ void uv__work_submit(uv_loop_t* loop,
                      void (*work)(struct uv__work *w),
                      void (*done)(struct uv__work *w, int status));
 
+#ifdef HAVE_LIBCAT
+/* UV_EAGAIN if the pool of this kind is full */
+int uv__work_check(uv_loop_t* loop, enum uv__work_kind kind);
+#endif
+
 void uv__work_done(uv_async_t* handle);
 
 size_t uv__count_bufs(const uv_buf_t bufs[], unsigned int nbufs);
@@ -363,6 +368,9 @@ void uv__metrics_set_provider_entry_time(uv_loop_t* loop);
 struct uv__loop_internal_fields_s {
   unsigned int flags;
   uv__loop_metrics_t loop_metrics;
+#ifdef HAVE_LIBCAT
+  struct uv_threadpool_s* threadpools[UV_THREADPOOL_KIND_MAX];
+#endif
 };
 
 #endif /* UV_COMMON_H_ */
@@ -42,10 +42,25 @@
 #define UV_FS_CLEANEDUP          0x0010
 
 
+#ifdef HAVE_LIBCAT
+#define UV__FS_CHECK()                                                        \
+  do {                                                                        \
+    if (cb != NULL) {                                                         \
+      int check_err = uv__work_check(loop, UV__WORK_FAST_IO);                 \
+      if (check_err)                                                          \
+        return check_err;                                                     \
+    }                                                                         \
+  }                                                                           \
+  while (0)
+#else
+#define UV__FS_CHECK()
+#endif
+
 #define INIT(subtype)                                                         \
   do {                                                                        \
     if (req == NULL)                                                          \
       return UV_EINVAL;                                                       \
+    UV__FS_CHECK();                                                           \
     uv_fs_req_init(loop, req, subtype, cb);                                   \
   }                                                                           \
   while (0)
@@ -272,6 +272,14 @@ int uv_getaddrinfo(uv_loop_t* loop,
     return UV_EINVAL;
   }
 
+#ifdef HAVE_LIBCAT
+  if (getaddrinfo_cb != NULL) {
+    rc = uv__work_check(loop, UV__WORK_SLOW_IO);
+    if (rc)
+      return rc;
+  }
+#endif
+
   UV_REQ_INIT(req, UV_GETADDRINFO);
   req->getaddrinfo_cb = getaddrinfo_cb;
   req->addrinfo = NULL;
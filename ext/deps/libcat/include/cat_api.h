@@ -28,6 +28,7 @@ extern "C" {
 #include "cat_sync.h"
 #include "cat_event.h"
 #include "cat_time.h"
+#include "cat_io_uring.h"
 #include "cat_socket.h"
 #include "cat_dns.h"
 #include "cat_work.h"
@@ -44,11 +44,12 @@ typedef uint8_t cat_channel_data_size_t;
 
 typedef void (*cat_channel_data_dtor_t)(const cat_data_t *data);
 
-typedef struct
-{
-    cat_queue_node_t node;
-    char data[1];
-} cat_channel_bucket_t;
+/* buffered channel stores data in a ring of slots,
+ * slots are preallocated up to this size on create and the ring grows on demand
+ * (doubling until it reaches the capacity) for the larger ones */
+#ifndef CAT_CHANNEL_BUFFERED_PREALLOC_SIZE
+#define CAT_CHANNEL_BUFFERED_PREALLOC_SIZE (64 * 1024)
+#endif
 
 typedef struct
 {
@@ -71,7 +72,9 @@ typedef struct
             } able;
         } unbuffered;
         struct {
-            cat_queue_t storage;
+            char *storage;
+            cat_channel_size_t size;
+            cat_channel_size_t head;
         } buffered;
     } u;
 } cat_channel_t;
@@ -132,7 +135,19 @@ CAT_API cat_channel_data_dtor_t cat_channel_set_dtor(cat_channel_t *channel, cat
 
 /* ext */
 
-CAT_API cat_queue_t *cat_channel_get_storage(cat_channel_t *channel); CAT_INTERNAL
+#define CAT_CHANNEL_BUFFERED_FOREACH_DATA_START(channel, name) do { \
+    const cat_channel_t *_channel = channel; \
+    cat_channel_size_t _index = _channel->u.buffered.head, _n; \
+    cat_data_t *name; \
+    for (_n = 0; _n < _channel->length; _n++) { \
+        name = (cat_data_t *) (_channel->u.buffered.storage + ((size_t) _index * _channel->data_size)); \
+        if (++_index == _channel->u.buffered.size) { \
+            _index = 0; \
+        } \
+
+#define CAT_CHANNEL_BUFFERED_FOREACH_DATA_END() \
+    } \
+} while (0)
 
 #ifdef __cplusplus
 }
@@ -30,6 +30,11 @@ extern "C" {
 #define CAT_COROUTINE_RECOMMENDED_STACK_SIZE    (256 * 1024)
 #define CAT_COROUTINE_MAX_STACK_SIZE            (16 * 1024 * 1024)
 
+/* stacks are pooled by power-of-two size classes (128K, 256K ... 16M) */
+#define CAT_COROUTINE_STACK_POOL_CLASS_COUNT              8
+#define CAT_COROUTINE_STACK_POOL_DEFAULT_LOW_WATERMARK    16
+#define CAT_COROUTINE_STACK_POOL_DEFAULT_HIGH_WATERMARK   128
+
 #define CAT_COROUTINE_MIN_ID                    0
 #define CAT_COROUTINE_MAX_ID                    UINT64_MAX
 #define CAT_COROUTINE_MAIN_ID                   1
@@ -112,6 +117,34 @@ typedef uint32_t cat_coroutine_stack_size_t;
 
 typedef cat_data_t *(*cat_coroutine_function_t)(cat_data_t *data);
 
+/* what the coroutine is waiting for (it is set before yield) */
+#define CAT_COROUTINE_WAIT_TYPE_MAP(XX) \
+    XX(OTHER,   0, "other") \
+    XX(IO,      1, "io") \
+    XX(TIMER,   2, "timer") \
+    XX(CHANNEL, 3, "channel") \
+
+typedef enum
+{
+#define CAT_COROUTINE_WAIT_TYPE_GEN(name, value, unused) CAT_ENUM_GEN(CAT_COROUTINE_WAIT_TYPE_, name, value)
+    CAT_COROUTINE_WAIT_TYPE_MAP(CAT_COROUTINE_WAIT_TYPE_GEN)
+#undef CAT_COROUTINE_WAIT_TYPE_GEN
+} cat_coroutine_wait_type_t;
+
+#define CAT_COROUTINE_WAIT_TYPE_COUNT (CAT_COROUTINE_WAIT_TYPE_CHANNEL + 1)
+
+/* they are only updated when stats is enabled */
+typedef struct cat_coroutine_stats_s {
+    cat_nsec_t run_time;  /* time between it was switched in and out (it is not accurate for scheduler, it includes polling) */
+    uint64_t switches;    /* times it was switched in */
+    cat_nsec_t wait_time[CAT_COROUTINE_WAIT_TYPE_COUNT];
+    uint64_t bytes_read;  /* through cat_socket */
+    uint64_t bytes_written;
+    /* private */
+    cat_nsec_t last_switch_time;
+    cat_coroutine_wait_type_t wait_type;
+} cat_coroutine_stats_t;
+
 typedef struct cat_coroutine_s cat_coroutine_t;
 
 struct cat_coroutine_s
@@ -138,6 +171,7 @@ struct cat_coroutine_s
 #ifdef CAT_COROUTINE_USE_UCONTEXT
     cat_data_t *transfer_data;
 #endif
+    cat_coroutine_stats_t stats;
     /* ext info */
 #ifdef HAVE_VALGRIND
     uint32_t valgrind_stack_id;
@@ -149,6 +183,43 @@ typedef cat_bool_t (*cat_coroutine_resume_t)(cat_coroutine_t *coroutine, cat_dat
 typedef uint32_t cat_coroutine_count_t;
 #define CAT_COROUTINE_COUNT_FMT "%u"
 
+typedef struct cat_coroutine_stack_pool_class_s {
+    /* idle stacks which are ready to use without any syscall */
+    cat_coroutine_stack_t *hot;
+    cat_coroutine_count_t hot_count;
+    /* idle stacks whose pages have been given back to the OS */
+    cat_coroutine_stack_t *cold;
+    cat_coroutine_count_t cold_count;
+} cat_coroutine_stack_pool_class_t;
+
+typedef struct cat_coroutine_stack_pool_s {
+    /* options */
+    cat_coroutine_count_t low_watermark;  /* max hot stacks per class */
+    cat_coroutine_count_t high_watermark; /* max idle (hot + cold) stacks per class */
+    /* size classes */
+    cat_coroutine_stack_pool_class_t classes[CAT_COROUTINE_STACK_POOL_CLASS_COUNT];
+    /* counters */
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t recycled;
+    uint64_t trimmed;
+    uint64_t released;
+} cat_coroutine_stack_pool_t;
+
+typedef struct cat_coroutine_stack_pool_stats_s {
+    cat_coroutine_count_t low_watermark;
+    cat_coroutine_count_t high_watermark;
+    cat_coroutine_count_t hot_count;
+    cat_coroutine_count_t cold_count;
+    size_t hot_size;
+    size_t cold_size;
+    uint64_t hits;     /* got a stack from the pool */
+    uint64_t misses;   /* mapped a new stack */
+    uint64_t recycled; /* put back to the pool as it is */
+    uint64_t trimmed;  /* put back to the pool after its pages were given back */
+    uint64_t released; /* unmapped */
+} cat_coroutine_stack_pool_stats_t;
+
 CAT_GLOBALS_STRUCT_BEGIN(cat_coroutine)
     /* options */
     cat_coroutine_stack_size_t default_stack_size;
@@ -166,8 +237,13 @@ CAT_GLOBALS_STRUCT_BEGIN(cat_coroutine)
     cat_coroutine_id_t last_id;
     cat_coroutine_count_t count;
     cat_coroutine_count_t peak_count;
+    /* stack pool */
+    cat_coroutine_stack_pool_t stack_pool;
     /* for watch-dog */
     cat_coroutine_round_t round;
+    /* stats */
+    cat_bool_t stats_enabled;
+    cat_nsec_t stats_start_time;
 CAT_GLOBALS_STRUCT_END(cat_coroutine)
 
 extern CAT_API CAT_GLOBALS_DECLARE(cat_coroutine)
@@ -188,6 +264,8 @@ CAT_API cat_coroutine_t *cat_coroutine_register_main(cat_coroutine_t *coroutine)
 CAT_API cat_coroutine_stack_size_t cat_coroutine_set_default_stack_size(size_t size);
 /* It is recommended to set to error or warning */
 CAT_API cat_bool_t cat_coroutine_set_dead_lock_log_type(cat_log_type_t type);
+/* low: idle stacks kept as they are, high: idle stacks kept at all (the rest are unmapped) */
+CAT_API cat_bool_t cat_coroutine_set_stack_pool_watermarks(cat_coroutine_count_t low_watermark, cat_coroutine_count_t high_watermark);
 
 /* globals */
 CAT_API cat_coroutine_stack_size_t cat_coroutine_get_default_stack_size(void);
@@ -204,6 +282,30 @@ CAT_API cat_coroutine_count_t cat_coroutine_get_real_count(void);
 CAT_API cat_coroutine_count_t cat_coroutine_get_peak_count(void);
 CAT_API cat_coroutine_round_t cat_coroutine_get_current_round(void);
 
+/* stats */
+/* counters are not reset, time before it was enabled is not counted */
+CAT_API void cat_coroutine_set_stats_enabled(cat_bool_t enabled);
+CAT_API cat_bool_t cat_coroutine_is_stats_enabled(void);
+CAT_API const char *cat_coroutine_wait_type_name(cat_coroutine_wait_type_t type);
+/* it should be called before yield, and it will be reset after the coroutine is switched in again */
+#define cat_coroutine_set_wait_type(type) (CAT_COROUTINE_G(current)->stats.wait_type = (type))
+#define cat_coroutine_add_bytes_read(n) do { \
+    if (unlikely(CAT_COROUTINE_G(stats_enabled))) { \
+        CAT_COROUTINE_G(current)->stats.bytes_read += (n); \
+    } \
+} while (0)
+#define cat_coroutine_add_bytes_written(n) do { \
+    if (unlikely(CAT_COROUTINE_G(stats_enabled))) { \
+        CAT_COROUTINE_G(current)->stats.bytes_written += (n); \
+    } \
+} while (0)
+CAT_API const cat_coroutine_stats_t *cat_coroutine_get_stats(const cat_coroutine_t *coroutine);
+
+/* stack pool */
+CAT_API cat_coroutine_stack_pool_stats_t *cat_coroutine_get_stack_pool_stats(cat_coroutine_stack_pool_stats_t *stats);
+/* unmap all idle stacks, return the number of stacks released */
+CAT_API cat_coroutine_count_t cat_coroutine_stack_pool_clear(void);
+
 /* ctor and dtor */
 CAT_API void cat_coroutine_init(cat_coroutine_t *coroutine);
 CAT_API cat_coroutine_t *cat_coroutine_create(cat_coroutine_t *coroutine, cat_coroutine_function_t function);
@@ -23,20 +23,140 @@ extern "C" {
 #endif
 
 #include "cat.h"
-#include "cat_socket.h"
+#include "cat_queue.h"
 
 /* Notice: this module is a part of Socket */
 
-/*
-typedef struct {
+#ifndef CAT_DNS_CACHE_DEFAULT_SIZE
+#define CAT_DNS_CACHE_DEFAULT_SIZE 1024
+#endif
+/* getaddrinfo() does not tell us the TTL of records, so we use fixed ones (in milliseconds) */
+#ifndef CAT_DNS_CACHE_DEFAULT_TTL
+#define CAT_DNS_CACHE_DEFAULT_TTL (30 * 1000)
+#endif
+#ifndef CAT_DNS_CACHE_DEFAULT_NEGATIVE_TTL
+#define CAT_DNS_CACHE_DEFAULT_NEGATIVE_TTL (5 * 1000)
+#endif
+
+typedef struct cat_dns_cache_entry_s cat_dns_cache_entry_t;
 
+typedef struct
+{
+    /* lookups which were answered by cache */
+    uint64_t hits;
+    /* lookups which were answered by cached failures */
+    uint64_t negative_hits;
+    /* lookups which triggered a resolution */
+    uint64_t misses;
+    /* lookups which waited for the same in-flight resolution */
+    uint64_t coalesced;
+    /* entries which were evicted due to the size limit */
+    uint64_t evictions;
+} cat_dns_cache_stats_t;
+
+/* it is stored in socket globals */
+typedef struct
+{
+    /* max number of entries, 0 means disabled */
+    size_t size;
+    cat_msec_t ttl;
+    cat_msec_t negative_ttl;
+    /* hash table */
+    cat_dns_cache_entry_t **buckets;
+    size_t bucket_count;
+    size_t count;
+    /* resolved entries, the most recently used one is at the front */
+    cat_queue_t lru;
+    cat_dns_cache_stats_t stats;
 } cat_dns_cache_t;
-*/
+
+/* resolver */
+
+#ifndef CAT_DNS_RESOLV_CONF_PATH
+#define CAT_DNS_RESOLV_CONF_PATH "/etc/resolv.conf"
+#endif
+#ifndef CAT_DNS_HOSTS_PATH
+#ifndef CAT_OS_WIN
+#define CAT_DNS_HOSTS_PATH "/etc/hosts"
+#else
+#define CAT_DNS_HOSTS_PATH "C:\\Windows\\System32\\drivers\\etc\\hosts"
+#endif
+#endif
+
+#define CAT_DNS_RESOLVER_MAX_NAMESERVERS    3
+#define CAT_DNS_RESOLVER_MAX_SEARCH_DOMAINS 6
+#define CAT_DNS_RESOLVER_DEFAULT_PORT       53
+/* they are the same as resolv.conf(5) */
+#define CAT_DNS_RESOLVER_DEFAULT_NDOTS      1
+#define CAT_DNS_RESOLVER_DEFAULT_TIMEOUT    (5 * 1000)
+#define CAT_DNS_RESOLVER_DEFAULT_ATTEMPTS   2
+
+typedef struct cat_dns_resolver_config_s cat_dns_resolver_config_t;
+
+typedef struct
+{
+    /* queries which have been sent (over UDP or TCP) */
+    uint64_t queries;
+    /* queries which were sent over TCP due to truncated UDP responses */
+    uint64_t tcp_queries;
+    /* queries which got no response in time */
+    uint64_t timeouts;
+    /* lookups which were answered by hosts file */
+    uint64_t hosts_hits;
+} cat_dns_resolver_stats_t;
+
+/* it is stored in socket globals */
+typedef struct
+{
+    cat_bool_t enabled;
+    /* loaded on demand */
+    cat_dns_resolver_config_t *config;
+    /* for query ids */
+    uint32_t seed;
+    cat_dns_resolver_stats_t stats;
+} cat_dns_resolver_t;
+
+#include "cat_socket.h"
+
+CAT_API cat_bool_t cat_dns_runtime_init(void);
+CAT_API cat_bool_t cat_dns_runtime_shutdown(void);
 
 CAT_API struct addrinfo *cat_dns_getaddrinfo(const char *hostname, const char *service, const struct addrinfo *hints);
 CAT_API struct addrinfo *cat_dns_getaddrinfo_ex(const char *hostname, const char *service, const struct addrinfo *hints, cat_timeout_t timeout);
 CAT_API void cat_dns_freeaddrinfo(struct addrinfo *response);
 
+/* cache */
+
+CAT_API size_t cat_dns_cache_get_size(void);
+/* it evicts the least recently used entries if necessary, 0 disables the cache */
+CAT_API void cat_dns_cache_set_size(size_t size);
+CAT_API cat_msec_t cat_dns_cache_get_ttl(void);
+CAT_API void cat_dns_cache_set_ttl(cat_msec_t ttl);
+CAT_API cat_msec_t cat_dns_cache_get_negative_ttl(void);
+CAT_API void cat_dns_cache_set_negative_ttl(cat_msec_t ttl);
+CAT_API size_t cat_dns_cache_get_count(void);
+/* in-flight resolutions will not be affected */
+CAT_API void cat_dns_cache_flush(void);
+CAT_API void cat_dns_cache_get_stats(cat_dns_cache_stats_t *stats);
+CAT_API void cat_dns_cache_reset_stats(void);
+
+/* resolver (built-in stub resolver which runs in the event loop instead of the thread pool,
+ * it looks up hosts file then queries A/AAAA records of nameservers in resolv.conf,
+ * lookups which it can not handle (e.g. named services) still go to getaddrinfo()) */
+
+CAT_API cat_bool_t cat_dns_resolver_is_enabled(void);
+/* config would be loaded from the default paths if it has not been loaded */
+CAT_API cat_bool_t cat_dns_resolver_enable(void);
+CAT_API void cat_dns_resolver_disable(void);
+/* NULL means the default path, missing files are treated as empty ones,
+ * nameserver would be 127.0.0.1 if there is none */
+CAT_API cat_bool_t cat_dns_resolver_load_config(const char *resolv_conf_path, const char *hosts_path);
+/* override nameservers in resolv.conf (e.g. for test), port <= 0 means the default one */
+CAT_API cat_bool_t cat_dns_resolver_clear_nameservers(void);
+CAT_API cat_bool_t cat_dns_resolver_add_nameserver(const char *ip, int port);
+CAT_API void cat_dns_resolver_get_stats(cat_dns_resolver_stats_t *stats);
+CAT_API void cat_dns_resolver_reset_stats(void);
+
 CAT_API cat_bool_t cat_dns_get_ip(char *buffer, size_t buffer_size, const char *name, int af);
 CAT_API cat_bool_t cat_dns_get_ip_ex(char *buffer, size_t buffer_size, const char *name, int af, cat_timeout_t timeout);
 
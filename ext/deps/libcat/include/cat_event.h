@@ -32,11 +32,26 @@ typedef struct
     cat_data_t *data;
 } cat_event_task_t;
 
+/* histogram[i] counts values in [2^(i-1), 2^i) */
+#define CAT_EVENT_HISTOGRAM_SIZE 24
+
+typedef struct cat_event_stats_s {
+    uint64_t rounds;
+    cat_nsec_t busy_time; /* time of running callbacks and coroutines (excluding polling) */
+    cat_nsec_t idle_time; /* time of polling */
+    /* busy time of each round in microseconds, it is the latency of the event loop */
+    uint64_t latency_histogram[CAT_EVENT_HISTOGRAM_SIZE];
+    /* coroutines resumed in each round (it is derived from switches) */
+    uint64_t run_queue_histogram[CAT_EVENT_HISTOGRAM_SIZE];
+} cat_event_stats_t;
+
 CAT_GLOBALS_STRUCT_BEGIN(cat_event)
     uv_loop_t *loop;
     uv_timer_t *dead_lock;
     cat_queue_t defer_tasks;
     size_t defer_task_count;
+    cat_bool_t stats_enabled;
+    cat_event_stats_t stats;
     /* --- */
     uv_loop_t _loop;
     uv_timer_t _dead_lock;
@@ -64,6 +79,12 @@ CAT_API cat_bool_t cat_event_do_defer_tasks(void);
 
 CAT_API cat_bool_t cat_event_wait(void);
 
+/* stats */
+CAT_API cat_bool_t cat_event_set_stats_enabled(cat_bool_t enabled);
+CAT_API cat_bool_t cat_event_is_stats_enabled(void);
+CAT_API cat_event_stats_t *cat_event_get_stats(cat_event_stats_t *stats);
+CAT_API void cat_event_reset_stats(void);
+
 #ifdef __cplusplus
 }
 #endif
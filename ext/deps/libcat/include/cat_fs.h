@@ -24,11 +24,18 @@ extern "C" {
 
 #include "cat.h"
 
+typedef uv_stat_t cat_stat_t;
+
 CAT_API int cat_fs_open(const char *path, int flags, ...);
 CAT_API off_t cat_lseek(int fd, off_t offset, int whence);
 CAT_API ssize_t cat_fs_read(int fd, void *buffer, size_t size);
 CAT_API ssize_t cat_fs_write(int fd, const void *buffer, size_t length);
+CAT_API ssize_t cat_fs_pread(int fd, void *buffer, size_t size, int64_t offset);
+CAT_API ssize_t cat_fs_pwrite(int fd, const void *buffer, size_t length, int64_t offset);
 CAT_API int cat_fs_close(int fd);
+CAT_API int cat_fs_fstat(int fd, cat_stat_t *buf);
+CAT_API int cat_fs_fsync(int fd);
+CAT_API int cat_fs_fdatasync(int fd);
 
 CAT_API int cat_fs_access(const char *path, int mode);
 CAT_API int cat_fs_mkdir(const char *path, int mode);
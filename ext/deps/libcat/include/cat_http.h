@@ -161,6 +161,93 @@ typedef enum
 
 typedef uint32_t cat_http_parser_events_t;
 
+/* header table */
+
+#define CAT_HTTP_HEADER_MAP(XX) \
+    XX(HOST,                     "host") \
+    XX(CONNECTION,               "connection") \
+    XX(CONTENT_LENGTH,           "content-length") \
+    XX(CONTENT_TYPE,             "content-type") \
+    XX(CONTENT_ENCODING,         "content-encoding") \
+    XX(TRANSFER_ENCODING,        "transfer-encoding") \
+    XX(KEEP_ALIVE,               "keep-alive") \
+    XX(UPGRADE,                  "upgrade") \
+    XX(EXPECT,                   "expect") \
+    XX(ACCEPT,                   "accept") \
+    XX(ACCEPT_ENCODING,          "accept-encoding") \
+    XX(ACCEPT_LANGUAGE,          "accept-language") \
+    XX(AUTHORIZATION,            "authorization") \
+    XX(COOKIE,                   "cookie") \
+    XX(SET_COOKIE,               "set-cookie") \
+    XX(USER_AGENT,               "user-agent") \
+    XX(REFERER,                  "referer") \
+    XX(ORIGIN,                   "origin") \
+    XX(DATE,                     "date") \
+    XX(SERVER,                   "server") \
+    XX(LOCATION,                 "location") \
+    XX(CACHE_CONTROL,            "cache-control") \
+    XX(IF_MODIFIED_SINCE,        "if-modified-since") \
+    XX(IF_NONE_MATCH,            "if-none-match") \
+    XX(RANGE,                    "range") \
+    XX(X_FORWARDED_FOR,          "x-forwarded-for") \
+    XX(SEC_WEBSOCKET_KEY,        "sec-websocket-key") \
+    XX(SEC_WEBSOCKET_VERSION,    "sec-websocket-version") \
+    XX(SEC_WEBSOCKET_PROTOCOL,   "sec-websocket-protocol") \
+    XX(SEC_WEBSOCKET_EXTENSIONS, "sec-websocket-extensions") \
+    XX(SEC_WEBSOCKET_ACCEPT,     "sec-websocket-accept") \
+    XX(HTTP2_SETTINGS,           "http2-settings")
+
+typedef enum
+{
+    CAT_HTTP_HEADER_UNKNOWN = 0,
+#define CAT_HTTP_HEADER_ID_GEN(name, unused) CAT_HTTP_HEADER_##name,
+    CAT_HTTP_HEADER_MAP(CAT_HTTP_HEADER_ID_GEN)
+#undef CAT_HTTP_HEADER_ID_GEN
+    CAT_HTTP_HEADER_ID_COUNT
+} cat_http_header_id_t;
+
+/* offsets are relative to the head (the data passed to cat_http_parser_execute_head()) */
+typedef struct
+{
+    uint32_t name_offset;
+    uint32_t name_length;
+    uint32_t value_offset;
+    uint32_t value_length;
+    /* hash of the case-folded name */
+    uint32_t hash;
+    /* cat_http_header_id_t */
+    uint8_t id;
+} cat_http_header_t;
+
+typedef struct
+{
+    cat_http_header_t *headers;
+    uint32_t count;
+    uint32_t size;
+    /* url of request or status text of response */
+    uint32_t line_offset;
+    uint32_t line_length;
+    /* length of the whole head */
+    size_t head_length;
+    /* index + 1 of the first header of each known id (0 means not found) */
+    uint32_t known[CAT_HTTP_HEADER_ID_COUNT];
+    /* private: the head being parsed */
+    const char *base;
+} cat_http_header_table_t;
+
+CAT_API uint32_t cat_http_header_hash(const char *name, size_t length);
+CAT_API cat_http_header_id_t cat_http_header_get_id(const char *name, size_t length);
+CAT_API const char *cat_http_header_get_name(cat_http_header_id_t id);
+
+CAT_API void cat_http_header_table_init(cat_http_header_table_t *table);
+CAT_API void cat_http_header_table_clear(cat_http_header_table_t *table);
+CAT_API void cat_http_header_table_close(cat_http_header_table_t *table);
+/* returns the first header with the name (case-insensitive), it is O(1) for known headers */
+CAT_API const cat_http_header_t *cat_http_header_table_find(const cat_http_header_table_t *table, const char *head, const char *name, size_t length);
+CAT_API const cat_http_header_t *cat_http_header_table_find_by_id(const cat_http_header_table_t *table, cat_http_header_id_t id);
+/* for iterating headers which have the same name, start with the found one */
+CAT_API const cat_http_header_t *cat_http_header_table_find_next(const cat_http_header_table_t *table, const char *head, const cat_http_header_t *header);
+
 typedef struct
 {
     /* private: handle */
@@ -175,6 +262,8 @@ typedef struct
     size_t data_length;
     /* public readonly: keep alive (update on message complete) */
     cat_bool_t keep_alive;
+    /* private: head mode (headers are collected into it instead of being returned one by one) */
+    cat_http_header_table_t *header_table;
 } cat_http_parser_t;
 
 CAT_API void cat_http_parser_init(cat_http_parser_t *parser);
@@ -185,6 +274,11 @@ CAT_API cat_bool_t cat_http_parser_set_type(cat_http_parser_t *parser, cat_http_
 CAT_API cat_http_parser_events_t cat_http_parser_get_events(const cat_http_parser_t *parser);
 CAT_API void cat_http_parser_set_events(cat_http_parser_t *parser, cat_http_parser_events_t events);
 CAT_API cat_bool_t cat_http_parser_execute(cat_http_parser_t *parser, const char *data, size_t length);
+/* parse the whole head (start line and headers) in one call and fill the header table,
+ * event will be HEADERS_COMPLETE if the head is complete, otherwise it is NONE
+ * and the parser is reset (nothing is consumed, call it again with more data),
+ * the rest of message (body) can be parsed by cat_http_parser_execute() as usual */
+CAT_API cat_bool_t cat_http_parser_execute_head(cat_http_parser_t *parser, cat_http_header_table_t *table, const char *data, size_t length);
 CAT_API const char *cat_http_parser_event_name(cat_http_parser_event_t event);
 CAT_API cat_http_parser_event_t cat_http_parser_get_event(const cat_http_parser_t *parser);
 CAT_API const char* cat_http_parser_get_event_name(const cat_http_parser_t *parser);
@@ -0,0 +1,214 @@
+/*
+  +--------------------------------------------------------------------------+
+  | libcat                                                                   |
+  +--------------------------------------------------------------------------+
+  | Licensed under the Apache License, Version 2.0 (the "License");          |
+  | you may not use this file except in compliance with the License.         |
+  | You may obtain a copy of the License at                                  |
+  | http://www.apache.org/licenses/LICENSE-2.0                               |
+  | Unless required by applicable law or agreed to in writing, software      |
+  | distributed under the License is distributed on an "AS IS" BASIS,        |
+  | WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. |
+  | See the License for the specific language governing permissions and      |
+  | limitations under the License. See accompanying LICENSE file.            |
+  +--------------------------------------------------------------------------+
+  | Author: Twosee <twosee@php.net>                                          |
+  +--------------------------------------------------------------------------+
+ */
+
+#ifndef CAT_HTTP2_H
+#define CAT_HTTP2_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "cat.h"
+#include "cat_buffer.h"
+
+/* HTTP/2 (RFC 7540) */
+
+#define CAT_HTTP2_CONNECTION_PREFACE         "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"
+#define CAT_HTTP2_CONNECTION_PREFACE_LENGTH  (sizeof(CAT_HTTP2_CONNECTION_PREFACE) - 1)
+#define CAT_HTTP2_ALPN_PROTOCOL              "h2"
+#define CAT_HTTP2_FRAME_HEADER_LENGTH        9
+#define CAT_HTTP2_DEFAULT_HEADER_TABLE_SIZE  4096
+#define CAT_HTTP2_DEFAULT_WINDOW_SIZE        65535
+#define CAT_HTTP2_MAX_WINDOW_SIZE            0x7fffffff
+#define CAT_HTTP2_DEFAULT_MAX_FRAME_SIZE     16384
+#define CAT_HTTP2_MAX_MAX_FRAME_SIZE         0xffffff
+#define CAT_HTTP2_MAX_STREAM_ID              0x7fffffff
+
+#define CAT_HTTP2_FRAME_TYPE_MAP(XX) \
+    XX(DATA,          0x0) \
+    XX(HEADERS,       0x1) \
+    XX(PRIORITY,      0x2) \
+    XX(RST_STREAM,    0x3) \
+    XX(SETTINGS,      0x4) \
+    XX(PUSH_PROMISE,  0x5) \
+    XX(PING,          0x6) \
+    XX(GOAWAY,        0x7) \
+    XX(WINDOW_UPDATE, 0x8) \
+    XX(CONTINUATION,  0x9) \
+
+typedef enum cat_http2_frame_type_e {
+#define CAT_HTTP2_FRAME_TYPE_GEN(name, value) CAT_ENUM_GEN(CAT_HTTP2_FRAME_TYPE_, name, value)
+    CAT_HTTP2_FRAME_TYPE_MAP(CAT_HTTP2_FRAME_TYPE_GEN)
+#undef CAT_HTTP2_FRAME_TYPE_GEN
+} cat_http2_frame_type_t;
+
+#define CAT_HTTP2_FLAG_MAP(XX) \
+    XX(NONE,        0x00) \
+    XX(END_STREAM,  0x01) \
+    XX(ACK,         0x01) \
+    XX(END_HEADERS, 0x04) \
+    XX(PADDED,      0x08) \
+    XX(PRIORITY,    0x20) \
+
+typedef enum cat_http2_flag_e {
+#define CAT_HTTP2_FLAG_GEN(name, value) CAT_ENUM_GEN(CAT_HTTP2_FLAG_, name, value)
+    CAT_HTTP2_FLAG_MAP(CAT_HTTP2_FLAG_GEN)
+#undef CAT_HTTP2_FLAG_GEN
+} cat_http2_flag_t;
+
+typedef uint8_t cat_http2_flags_t;
+
+#define CAT_HTTP2_SETTINGS_MAP(XX) \
+    XX(HEADER_TABLE_SIZE,      0x1) \
+    XX(ENABLE_PUSH,            0x2) \
+    XX(MAX_CONCURRENT_STREAMS, 0x3) \
+    XX(INITIAL_WINDOW_SIZE,    0x4) \
+    XX(MAX_FRAME_SIZE,         0x5) \
+    XX(MAX_HEADER_LIST_SIZE,   0x6) \
+
+typedef enum cat_http2_settings_e {
+#define CAT_HTTP2_SETTINGS_GEN(name, value) CAT_ENUM_GEN(CAT_HTTP2_SETTINGS_, name, value)
+    CAT_HTTP2_SETTINGS_MAP(CAT_HTTP2_SETTINGS_GEN)
+#undef CAT_HTTP2_SETTINGS_GEN
+} cat_http2_settings_t;
+
+#define CAT_HTTP2_SETTINGS_ENTRY_LENGTH 6
+
+#define CAT_HTTP2_ERROR_CODE_MAP(XX) \
+    XX(NO_ERROR,            0x0, "Graceful shutdown") \
+    XX(PROTOCOL_ERROR,      0x1, "Protocol error detected") \
+    XX(INTERNAL_ERROR,      0x2, "Implementation fault") \
+    XX(FLOW_CONTROL_ERROR,  0x3, "Flow-control limits exceeded") \
+    XX(SETTINGS_TIMEOUT,    0x4, "Settings not acknowledged") \
+    XX(STREAM_CLOSED,       0x5, "Frame received for closed stream") \
+    XX(FRAME_SIZE_ERROR,    0x6, "Frame size incorrect") \
+    XX(REFUSED_STREAM,      0x7, "Stream not processed") \
+    XX(CANCEL,              0x8, "Stream cancelled") \
+    XX(COMPRESSION_ERROR,   0x9, "Compression state not updated") \
+    XX(CONNECT_ERROR,       0xa, "TCP connection error for CONNECT method") \
+    XX(ENHANCE_YOUR_CALM,   0xb, "Processing capacity exceeded") \
+    XX(INADEQUATE_SECURITY, 0xc, "Negotiated TLS parameters not acceptable") \
+    XX(HTTP_1_1_REQUIRED,   0xd, "Use HTTP/1.1 for the request") \
+
+typedef enum cat_http2_error_code_e {
+#define CAT_HTTP2_ERROR_CODE_GEN(name, value, unused) CAT_ENUM_GEN(CAT_HTTP2_ERROR_CODE_, name, value)
+    CAT_HTTP2_ERROR_CODE_MAP(CAT_HTTP2_ERROR_CODE_GEN)
+#undef CAT_HTTP2_ERROR_CODE_GEN
+} cat_http2_error_code_t;
+
+CAT_API const char *cat_http2_frame_type_name(uint8_t type);
+CAT_API const char *cat_http2_error_code_name(uint32_t code);
+CAT_API const char *cat_http2_error_code_get_description(uint32_t code);
+
+/*  HTTP/2 Frame:
+ +-----------------------------------------------+
+ |                 Length (24)                   |
+ +---------------+---------------+---------------+
+ |   Type (8)    |   Flags (8)   |
+ +-+-------------+---------------+-------------------------------+
+ |R|                 Stream Identifier (31)                      |
+ +=+=============================================================+
+ |                   Frame Payload (0...)                      ...
+ +---------------------------------------------------------------+
+ */
+
+typedef struct cat_http2_frame_header_s {
+    uint32_t length;
+    uint8_t type;
+    cat_http2_flags_t flags;
+    uint32_t stream_id;
+} cat_http2_frame_header_t;
+
+/* buffer must be at least CAT_HTTP2_FRAME_HEADER_LENGTH bytes,
+ * the reserved bit of stream id is always ignored */
+CAT_API void cat_http2_frame_header_pack(const cat_http2_frame_header_t *header, char *buffer);
+CAT_API void cat_http2_frame_header_unpack(cat_http2_frame_header_t *header, const char *buffer);
+
+/* HPACK (RFC 7541) */
+
+#define CAT_HPACK_STATIC_TABLE_COUNT 61
+#define CAT_HPACK_ENTRY_OVERHEAD     32
+
+typedef struct cat_hpack_entry_s {
+    uint32_t name_length;
+    uint32_t value_length;
+    char data[1]; /* name and value (they are not zero-terminated) */
+} cat_hpack_entry_t;
+
+/* a context is either used to encode or to decode header blocks of one direction of a connection,
+ * the dynamic table is a ring of entries, and the newest one is at [first] */
+typedef struct cat_hpack_s {
+    cat_hpack_entry_t **entries;
+    uint32_t capacity;
+    uint32_t first;
+    uint32_t count;
+    size_t size;
+    size_t max_size;
+    /* decoder: the max size that the encoder can update to (our SETTINGS_HEADER_TABLE_SIZE) */
+    size_t size_limit;
+    /* encoder: the table size update should be emitted at the beginning of the next header block */
+    size_t pending_min_size;
+    cat_bool_t size_update_pending;
+    /* decoder: used to decode Huffman encoded strings */
+    cat_buffer_t buffer;
+} cat_hpack_t;
+
+typedef enum cat_hpack_flag_e {
+    CAT_HPACK_FLAG_NONE         = 0,
+    /* do not add it into the dynamic table */
+    CAT_HPACK_FLAG_NO_INDEX     = 1 << 0,
+    /* intermediaries must not index it either (e.g. for sensitive values) */
+    CAT_HPACK_FLAG_NEVER_INDEX  = 1 << 1,
+    /* do not use Huffman encoding */
+    CAT_HPACK_FLAG_NO_HUFFMAN   = 1 << 2,
+} cat_hpack_flag_t;
+
+typedef uint8_t cat_hpack_flags_t;
+
+CAT_API void cat_hpack_init(cat_hpack_t *hpack);
+CAT_API void cat_hpack_close(cat_hpack_t *hpack);
+
+CAT_API size_t cat_hpack_get_size(const cat_hpack_t *hpack);
+CAT_API size_t cat_hpack_get_max_size(const cat_hpack_t *hpack);
+CAT_API uint32_t cat_hpack_get_count(const cat_hpack_t *hpack);
+
+/* decoder: set the limit of table size updates (it should be the SETTINGS_HEADER_TABLE_SIZE we sent) */
+CAT_API void cat_hpack_set_size_limit(cat_hpack_t *hpack, size_t size_limit);
+/* encoder: change the table size (it must not exceed the SETTINGS_HEADER_TABLE_SIZE of peer),
+ * the update will be emitted at the beginning of the next header block */
+CAT_API void cat_hpack_update_size(cat_hpack_t *hpack, size_t max_size);
+
+/* strings are only available during the call, return false to abort decoding (last error should be set) */
+typedef cat_bool_t (*cat_hpack_header_handler_t)(void *arg, const char *name, size_t name_length, const char *value, size_t value_length, cat_hpack_flags_t flags);
+
+/* decode a complete header block, it fails with CAT_EPROTO (which is a COMPRESSION_ERROR of HTTP/2) */
+CAT_API cat_bool_t cat_hpack_decode(cat_hpack_t *hpack, const char *data, size_t length, cat_hpack_header_handler_t handler, void *arg);
+/* append a header field representation to the header block in buffer,
+ * name must be lowercase, sensitive headers (e.g. authorization) are never indexed */
+CAT_API cat_bool_t cat_hpack_encode(cat_hpack_t *hpack, cat_buffer_t *buffer, const char *name, size_t name_length, const char *value, size_t value_length, cat_hpack_flags_t flags);
+
+/* Huffman coding of string literals */
+CAT_API size_t cat_hpack_huffman_encoded_length(const char *data, size_t length);
+/* out must have at least cat_hpack_huffman_encoded_length() bytes, returns the encoded length */
+CAT_API size_t cat_hpack_huffman_encode(char *out, const char *data, size_t length);
+/* decoded string is appended to buffer, it fails with CAT_EPROTO on invalid data */
+CAT_API cat_bool_t cat_hpack_huffman_decode(cat_buffer_t *buffer, const char *data, size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* CAT_HTTP2_H */
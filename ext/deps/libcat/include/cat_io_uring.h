@@ -0,0 +1,109 @@
+/*
+  +--------------------------------------------------------------------------+
+  | libcat                                                                   |
+  +--------------------------------------------------------------------------+
+  | Licensed under the Apache License, Version 2.0 (the "License");          |
+  | you may not use this file except in compliance with the License.         |
+  | You may obtain a copy of the License at                                  |
+  | http://www.apache.org/licenses/LICENSE-2.0                               |
+  | Unless required by applicable law or agreed to in writing, software      |
+  | distributed under the License is distributed on an "AS IS" BASIS,        |
+  | WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. |
+  | See the License for the specific language governing permissions and      |
+  | limitations under the License. See accompanying LICENSE file.            |
+  +--------------------------------------------------------------------------+
+  | Author: Twosee <twosee@php.net>                                          |
+  +--------------------------------------------------------------------------+
+ */
+
+#ifndef CAT_IO_URING_H
+#define CAT_IO_URING_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "cat.h"
+
+#if defined(CAT_OS_LINUX) && defined(HAVE_LINUX_IO_URING_H)
+#define CAT_IO_URING 1
+#endif
+
+/* number of SQ entries, CQ has twice of it */
+#ifndef CAT_IO_URING_ENTRIES
+#define CAT_IO_URING_ENTRIES 256
+#endif
+
+typedef struct
+{
+    /* times of io_uring_enter() */
+    uint64_t submit_calls;
+    /* number of SQEs which have been submitted */
+    uint64_t submitted;
+    /* number of CQEs which have been reaped */
+    uint64_t completed;
+    /* number of operations which were canceled (timed out or interrupted) */
+    uint64_t canceled;
+} cat_io_uring_stats_t;
+
+#ifdef CAT_IO_URING
+CAT_GLOBALS_STRUCT_BEGIN(cat_io_uring)
+    cat_bool_t enabled;
+    int fd;
+    size_t inflight;
+    size_t unsubmitted;
+    /* mapped rings */
+    void *sq_ring;
+    size_t sq_ring_size;
+    void *cq_ring;
+    size_t cq_ring_size;
+    void *sqes;
+    size_t sqes_size;
+    /* ring pointers */
+    unsigned int *sq_head;
+    unsigned int *sq_tail;
+    unsigned int *sq_mask;
+    unsigned int *sq_array;
+    unsigned int *cq_head;
+    unsigned int *cq_tail;
+    unsigned int *cq_mask;
+    void *cqes;
+    /* event loop integration */
+    uv_poll_t poll;
+    uv_prepare_t prepare;
+    cat_io_uring_stats_t stats;
+CAT_GLOBALS_STRUCT_END(cat_io_uring)
+
+extern CAT_API CAT_GLOBALS_DECLARE(cat_io_uring)
+
+#define CAT_IO_URING_G(x) CAT_GLOBALS_GET(cat_io_uring, x)
+#endif
+
+CAT_API cat_bool_t cat_io_uring_module_init(void);
+CAT_API cat_bool_t cat_io_uring_runtime_init(void);
+/* must be called before event runtime shutdown (it closes the ring handles) */
+CAT_API cat_bool_t cat_io_uring_runtime_shutdown(void);
+
+/* whether io_uring support was compiled in */
+CAT_API cat_bool_t cat_io_uring_is_available(void);
+CAT_API cat_bool_t cat_io_uring_is_enabled(void);
+/* setup the ring (lazily) and route supported operations to it,
+ * it fails if kernel does not support the required features */
+CAT_API cat_bool_t cat_io_uring_enable(void);
+/* operations in flight will still be completed by the ring */
+CAT_API void cat_io_uring_disable(void);
+
+CAT_API void cat_io_uring_get_stats(cat_io_uring_stats_t *stats);
+CAT_API void cat_io_uring_reset_stats(void);
+
+/* returns the result or a negative error code like libuv (last error will not be updated),
+ * if the operation timed out or was interrupted, it would be canceled
+ * and we always wait until kernel has released the buffer */
+CAT_API ssize_t cat_io_uring_recv(int fd, void *buffer, size_t size, int flags, cat_timeout_t timeout);
+/* offset -1 means the current file position */
+CAT_API ssize_t cat_io_uring_read(int fd, void *buffer, size_t size, int64_t offset, cat_timeout_t timeout);
+CAT_API ssize_t cat_io_uring_write(int fd, const void *buffer, size_t length, int64_t offset, cat_timeout_t timeout);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* CAT_IO_URING_H */
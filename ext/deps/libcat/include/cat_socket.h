@@ -190,6 +190,25 @@ static cat_always_inline cat_socket_write_vector_t cat_socket_write_vector_init(
 
 CAT_API size_t cat_socket_write_vector_length(const cat_socket_write_vector_t *vector, unsigned int vector_count);
 
+/* datagram for batch APIs */
+
+#ifndef CAT_SOCKET_BATCH_SIZE
+/* max number of datagrams per recvmmsg/sendmmsg call */
+#define CAT_SOCKET_BATCH_SIZE 64
+#endif
+
+typedef struct
+{
+    /* recv: buffer to receive data */
+    char *buffer;
+    /* recv: buffer size as input, and data length as output;
+     * send: data length */
+    size_t length;
+    /* recv: peer address as output;
+     * send: destination, empty (length is 0) means the connected peer */
+    cat_sockaddr_info_t address;
+} cat_socket_datagram_t;
+
 /* socket */
 
 #ifdef CAT_OS_UNIX_LIKE
@@ -282,6 +301,13 @@ typedef enum
 {
     CAT_SOCKET_INTERNAL_FLAG_NONE = 0,
     CAT_SOCKET_INTERNAL_FLAG_CONNECTED = 1 << 0,
+    CAT_SOCKET_INTERNAL_FLAG_WRITE_REQUEST_IN_USE = 1 << 1,
+    /* kernel owns the read buffer, isocket must be kept until the ring returns it */
+    CAT_SOCKET_INTERNAL_FLAG_IO_URING_READING = 1 << 2,
+    /* closed during io_uring reading, reader is responsible to free it */
+    CAT_SOCKET_INTERNAL_FLAG_CLOSED = 1 << 3,
+    /* keep reading even if there is no reader (see sticky read) */
+    CAT_SOCKET_INTERNAL_FLAG_STICKY_READ = 1 << 4,
 } cat_socket_internal_flag_t;
 
 typedef uint32_t cat_socket_internal_flags_t;
@@ -356,6 +382,57 @@ typedef struct
     cat_queue_t coroutines;
 } cat_socket_write_context_t;
 
+typedef struct
+{
+    int error;
+    union {
+        cat_coroutine_t *coroutine;
+        cat_queue_node_t node; /* (in pool) */
+        uv_write_t stream;
+        uv_udp_send_t udp;
+    } u;
+} cat_socket_write_request_t;
+
+/* max number of idle write requests for queued writes (per thread) */
+#ifndef CAT_SOCKET_WRITE_REQUEST_POOL_MAX_SIZE
+#define CAT_SOCKET_WRITE_REQUEST_POOL_MAX_SIZE 128
+#endif
+
+typedef struct
+{
+    uint64_t inline_requests;    /* served by the request slot of the socket */
+    uint64_t pooled_requests;    /* served by the idle request pool */
+    uint64_t allocated_requests; /* request has to be allocated */
+    uint64_t direct_writes;      /* all data was written by try write */
+    uint64_t partial_writes;     /* try write did not write all data, the rest was queued */
+    uint64_t shared_writes;      /* shared writes which have been queued */
+    uint64_t skipped_writes;     /* shared writes which were rejected by the high-water mark */
+} cat_socket_write_stats_t;
+
+/* shared data can be written to any number of sockets without copying (e.g. broadcast),
+ * it is released once all writes on it have been done */
+typedef struct cat_socket_shared_data_s {
+    uint32_t refcount;
+    size_t length;
+    char value[1];
+} cat_socket_shared_data_t;
+
+/* sticky read: stream socket stays registered for readability between reads,
+ * data which arrives when there is no reader is kept in this buffer,
+ * reading will be stopped when it is full */
+#ifndef CAT_SOCKET_STICKY_READ_BUFFER_SIZE
+#define CAT_SOCKET_STICKY_READ_BUFFER_SIZE 8192
+#endif
+
+typedef struct
+{
+    char *value;
+    size_t offset;
+    size_t length;
+    /* error (or EOF) which was met when there was no reader */
+    ssize_t error;
+} cat_socket_sticky_read_buffer_t;
+
 typedef struct cat_socket_s cat_socket_t;
 typedef struct cat_socket_internal_s cat_socket_internal_t;
 
@@ -380,6 +457,10 @@ struct cat_socket_internal_s
             cat_socket_write_context_t write;
         } io;
     } context;
+    /* for the common single writer case (no allocation) */
+    cat_socket_write_request_t write_request;
+    /* data read ahead in sticky read mode */
+    cat_socket_sticky_read_buffer_t sticky_read_buffer;
     /* cache */
     struct {
         cat_sockaddr_info_t *sockname;
@@ -417,9 +498,16 @@ CAT_GLOBALS_STRUCT_BEGIN(cat_socket)
     struct {
         cat_socket_timeout_options_t timeout;
         unsigned int tcp_keepalive_delay;
+        cat_bool_t try_write;
+        cat_bool_t sticky_read;
     } options;
+    /* write */
+    cat_queue_t write_request_pool;
+    size_t write_request_pool_count;
+    cat_socket_write_stats_t write_stats;
     /* dns */
-    // TODO: dns_cache (we should implement lru_cache)
+    cat_dns_cache_t dns_cache;
+    cat_dns_resolver_t dns_resolver;
 CAT_GLOBALS_STRUCT_END(cat_socket)
 
 extern CAT_API CAT_GLOBALS_DECLARE(cat_socket)
@@ -430,6 +518,7 @@ extern CAT_API CAT_GLOBALS_DECLARE(cat_socket)
 
 CAT_API cat_bool_t cat_socket_module_init(void);
 CAT_API cat_bool_t cat_socket_runtime_init(void);
+CAT_API cat_bool_t cat_socket_runtime_shutdown(void);
 
 /* common methods */
 /* tip: functions of fast version will never change the last error */
@@ -460,6 +549,16 @@ CAT_API void cat_socket_set_global_handshake_timeout(cat_timeout_t timeout);
 CAT_API void cat_socket_set_global_read_timeout(cat_timeout_t timeout);
 CAT_API void cat_socket_set_global_write_timeout(cat_timeout_t timeout);
 
+/* try to write directly (non-blocking) before queuing the write request */
+CAT_API cat_bool_t cat_socket_get_global_try_write(void);
+CAT_API void cat_socket_set_global_try_write(cat_bool_t enable);
+/* it only affects new stream sockets */
+CAT_API cat_bool_t cat_socket_get_global_sticky_read(void);
+CAT_API void cat_socket_set_global_sticky_read(cat_bool_t enable);
+
+CAT_API void cat_socket_get_write_stats(cat_socket_write_stats_t *stats);
+CAT_API void cat_socket_reset_write_stats(void);
+
 CAT_API cat_timeout_t cat_socket_get_dns_timeout(const cat_socket_t *socket);
 CAT_API cat_timeout_t cat_socket_get_accept_timeout(const cat_socket_t *socket);
 CAT_API cat_timeout_t cat_socket_get_connect_timeout(const cat_socket_t *socket);
@@ -519,6 +618,15 @@ CAT_API ssize_t cat_socket_read_ex(cat_socket_t *socket, char *buffer, size_t le
 /* write: it always writes all data as much as possible, unless interrupted by errors */
 CAT_API cat_bool_t cat_socket_write(cat_socket_t *socket, const cat_socket_write_vector_t *vector, unsigned int vector_count);
 CAT_API cat_bool_t cat_socket_write_ex(cat_socket_t *socket, const cat_socket_write_vector_t *vector, unsigned int vector_count, cat_timeout_t timeout);
+/* shared write: data is queued on the socket and it returns immediately without waiting for completion,
+ * high_water_mark is the max number of bytes which may be waiting in the write queue of the socket
+ * (0 means unlimited), otherwise data will be skipped and it fails with CAT_EAGAIN */
+CAT_API cat_bool_t cat_socket_write_shared(cat_socket_t *socket, cat_socket_shared_data_t *data, size_t high_water_mark);
+CAT_API size_t cat_socket_get_write_queue_size(const cat_socket_t *socket);
+
+CAT_API cat_socket_shared_data_t *cat_socket_shared_data_create(const cat_socket_write_vector_t *vector, unsigned int vector_count);
+CAT_API void cat_socket_shared_data_addref(cat_socket_shared_data_t *data);
+CAT_API void cat_socket_shared_data_release(cat_socket_shared_data_t *data);
 
 CAT_API ssize_t cat_socket_read_from(cat_socket_t *socket, char *buffer, size_t size, char *name, size_t *name_length, int *port);
 CAT_API ssize_t cat_socket_read_from_ex(cat_socket_t *socket, char *buffer, size_t size, char *name, size_t *name_length, int *port, cat_timeout_t timeout);
@@ -542,6 +650,22 @@ CAT_API cat_bool_t cat_socket_sendto_ex(cat_socket_t *socket, const char *buffer
 CAT_API cat_bool_t cat_socket_send_to(cat_socket_t *socket, const char *buffer, size_t length, const char *name, size_t name_length, int port);
 CAT_API cat_bool_t cat_socket_send_to_ex(cat_socket_t *socket, const char *buffer, size_t length, const char *name, size_t name_length, int port, cat_timeout_t timeout);
 
+/* recv_batch: it waits until at least one datagram arrives (or timed out),
+ * then receives as many as possible (up to count) without waiting,
+ * returns the number of datagrams received or -1 on error */
+CAT_API ssize_t cat_socket_recv_batch(cat_socket_t *socket, cat_socket_datagram_t *datagrams, size_t count);
+CAT_API ssize_t cat_socket_recv_batch_ex(cat_socket_t *socket, cat_socket_datagram_t *datagrams, size_t count, cat_timeout_t timeout);
+/* send_batch: it sends all datagrams in order, unless interrupted by errors,
+ * returns the number of datagrams sent, or -1 if error occurred before anything was sent */
+CAT_API ssize_t cat_socket_send_batch(cat_socket_t *socket, const cat_socket_datagram_t *datagrams, size_t count);
+CAT_API ssize_t cat_socket_send_batch_ex(cat_socket_t *socket, const cat_socket_datagram_t *datagrams, size_t count, cat_timeout_t timeout);
+
+/* sendfile: it sends the file from offset to the stream socket without copying data to the user space,
+ * it always sends data of the specified length as far as possible, unless interrupted by errors or EOF,
+ * length 0 means until EOF, returns the number of bytes sent or -1 on error */
+CAT_API ssize_t cat_socket_sendfile(cat_socket_t *socket, int file, int64_t offset, size_t length);
+CAT_API ssize_t cat_socket_sendfile_ex(cat_socket_t *socket, int file, int64_t offset, size_t length, cat_timeout_t timeout);
+
 CAT_API ssize_t cat_socket_peek(const cat_socket_t *socket, char *buffer, size_t size);
 CAT_API ssize_t cat_socket_peekfrom(const cat_socket_t *socket, char *buffer, size_t size, cat_sockaddr_t *address, cat_socklen_t *address_length);
 CAT_API ssize_t cat_socket_peek_from(const cat_socket_t *socket, char *buffer, size_t size, char *name, size_t *name_length, int *port);
@@ -587,6 +711,10 @@ CAT_API cat_bool_t cat_socket_set_tcp_nodelay(cat_socket_t *socket, cat_bool_t e
 CAT_API cat_bool_t cat_socket_set_tcp_keepalive(cat_socket_t *socket, cat_bool_t enable, unsigned int delay);
 CAT_API cat_bool_t cat_socket_set_tcp_accept_balance(cat_socket_t *socket, cat_bool_t enable);
 
+CAT_API cat_bool_t cat_socket_is_sticky_read(const cat_socket_t *socket);
+/* keep the stream socket registered for readability between reads */
+CAT_API cat_bool_t cat_socket_set_sticky_read(cat_socket_t *socket, cat_bool_t enable);
+
 /* helper */
 
 CAT_API int cat_socket_get_local_free_port(void);
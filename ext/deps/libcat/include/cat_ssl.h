@@ -149,6 +149,8 @@ CAT_API cat_bool_t cat_ssl_context_set_default_verify_paths(cat_ssl_context_t *c
 CAT_API cat_bool_t cat_ssl_context_set_ca_file(cat_ssl_context_t *context, const char *ca_file);
 CAT_API cat_bool_t cat_ssl_context_set_ca_path(cat_ssl_context_t *context, const char *ca_path);
 CAT_API void cat_ssl_context_set_verify_depth(cat_ssl_context_t *context, int depth);
+/* protocols are in wire format (e.g. "\x02h2\x08http/1.1"), server selects the first one it supports in its own order */
+CAT_API cat_bool_t cat_ssl_context_set_alpn_protocols(cat_ssl_context_t *context, cat_bool_t is_server, const char *protocols, size_t length);
 
 /* connection */
 CAT_API cat_ssl_t *cat_ssl_create(cat_ssl_t *ssl, cat_ssl_context_t *context);
@@ -161,6 +163,8 @@ CAT_API void cat_ssl_set_connect_state(cat_ssl_t *ssl);
 
 CAT_API cat_bool_t cat_ssl_set_sni_server_name(cat_ssl_t *ssl, const char *name);
 CAT_API cat_bool_t cat_ssl_set_passphrase(cat_ssl_t *ssl, const char *passphrase, size_t passphrase_length);
+/* returns NULL if nothing was negotiated, the result is not zero-terminated */
+CAT_API const char *cat_ssl_get_alpn_protocol(const cat_ssl_t *ssl, size_t *length);
 
 typedef enum {
     CAT_SSL_RET_OK         = 0,
@@ -23,6 +23,27 @@ extern "C" {
 #endif
 
 #include "cat.h"
+#include "cat_queue.h"
+
+/* timers used by cat_time_wait() are initialized once and reused,
+ * at most this number of idle timers are kept for the next waiters */
+#ifndef CAT_TIME_TIMER_POOL_MAX_SIZE
+#define CAT_TIME_TIMER_POOL_MAX_SIZE 16384
+#endif
+
+CAT_GLOBALS_STRUCT_BEGIN(cat_time)
+    cat_queue_t timer_pool;
+    size_t timer_pool_count;
+CAT_GLOBALS_STRUCT_END(cat_time)
+
+extern CAT_API CAT_GLOBALS_DECLARE(cat_time)
+
+#define CAT_TIME_G(x) CAT_GLOBALS_GET(cat_time, x)
+
+CAT_API cat_bool_t cat_time_module_init(void);
+CAT_API cat_bool_t cat_time_runtime_init(void);
+/* must be called before event runtime shutdown (it closes all idle timers) */
+CAT_API cat_bool_t cat_time_runtime_shutdown(void);
 
 CAT_API cat_nsec_t cat_time_nsec(void);
 CAT_API cat_msec_t cat_time_msec(void);
@@ -37,9 +58,11 @@ CAT_API cat_bool_t cat_time_wait(cat_timeout_t timeout);
     cat_msec_t __time_cached = cat_time_msec_cached(); \
 
 #define CAT_TIME_WAIT_END(timeout) \
-    timeout -= (cat_time_msec_cached() - __time_cached); \
-    if (unlikely(timeout < 0)) { \
-        timeout = 0; \
+    if (timeout >= 0) { /* do not turn infinite into 0 */ \
+        timeout -= (cat_time_msec_cached() - __time_cached); \
+        if (unlikely(timeout < 0)) { \
+            timeout = 0; \
+        } \
     } \
 } while (0)
 
@@ -41,6 +41,8 @@ typedef uint64_t cat_alert_count_t;
 typedef struct cat_watch_dog_s cat_watch_dog_t;
 
 typedef void (*cat_watch_dog_alerter_t)(cat_watch_dog_t *watch_dog);
+/* it is called in watch-dog thread on every tick */
+typedef void (*cat_watch_dog_sampler_t)(cat_watch_dog_t *watch_dog);
 
 CAT_GLOBALS_STRUCT_BEGIN(cat_watch_dog)
     cat_watch_dog_t *watch_dog;
@@ -56,6 +58,7 @@ struct cat_watch_dog_s
     cat_nsec_t quantum;
     cat_nsec_t threshold;
     cat_watch_dog_alerter_t alerter;
+    cat_watch_dog_sampler_t sampler;
     /* private */
     cat_alert_count_t alert_count;
     cat_bool_t allocated;
@@ -76,6 +79,8 @@ CAT_API cat_bool_t cat_watch_dog_runtime_shutdown(void);
 CAT_API cat_bool_t cat_watch_dog_run(cat_watch_dog_t *watch_dog, cat_nsec_t quantum, cat_nsec_t threshold, cat_watch_dog_alerter_t alerter);
 CAT_API cat_bool_t cat_watch_dog_stop(void);
 
+CAT_API cat_bool_t cat_watch_dog_set_sampler(cat_watch_dog_sampler_t sampler);
+
 CAT_API void cat_watch_dog_alert_standard(cat_watch_dog_t *watch_dog);
 
 CAT_API cat_bool_t cat_watch_dog_is_running(void);
@@ -55,6 +55,8 @@ enum cat_websocket_opcode_e
 typedef uint8_t cat_websocket_opcode_t;
 
 CAT_API const char* cat_websocket_opcode_name(cat_websocket_opcode_t opcode);
+CAT_API cat_bool_t cat_websocket_opcode_is_valid(cat_websocket_opcode_t opcode);
+CAT_API cat_bool_t cat_websocket_opcode_is_control(cat_websocket_opcode_t opcode);
 
 #define CAT_WEBSOCKET_STATUS_MAP(XX) \
     XX(NORMAL_CLOSURE, 1000, "Normal closure; the connection successfully completed whatever purpose for which it was created") \
@@ -83,6 +85,8 @@ enum cat_websocket_status_e
 typedef uint16_t cat_websocket_status_code_t;
 
 CAT_API const char* cat_websocket_status_get_description(cat_websocket_status_code_t code);
+/* whether the code can be sent in a close frame (RFC 6455 section 7.4) */
+CAT_API cat_bool_t cat_websocket_status_code_is_valid(cat_websocket_status_code_t code);
 
 #define CAT_WEBSOCKET_STATUS_CODE_LENGTH                 2
 #define CAT_WEBSOCKET_CONTROL_FRAME_MAX_PAYLOAD_LENGTH   125
@@ -130,6 +134,45 @@ CAT_API uint8_t cat_websocket_header_pack(cat_websocket_header_t *header, char *
 CAT_API uint8_t cat_websocket_header_unpack(cat_websocket_header_t *header, const char *data, size_t length);
 CAT_API void cat_websocket_mask(char *to, char *from, uint64_t length, const char *mask_key);
 CAT_API void cat_websocket_unmask(char *data, uint64_t length, const char *mask_key);
+/* index is the position of from in the whole payload (for masking in chunks),
+ * to may be equal to from, or they must not overlap */
+CAT_API void cat_websocket_mask_ex(char *to, const char *from, uint64_t length, const char *mask_key, uint64_t index);
+
+/* UTF-8 validation (RFC 3629), data can be validated in chunks (e.g. fragments of a text message),
+ * state must be initialized to CAT_WEBSOCKET_UTF8_ACCEPT, and it is back to ACCEPT
+ * only if the data validated so far does not end with an incomplete sequence */
+
+#define CAT_WEBSOCKET_UTF8_ACCEPT 0
+
+typedef uint32_t cat_websocket_utf8_state_t;
+
+/* returns false if data is not a valid UTF-8 sequence (state is undefined then) */
+CAT_API cat_bool_t cat_websocket_utf8_validate(cat_websocket_utf8_state_t *state, const char *data, size_t length);
+/* validate a complete string */
+CAT_API cat_bool_t cat_websocket_utf8_check(const char *data, size_t length);
+
+/* mask kernels are selected by CPU features at runtime */
+
+#define CAT_WEBSOCKET_MASK_KERNEL_MAP(XX) \
+    XX(GENERIC) \
+    XX(SSE2) \
+    XX(AVX2) \
+    XX(AVX512) \
+    XX(NEON)
+
+typedef enum cat_websocket_mask_kernel_e {
+#define CAT_WEBSOCKET_MASK_KERNEL_GEN(name) CAT_WEBSOCKET_MASK_KERNEL_##name,
+    CAT_WEBSOCKET_MASK_KERNEL_MAP(CAT_WEBSOCKET_MASK_KERNEL_GEN)
+#undef CAT_WEBSOCKET_MASK_KERNEL_GEN
+    CAT_WEBSOCKET_MASK_KERNEL_COUNT,
+} cat_websocket_mask_kernel_t;
+
+CAT_API const char *cat_websocket_mask_kernel_name(cat_websocket_mask_kernel_t kernel);
+CAT_API cat_bool_t cat_websocket_mask_kernel_is_available(cat_websocket_mask_kernel_t kernel);
+/* the fastest available one by default */
+CAT_API cat_websocket_mask_kernel_t cat_websocket_mask_kernel_get(void);
+/* it fails with CAT_ENOTSUP if it is not available (for testing and benchmarking) */
+CAT_API cat_bool_t cat_websocket_mask_kernel_set(cat_websocket_mask_kernel_t kernel);
 
 #ifdef __cplusplus
 }
@@ -26,7 +26,77 @@ extern "C" {
 
 typedef cat_data_callback_t cat_work_function_t;
 
+/* works are dispatched to thread pools by their kinds,
+ * all kinds share the default pool unless a dedicated one is set */
+typedef enum cat_work_kind_e {
+    CAT_WORK_KIND_CPU = UV_THREADPOOL_KIND_CPU,     /* cat_work() */
+    CAT_WORK_KIND_FS  = UV_THREADPOOL_KIND_FAST_IO, /* cat_fs_*() */
+    CAT_WORK_KIND_DNS = UV_THREADPOOL_KIND_SLOW_IO, /* cat_dns_*() */
+} cat_work_kind_t;
+
+#define CAT_WORK_KIND_COUNT UV_THREADPOOL_KIND_MAX
+
+#define CAT_WORK_POOL_DEFAULT_NAME "default"
+#define CAT_WORK_POOL_NAME_SIZE UV_THREADPOOL_NAME_SIZE
+/* see uv_threadpool_stats_t */
+#define CAT_WORK_POOL_HISTOGRAM_SIZE UV_THREADPOOL_HISTOGRAM_SIZE
+
+#ifndef CAT_WORK_POOL_MAX_COUNT
+#define CAT_WORK_POOL_MAX_COUNT 32
+#endif
+
+typedef uv_threadpool_t cat_work_pool_t;
+typedef uv_threadpool_stats_t cat_work_pool_stats_t;
+
+CAT_GLOBALS_STRUCT_BEGIN(cat_work)
+    /* dedicated pools (the default one is not included) */
+    cat_work_pool_t *pools[CAT_WORK_POOL_MAX_COUNT];
+    size_t pool_count;
+CAT_GLOBALS_STRUCT_END(cat_work)
+
+extern CAT_API CAT_GLOBALS_DECLARE(cat_work)
+
+#define CAT_WORK_G(x) CAT_GLOBALS_GET(cat_work, x)
+
+/* module/runtime */
+
+CAT_API cat_bool_t cat_work_module_init(void);
+CAT_API cat_bool_t cat_work_runtime_init(void);
+CAT_API cat_bool_t cat_work_runtime_shutdown(void);
+
+/* work */
+
 CAT_API cat_bool_t cat_work(cat_work_function_t function, cat_data_t *data, cat_timeout_t timeout);
+/* pool NULL means the pool of CAT_WORK_KIND_CPU;
+ * if cleanup is set, the ownership of data is transferred to it when it fails,
+ * (function may be still running on the thread after timeout or cancellation),
+ * it will be called on the loop thread once the work is done */
+CAT_API cat_bool_t cat_work_ex(cat_work_pool_t *pool, cat_work_function_t function, cat_data_dtor_t cleanup, cat_data_t *data, cat_timeout_t timeout);
+
+/* pool */
+
+/* max_queue_size 0 means unlimited, otherwise works will be rejected with CAT_EAGAIN
+ * if there are too many works waiting for threads;
+ * priority is the nice value of the threads (only Linux supports it) */
+CAT_API cat_work_pool_t *cat_work_pool_create(const char *name, size_t size, size_t max_queue_size, int priority);
+/* it fails with CAT_EBUSY if there are works on it */
+CAT_API cat_bool_t cat_work_pool_close(cat_work_pool_t *pool);
+CAT_API cat_work_pool_t *cat_work_pool_get_default(void);
+CAT_API cat_work_pool_t *cat_work_pool_get(const char *name);
+/* index 0 is always the default pool, NULL if out of range */
+CAT_API cat_work_pool_t *cat_work_pool_get_by_index(size_t index);
+CAT_API size_t cat_work_pool_get_count(void);
+CAT_API const char *cat_work_pool_get_name(const cat_work_pool_t *pool);
+CAT_API int cat_work_pool_get_priority(const cat_work_pool_t *pool);
+CAT_API void cat_work_pool_set_max_queue_size(cat_work_pool_t *pool, size_t max_queue_size);
+CAT_API void cat_work_pool_get_stats(cat_work_pool_t *pool, cat_work_pool_stats_t *stats);
+CAT_API void cat_work_pool_reset_stats(cat_work_pool_t *pool);
+
+/* kind */
+
+CAT_API cat_work_pool_t *cat_work_get_pool(cat_work_kind_t kind);
+/* pool NULL means the default pool */
+CAT_API void cat_work_set_pool(cat_work_kind_t kind, cat_work_pool_t *pool);
 
 #ifdef __cplusplus
 }
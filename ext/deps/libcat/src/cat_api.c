@@ -39,7 +39,10 @@ CAT_API cat_bool_t cat_module_init_all(void)
     return cat_module_init() &&
            cat_coroutine_module_init() &&
            cat_event_module_init() &&
+           cat_time_module_init() &&
+           cat_io_uring_module_init() &&
            cat_buffer_module_init() &&
+           cat_work_module_init() &&
 #ifdef CAT_SSL
            cat_ssl_module_init() &&
 #endif
@@ -62,6 +65,9 @@ CAT_API cat_bool_t cat_runtime_init_all(void)
     return cat_runtime_init() &&
            cat_coroutine_runtime_init() &&
            cat_event_runtime_init() &&
+           cat_time_runtime_init() &&
+           cat_io_uring_runtime_init() &&
+           cat_work_runtime_init() &&
            cat_socket_runtime_init() &&
            cat_watch_dog_runtime_init();
 }
@@ -71,7 +77,11 @@ CAT_API cat_bool_t cat_runtime_shutdown_all(void)
     cat_bool_t ret = cat_true;
 
     ret = cat_watch_dog_runtime_shutdown() && ret;
+    ret = cat_time_runtime_shutdown() && ret;
+    ret = cat_io_uring_runtime_shutdown() && ret;
     ret = cat_event_runtime_shutdown() && ret;
+    ret = cat_work_runtime_shutdown() && ret;
+    ret = cat_socket_runtime_shutdown() && ret;
     ret = cat_coroutine_runtime_shutdown() && ret;
     ret = cat_runtime_shutdown() && ret;
 
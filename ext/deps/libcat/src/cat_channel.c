@@ -129,6 +129,7 @@ static cat_always_inline cat_bool_t cat_channel_wait(cat_queue_t *queue, cat_tim
     cat_bool_t ret;
 
     cat_queue_push_back(queue, waiter);
+    cat_coroutine_set_wait_type(CAT_COROUTINE_WAIT_TYPE_CHANNEL);
     ret = cat_time_wait(timeout);
     cat_queue_remove(waiter);
 
@@ -261,33 +262,75 @@ static cat_bool_t cat_channel_unbuffered_pop(cat_channel_t *channel, cat_data_t
     return cat_true;
 }
 
-static cat_always_inline cat_channel_bucket_t *cat_channel_buffered_bucket_create(const cat_data_t *data, size_t data_size)
+static cat_always_inline char *cat_channel_buffered_slot(const cat_channel_t *channel, cat_channel_size_t index)
 {
-    cat_channel_bucket_t *bucket;
+    return channel->u.buffered.storage + ((size_t) index * channel->data_size);
+}
 
-    bucket = (cat_channel_bucket_t *) cat_malloc(offsetof(cat_channel_bucket_t, data) + data_size);
+static cat_channel_size_t cat_channel_buffered_prealloc_size(const cat_channel_t *channel)
+{
+    cat_channel_size_t size = CAT_CHANNEL_BUFFERED_PREALLOC_SIZE / (channel->data_size > 0 ? channel->data_size : 1);
 
-    if (unlikely(bucket == NULL)) {
-        cat_update_last_error_of_syscall("Malloc for channel bucket failed");
-        return NULL;
+    if (size == 0) {
+        size = 1;
     }
 
-    memcpy(bucket->data, data, data_size);
-
-    return bucket;
+    return CAT_MIN(size, channel->capacity);
 }
 
-static cat_always_inline cat_bool_t cat_channel_buffered_push_data(cat_channel_t *channel, const cat_data_t *data)
+static cat_never_inline cat_bool_t cat_channel_buffered_grow(cat_channel_t *channel)
 {
-    cat_channel_bucket_t *bucket;
+    cat_channel_size_t size = channel->u.buffered.size;
+    cat_channel_size_t new_size;
+    char *storage;
+
+    if (size == 0) {
+        new_size = cat_channel_buffered_prealloc_size(channel);
+    } else if (size > channel->capacity / 2) {
+        new_size = channel->capacity;
+    } else {
+        new_size = size * 2;
+    }
+    CAT_ASSERT(new_size > size);
 
-    bucket = cat_channel_buffered_bucket_create(data, channel->data_size);
+    storage = (char *) cat_realloc(channel->u.buffered.storage, (size_t) new_size * channel->data_size);
 
-    if (unlikely(bucket == NULL)) {
+    if (unlikely(storage == NULL)) {
+        cat_update_last_error_of_syscall("Realloc for channel storage failed");
         return cat_false;
     }
 
-    cat_queue_push_back(&channel->u.buffered.storage, &bucket->node);
+    channel->u.buffered.storage = storage;
+    channel->u.buffered.size = new_size;
+    /* the ring is full here, move the wrapped part [head, size) to the end of the new one */
+    if (channel->u.buffered.head != 0) {
+        cat_channel_size_t n = size - channel->u.buffered.head;
+        memmove(
+            cat_channel_buffered_slot(channel, new_size - n),
+            cat_channel_buffered_slot(channel, channel->u.buffered.head),
+            (size_t) n * channel->data_size
+        );
+        channel->u.buffered.head = new_size - n;
+    }
+
+    return cat_true;
+}
+
+static cat_always_inline cat_bool_t cat_channel_buffered_push_data(cat_channel_t *channel, const cat_data_t *data)
+{
+    cat_channel_size_t index;
+
+    if (unlikely(channel->length == channel->u.buffered.size)) {
+        if (unlikely(!cat_channel_buffered_grow(channel))) {
+            return cat_false;
+        }
+    }
+
+    index = channel->u.buffered.head + channel->length;
+    if (index >= channel->u.buffered.size) {
+        index -= channel->u.buffered.size;
+    }
+    memcpy(cat_channel_buffered_slot(channel, index), data, channel->data_size);
     channel->length++;
 
     return cat_true;
@@ -295,16 +338,16 @@ static cat_always_inline cat_bool_t cat_channel_buffered_push_data(cat_channel_t
 
 static cat_always_inline void cat_channel_buffered_pop_data(cat_channel_t *channel, cat_data_t *data)
 {
-    cat_channel_bucket_t *bucket;
+    char *slot = cat_channel_buffered_slot(channel, channel->u.buffered.head);
 
-    bucket = cat_queue_front_data(&channel->u.buffered.storage, cat_channel_bucket_t, node);
-    cat_queue_remove(&bucket->node);
     if (data != NULL) {
-        memcpy(data, bucket->data, channel->data_size);
+        memcpy(data, slot, channel->data_size);
     } else if (channel->dtor != NULL) {
-        channel->dtor(bucket->data);
+        channel->dtor(slot);
+    }
+    if (++channel->u.buffered.head == channel->u.buffered.size) {
+        channel->u.buffered.head = 0;
     }
-    cat_free(bucket);
     channel->length--;
 }
 
@@ -403,7 +446,13 @@ CAT_API cat_channel_t *cat_channel_create(cat_channel_t *channel, cat_channel_si
     if (cat_channel__is_unbuffered(channel)) {
         memset(&channel->u.unbuffered, 0, sizeof(channel->u.unbuffered));
     } else {
-        cat_queue_init(&channel->u.buffered.storage);
+        channel->u.buffered.storage = NULL;
+        channel->u.buffered.size = 0;
+        channel->u.buffered.head = 0;
+        /* preallocate the ring so that push/pop never allocate in the common case */
+        if (unlikely(!cat_channel_buffered_grow(channel))) {
+            return NULL;
+        }
     }
 
     return channel;
@@ -455,19 +504,18 @@ CAT_API void cat_channel_close(cat_channel_t *channel)
     CAT_ASSERT(!cat_channel__has_producers(channel));
     CAT_ASSERT(!cat_channel__has_consumers(channel));
 
-    /* clean up the data bucket (no more consumers) */
+    /* clean up the data storage (no more consumers),
+     * it will be allocated again on demand if we reuse the channel */
     if (!cat_channel__is_unbuffered(channel)) {
-        cat_queue_t *storage = &channel->u.buffered.storage;
-        cat_channel_data_dtor_t dtor = channel->dtor;
-        cat_channel_bucket_t *bucket;
-        while ((bucket = cat_queue_front_data(storage, cat_channel_bucket_t, node))) {
-            cat_queue_remove(&bucket->node);
-            if (dtor != NULL) {
-                dtor(bucket->data);
-            }
-            cat_free(bucket);
-            channel->length--;
+        while (!cat_channel__is_empty(channel)) {
+            cat_channel_buffered_pop_data(channel, NULL);
+        }
+        if (channel->u.buffered.storage != NULL) {
+            cat_free(channel->u.buffered.storage);
+            channel->u.buffered.storage = NULL;
         }
+        channel->u.buffered.size = 0;
+        channel->u.buffered.head = 0;
     }
 
     /* everything will be reset after close */
@@ -537,6 +585,7 @@ CAT_API cat_channel_select_response_t *cat_channel_select(cat_channel_select_req
         }
     }
 
+    cat_coroutine_set_wait_type(CAT_COROUTINE_WAIT_TYPE_CHANNEL);
     ret = cat_time_wait(timeout);
 
     response = NULL;
@@ -659,12 +708,3 @@ CAT_API cat_channel_data_dtor_t cat_channel_set_dtor(cat_channel_t *channel, cat
     return old_dtor;
 }
 
-/* ext */
-
-CAT_API cat_queue_t *cat_channel_get_storage(cat_channel_t *channel)
-{
-    if (unlikely(cat_channel__is_unbuffered(channel))) {
-        return NULL;
-    }
-    return &channel->u.buffered.storage;
-}
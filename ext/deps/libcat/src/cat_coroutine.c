@@ -19,10 +19,27 @@
 #include "cat_coroutine.h"
 #include "cat_time.h"
 
-#if defined(CAT_OS_UNIX_LIKE) && defined(CAT_DEBUG)
+#ifdef CAT_OS_UNIX_LIKE
 #include <sys/mman.h>
-#ifdef PROT_NONE
-#define CAT_COROUTINE_USE_MPEOTECT
+#if defined(PROT_NONE) && (defined(MAP_ANONYMOUS) || defined(MAP_ANON))
+#define CAT_COROUTINE_USE_MMAP
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#ifndef MAP_STACK
+#define MAP_STACK 0
+#endif
+#if defined(MADV_FREE)
+#define CAT_COROUTINE_STACK_MADVISE MADV_FREE
+#elif defined(MADV_DONTNEED)
+#define CAT_COROUTINE_STACK_MADVISE MADV_DONTNEED
+#endif
+/* every protected guard page splits the mapping into two VMAs,
+ * it would exhaust vm.max_map_count with tens of thousands of coroutines,
+ * so we only do it in debug mode as before */
+#ifdef CAT_DEBUG
+#define CAT_COROUTINE_USE_MPROTECT
+#endif
 #endif
 #endif
 
@@ -78,6 +95,186 @@ static cat_coroutine_stack_size_t cat_coroutine_align_stack_size(size_t size)
     return size;
 }
 
+/* stack pool */
+
+typedef struct
+{
+    cat_coroutine_stack_t *next;
+} cat_coroutine_stack_pool_node_t;
+
+static cat_always_inline size_t cat_coroutine_stack_pool_class_size(int index)
+{
+    return ((size_t) CAT_COROUTINE_MIN_STACK_SIZE) << index;
+}
+
+static cat_always_inline int cat_coroutine_stack_pool_class_index(size_t size)
+{
+    int index = 0;
+
+    while (cat_coroutine_stack_pool_class_size(index) < size) {
+        index++;
+    }
+    CAT_ASSERT(index < CAT_COROUTINE_STACK_POOL_CLASS_COUNT);
+
+    return index;
+}
+
+/* the link is stored at the top of the idle stack (the page which will never be trimmed) */
+static cat_always_inline cat_coroutine_stack_pool_node_t *cat_coroutine_stack_pool_node(cat_coroutine_stack_t *stack, size_t size)
+{
+    return (cat_coroutine_stack_pool_node_t *) (((char *) stack) + size - sizeof(cat_coroutine_stack_pool_node_t));
+}
+
+static cat_coroutine_stack_t *cat_coroutine_stack_map(size_t size)
+{
+    cat_coroutine_stack_t *stack;
+
+#ifdef CAT_COROUTINE_USE_MMAP
+    stack = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (unlikely(stack == MAP_FAILED)) {
+        cat_update_last_error_of_syscall("Map memory for stack failed with size %zu", size);
+        return NULL;
+    }
+#ifdef CAT_COROUTINE_USE_MPROTECT
+    /* the guard page only needs to be protected once in the whole life of the stack */
+    if (unlikely(mprotect(stack, cat_getpagesize(), PROT_NONE) != 0)) {
+        cat_syscall_failure(NOTICE, COROUTINE, "Protect stack failed");
+    }
+#endif
+#else
+    stack = (cat_coroutine_stack_t *) cat_sys_malloc(size);
+    if (unlikely(stack == NULL)) {
+        cat_update_last_error_of_syscall("Malloc for stack failed with size %zu", size);
+        return NULL;
+    }
+#endif
+
+    return stack;
+}
+
+static void cat_coroutine_stack_unmap(cat_coroutine_stack_t *stack, size_t size)
+{
+#ifdef CAT_COROUTINE_USE_MMAP
+    if (unlikely(munmap(stack, size) != 0)) {
+        cat_syscall_failure(NOTICE, COROUTINE, "Unmap stack failed");
+    }
+#else
+    (void) size;
+    cat_sys_free(stack);
+#endif
+}
+
+static cat_bool_t cat_coroutine_stack_trim(cat_coroutine_stack_t *stack, size_t size)
+{
+#if defined(CAT_COROUTINE_USE_MMAP) && defined(CAT_COROUTINE_STACK_MADVISE)
+    size_t pagesize = cat_getpagesize();
+    /* skip the guard page and the top page which holds the link */
+    if (unlikely(madvise(((char *) stack) + pagesize, size - (pagesize * 2), CAT_COROUTINE_STACK_MADVISE) != 0)) {
+        cat_syscall_failure(NOTICE, COROUTINE, "Trim stack failed");
+        return cat_false;
+    }
+    return cat_true;
+#else
+    (void) stack;
+    (void) size;
+    return cat_false;
+#endif
+}
+
+static void cat_coroutine_stack_pool_init(cat_coroutine_stack_pool_t *pool)
+{
+    memset(pool, 0, sizeof(*pool));
+    pool->low_watermark = CAT_COROUTINE_STACK_POOL_DEFAULT_LOW_WATERMARK;
+    pool->high_watermark = CAT_COROUTINE_STACK_POOL_DEFAULT_HIGH_WATERMARK;
+}
+
+static cat_coroutine_stack_t *cat_coroutine_stack_pool_pop(cat_coroutine_stack_t **list, cat_coroutine_count_t *count, size_t size)
+{
+    cat_coroutine_stack_t *stack = *list;
+
+    *list = cat_coroutine_stack_pool_node(stack, size)->next;
+    (*count)--;
+
+    return stack;
+}
+
+static void cat_coroutine_stack_pool_push(cat_coroutine_stack_t **list, cat_coroutine_count_t *count, cat_coroutine_stack_t *stack, size_t size)
+{
+    cat_coroutine_stack_pool_node(stack, size)->next = *list;
+    *list = stack;
+    (*count)++;
+}
+
+/* shrink the class to fit the given watermarks */
+static cat_coroutine_count_t cat_coroutine_stack_pool_class_shrink(cat_coroutine_stack_pool_t *pool, int index, cat_coroutine_count_t low_watermark, cat_coroutine_count_t high_watermark)
+{
+    cat_coroutine_stack_pool_class_t *klass = &pool->classes[index];
+    size_t size = cat_coroutine_stack_pool_class_size(index);
+    cat_coroutine_count_t released = 0;
+
+    while (klass->hot_count + klass->cold_count > high_watermark) {
+        cat_coroutine_stack_t *stack;
+        if (klass->cold_count > 0) {
+            stack = cat_coroutine_stack_pool_pop(&klass->cold, &klass->cold_count, size);
+        } else {
+            stack = cat_coroutine_stack_pool_pop(&klass->hot, &klass->hot_count, size);
+        }
+        cat_coroutine_stack_unmap(stack, size);
+        released++;
+    }
+    while (klass->hot_count > low_watermark) {
+        cat_coroutine_stack_t *stack = cat_coroutine_stack_pool_pop(&klass->hot, &klass->hot_count, size);
+        if (cat_coroutine_stack_trim(stack, size)) {
+            cat_coroutine_stack_pool_push(&klass->cold, &klass->cold_count, stack, size);
+        } else {
+            cat_coroutine_stack_unmap(stack, size);
+            released++;
+        }
+    }
+    pool->released += released;
+
+    return released;
+}
+
+static cat_coroutine_stack_t *cat_coroutine_stack_acquire(size_t size)
+{
+    cat_coroutine_stack_pool_t *pool = &CAT_COROUTINE_G(stack_pool);
+    cat_coroutine_stack_pool_class_t *klass = &pool->classes[cat_coroutine_stack_pool_class_index(size)];
+    cat_coroutine_stack_t *stack;
+
+    if (likely(klass->hot_count > 0)) {
+        stack = cat_coroutine_stack_pool_pop(&klass->hot, &klass->hot_count, size);
+    } else if (klass->cold_count > 0) {
+        stack = cat_coroutine_stack_pool_pop(&klass->cold, &klass->cold_count, size);
+    } else {
+        stack = cat_coroutine_stack_map(size);
+        if (likely(stack != NULL)) {
+            pool->misses++;
+        }
+        return stack;
+    }
+    pool->hits++;
+
+    return stack;
+}
+
+static void cat_coroutine_stack_release(cat_coroutine_stack_t *stack, size_t size)
+{
+    cat_coroutine_stack_pool_t *pool = &CAT_COROUTINE_G(stack_pool);
+    cat_coroutine_stack_pool_class_t *klass = &pool->classes[cat_coroutine_stack_pool_class_index(size)];
+
+    if (likely(klass->hot_count < pool->low_watermark)) {
+        cat_coroutine_stack_pool_push(&klass->hot, &klass->hot_count, stack, size);
+        pool->recycled++;
+    } else if (klass->hot_count + klass->cold_count < pool->high_watermark && cat_coroutine_stack_trim(stack, size)) {
+        cat_coroutine_stack_pool_push(&klass->cold, &klass->cold_count, stack, size);
+        pool->trimmed++;
+    } else {
+        cat_coroutine_stack_unmap(stack, size);
+        pool->released++;
+    }
+}
+
 CAT_API CAT_GLOBALS_DECLARE(cat_coroutine)
 
 CAT_GLOBALS_CTOR_DECLARE_SZ(cat_coroutine)
@@ -102,6 +299,11 @@ CAT_API cat_bool_t cat_coroutine_runtime_init(void)
     CAT_COROUTINE_G(count) = 0;
     CAT_COROUTINE_G(peak_count) = 0;
     CAT_COROUTINE_G(round) = 0;
+    CAT_COROUTINE_G(stats_enabled) = cat_false;
+    CAT_COROUTINE_G(stats_start_time) = 0;
+
+    /* init stack pool */
+    cat_coroutine_stack_pool_init(&CAT_COROUTINE_G(stack_pool));
 
     /* init main coroutine properties */
     do {
@@ -118,6 +320,7 @@ CAT_API cat_bool_t cat_coroutine_runtime_init(void)
         main_coroutine->stack_size = 0;
         memset(&main_coroutine->context, ~0, sizeof(cat_coroutine_context_t));
         main_coroutine->function = NULL;
+        memset(&main_coroutine->stats, 0, sizeof(main_coroutine->stats));
 #ifdef CAT_COROUTINE_USE_UCONTEXT
         main_coroutine->transfer_data = NULL;
 #endif
@@ -145,6 +348,8 @@ CAT_API cat_bool_t cat_coroutine_runtime_shutdown(void)
     CAT_ASSERT(cat_coroutine_get_scheduler() == NULL && "Coroutine scheduler should have been stopped");
     CAT_ASSERT(CAT_COROUTINE_G(count) == 1 && "Coroutine count should be 1");
 
+    (void) cat_coroutine_stack_pool_clear();
+
     return cat_true;
 }
 
@@ -161,6 +366,26 @@ CAT_API cat_bool_t cat_coroutine_set_dead_lock_log_type(cat_log_type_t type)
     return cat_true;
 }
 
+CAT_API cat_bool_t cat_coroutine_set_stack_pool_watermarks(cat_coroutine_count_t low_watermark, cat_coroutine_count_t high_watermark)
+{
+    cat_coroutine_stack_pool_t *pool = &CAT_COROUTINE_G(stack_pool);
+    int index;
+
+    if (unlikely(low_watermark > high_watermark)) {
+        cat_update_last_error(CAT_EINVAL, "Stack pool low watermark (" CAT_COROUTINE_COUNT_FMT ") should not be greater than high watermark (" CAT_COROUTINE_COUNT_FMT ")", low_watermark, high_watermark);
+        return cat_false;
+    }
+
+    pool->low_watermark = low_watermark;
+    pool->high_watermark = high_watermark;
+
+    for (index = 0; index < CAT_COROUTINE_STACK_POOL_CLASS_COUNT; index++) {
+        (void) cat_coroutine_stack_pool_class_shrink(pool, index, low_watermark, high_watermark);
+    }
+
+    return cat_true;
+}
+
 CAT_API cat_coroutine_resume_t cat_coroutine_register_resume(cat_coroutine_resume_t resume)
 {
     cat_coroutine_resume_t origin_resume = cat_coroutine_resume;
@@ -278,6 +503,78 @@ CAT_API cat_coroutine_round_t cat_coroutine_get_current_round(void)
     return CAT_COROUTINE_G(round);
 }
 
+/* stats */
+
+CAT_API void cat_coroutine_set_stats_enabled(cat_bool_t enabled)
+{
+    if (enabled && !CAT_COROUTINE_G(stats_enabled)) {
+        /* switch times which were recorded before are stale */
+        CAT_COROUTINE_G(stats_start_time) = uv_hrtime();
+        CAT_COROUTINE_G(current)->stats.last_switch_time = CAT_COROUTINE_G(stats_start_time);
+    }
+    CAT_COROUTINE_G(stats_enabled) = enabled;
+}
+
+CAT_API cat_bool_t cat_coroutine_is_stats_enabled(void)
+{
+    return CAT_COROUTINE_G(stats_enabled);
+}
+
+CAT_API const char *cat_coroutine_wait_type_name(cat_coroutine_wait_type_t type)
+{
+    switch (type) {
+#define CAT_COROUTINE_WAIT_TYPE_NAME_GEN(name, unused, value) case CAT_COROUTINE_WAIT_TYPE_##name: return value;
+    CAT_COROUTINE_WAIT_TYPE_MAP(CAT_COROUTINE_WAIT_TYPE_NAME_GEN)
+#undef CAT_COROUTINE_WAIT_TYPE_NAME_GEN
+    }
+    CAT_NEVER_HERE("Unknown wait type");
+}
+
+CAT_API const cat_coroutine_stats_t *cat_coroutine_get_stats(const cat_coroutine_t *coroutine)
+{
+    return &coroutine->stats;
+}
+
+/* stack pool */
+
+CAT_API cat_coroutine_stack_pool_stats_t *cat_coroutine_get_stack_pool_stats(cat_coroutine_stack_pool_stats_t *stats)
+{
+    const cat_coroutine_stack_pool_t *pool = &CAT_COROUTINE_G(stack_pool);
+    int index;
+
+    memset(stats, 0, sizeof(*stats));
+    stats->low_watermark = pool->low_watermark;
+    stats->high_watermark = pool->high_watermark;
+    for (index = 0; index < CAT_COROUTINE_STACK_POOL_CLASS_COUNT; index++) {
+        const cat_coroutine_stack_pool_class_t *klass = &pool->classes[index];
+        size_t size = cat_coroutine_stack_pool_class_size(index);
+        stats->hot_count += klass->hot_count;
+        stats->cold_count += klass->cold_count;
+        stats->hot_size += klass->hot_count * size;
+        stats->cold_size += klass->cold_count * size;
+    }
+    stats->hits = pool->hits;
+    stats->misses = pool->misses;
+    stats->recycled = pool->recycled;
+    stats->trimmed = pool->trimmed;
+    stats->released = pool->released;
+
+    return stats;
+}
+
+CAT_API cat_coroutine_count_t cat_coroutine_stack_pool_clear(void)
+{
+    cat_coroutine_stack_pool_t *pool = &CAT_COROUTINE_G(stack_pool);
+    cat_coroutine_count_t released = 0;
+    int index;
+
+    for (index = 0; index < CAT_COROUTINE_STACK_POOL_CLASS_COUNT; index++) {
+        released += cat_coroutine_stack_pool_class_shrink(pool, index, 0, 0);
+    }
+
+    return released;
+}
+
 static void cat_coroutine_context_function(cat_coroutine_transfer_t transfer)
 {
     cat_coroutine_t *coroutine = CAT_COROUTINE_G(current);
@@ -323,12 +620,13 @@ CAT_API cat_coroutine_t *cat_coroutine_create_ex(cat_coroutine_t *coroutine, cat
     size_t real_stack_size;
     cat_coroutine_context_t context;
 
-    /* align stack size */
-    stack_size = cat_coroutine_align_stack_size(stack_size);
-    /* alloc memory */
-    stack = (cat_coroutine_stack_t *) cat_sys_malloc(stack_size);
-    if (unlikely(!stack)) {
-        cat_update_last_error_of_syscall("Malloc for stack failed with size %zu", stack_size);
+    /* align stack size (round up to the size class of stack pool) */
+    stack_size = cat_coroutine_stack_pool_class_size(
+        cat_coroutine_stack_pool_class_index(cat_coroutine_align_stack_size(stack_size))
+    );
+    /* get memory from pool (or map a new one) */
+    stack = cat_coroutine_stack_acquire(stack_size);
+    if (unlikely(stack == NULL)) {
         return NULL;
     }
     /* calculations */
@@ -341,7 +639,7 @@ CAT_API cat_coroutine_t *cat_coroutine_create_ex(cat_coroutine_t *coroutine, cat
     /* make context */
 #ifdef CAT_COROUTINE_USE_UCONTEXT
     if (unlikely(getcontext(&context) == -1)) {
-        cat_sys_free(stack);
+        cat_coroutine_stack_release(stack, stack_size);
         cat_update_last_error_ez("Ucontext getcontext failed");
         return NULL;
     }
@@ -352,12 +650,6 @@ CAT_API cat_coroutine_t *cat_coroutine_create_ex(cat_coroutine_t *coroutine, cat
     cat_coroutine_context_make(&context, (void (*)(void)) &cat_coroutine_context_function, 1, NULL);
 #else
     context = cat_coroutine_context_make((void *) stack_end, real_stack_size, cat_coroutine_context_function);
-#endif
-    /* protect stack */
-#ifdef CAT_COROUTINE_USE_MPEOTECT
-    if (unlikely(mprotect(cat_getpageof(stack) + cat_getpagesize(), cat_getpagesize(), PROT_NONE) != 0)) {
-        cat_syscall_failure(NOTICE, COROUTINE, "Protect stack failed");
-    }
 #endif
     /* init coroutine properties */
     coroutine->id = CAT_COROUTINE_G(last_id)++;
@@ -375,6 +667,7 @@ CAT_API cat_coroutine_t *cat_coroutine_create_ex(cat_coroutine_t *coroutine, cat
 #ifdef CAT_COROUTINE_USE_UCONTEXT
     coroutine->transfer_data = NULL;
 #endif
+    memset(&coroutine->stats, 0, sizeof(coroutine->stats));
 #ifdef HAVE_VALGRIND
     coroutine->valgrind_stack_id = VALGRIND_STACK_REGISTER(stack_end, stack);
 #endif
@@ -394,15 +687,31 @@ CAT_API void cat_coroutine_close(cat_coroutine_t *coroutine)
 #ifdef HAVE_VALGRIND
     VALGRIND_STACK_DEREGISTER(coroutine->valgrind_stack_id);
 #endif
-#ifdef CAT_COROUTINE_USE_MPEOTECT
-    if (unlikely(mprotect(cat_getpageof(stack) + cat_getpagesize(), cat_getpagesize(), PROT_READ | PROT_WRITE) != 0)) {
-        cat_syscall_failure(NOTICE, COROUTINE, "Unprotect stack failed");
-    }
-#endif
-    /* fast free */
+    /* fast free (give it back to the pool) */
     coroutine->state = CAT_COROUTINE_STATE_DEAD;
     coroutine->stack = NULL;
-    cat_sys_free(stack);
+    cat_coroutine_stack_release(stack, coroutine->stack_size);
+}
+
+static void cat_coroutine_update_stats(cat_coroutine_t *current_coroutine, cat_coroutine_t *coroutine)
+{
+    cat_coroutine_stats_t *stats;
+    cat_nsec_t now = uv_hrtime();
+
+    /* current one is switched out */
+    stats = &current_coroutine->stats;
+    if (stats->last_switch_time >= CAT_COROUTINE_G(stats_start_time)) {
+        stats->run_time += now - stats->last_switch_time;
+    }
+    stats->last_switch_time = now;
+    /* target one is switched in */
+    stats = &coroutine->stats;
+    if (stats->last_switch_time >= CAT_COROUTINE_G(stats_start_time)) {
+        stats->wait_time[stats->wait_type] += now - stats->last_switch_time;
+    }
+    stats->last_switch_time = now;
+    stats->wait_type = CAT_COROUTINE_WAIT_TYPE_OTHER;
+    stats->switches++;
 }
 
 CAT_API cat_data_t *cat_coroutine_jump(cat_coroutine_t *coroutine, cat_data_t *data)
@@ -435,6 +744,9 @@ CAT_API cat_data_t *cat_coroutine_jump(cat_coroutine_t *coroutine, cat_data_t *d
     coroutine->opcodes = CAT_COROUTINE_OPCODE_NONE;
     /* round++ */
     coroutine->round = ++CAT_COROUTINE_G(round);
+    if (unlikely(CAT_COROUTINE_G(stats_enabled))) {
+        cat_coroutine_update_stats(current_coroutine, coroutine);
+    }
     /* jump */
 #ifdef CAT_COROUTINE_USE_UCONTEXT
     coroutine->transfer_data = data;
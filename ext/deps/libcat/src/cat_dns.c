@@ -32,34 +32,1207 @@ typedef struct
     struct addrinfo *response;
 } cat_getaddrinfo_context_t;
 
+struct cat_dns_cache_entry_s
+{
+    /* hash table chain */
+    cat_dns_cache_entry_t *next;
+    uint32_t hash;
+    /* LRU node (only for resolved entries) */
+    cat_queue_t node;
+    /* key */
+    int family;
+    int socktype;
+    int protocol;
+    int flags;
+    char *service;
+    /* value */
+    cat_bool_t resolving;
+    int error;
+    struct addrinfo *response;
+    cat_msec_t expire;
+    /* waiters for the in-flight resolution */
+    cat_queue_t waiters;
+    char hostname[1];
+};
+
+typedef struct
+{
+    cat_queue_t node;
+    cat_coroutine_t *coroutine;
+    cat_bool_t done;
+    /* resolution was not completed (e.g. timed out), waiter should try it by itself */
+    cat_bool_t retry;
+    int error;
+    struct addrinfo *response;
+} cat_dns_cache_waiter_t;
+
+#define CAT_DNS_CACHE_G(x) CAT_SOCKET_G(dns_cache.x)
+
+#define CAT_DNS_CACHE_MIN_BUCKET_COUNT 16
+
+/* we always return our own copy of addrinfo (so that it can be shared with cache),
+ * each node is allocated as a block with its address and canonname */
+static struct addrinfo *cat_dns_addrinfo_dup(const struct addrinfo *response)
+{
+    struct addrinfo *head = NULL, **next = &head;
+
+    for (; response != NULL; response = response->ai_next) {
+        size_t canonname_size = response->ai_canonname != NULL ? strlen(response->ai_canonname) + 1 : 0;
+        struct addrinfo *ai = (struct addrinfo *) cat_malloc(sizeof(*ai) + response->ai_addrlen + canonname_size);
+        if (unlikely(ai == NULL)) {
+            cat_update_last_error_of_syscall("Malloc for DNS addrinfo failed");
+            cat_dns_freeaddrinfo(head);
+            return NULL;
+        }
+        memcpy(ai, response, sizeof(*ai));
+        ai->ai_addr = (struct sockaddr *) (ai + 1);
+        memcpy(ai->ai_addr, response->ai_addr, response->ai_addrlen);
+        if (canonname_size != 0) {
+            ai->ai_canonname = ((char *) ai->ai_addr) + response->ai_addrlen;
+            memcpy(ai->ai_canonname, response->ai_canonname, canonname_size);
+        }
+        ai->ai_next = NULL;
+        *next = ai;
+        next = &ai->ai_next;
+    }
+
+    return head;
+}
+
 static void cat_dns_getaddrinfo_callback(uv_getaddrinfo_t* request, int status, struct addrinfo *response)
 {
-    cat_getaddrinfo_context_t *context = cat_container_of(request, cat_getaddrinfo_context_t, request.getaddrinfo);
+    cat_getaddrinfo_context_t *context = cat_container_of(request, cat_getaddrinfo_context_t, request.getaddrinfo);
+
+    if (likely(context->request.coroutine != NULL)) {
+        context->status = status;
+        context->response = response;
+        if (unlikely(!cat_coroutine_resume(context->request.coroutine, NULL, NULL))) {
+            cat_core_error_with_last(DNS, "DNS resolver schedule failed");
+        }
+    } else if (response != NULL) {
+        uv_freeaddrinfo(response);
+    }
+
+    cat_free(context);
+}
+
+/* resolver */
+
+#define CAT_DNS_RESOLVER_G(x) CAT_SOCKET_G(dns_resolver.x)
+
+#define CAT_DNS_HEADER_SIZE          12
+/* 255 octets in wire format, the presentation one is shorter */
+#define CAT_DNS_MAX_NAME_SIZE        256
+#define CAT_DNS_MAX_QUERY_SIZE       (CAT_DNS_HEADER_SIZE + CAT_DNS_MAX_NAME_SIZE + 4)
+/* responses should not be larger than 512 since we do not send EDNS,
+ * but some of servers do not care about it */
+#define CAT_DNS_UDP_BUFFER_SIZE      4096
+#define CAT_DNS_MAX_ADDRESSES        32
+#define CAT_DNS_MAX_CNAME_CHAIN      16
+#define CAT_DNS_MAX_COMPRESSION_JUMPS 64
+
+#define CAT_DNS_TYPE_A     1
+#define CAT_DNS_TYPE_CNAME 5
+#define CAT_DNS_TYPE_AAAA  28
+#define CAT_DNS_CLASS_IN   1
+
+#define CAT_DNS_RCODE_NOERROR  0
+#define CAT_DNS_RCODE_NXDOMAIN 3
+
+typedef struct cat_dns_hosts_entry_s cat_dns_hosts_entry_t;
+
+struct cat_dns_hosts_entry_s
+{
+    cat_dns_hosts_entry_t *next;
+    int family;
+    unsigned char address[16];
+    char name[1];
+};
+
+struct cat_dns_resolver_config_s
+{
+    cat_sockaddr_inet_info_t nameservers[CAT_DNS_RESOLVER_MAX_NAMESERVERS];
+    size_t nameserver_count;
+    char search[CAT_DNS_RESOLVER_MAX_SEARCH_DOMAINS][CAT_DNS_MAX_NAME_SIZE];
+    size_t search_count;
+    unsigned int ndots;
+    /* timeout of each query (ms) */
+    cat_timeout_t timeout;
+    unsigned int attempts;
+    cat_dns_hosts_entry_t *hosts;
+};
+
+typedef struct
+{
+    int family;
+    unsigned char address[16];
+} cat_dns_address_t;
+
+typedef struct
+{
+    uint16_t type;
+    uint16_t id;
+    cat_bool_t answered;
+    cat_bool_t truncated;
+    int rcode;
+    /* the name which addresses belong to (the end of CNAME chain) */
+    char canonname[CAT_DNS_MAX_NAME_SIZE];
+    /* min TTL of records (in seconds) */
+    uint32_t ttl;
+    size_t count;
+    unsigned char addresses[CAT_DNS_MAX_ADDRESSES][16];
+} cat_dns_question_t;
+
+static void cat_dns_resolver_config_init(cat_dns_resolver_config_t *config)
+{
+    config->nameserver_count = 0;
+    config->search_count = 0;
+    config->ndots = CAT_DNS_RESOLVER_DEFAULT_NDOTS;
+    config->timeout = CAT_DNS_RESOLVER_DEFAULT_TIMEOUT;
+    config->attempts = CAT_DNS_RESOLVER_DEFAULT_ATTEMPTS;
+    config->hosts = NULL;
+}
+
+static void cat_dns_resolver_config_free_hosts(cat_dns_resolver_config_t *config)
+{
+    cat_dns_hosts_entry_t *entry = config->hosts, *next;
+
+    for (; entry != NULL; entry = next) {
+        next = entry->next;
+        cat_free(entry);
+    }
+    config->hosts = NULL;
+}
+
+static cat_bool_t cat_dns_resolver_parse_nameserver(cat_sockaddr_inet_info_t *nameserver, const char *ip, int port)
+{
+    int error;
+
+    if (port <= 0) {
+        port = CAT_DNS_RESOLVER_DEFAULT_PORT;
+    }
+    error = uv_ip4_addr(ip, port, &nameserver->address.in);
+    if (error == 0) {
+        nameserver->length = sizeof(nameserver->address.in);
+        return cat_true;
+    }
+    error = uv_ip6_addr(ip, port, &nameserver->address.in6);
+    if (error == 0) {
+        nameserver->length = sizeof(nameserver->address.in6);
+        return cat_true;
+    }
+
+    return cat_false;
+}
+
+/* it discards the rest of line if it is too long */
+static cat_bool_t cat_dns_config_read_line(FILE *file, char *line, size_t size)
+{
+    size_t length;
+
+    if (fgets(line, (int) size, file) == NULL) {
+        return cat_false;
+    }
+    length = strlen(line);
+    if (length > 0 && line[length - 1] != '\n' && !feof(file)) {
+        int c;
+        do {
+            c = fgetc(file);
+        } while (c != '\n' && c != EOF);
+    }
+
+    return cat_true;
+}
+
+static char *cat_dns_config_next_token(char **cursor)
+{
+    char *p = *cursor, *token;
+
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+        p++;
+    }
+    if (*p == '\0' || *p == '#' || *p == ';') {
+        *cursor = p;
+        return NULL;
+    }
+    token = p;
+    while (*p != '\0' && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') {
+        p++;
+    }
+    if (*p != '\0') {
+        *p++ = '\0';
+    }
+    *cursor = p;
+
+    return token;
+}
+
+static void cat_dns_resolver_config_add_search(cat_dns_resolver_config_t *config, const char *domain)
+{
+    size_t length = strlen(domain);
+
+    if (length > 0 && domain[length - 1] == '.') {
+        length--;
+    }
+    if (length == 0 || length >= CAT_DNS_MAX_NAME_SIZE || config->search_count == CAT_DNS_RESOLVER_MAX_SEARCH_DOMAINS) {
+        return;
+    }
+    memcpy(config->search[config->search_count], domain, length);
+    config->search[config->search_count][length] = '\0';
+    config->search_count++;
+}
+
+static unsigned int cat_dns_resolver_parse_option_value(const char *value, unsigned int max)
+{
+    unsigned long n = strtoul(value, NULL, 10);
+
+    return n > max ? max : (unsigned int) n;
+}
+
+static cat_bool_t cat_dns_resolver_load_resolv_conf(cat_dns_resolver_config_t *config, const char *path)
+{
+    char line[1024];
+    FILE *file;
+
+    file = fopen(path, "r");
+    if (file == NULL) {
+        if (errno != ENOENT) {
+            cat_update_last_error_of_syscall("DNS resolver open \"%s\" failed", path);
+            return cat_false;
+        }
+    } else {
+        while (cat_dns_config_read_line(file, line, sizeof(line))) {
+            char *cursor = line, *key, *value;
+            key = cat_dns_config_next_token(&cursor);
+            if (key == NULL) {
+                continue;
+            }
+            if (strcmp(key, "nameserver") == 0) {
+                value = cat_dns_config_next_token(&cursor);
+                if (value != NULL && config->nameserver_count < CAT_DNS_RESOLVER_MAX_NAMESERVERS &&
+                    cat_dns_resolver_parse_nameserver(&config->nameservers[config->nameserver_count], value, 0)) {
+                    config->nameserver_count++;
+                }
+            } else if (strcmp(key, "search") == 0 || strcmp(key, "domain") == 0) {
+                /* the last one wins */
+                config->search_count = 0;
+                while ((value = cat_dns_config_next_token(&cursor)) != NULL) {
+                    cat_dns_resolver_config_add_search(config, value);
+                    if (key[0] == 'd') {
+                        break;
+                    }
+                }
+            } else if (strcmp(key, "options") == 0) {
+                while ((value = cat_dns_config_next_token(&cursor)) != NULL) {
+                    if (strncmp(value, "ndots:", CAT_STRLEN("ndots:")) == 0) {
+                        config->ndots = cat_dns_resolver_parse_option_value(value + CAT_STRLEN("ndots:"), 15);
+                    } else if (strncmp(value, "timeout:", CAT_STRLEN("timeout:")) == 0) {
+                        unsigned int timeout = cat_dns_resolver_parse_option_value(value + CAT_STRLEN("timeout:"), 30);
+                        config->timeout = (timeout == 0 ? 1 : timeout) * 1000;
+                    } else if (strncmp(value, "attempts:", CAT_STRLEN("attempts:")) == 0) {
+                        unsigned int attempts = cat_dns_resolver_parse_option_value(value + CAT_STRLEN("attempts:"), 5);
+                        config->attempts = attempts == 0 ? 1 : attempts;
+                    }
+                }
+            }
+        }
+        fclose(file);
+    }
+    if (config->nameserver_count == 0) {
+        (void) cat_dns_resolver_parse_nameserver(&config->nameservers[0], "127.0.0.1", 0);
+        config->nameserver_count = 1;
+    }
+
+    return cat_true;
+}
+
+static cat_bool_t cat_dns_resolver_load_hosts(cat_dns_resolver_config_t *config, const char *path)
+{
+    cat_dns_hosts_entry_t **tail = &config->hosts;
+    char line[1024];
+    FILE *file;
+
+    file = fopen(path, "r");
+    if (file == NULL) {
+        if (errno != ENOENT) {
+            cat_update_last_error_of_syscall("DNS resolver open \"%s\" failed", path);
+            return cat_false;
+        }
+        return cat_true;
+    }
+    while (cat_dns_config_read_line(file, line, sizeof(line))) {
+        char *cursor = line, *ip, *name;
+        unsigned char address[16];
+        int family;
+        ip = cat_dns_config_next_token(&cursor);
+        if (ip == NULL) {
+            continue;
+        }
+        if (uv_inet_pton(AF_INET, ip, address) == 0) {
+            family = AF_INET;
+        } else if (uv_inet_pton(AF_INET6, ip, address) == 0) {
+            family = AF_INET6;
+        } else {
+            continue;
+        }
+        while ((name = cat_dns_config_next_token(&cursor)) != NULL) {
+            size_t name_length = strlen(name);
+            cat_dns_hosts_entry_t *entry = (cat_dns_hosts_entry_t *) cat_malloc(offsetof(cat_dns_hosts_entry_t, name) + name_length + 1);
+            if (unlikely(entry == NULL)) {
+                cat_update_last_error_of_syscall("Malloc for DNS hosts entry failed");
+                fclose(file);
+                return cat_false;
+            }
+            entry->next = NULL;
+            entry->family = family;
+            memcpy(entry->address, address, sizeof(address));
+            memcpy(entry->name, name, name_length + 1);
+            *tail = entry;
+            tail = &entry->next;
+        }
+    }
+    fclose(file);
+
+    return cat_true;
+}
+
+static cat_bool_t cat_dns_resolver_get_config(cat_dns_resolver_config_t **config)
+{
+    if (CAT_DNS_RESOLVER_G(config) == NULL) {
+        if (unlikely(!cat_dns_resolver_load_config(NULL, NULL))) {
+            return cat_false;
+        }
+    }
+    *config = CAT_DNS_RESOLVER_G(config);
+
+    return cat_true;
+}
+
+CAT_API cat_bool_t cat_dns_resolver_is_enabled(void)
+{
+    return CAT_DNS_RESOLVER_G(enabled);
+}
+
+CAT_API cat_bool_t cat_dns_resolver_enable(void)
+{
+    cat_dns_resolver_config_t *config;
+
+    if (unlikely(!cat_dns_resolver_get_config(&config))) {
+        cat_update_last_error_with_previous("DNS resolver enable failed");
+        return cat_false;
+    }
+    if (!CAT_DNS_RESOLVER_G(enabled)) {
+        CAT_DNS_RESOLVER_G(enabled) = cat_true;
+        cat_dns_cache_flush();
+    }
+
+    return cat_true;
+}
+
+CAT_API void cat_dns_resolver_disable(void)
+{
+    if (CAT_DNS_RESOLVER_G(enabled)) {
+        CAT_DNS_RESOLVER_G(enabled) = cat_false;
+        cat_dns_cache_flush();
+    }
+}
+
+CAT_API cat_bool_t cat_dns_resolver_load_config(const char *resolv_conf_path, const char *hosts_path)
+{
+    cat_dns_resolver_config_t *config = CAT_DNS_RESOLVER_G(config);
+    cat_dns_resolver_config_t new_config;
+
+    cat_dns_resolver_config_init(&new_config);
+    if (unlikely(!cat_dns_resolver_load_resolv_conf(&new_config, resolv_conf_path != NULL ? resolv_conf_path : CAT_DNS_RESOLV_CONF_PATH))) {
+        return cat_false;
+    }
+    if (unlikely(!cat_dns_resolver_load_hosts(&new_config, hosts_path != NULL ? hosts_path : CAT_DNS_HOSTS_PATH))) {
+        cat_dns_resolver_config_free_hosts(&new_config);
+        return cat_false;
+    }
+    if (config == NULL) {
+        config = (cat_dns_resolver_config_t *) cat_malloc(sizeof(*config));
+        if (unlikely(config == NULL)) {
+            cat_update_last_error_of_syscall("Malloc for DNS resolver config failed");
+            cat_dns_resolver_config_free_hosts(&new_config);
+            return cat_false;
+        }
+        CAT_DNS_RESOLVER_G(config) = config;
+    } else {
+        /* lookups never hold hosts entries across yields */
+        cat_dns_resolver_config_free_hosts(config);
+    }
+    *config = new_config;
+    cat_dns_cache_flush();
+
+    return cat_true;
+}
+
+CAT_API cat_bool_t cat_dns_resolver_clear_nameservers(void)
+{
+    cat_dns_resolver_config_t *config;
+
+    if (unlikely(!cat_dns_resolver_get_config(&config))) {
+        return cat_false;
+    }
+    config->nameserver_count = 0;
+    cat_dns_cache_flush();
+
+    return cat_true;
+}
+
+CAT_API cat_bool_t cat_dns_resolver_add_nameserver(const char *ip, int port)
+{
+    cat_dns_resolver_config_t *config;
+
+    if (unlikely(!cat_dns_resolver_get_config(&config))) {
+        return cat_false;
+    }
+    if (unlikely(config->nameserver_count == CAT_DNS_RESOLVER_MAX_NAMESERVERS)) {
+        cat_update_last_error(CAT_ENOSPC, "DNS resolver can not have more than %u nameservers", CAT_DNS_RESOLVER_MAX_NAMESERVERS);
+        return cat_false;
+    }
+    if (unlikely(!cat_dns_resolver_parse_nameserver(&config->nameservers[config->nameserver_count], ip, port))) {
+        cat_update_last_error(CAT_EINVAL, "DNS resolver nameserver \"%s\" is not a valid IP address", ip);
+        return cat_false;
+    }
+    config->nameserver_count++;
+    cat_dns_cache_flush();
+
+    return cat_true;
+}
+
+CAT_API void cat_dns_resolver_get_stats(cat_dns_resolver_stats_t *stats)
+{
+    *stats = CAT_DNS_RESOLVER_G(stats);
+}
+
+CAT_API void cat_dns_resolver_reset_stats(void)
+{
+    memset(&CAT_DNS_RESOLVER_G(stats), 0, sizeof(CAT_DNS_RESOLVER_G(stats)));
+}
+
+static uint16_t cat_dns_resolver_generate_id(void)
+{
+    /* xorshift32 */
+    uint32_t x = CAT_DNS_RESOLVER_G(seed);
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    CAT_DNS_RESOLVER_G(seed) = x;
+
+    return (uint16_t) (x >> 16);
+}
+
+/* returns 0 if name is invalid */
+static size_t cat_dns_query_build(unsigned char *packet, uint16_t id, const char *name, uint16_t type)
+{
+    unsigned char *p = packet + CAT_DNS_HEADER_SIZE;
+    const char *label = name;
+
+    memset(packet, 0, CAT_DNS_HEADER_SIZE);
+    packet[0] = (unsigned char) (id >> 8);
+    packet[1] = (unsigned char) id;
+    packet[2] = 0x01; /* RD */
+    packet[5] = 1; /* QDCOUNT */
+    while (*label != '\0') {
+        const char *dot = strchr(label, '.');
+        size_t length = dot != NULL ? (size_t) (dot - label) : strlen(label);
+        if (length == 0 || length > 63 ||
+            (size_t) (p - packet - CAT_DNS_HEADER_SIZE) + 1 + length + 1 > CAT_DNS_MAX_NAME_SIZE - 1) {
+            return 0;
+        }
+        *p++ = (unsigned char) length;
+        memcpy(p, label, length);
+        p += length;
+        if (dot == NULL) {
+            break;
+        }
+        label = dot + 1;
+    }
+    *p++ = 0;
+    *p++ = (unsigned char) (type >> 8);
+    *p++ = (unsigned char) type;
+    *p++ = 0;
+    *p++ = CAT_DNS_CLASS_IN;
+
+    return p - packet;
+}
+
+/* returns offset after the name or 0 if it is malformed, name can be NULL */
+static size_t cat_dns_packet_read_name(const unsigned char *packet, size_t length, size_t offset, char *name)
+{
+    size_t next = 0, name_length = 0;
+    unsigned int jumps = 0;
+
+    while (1) {
+        unsigned int label_length;
+        if (unlikely(offset >= length)) {
+            return 0;
+        }
+        label_length = packet[offset];
+        if ((label_length & 0xc0) == 0xc0) {
+            /* compression pointer */
+            if (unlikely(offset + 1 >= length || ++jumps > CAT_DNS_MAX_COMPRESSION_JUMPS)) {
+                return 0;
+            }
+            if (next == 0) {
+                next = offset + 2;
+            }
+            offset = ((label_length & 0x3f) << 8) | packet[offset + 1];
+            continue;
+        }
+        if (unlikely((label_length & 0xc0) != 0)) {
+            return 0;
+        }
+        offset++;
+        if (label_length == 0) {
+            break;
+        }
+        if (unlikely(offset + label_length > length)) {
+            return 0;
+        }
+        if (name_length != 0) {
+            if (name != NULL) {
+                name[name_length] = '.';
+            }
+            name_length++;
+        }
+        if (unlikely(name_length + label_length >= CAT_DNS_MAX_NAME_SIZE)) {
+            return 0;
+        }
+        if (name != NULL) {
+            memcpy(name + name_length, packet + offset, label_length);
+        }
+        name_length += label_length;
+        offset += label_length;
+    }
+    if (name != NULL) {
+        name[name_length] = '\0';
+    }
+
+    return next != 0 ? next : offset;
+}
+
+typedef struct
+{
+    char name[CAT_DNS_MAX_NAME_SIZE];
+    uint16_t type;
+    uint16_t klass;
+    uint32_t ttl;
+    size_t rdata;
+    uint16_t rdlength;
+} cat_dns_record_t;
+
+static size_t cat_dns_packet_read_record(const unsigned char *packet, size_t length, size_t offset, cat_dns_record_t *record)
+{
+    const unsigned char *p;
+
+    offset = cat_dns_packet_read_name(packet, length, offset, record->name);
+    if (unlikely(offset == 0 || offset + 10 > length)) {
+        return 0;
+    }
+    p = packet + offset;
+    record->type = (uint16_t) ((p[0] << 8) | p[1]);
+    record->klass = (uint16_t) ((p[2] << 8) | p[3]);
+    record->ttl = ((uint32_t) p[4] << 24) | ((uint32_t) p[5] << 16) | ((uint32_t) p[6] << 8) | (uint32_t) p[7];
+    record->rdlength = (uint16_t) ((p[8] << 8) | p[9]);
+    record->rdata = offset + 10;
+    if (unlikely(record->rdata + record->rdlength > length)) {
+        return 0;
+    }
+
+    return record->rdata + record->rdlength;
+}
+
+/* returns cat_false if packet is malformed or it is not the response of the question */
+static cat_bool_t cat_dns_response_parse(const unsigned char *packet, size_t length, const char *name, cat_dns_question_t *question)
+{
+    char qname[CAT_DNS_MAX_NAME_SIZE];
+    cat_dns_record_t record;
+    size_t offset, answers_offset, n;
+    unsigned int ancount, i;
+    size_t address_length = question->type == CAT_DNS_TYPE_A ? 4 : 16;
+
+    if (unlikely(length < CAT_DNS_HEADER_SIZE)) {
+        return cat_false;
+    }
+    if (((packet[0] << 8) | packet[1]) != question->id) {
+        return cat_false;
+    }
+    /* QR must be set and OPCODE must be QUERY */
+    if (unlikely((packet[2] & 0x80) == 0 || (packet[2] & 0x78) != 0)) {
+        return cat_false;
+    }
+    if (unlikely(((packet[4] << 8) | packet[5]) != 1)) {
+        return cat_false;
+    }
+    offset = cat_dns_packet_read_name(packet, length, CAT_DNS_HEADER_SIZE, qname);
+    if (unlikely(offset == 0 || offset + 4 > length)) {
+        return cat_false;
+    }
+    if (strcasecmp(qname, name) != 0 ||
+        ((packet[offset] << 8) | packet[offset + 1]) != question->type ||
+        ((packet[offset + 2] << 8) | packet[offset + 3]) != CAT_DNS_CLASS_IN) {
+        return cat_false;
+    }
+    answers_offset = offset + 4;
+    question->truncated = (packet[2] & 0x02) != 0;
+    question->rcode = packet[3] & 0x0f;
+    question->ttl = UINT32_MAX;
+    question->count = 0;
+    strcpy(question->canonname, name);
+    if (question->truncated || question->rcode != CAT_DNS_RCODE_NOERROR) {
+        return cat_true;
+    }
+    ancount = (packet[6] << 8) | packet[7];
+
+    /* follow the CNAME chain */
+    for (n = 0; n < CAT_DNS_MAX_CNAME_CHAIN; n++) {
+        cat_bool_t found = cat_false;
+        offset = answers_offset;
+        for (i = 0; i < ancount; i++) {
+            offset = cat_dns_packet_read_record(packet, length, offset, &record);
+            if (unlikely(offset == 0)) {
+                return cat_false;
+            }
+            if (record.type == CAT_DNS_TYPE_CNAME && record.klass == CAT_DNS_CLASS_IN &&
+                strcasecmp(record.name, question->canonname) == 0) {
+                if (unlikely(cat_dns_packet_read_name(packet, length, record.rdata, question->canonname) == 0)) {
+                    return cat_false;
+                }
+                question->ttl = MIN(question->ttl, record.ttl);
+                found = cat_true;
+                break;
+            }
+        }
+        if (!found) {
+            break;
+        }
+    }
+
+    offset = answers_offset;
+    for (i = 0; i < ancount; i++) {
+        offset = cat_dns_packet_read_record(packet, length, offset, &record);
+        if (unlikely(offset == 0)) {
+            return cat_false;
+        }
+        if (record.type != question->type || record.klass != CAT_DNS_CLASS_IN ||
+            record.rdlength != address_length || strcasecmp(record.name, question->canonname) != 0) {
+            continue;
+        }
+        if (question->count < CAT_DNS_MAX_ADDRESSES) {
+            memcpy(question->addresses[question->count++], packet + record.rdata, address_length);
+            question->ttl = MIN(question->ttl, record.ttl);
+        }
+    }
+
+    return cat_true;
+}
+
+static cat_socket_type_t cat_dns_resolver_get_socket_type(const cat_sockaddr_inet_info_t *nameserver, cat_bool_t stream)
+{
+    if (nameserver->address.common.sa_family == AF_INET6) {
+        return stream ? CAT_SOCKET_TYPE_TCP6 : CAT_SOCKET_TYPE_UDP6;
+    }
+    return stream ? CAT_SOCKET_TYPE_TCP4 : CAT_SOCKET_TYPE_UDP4;
+}
+
+/* returns 0 if all of questions have been answered, otherwise error code */
+static int cat_dns_resolver_query_udp(const cat_sockaddr_inet_info_t *nameserver, const char *name, cat_dns_question_t *questions, size_t count, cat_timeout_t timeout)
+{
+    unsigned char packet[CAT_DNS_UDP_BUFFER_SIZE];
+    cat_socket_t socket;
+    size_t n, unanswered = count;
+    int error = 0;
+
+    if (unlikely(cat_socket_create(&socket, cat_dns_resolver_get_socket_type(nameserver, cat_false)) == NULL)) {
+        return cat_get_last_error_code();
+    }
+    if (unlikely(!cat_socket_connect_to(&socket, &nameserver->address.common, nameserver->length))) {
+        error = cat_get_last_error_code();
+        goto _out;
+    }
+    for (n = 0; n < count; n++) {
+        size_t length;
+        questions[n].id = cat_dns_resolver_generate_id();
+        questions[n].answered = cat_false;
+        length = cat_dns_query_build(packet, questions[n].id, name, questions[n].type);
+        CAT_ASSERT(length != 0);
+        if (unlikely(!cat_socket_send_ex(&socket, (const char *) packet, length, timeout))) {
+            error = cat_get_last_error_code();
+            goto _out;
+        }
+        CAT_DNS_RESOLVER_G(stats.queries)++;
+    }
+    while (unanswered > 0) {
+        ssize_t nread;
+        CAT_TIME_WAIT_START() {
+            nread = cat_socket_recv_ex(&socket, (char *) packet, sizeof(packet), timeout);
+        } CAT_TIME_WAIT_END(timeout);
+        if (unlikely(nread < 0)) {
+            error = cat_get_last_error_code();
+            if (error == CAT_ETIMEDOUT) {
+                CAT_DNS_RESOLVER_G(stats.timeouts)++;
+            }
+            goto _out;
+        }
+        /* packets which do not match any question are ignored */
+        for (n = 0; n < count; n++) {
+            if (!questions[n].answered && cat_dns_response_parse(packet, nread, name, &questions[n])) {
+                questions[n].answered = cat_true;
+                unanswered--;
+                break;
+            }
+        }
+    }
+
+    _out:
+    cat_socket_close(&socket);
+    return error;
+}
+
+static int cat_dns_resolver_query_tcp(const cat_sockaddr_inet_info_t *nameserver, const char *name, cat_dns_question_t *question, cat_timeout_t timeout)
+{
+    unsigned char query[2 + CAT_DNS_MAX_QUERY_SIZE];
+    unsigned char *packet = NULL;
+    cat_socket_t socket;
+    size_t length;
+    ssize_t nread;
+    int error = 0;
+
+    if (unlikely(cat_socket_create(&socket, cat_dns_resolver_get_socket_type(nameserver, cat_true)) == NULL)) {
+        return cat_get_last_error_code();
+    }
+    CAT_TIME_WAIT_START() {
+        if (unlikely(!cat_socket_connect_to_ex(&socket, &nameserver->address.common, nameserver->length, timeout))) {
+            error = cat_get_last_error_code();
+        }
+    } CAT_TIME_WAIT_END(timeout);
+    if (unlikely(error != 0)) {
+        goto _out;
+    }
+    question->id = cat_dns_resolver_generate_id();
+    question->answered = cat_false;
+    length = cat_dns_query_build(query + 2, question->id, name, question->type);
+    query[0] = (unsigned char) (length >> 8);
+    query[1] = (unsigned char) length;
+    CAT_TIME_WAIT_START() {
+        if (unlikely(!cat_socket_send_ex(&socket, (const char *) query, length + 2, timeout))) {
+            error = cat_get_last_error_code();
+        }
+    } CAT_TIME_WAIT_END(timeout);
+    if (unlikely(error != 0)) {
+        goto _out;
+    }
+    CAT_DNS_RESOLVER_G(stats.queries)++;
+    CAT_DNS_RESOLVER_G(stats.tcp_queries)++;
+    CAT_TIME_WAIT_START() {
+        nread = cat_socket_read_ex(&socket, (char *) query, 2, timeout);
+    } CAT_TIME_WAIT_END(timeout);
+    if (unlikely(nread != 2)) {
+        error = nread < 0 ? cat_get_last_error_code() : CAT_ECONNRESET;
+        goto _out;
+    }
+    length = (query[0] << 8) | query[1];
+    packet = (unsigned char *) cat_malloc(length == 0 ? 1 : length);
+    if (unlikely(packet == NULL)) {
+        error = cat_translate_sys_error(cat_sys_errno);
+        goto _out;
+    }
+    CAT_TIME_WAIT_START() {
+        nread = cat_socket_read_ex(&socket, (char *) packet, length, timeout);
+    } CAT_TIME_WAIT_END(timeout);
+    if (unlikely(nread != (ssize_t) length)) {
+        error = nread < 0 ? cat_get_last_error_code() : CAT_ECONNRESET;
+        goto _out;
+    }
+    if (unlikely(!cat_dns_response_parse(packet, length, name, question) || question->truncated)) {
+        error = CAT_EPROTO;
+        goto _out;
+    }
+    question->answered = cat_true;
+
+    _out:
+    if (packet != NULL) {
+        cat_free(packet);
+    }
+    if (error == CAT_ETIMEDOUT) {
+        CAT_DNS_RESOLVER_G(stats.timeouts)++;
+    }
+    cat_socket_close(&socket);
+    return error;
+}
+
+/* returns 0 if we got the definitive answers (see rcode of questions),
+ * returns ECANCELED if it was canceled or there is no time left */
+static int cat_dns_resolver_query(const cat_dns_resolver_config_t *config, const char *name, cat_dns_question_t *questions, size_t count, cat_timeout_t *timeout)
+{
+    unsigned int attempt;
+    size_t i, n;
+    int error = CAT_EAI_AGAIN;
 
-    if (likely(context->request.coroutine != NULL)) {
-        context->status = status;
-        context->response = response;
-        if (unlikely(!cat_coroutine_resume(context->request.coroutine, NULL, NULL))) {
-            cat_core_error_with_last(DNS, "DNS resolver schedule failed");
+    for (attempt = 0; attempt < config->attempts; attempt++) {
+        /* config may be changed during the query, so we always check the count */
+        for (i = 0; i < config->nameserver_count; i++) {
+            cat_sockaddr_inet_info_t nameserver = config->nameservers[i];
+            cat_timeout_t query_timeout;
+            if (*timeout == 0) {
+                return CAT_ECANCELED;
+            }
+            query_timeout = (*timeout < 0 || config->timeout < *timeout) ? config->timeout : *timeout;
+            CAT_TIME_WAIT_START() {
+                error = cat_dns_resolver_query_udp(&nameserver, name, questions, count, query_timeout);
+                for (n = 0; error == 0 && n < count; n++) {
+                    if (questions[n].truncated) {
+                        error = cat_dns_resolver_query_tcp(&nameserver, name, &questions[n], query_timeout);
+                    }
+                }
+            } CAT_TIME_WAIT_END(*timeout);
+            if (error == CAT_ECANCELED) {
+                return CAT_ECANCELED;
+            }
+            if (error != 0) {
+                /* timed out or the server is unreachable, try the next one */
+                continue;
+            }
+            for (n = 0; n < count; n++) {
+                if (questions[n].rcode != CAT_DNS_RCODE_NOERROR && questions[n].rcode != CAT_DNS_RCODE_NXDOMAIN) {
+                    /* SERVFAIL, REFUSED and so on, try the next one */
+                    error = CAT_EAI_AGAIN;
+                    break;
+                }
+            }
+            if (error == 0) {
+                return 0;
+            }
         }
-    } else if (response != NULL) {
-        uv_freeaddrinfo(response);
     }
 
-    cat_free(context);
+    return error;
 }
 
-CAT_API struct addrinfo *cat_dns_getaddrinfo(const char *hostname, const char *service, const struct addrinfo *hints)
+static size_t cat_dns_resolver_get_candidates(const cat_dns_resolver_config_t *config, const char *hostname, char (*candidates)[CAT_DNS_MAX_NAME_SIZE])
 {
-    return cat_dns_getaddrinfo_ex(hostname, service, hints, cat_socket_get_global_dns_timeout());
+    size_t length = strlen(hostname), count = 0, dots = 0, i;
+    cat_bool_t as_is_first;
+
+    for (i = 0; i < length; i++) {
+        dots += hostname[i] == '.';
+    }
+    if (hostname[length - 1] == '.') {
+        /* absolute name */
+        memcpy(candidates[0], hostname, length - 1);
+        candidates[0][length - 1] = '\0';
+        return 1;
+    }
+    as_is_first = dots >= config->ndots;
+    if (as_is_first) {
+        memcpy(candidates[count++], hostname, length + 1);
+    }
+    for (i = 0; i < config->search_count; i++) {
+        size_t domain_length = strlen(config->search[i]);
+        if (length + 1 + domain_length >= CAT_DNS_MAX_NAME_SIZE) {
+            continue;
+        }
+        memcpy(candidates[count], hostname, length);
+        candidates[count][length] = '.';
+        memcpy(candidates[count] + length + 1, config->search[i], domain_length + 1);
+        count++;
+    }
+    if (!as_is_first) {
+        memcpy(candidates[count++], hostname, length + 1);
+    }
+
+    return count;
 }
 
-CAT_API struct addrinfo *cat_dns_getaddrinfo_ex(const char *hostname, const char *service, const struct addrinfo *hints, cat_timeout_t timeout)
+static cat_bool_t cat_dns_resolver_check(const char *hostname, const char *service, const struct addrinfo *hints, int *port)
 {
-    cat_getaddrinfo_context_t *context = (cat_getaddrinfo_context_t *) cat_malloc(sizeof(*context));
-    cat_bool_t ret;
+    if (!CAT_DNS_RESOLVER_G(enabled) || hostname == NULL || hostname[0] == '\0') {
+        return cat_false;
+    }
+    if (hints != NULL) {
+        if (hints->ai_family != AF_UNSPEC && hints->ai_family != AF_INET && hints->ai_family != AF_INET6) {
+            return cat_false;
+        }
+        if (hints->ai_socktype != 0 && hints->ai_socktype != SOCK_STREAM &&
+            hints->ai_socktype != SOCK_DGRAM && hints->ai_socktype != SOCK_RAW) {
+            return cat_false;
+        }
+        /* AI_V4MAPPED, AI_ALL and so on are not supported */
+        if ((hints->ai_flags & ~(AI_PASSIVE | AI_CANONNAME | AI_NUMERICHOST | AI_NUMERICSERV | AI_ADDRCONFIG)) != 0) {
+            return cat_false;
+        }
+    }
+    /* only numeric services are supported */
+    *port = 0;
+    if (service != NULL) {
+        const char *p = service;
+        long n = 0;
+        if (*p == '\0') {
+            return cat_false;
+        }
+        for (; *p != '\0'; p++) {
+            if (*p < '0' || *p > '9' || (n = n * 10 + (*p - '0')) > 65535) {
+                return cat_false;
+            }
+        }
+        *port = (int) n;
+    }
+
+    return cat_true;
+}
+
+static struct addrinfo *cat_dns_resolver_build_addrinfo(const cat_dns_address_t *addresses, size_t count, int port, const struct addrinfo *hints, const char *canonname)
+{
+    struct { int socktype; int protocol; } types[3];
+    struct addrinfo *head = NULL, **next = &head;
+    size_t type_count = 0, canonname_size = 0, i, j;
+    int socktype = hints != NULL ? hints->ai_socktype : 0;
+    int protocol = hints != NULL ? hints->ai_protocol : 0;
+
+    if (socktype == 0 && protocol == IPPROTO_TCP) {
+        socktype = SOCK_STREAM;
+    } else if (socktype == 0 && protocol == IPPROTO_UDP) {
+        socktype = SOCK_DGRAM;
+    }
+    if (socktype == 0 || socktype == SOCK_STREAM) {
+        types[type_count].socktype = SOCK_STREAM;
+        types[type_count++].protocol = IPPROTO_TCP;
+    }
+    if (socktype == 0 || socktype == SOCK_DGRAM) {
+        types[type_count].socktype = SOCK_DGRAM;
+        types[type_count++].protocol = IPPROTO_UDP;
+    }
+    if ((socktype == 0 && port == 0) || socktype == SOCK_RAW) {
+        types[type_count].socktype = SOCK_RAW;
+        types[type_count++].protocol = protocol;
+    }
+    if (hints != NULL && (hints->ai_flags & AI_CANONNAME)) {
+        canonname_size = strlen(canonname) + 1;
+    }
+    for (i = 0; i < count; i++) {
+        socklen_t address_length = addresses[i].family == AF_INET ? sizeof(struct sockaddr_in) : sizeof(struct sockaddr_in6);
+        for (j = 0; j < type_count; j++) {
+            struct addrinfo *ai = (struct addrinfo *) cat_malloc(sizeof(*ai) + address_length + canonname_size);
+            if (unlikely(ai == NULL)) {
+                cat_update_last_error_of_syscall("Malloc for DNS addrinfo failed");
+                cat_dns_freeaddrinfo(head);
+                return NULL;
+            }
+            memset(ai, 0, sizeof(*ai) + address_length);
+            ai->ai_family = addresses[i].family;
+            ai->ai_socktype = types[j].socktype;
+            ai->ai_protocol = types[j].protocol;
+            ai->ai_addrlen = address_length;
+            ai->ai_addr = (struct sockaddr *) (ai + 1);
+            if (addresses[i].family == AF_INET) {
+                struct sockaddr_in *in = (struct sockaddr_in *) ai->ai_addr;
+                in->sin_family = AF_INET;
+                in->sin_port = htons((uint16_t) port);
+                memcpy(&in->sin_addr, addresses[i].address, 4);
+            } else {
+                struct sockaddr_in6 *in6 = (struct sockaddr_in6 *) ai->ai_addr;
+                in6->sin6_family = AF_INET6;
+                in6->sin6_port = htons((uint16_t) port);
+                memcpy(&in6->sin6_addr, addresses[i].address, 16);
+            }
+            if (canonname_size != 0) {
+                /* only the first one has canonname */
+                ai->ai_canonname = ((char *) ai->ai_addr) + address_length;
+                memcpy(ai->ai_canonname, canonname, canonname_size);
+                canonname_size = 0;
+            }
+            *next = ai;
+            next = &ai->ai_next;
+        }
+    }
+
+    return head;
+}
+
+static struct addrinfo *cat_dns_resolver_getaddrinfo(const char *hostname, int port, const struct addrinfo *hints, cat_timeout_t timeout, int *status, cat_msec_t *ttl)
+{
+    char name[CAT_DNS_MAX_NAME_SIZE];
+    char candidates[CAT_DNS_RESOLVER_MAX_SEARCH_DOMAINS + 1][CAT_DNS_MAX_NAME_SIZE];
+    cat_dns_question_t questions[2];
+    cat_dns_address_t addresses[CAT_DNS_MAX_ADDRESSES * 2];
+    cat_dns_resolver_config_t *config;
+    const char *canonname = name;
+    size_t name_length = strlen(hostname), candidate_count, question_count = 0, count = 0, i, n;
+    int family = hints != NULL ? hints->ai_family : AF_UNSPEC;
+    cat_bool_t temporary = cat_false;
+    const cat_dns_hosts_entry_t *entry;
+    struct addrinfo *response;
     int error;
 
+    *status = CAT_ECANCELED;
+    if (unlikely(!cat_dns_resolver_get_config(&config))) {
+        cat_update_last_error_with_previous("DNS resolver get config failed");
+        return NULL;
+    }
+
+    /* numeric host */
+    if (uv_inet_pton(AF_INET, hostname, addresses[0].address) == 0) {
+        addresses[0].family = AF_INET;
+        count = 1;
+    } else if (uv_inet_pton(AF_INET6, hostname, addresses[0].address) == 0) {
+        addresses[0].family = AF_INET6;
+        count = 1;
+    }
+    if (count != 0) {
+        if (family != AF_UNSPEC && family != addresses[0].family) {
+            *status = CAT_EAI_ADDRFAMILY;
+            goto _error;
+        }
+        canonname = hostname;
+        goto _build;
+    }
+    if (hints != NULL && (hints->ai_flags & AI_NUMERICHOST)) {
+        *status = CAT_EAI_NONAME;
+        goto _error;
+    }
+    if (unlikely(name_length >= CAT_DNS_MAX_NAME_SIZE)) {
+        *status = CAT_EAI_NONAME;
+        goto _error;
+    }
+    memcpy(name, hostname, name_length + 1);
+    if (name[name_length - 1] == '.') {
+        name[name_length - 1] = '\0';
+    }
+
+    /* hosts */
+    for (entry = config->hosts; entry != NULL && count < CAT_DNS_MAX_ADDRESSES; entry = entry->next) {
+        if ((family == AF_UNSPEC || family == entry->family) && strcasecmp(entry->name, name) == 0) {
+            addresses[count].family = entry->family;
+            memcpy(addresses[count].address, entry->address, sizeof(entry->address));
+            count++;
+        }
+    }
+    if (count != 0) {
+        CAT_DNS_RESOLVER_G(stats.hosts_hits)++;
+        goto _build;
+    }
+
+    /* DNS */
+    if (family == AF_UNSPEC || family == AF_INET) {
+        questions[question_count++].type = CAT_DNS_TYPE_A;
+    }
+    if (family == AF_UNSPEC || family == AF_INET6) {
+        questions[question_count++].type = CAT_DNS_TYPE_AAAA;
+    }
+    candidate_count = cat_dns_resolver_get_candidates(config, hostname, candidates);
+    for (i = 0; i < candidate_count; i++) {
+        unsigned char packet[CAT_DNS_MAX_QUERY_SIZE];
+        if (cat_dns_query_build(packet, 0, candidates[i], CAT_DNS_TYPE_A) == 0) {
+            /* invalid name (e.g. empty label) */
+            continue;
+        }
+        error = cat_dns_resolver_query(config, candidates[i], questions, question_count, &timeout);
+        if (error == CAT_ECANCELED) {
+            if (timeout == 0) {
+                cat_update_last_error(CAT_ETIMEDOUT, "DNS resolver timed out");
+            } else {
+                cat_update_last_error(CAT_ECANCELED, "DNS resolver has been canceled");
+            }
+            return NULL;
+        }
+        if (error != 0) {
+            temporary = cat_true;
+            continue;
+        }
+        /* A first */
+        for (n = 0; n < question_count; n++) {
+            size_t j;
+            for (j = 0; j < questions[n].count; j++) {
+                addresses[count].family = questions[n].type == CAT_DNS_TYPE_A ? AF_INET : AF_INET6;
+                memcpy(addresses[count].address, questions[n].addresses[j], questions[n].type == CAT_DNS_TYPE_A ? 4 : 16);
+                count++;
+            }
+            if (questions[n].count != 0) {
+                if (canonname == name) {
+                    canonname = questions[n].canonname;
+                }
+                *ttl = MIN(*ttl, (cat_msec_t) questions[n].ttl * 1000);
+            }
+        }
+        if (count != 0) {
+            goto _build;
+        }
+    }
+    *status = temporary ? CAT_EAI_AGAIN : CAT_EAI_NONAME;
+
+    _error:
+    cat_update_last_error_with_reason(*status, "DNS getaddrinfo failed");
+    return NULL;
+
+    _build:
+    response = cat_dns_resolver_build_addrinfo(addresses, count, port, hints, canonname);
+    if (unlikely(response == NULL)) {
+        return NULL;
+    }
+    *status = 0;
+
+    return response;
+}
+
+CAT_API cat_bool_t cat_dns_runtime_init(void)
+{
+    CAT_DNS_CACHE_G(size) = CAT_DNS_CACHE_DEFAULT_SIZE;
+    CAT_DNS_CACHE_G(ttl) = CAT_DNS_CACHE_DEFAULT_TTL;
+    CAT_DNS_CACHE_G(negative_ttl) = CAT_DNS_CACHE_DEFAULT_NEGATIVE_TTL;
+    CAT_DNS_CACHE_G(buckets) = NULL;
+    CAT_DNS_CACHE_G(bucket_count) = 0;
+    CAT_DNS_CACHE_G(count) = 0;
+    cat_queue_init(&CAT_DNS_CACHE_G(lru));
+    memset(&CAT_DNS_CACHE_G(stats), 0, sizeof(CAT_DNS_CACHE_G(stats)));
+
+    CAT_DNS_RESOLVER_G(enabled) = cat_false;
+    CAT_DNS_RESOLVER_G(config) = NULL;
+    if (uv_random(NULL, NULL, &CAT_DNS_RESOLVER_G(seed), sizeof(CAT_DNS_RESOLVER_G(seed)), 0, NULL) != 0 ||
+        CAT_DNS_RESOLVER_G(seed) == 0) {
+        CAT_DNS_RESOLVER_G(seed) = (uint32_t) uv_hrtime() | 1;
+    }
+    memset(&CAT_DNS_RESOLVER_G(stats), 0, sizeof(CAT_DNS_RESOLVER_G(stats)));
+
+    return cat_true;
+}
+
+CAT_API cat_bool_t cat_dns_runtime_shutdown(void)
+{
+    cat_dns_resolver_config_t *config = CAT_DNS_RESOLVER_G(config);
+
+    if (config != NULL) {
+        cat_dns_resolver_config_free_hosts(config);
+        cat_free(config);
+        CAT_DNS_RESOLVER_G(config) = NULL;
+    }
+    cat_dns_cache_flush();
+    if (CAT_DNS_CACHE_G(buckets) != NULL) {
+        cat_free(CAT_DNS_CACHE_G(buckets));
+        CAT_DNS_CACHE_G(buckets) = NULL;
+        CAT_DNS_CACHE_G(bucket_count) = 0;
+    }
+
+    return cat_true;
+}
+
+/* status would be ECANCELED if resolution was not completed (e.g. timed out),
+ * ttl would be lowered if we know the TTL of records */
+static struct addrinfo *cat_dns_resolve(const char *hostname, const char *service, const struct addrinfo *hints, cat_timeout_t timeout, int *status, cat_msec_t *ttl)
+{
+    cat_getaddrinfo_context_t *context;
+    struct addrinfo *response;
+    cat_bool_t ret;
+    int error, port;
+
+    if (cat_dns_resolver_check(hostname, service, hints, &port)) {
+        return cat_dns_resolver_getaddrinfo(hostname, port, hints, timeout, status, ttl);
+    }
+    *status = CAT_ECANCELED;
+    context = (cat_getaddrinfo_context_t *) cat_malloc(sizeof(*context));
     if (unlikely(context == NULL)) {
         cat_update_last_error_of_syscall("Malloc for DNS getaddrinfo context failed");
         return NULL;
@@ -72,6 +1245,7 @@ CAT_API struct addrinfo *cat_dns_getaddrinfo_ex(const char *hostname, const char
     }
     context->status = CAT_ECANCELED;
     context->request.coroutine = CAT_COROUTINE_G(current);
+    cat_coroutine_set_wait_type(CAT_COROUTINE_WAIT_TYPE_IO);
     ret = cat_time_wait(timeout);
     context->request.coroutine = NULL;
     if (unlikely(!ret)) {
@@ -84,17 +1258,420 @@ CAT_API struct addrinfo *cat_dns_getaddrinfo_ex(const char *hostname, const char
             cat_update_last_error(CAT_ECANCELED, "DNS getaddrinfo has been canceled");
             (void) uv_cancel(&context->request.req);
         } else {
+            *status = context->status;
             cat_update_last_error_with_reason(context->status, "DNS getaddrinfo failed");
         }
         return NULL;
     }
+    /* context has been released in callback */
+    response = cat_dns_addrinfo_dup(context->response);
+    uv_freeaddrinfo(context->response);
+    if (unlikely(response == NULL)) {
+        return NULL;
+    }
+    *status = 0;
+
+    return response;
+}
+
+/* cache */
+
+static uint32_t cat_dns_cache_hash(const char *hostname, const char *service, const struct addrinfo *hints)
+{
+    /* FNV-1a */
+    uint32_t hash = 2166136261u;
+    const unsigned char *p;
+
+    for (p = (const unsigned char *) hostname; *p != '\0'; p++) {
+        hash = (hash ^ *p) * 16777619u;
+    }
+    if (service != NULL) {
+        for (p = (const unsigned char *) service; *p != '\0'; p++) {
+            hash = (hash ^ *p) * 16777619u;
+        }
+    }
+    if (hints != NULL) {
+        hash = (hash ^ (uint32_t) hints->ai_family) * 16777619u;
+        hash = (hash ^ (uint32_t) hints->ai_socktype) * 16777619u;
+        hash = (hash ^ (uint32_t) hints->ai_protocol) * 16777619u;
+        hash = (hash ^ (uint32_t) hints->ai_flags) * 16777619u;
+    }
+
+    return hash;
+}
+
+static cat_bool_t cat_dns_cache_entry_match(const cat_dns_cache_entry_t *entry, uint32_t hash, const char *hostname, const char *service, const struct addrinfo *hints)
+{
+    if (entry->hash != hash) {
+        return cat_false;
+    }
+    if (hints != NULL) {
+        if (entry->family != hints->ai_family || entry->socktype != hints->ai_socktype ||
+            entry->protocol != hints->ai_protocol || entry->flags != hints->ai_flags) {
+            return cat_false;
+        }
+    } else if (entry->family != AF_UNSPEC || entry->socktype != 0 || entry->protocol != 0 || entry->flags != 0) {
+        return cat_false;
+    }
+    if ((entry->service == NULL) != (service == NULL)) {
+        return cat_false;
+    }
+    if (service != NULL && strcmp(entry->service, service) != 0) {
+        return cat_false;
+    }
+
+    return strcmp(entry->hostname, hostname) == 0;
+}
+
+static cat_dns_cache_entry_t *cat_dns_cache_find(uint32_t hash, const char *hostname, const char *service, const struct addrinfo *hints)
+{
+    cat_dns_cache_entry_t *entry;
+
+    if (CAT_DNS_CACHE_G(buckets) == NULL) {
+        return NULL;
+    }
+    for (entry = CAT_DNS_CACHE_G(buckets)[hash & (CAT_DNS_CACHE_G(bucket_count) - 1)]; entry != NULL; entry = entry->next) {
+        if (cat_dns_cache_entry_match(entry, hash, hostname, service, hints)) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+static void cat_dns_cache_unlink(cat_dns_cache_entry_t *entry)
+{
+    cat_dns_cache_entry_t **p = &CAT_DNS_CACHE_G(buckets)[entry->hash & (CAT_DNS_CACHE_G(bucket_count) - 1)];
+
+    while (*p != entry) {
+        p = &(*p)->next;
+    }
+    *p = entry->next;
+    CAT_DNS_CACHE_G(count)--;
+}
+
+static void cat_dns_cache_entry_free(cat_dns_cache_entry_t *entry)
+{
+    CAT_ASSERT(!entry->resolving);
+    cat_dns_cache_unlink(entry);
+    cat_queue_remove(&entry->node);
+    if (entry->response != NULL) {
+        cat_dns_freeaddrinfo(entry->response);
+    }
+    cat_free(entry);
+}
+
+static cat_bool_t cat_dns_cache_rehash(size_t bucket_count)
+{
+    cat_dns_cache_entry_t **buckets, **old_buckets = CAT_DNS_CACHE_G(buckets);
+    size_t old_bucket_count = CAT_DNS_CACHE_G(bucket_count), n;
+
+    buckets = (cat_dns_cache_entry_t **) cat_malloc(sizeof(*buckets) * bucket_count);
+    if (unlikely(buckets == NULL)) {
+        cat_update_last_error_of_syscall("Malloc for DNS cache buckets failed");
+        return cat_false;
+    }
+    memset(buckets, 0, sizeof(*buckets) * bucket_count);
+    for (n = 0; n < old_bucket_count; n++) {
+        cat_dns_cache_entry_t *entry = old_buckets[n], *next;
+        for (; entry != NULL; entry = next) {
+            next = entry->next;
+            entry->next = buckets[entry->hash & (bucket_count - 1)];
+            buckets[entry->hash & (bucket_count - 1)] = entry;
+        }
+    }
+    if (old_buckets != NULL) {
+        cat_free(old_buckets);
+    }
+    CAT_DNS_CACHE_G(buckets) = buckets;
+    CAT_DNS_CACHE_G(bucket_count) = bucket_count;
+
+    return cat_true;
+}
+
+static size_t cat_dns_cache_get_bucket_count_for(size_t size)
+{
+    size_t bucket_count = CAT_DNS_CACHE_MIN_BUCKET_COUNT;
+
+    while (bucket_count < size) {
+        bucket_count <<= 1;
+    }
+
+    return bucket_count;
+}
+
+/* evict resolved entries (in-flight ones are not in LRU) */
+static void cat_dns_cache_evict(size_t max_count)
+{
+    cat_dns_cache_entry_t *entry;
+
+    while (CAT_DNS_CACHE_G(count) > max_count &&
+           (entry = cat_queue_back_data(&CAT_DNS_CACHE_G(lru), cat_dns_cache_entry_t, node)) != NULL) {
+        cat_dns_cache_entry_free(entry);
+        CAT_DNS_CACHE_G(stats.evictions)++;
+    }
+}
+
+static cat_dns_cache_entry_t *cat_dns_cache_add(uint32_t hash, const char *hostname, const char *service, const struct addrinfo *hints)
+{
+    size_t hostname_length = strlen(hostname);
+    size_t service_size = service != NULL ? strlen(service) + 1 : 0;
+    cat_dns_cache_entry_t *entry;
+    cat_dns_cache_entry_t **bucket;
+
+    if (unlikely(CAT_DNS_CACHE_G(buckets) == NULL)) {
+        if (unlikely(!cat_dns_cache_rehash(cat_dns_cache_get_bucket_count_for(CAT_DNS_CACHE_G(size))))) {
+            return NULL;
+        }
+    }
+    cat_dns_cache_evict(CAT_DNS_CACHE_G(size) - 1);
+    entry = (cat_dns_cache_entry_t *) cat_malloc(sizeof(*entry) + hostname_length + service_size);
+    if (unlikely(entry == NULL)) {
+        cat_update_last_error_of_syscall("Malloc for DNS cache entry failed");
+        return NULL;
+    }
+    entry->hash = hash;
+    cat_queue_init(&entry->node);
+    if (hints != NULL) {
+        entry->family = hints->ai_family;
+        entry->socktype = hints->ai_socktype;
+        entry->protocol = hints->ai_protocol;
+        entry->flags = hints->ai_flags;
+    } else {
+        entry->family = AF_UNSPEC;
+        entry->socktype = 0;
+        entry->protocol = 0;
+        entry->flags = 0;
+    }
+    memcpy(entry->hostname, hostname, hostname_length + 1);
+    if (service != NULL) {
+        entry->service = entry->hostname + hostname_length + 1;
+        memcpy(entry->service, service, service_size);
+    } else {
+        entry->service = NULL;
+    }
+    entry->resolving = cat_true;
+    entry->error = 0;
+    entry->response = NULL;
+    entry->expire = 0;
+    cat_queue_init(&entry->waiters);
+    bucket = &CAT_DNS_CACHE_G(buckets)[hash & (CAT_DNS_CACHE_G(bucket_count) - 1)];
+    entry->next = *bucket;
+    *bucket = entry;
+    CAT_DNS_CACHE_G(count)++;
+
+    return entry;
+}
+
+static cat_always_inline cat_bool_t cat_dns_cache_status_is_cacheable(int status)
+{
+    /* temporary failures or incomplete resolutions should not be cached */
+    return status != CAT_ECANCELED && status != CAT_EAI_AGAIN && status != CAT_EAI_MEMORY && status != CAT_EAI_CANCELED;
+}
+
+static struct addrinfo *cat_dns_cache_resolve(cat_dns_cache_entry_t *entry, const char *hostname, const char *service, const struct addrinfo *hints, cat_timeout_t timeout)
+{
+    struct addrinfo *response;
+    cat_queue_t waiters;
+    cat_dns_cache_waiter_t *waiter;
+    cat_msec_t ttl = CAT_DNS_CACHE_G(ttl);
+    int status;
+
+    response = cat_dns_resolve(hostname, service, hints, timeout, &status, &ttl);
+
+    /* take over waiters, they will not touch the entry anymore after being woken up */
+    cat_queue_init(&waiters);
+    while ((waiter = cat_queue_front_data(&entry->waiters, cat_dns_cache_waiter_t, node)) != NULL) {
+        cat_queue_remove(&waiter->node);
+        cat_queue_push_back(&waiters, &waiter->node);
+    }
+
+    entry->resolving = cat_false;
+    if (cat_dns_cache_status_is_cacheable(status)) {
+        entry->error = status;
+        if (status == 0) {
+            entry->response = cat_dns_addrinfo_dup(response);
+        }
+        entry->expire = cat_time_msec_cached() + (status == 0 ? ttl : CAT_DNS_CACHE_G(negative_ttl));
+        if (status == 0 && unlikely(entry->response == NULL)) {
+            /* OOM, just discard it */
+            cat_dns_cache_entry_free(entry);
+        } else {
+            cat_queue_push_front(&CAT_DNS_CACHE_G(lru), &entry->node);
+            cat_dns_cache_evict(CAT_DNS_CACHE_G(size));
+        }
+    } else {
+        cat_dns_cache_entry_free(entry);
+    }
+
+    while ((waiter = cat_queue_front_data(&waiters, cat_dns_cache_waiter_t, node)) != NULL) {
+        cat_queue_remove(&waiter->node);
+        waiter->done = cat_true;
+        if (!cat_dns_cache_status_is_cacheable(status)) {
+            waiter->retry = cat_true;
+        } else if (status != 0) {
+            waiter->error = status;
+        } else {
+            waiter->response = cat_dns_addrinfo_dup(response);
+            if (unlikely(waiter->response == NULL)) {
+                waiter->error = CAT_ENOMEM;
+            }
+        }
+        if (unlikely(!cat_coroutine_resume(waiter->coroutine, NULL, NULL))) {
+            cat_core_error_with_last(DNS, "DNS resolver schedule failed");
+        }
+    }
+
+    return response;
+}
+
+CAT_API struct addrinfo *cat_dns_getaddrinfo(const char *hostname, const char *service, const struct addrinfo *hints)
+{
+    return cat_dns_getaddrinfo_ex(hostname, service, hints, cat_socket_get_global_dns_timeout());
+}
+
+CAT_API struct addrinfo *cat_dns_getaddrinfo_ex(const char *hostname, const char *service, const struct addrinfo *hints, cat_timeout_t timeout)
+{
+    cat_dns_cache_entry_t *entry;
+    cat_msec_t ttl = CAT_DNS_CACHE_G(ttl);
+    uint32_t hash;
+    int status;
+
+    if (hostname == NULL || CAT_DNS_CACHE_G(size) == 0) {
+        return cat_dns_resolve(hostname, service, hints, timeout, &status, &ttl);
+    }
+    hash = cat_dns_cache_hash(hostname, service, hints);
 
-    return context->response;
+    while (1) {
+        entry = cat_dns_cache_find(hash, hostname, service, hints);
+        if (entry == NULL) {
+            CAT_DNS_CACHE_G(stats.misses)++;
+            entry = cat_dns_cache_add(hash, hostname, service, hints);
+            if (unlikely(entry == NULL)) {
+                return cat_dns_resolve(hostname, service, hints, timeout, &status, &ttl);
+            }
+            return cat_dns_cache_resolve(entry, hostname, service, hints, timeout);
+        }
+        if (entry->resolving) {
+            /* coalesce with the in-flight resolution */
+            cat_dns_cache_waiter_t waiter;
+            cat_bool_t ret;
+            waiter.coroutine = CAT_COROUTINE_G(current);
+            waiter.done = cat_false;
+            waiter.retry = cat_false;
+            waiter.error = 0;
+            waiter.response = NULL;
+            cat_queue_push_back(&entry->waiters, &waiter.node);
+            CAT_DNS_CACHE_G(stats.coalesced)++;
+            cat_coroutine_set_wait_type(CAT_COROUTINE_WAIT_TYPE_IO);
+            CAT_TIME_WAIT_START() {
+                ret = cat_time_wait(timeout);
+            } CAT_TIME_WAIT_END(timeout);
+            if (unlikely(!waiter.done)) {
+                cat_queue_remove(&waiter.node);
+                if (!ret) {
+                    cat_update_last_error_with_previous("DNS getaddrinfo wait failed");
+                } else {
+                    cat_update_last_error(CAT_ECANCELED, "DNS getaddrinfo has been canceled");
+                }
+                return NULL;
+            }
+            if (waiter.retry) {
+                continue;
+            }
+            if (unlikely(waiter.response == NULL)) {
+                cat_update_last_error_with_reason(waiter.error, "DNS getaddrinfo failed");
+            }
+            return waiter.response;
+        }
+        if (cat_time_msec_cached() >= entry->expire) {
+            /* expired, resolve it again */
+            CAT_DNS_CACHE_G(stats.misses)++;
+            cat_queue_remove(&entry->node);
+            cat_queue_init(&entry->node);
+            if (entry->response != NULL) {
+                cat_dns_freeaddrinfo(entry->response);
+                entry->response = NULL;
+            }
+            entry->error = 0;
+            entry->resolving = cat_true;
+            return cat_dns_cache_resolve(entry, hostname, service, hints, timeout);
+        }
+        /* hit */
+        cat_queue_remove(&entry->node);
+        cat_queue_push_front(&CAT_DNS_CACHE_G(lru), &entry->node);
+        if (entry->error != 0) {
+            CAT_DNS_CACHE_G(stats.negative_hits)++;
+            cat_update_last_error_with_reason(entry->error, "DNS getaddrinfo failed");
+            return NULL;
+        }
+        CAT_DNS_CACHE_G(stats.hits)++;
+        return cat_dns_addrinfo_dup(entry->response);
+    }
 }
 
 CAT_API void cat_dns_freeaddrinfo(struct addrinfo *response)
 {
-    uv_freeaddrinfo(response);
+    while (response != NULL) {
+        struct addrinfo *next = response->ai_next;
+        cat_free(response);
+        response = next;
+    }
+}
+
+CAT_API size_t cat_dns_cache_get_size(void)
+{
+    return CAT_DNS_CACHE_G(size);
+}
+
+CAT_API void cat_dns_cache_set_size(size_t size)
+{
+    CAT_DNS_CACHE_G(size) = size;
+    cat_dns_cache_evict(size);
+    if (CAT_DNS_CACHE_G(buckets) != NULL && cat_dns_cache_get_bucket_count_for(size) > CAT_DNS_CACHE_G(bucket_count)) {
+        /* keep the current one if failed */
+        (void) cat_dns_cache_rehash(cat_dns_cache_get_bucket_count_for(size));
+    }
+}
+
+CAT_API cat_msec_t cat_dns_cache_get_ttl(void)
+{
+    return CAT_DNS_CACHE_G(ttl);
+}
+
+CAT_API void cat_dns_cache_set_ttl(cat_msec_t ttl)
+{
+    CAT_DNS_CACHE_G(ttl) = ttl;
+}
+
+CAT_API cat_msec_t cat_dns_cache_get_negative_ttl(void)
+{
+    return CAT_DNS_CACHE_G(negative_ttl);
+}
+
+CAT_API void cat_dns_cache_set_negative_ttl(cat_msec_t ttl)
+{
+    CAT_DNS_CACHE_G(negative_ttl) = ttl;
+}
+
+CAT_API size_t cat_dns_cache_get_count(void)
+{
+    return CAT_DNS_CACHE_G(count);
+}
+
+CAT_API void cat_dns_cache_flush(void)
+{
+    cat_dns_cache_evict(0);
+}
+
+CAT_API void cat_dns_cache_get_stats(cat_dns_cache_stats_t *stats)
+{
+    *stats = CAT_DNS_CACHE_G(stats);
+}
+
+CAT_API void cat_dns_cache_reset_stats(void)
+{
+    memset(&CAT_DNS_CACHE_G(stats), 0, sizeof(CAT_DNS_CACHE_G(stats)));
 }
 
 CAT_API cat_bool_t cat_dns_get_ip(char *buffer, size_t buffer_size, const char *name, int af)
@@ -60,6 +60,9 @@ CAT_API cat_bool_t cat_event_module_shutdown(void)
 
 CAT_API cat_bool_t cat_event_runtime_init(void)
 {
+    CAT_EVENT_G(stats_enabled) = cat_false;
+    memset(&CAT_EVENT_G(stats), 0, sizeof(CAT_EVENT_G(stats)));
+
     return cat_true;
 }
 
@@ -112,6 +115,51 @@ CAT_API void cat_event_dead_lock(void)
     }
 }
 
+static cat_always_inline cat_bool_t cat_event_run_once(uv_loop_t *loop)
+{
+    cat_bool_t alive;
+
+    alive = uv_crun(loop);
+
+    /* if we have unfinished tasks, continue to loop  */
+    alive = cat_event_do_defer_tasks() || alive;
+
+    return alive;
+}
+
+static void cat_event_histogram_add(uint64_t *histogram, uint64_t value)
+{
+    size_t i;
+
+    for (i = 0; value != 0 && i < CAT_EVENT_HISTOGRAM_SIZE - 1; i++) {
+        value >>= 1;
+    }
+    histogram[i]++;
+}
+
+static cat_bool_t cat_event_run_once_with_stats(uv_loop_t *loop)
+{
+    cat_event_stats_t *stats = &CAT_EVENT_G(stats);
+    cat_nsec_t start_time = uv_hrtime();
+    cat_nsec_t idle_time = uv_metrics_idle_time(loop);
+    cat_coroutine_round_t round = CAT_COROUTINE_G(round);
+    cat_nsec_t busy_time;
+    cat_bool_t alive;
+
+    alive = cat_event_run_once(loop);
+
+    idle_time = uv_metrics_idle_time(loop) - idle_time;
+    busy_time = (uv_hrtime() - start_time) - idle_time;
+    stats->rounds++;
+    stats->busy_time += busy_time;
+    stats->idle_time += idle_time;
+    cat_event_histogram_add(stats->latency_histogram, busy_time / 1000);
+    /* every resumed coroutine switches in and yields back to scheduler */
+    cat_event_histogram_add(stats->run_queue_histogram, (CAT_COROUTINE_G(round) - round) / 2);
+
+    return alive;
+}
+
 CAT_API void cat_event_schedule(void)
 {
     uv_loop_t *loop = CAT_EVENT_G(loop);
@@ -119,10 +167,11 @@ CAT_API void cat_event_schedule(void)
     while (1) {
         cat_bool_t alive;
 
-        alive = uv_crun(loop);
-
-        /* if we have unfinished tasks, continue to loop  */
-        alive = cat_event_do_defer_tasks() || alive;
+        if (unlikely(CAT_EVENT_G(stats_enabled))) {
+            alive = cat_event_run_once_with_stats(loop);
+        } else {
+            alive = cat_event_run_once(loop);
+        }
 
         if (!alive) {
             break;
@@ -183,3 +232,35 @@ CAT_API cat_bool_t cat_event_wait(void)
 {
     return cat_coroutine_wait();
 }
+
+CAT_API cat_bool_t cat_event_set_stats_enabled(cat_bool_t enabled)
+{
+    if (enabled && !CAT_EVENT_G(stats_enabled)) {
+        /* it can not be disabled once it was configured, but it is cheap */
+        int error = uv_loop_configure(CAT_EVENT_G(loop), UV_METRICS_IDLE_TIME);
+        if (unlikely(error != 0)) {
+            cat_update_last_error_with_reason(error, "Event loop enable idle time metrics failed");
+            return cat_false;
+        }
+    }
+    CAT_EVENT_G(stats_enabled) = enabled;
+
+    return cat_true;
+}
+
+CAT_API cat_bool_t cat_event_is_stats_enabled(void)
+{
+    return CAT_EVENT_G(stats_enabled);
+}
+
+CAT_API cat_event_stats_t *cat_event_get_stats(cat_event_stats_t *stats)
+{
+    memcpy(stats, &CAT_EVENT_G(stats), sizeof(*stats));
+
+    return stats;
+}
+
+CAT_API void cat_event_reset_stats(void)
+{
+    memset(&CAT_EVENT_G(stats), 0, sizeof(CAT_EVENT_G(stats)));
+}
@@ -20,6 +20,7 @@
 #include "cat_coroutine.h"
 #include "cat_event.h"
 #include "cat_time.h"
+#include "cat_io_uring.h"
 
 #include <fcntl.h>
 
@@ -56,6 +57,7 @@ typedef union
         return -1; \
     } \
     context->coroutine = CAT_COROUTINE_G(current); \
+    cat_coroutine_set_wait_type(CAT_COROUTINE_WAIT_TYPE_IO); \
     ret = cat_time_wait(-1); \
     done = context->coroutine == NULL; \
     context->coroutine = NULL; \
@@ -125,14 +127,73 @@ CAT_API ssize_t cat_fs_read(int fd, void *buffer, size_t size)
 {
     uv_buf_t buf = uv_buf_init(buffer, size);
 
-    CAT_FS_DO_RESULT(read, fd, &buf, 1, 0);
+#ifdef CAT_IO_URING
+    if (cat_io_uring_is_enabled()) {
+        ssize_t n = cat_io_uring_read(fd, buffer, size, -1, -1);
+        if (unlikely(n < 0)) {
+            cat_update_last_error_with_reason(n, "File-System read failed");
+            return -1;
+        }
+        return n;
+    }
+#endif
+
+    /* offset -1 means read from the current position (instead of pread(0)) */
+    CAT_FS_DO_RESULT(read, fd, &buf, 1, -1);
 }
 
 CAT_API ssize_t cat_fs_write(int fd, const void *buffer, size_t length)
 {
     uv_buf_t buf = uv_buf_init((char *) buffer, length);
 
-    CAT_FS_DO_RESULT(write, fd, &buf, 1, 0);
+#ifdef CAT_IO_URING
+    if (cat_io_uring_is_enabled()) {
+        ssize_t n = cat_io_uring_write(fd, buffer, length, -1, -1);
+        if (unlikely(n < 0)) {
+            cat_update_last_error_with_reason(n, "File-System write failed");
+            return -1;
+        }
+        return n;
+    }
+#endif
+
+    CAT_FS_DO_RESULT(write, fd, &buf, 1, -1);
+}
+
+CAT_API ssize_t cat_fs_pread(int fd, void *buffer, size_t size, int64_t offset)
+{
+    uv_buf_t buf = uv_buf_init(buffer, size);
+
+#ifdef CAT_IO_URING
+    if (cat_io_uring_is_enabled()) {
+        ssize_t n = cat_io_uring_read(fd, buffer, size, offset, -1);
+        if (unlikely(n < 0)) {
+            cat_update_last_error_with_reason(n, "File-System pread failed");
+            return -1;
+        }
+        return n;
+    }
+#endif
+
+    CAT_FS_DO_RESULT(read, fd, &buf, 1, offset);
+}
+
+CAT_API ssize_t cat_fs_pwrite(int fd, const void *buffer, size_t length, int64_t offset)
+{
+    uv_buf_t buf = uv_buf_init((char *) buffer, length);
+
+#ifdef CAT_IO_URING
+    if (cat_io_uring_is_enabled()) {
+        ssize_t n = cat_io_uring_write(fd, buffer, length, offset, -1);
+        if (unlikely(n < 0)) {
+            cat_update_last_error_with_reason(n, "File-System pwrite failed");
+            return -1;
+        }
+        return n;
+    }
+#endif
+
+    CAT_FS_DO_RESULT(write, fd, &buf, 1, offset);
 }
 
 CAT_API int cat_fs_close(int fd)
@@ -140,6 +201,31 @@ CAT_API int cat_fs_close(int fd)
     CAT_FS_DO_RESULT(close, fd);
 }
 
+CAT_API int cat_fs_fstat(int fd, cat_stat_t *buf)
+{
+    CAT_FS_PREPARE(return -1)
+    CAT_FS_CALL(fstat, fd)
+    CAT_FS_HANDLE_ERROR(fstat);
+    if (unlikely(context->fs.result < 0)) {
+        cat_update_last_error_with_reason(context->fs.result, "File-System fstat failed");
+        return -1;
+    }
+    /* context will be released after we yield, copy it out now */
+    memcpy(buf, &context->fs.statbuf, sizeof(*buf));
+    return 0;
+    } while (0);
+}
+
+CAT_API int cat_fs_fsync(int fd)
+{
+    CAT_FS_DO_RESULT(fsync, fd);
+}
+
+CAT_API int cat_fs_fdatasync(int fd)
+{
+    CAT_FS_DO_RESULT(fdatasync, fd);
+}
+
 CAT_API int cat_fs_access(const char *path, int mode)
 {
     CAT_FS_DO_RESULT(access, path, mode);
@@ -71,7 +71,7 @@ static int cat_http_parser_on_##name(llhttp_t *llhttp) \
     \
 
 #define CAT_HTTP_PARSER_ON_EVENT_END() \
-    if ((parser->events & parser->event) == parser->event) { \
+    if ((parser->events & parser->event) == parser->event && parser->header_table == NULL) { \
         return HPE_PAUSED; \
     } else { \
         return HPE_OK; \
@@ -85,6 +85,11 @@ CAT_HTTP_PARSER_ON_EVENT_END()
 #define CAT_HTTP_PARSER_ON_HDONE(name, NAME) \
 CAT_HTTP_PARSER_ON_EVENT_BEGIN(name, NAME) \
     parser->keep_alive = cat_llhttp_should_keep_alive(llhttp); \
+    if (parser->header_table != NULL) { \
+        /* head mode is over, always pause here */ \
+        parser->header_table = NULL; \
+        return HPE_PAUSED; \
+    } \
 CAT_HTTP_PARSER_ON_EVENT_END()
 
 #define CAT_HTTP_PARSER_ON_DATA_BEGIN(name, NAME) \
@@ -102,16 +107,96 @@ static int cat_http_parser_on_##name(llhttp_t *llhttp, const char *at, size_t le
 CAT_HTTP_PARSER_ON_DATA_BEGIN(name, NAME) \
 CAT_HTTP_PARSER_ON_DATA_END()
 
+/* always pause at the end of message, so that pipelined messages
+ * in the same data will be parsed by the next execution one by one */
 #define CAT_HTTP_PARSER_ON_DONE(name, NAME) \
 CAT_HTTP_PARSER_ON_EVENT_BEGIN(name, NAME) \
-    return HPE_OK; \
+    return HPE_PAUSED; \
+}
+
+static int cat_http_header_table_on_line(cat_http_header_table_t *table, const char *at, size_t length)
+{
+    if (table->line_length == 0) {
+        table->line_offset = (uint32_t) (at - table->base);
+    }
+    table->line_length += (uint32_t) length;
+
+    return HPE_OK;
+}
+
+static int cat_http_header_table_on_field(cat_http_header_table_t *table, const char *at, size_t length)
+{
+    cat_http_header_t *header;
+    uint32_t offset = (uint32_t) (at - table->base);
+
+    if (table->count > 0) {
+        header = &table->headers[table->count - 1];
+        if (header->value_length == 0 && header->name_offset + header->name_length == offset) {
+            /* continuation of the name */
+            header->name_length += (uint32_t) length;
+            return HPE_OK;
+        }
+    }
+    if (unlikely(table->count == table->size)) {
+        uint32_t size = table->size == 0 ? 16 : table->size * 2;
+        cat_http_header_t *headers = (cat_http_header_t *) cat_realloc(table->headers, sizeof(*headers) * size);
+        if (unlikely(headers == NULL)) {
+            cat_update_last_error_of_syscall("Realloc for HTTP header table failed");
+            return -1;
+        }
+        table->headers = headers;
+        table->size = size;
+    }
+    header = &table->headers[table->count++];
+    header->name_offset = offset;
+    header->name_length = (uint32_t) length;
+    header->value_offset = 0;
+    header->value_length = 0;
+    header->hash = 0;
+    header->id = CAT_HTTP_HEADER_UNKNOWN;
+
+    return HPE_OK;
+}
+
+static int cat_http_header_table_on_value(cat_http_header_table_t *table, const char *at, size_t length)
+{
+    cat_http_header_t *header = &table->headers[table->count - 1];
+
+    if (header->value_length == 0) {
+        header->value_offset = (uint32_t) (at - table->base);
+    }
+    header->value_length += (uint32_t) length;
+
+    return HPE_OK;
+}
+
+static void cat_http_header_table_on_complete(cat_http_header_table_t *table)
+{
+    uint32_t n;
+
+    for (n = 0; n < table->count; n++) {
+        cat_http_header_t *header = &table->headers[n];
+        const char *name = table->base + header->name_offset;
+        header->hash = cat_http_header_hash(name, header->name_length);
+        header->id = cat_http_header_get_id(name, header->name_length);
+        if (header->id != CAT_HTTP_HEADER_UNKNOWN && table->known[header->id] == 0) {
+            table->known[header->id] = n + 1;
+        }
+    }
 }
 
+#define CAT_HTTP_PARSER_ON_HEAD_DATA(name, NAME, handler) \
+CAT_HTTP_PARSER_ON_DATA_BEGIN(name, NAME) \
+    if (parser->header_table != NULL) { \
+        return handler(parser->header_table, at, length); \
+    } \
+CAT_HTTP_PARSER_ON_DATA_END()
+
 CAT_HTTP_PASRER_ON_EVENT(message_begin,    MESSAGE_BEGIN   )
-CAT_HTTP_PARSER_ON_DATA (url,              URL             )
-CAT_HTTP_PARSER_ON_DATA (status,           STATUS          )
-CAT_HTTP_PARSER_ON_DATA (header_field,     HEADER_FIELD    )
-CAT_HTTP_PARSER_ON_DATA (header_value,     HEADER_VALUE    )
+CAT_HTTP_PARSER_ON_HEAD_DATA(url,          URL,          cat_http_header_table_on_line)
+CAT_HTTP_PARSER_ON_HEAD_DATA(status,       STATUS,       cat_http_header_table_on_line)
+CAT_HTTP_PARSER_ON_HEAD_DATA(header_field, HEADER_FIELD, cat_http_header_table_on_field)
+CAT_HTTP_PARSER_ON_HEAD_DATA(header_value, HEADER_VALUE, cat_http_header_table_on_value)
 CAT_HTTP_PARSER_ON_HDONE(headers_complete, HEADERS_COMPLETE)
 CAT_HTTP_PARSER_ON_DATA (body,             BODY            )
 CAT_HTTP_PASRER_ON_EVENT(chunk_header,     CHUNK_HEADER    )
@@ -138,6 +223,7 @@ static cat_always_inline void cat_http_parser__init(cat_http_parser_t *parser, u
     parser->data = NULL;
     parser->data_length = 0;
     parser->keep_alive = cat_false;
+    parser->header_table = NULL;
 }
 
 CAT_API void cat_http_parser_init(cat_http_parser_t *parser)
@@ -207,6 +293,31 @@ CAT_API cat_bool_t cat_http_parser_execute(cat_http_parser_t *parser, const char
     return cat_true;
 }
 
+CAT_API cat_bool_t cat_http_parser_execute_head(cat_http_parser_t *parser, cat_http_header_table_t *table, const char *data, size_t length)
+{
+    cat_bool_t ret;
+
+    cat_http_header_table_clear(table);
+    table->base = data;
+    parser->header_table = table;
+    ret = cat_http_parser_execute(parser, data, length);
+    if (unlikely(!ret)) {
+        parser->header_table = NULL;
+        return cat_false;
+    }
+    if (parser->event != CAT_HTTP_PARSER_EVENT_HEADERS_COMPLETE) {
+        /* incomplete, parse it from the beginning next time */
+        cat_http_parser_reset(parser);
+        parser->event = CAT_HTTP_PARSER_EVENT_NONE;
+        cat_http_header_table_clear(table);
+        return cat_true;
+    }
+    table->head_length = cat_http_parser_get_parsed_length(parser, data);
+    cat_http_header_table_on_complete(table);
+
+    return cat_true;
+}
+
 CAT_API const char *cat_http_parser_event_name(cat_http_parser_event_t event)
 {
     switch (event) {
@@ -249,7 +360,7 @@ CAT_API cat_bool_t cat_http_parser_finish(cat_http_parser_t *parser)
     llhttp_errno_t error;
 
     error = llhttp_finish(&parser->llhttp);
-    if (unlikely(error != 0)) {
+    if (unlikely(error != 0 && error != HPE_PAUSED)) {
         cat_update_last_error(error, "HTTP-Parser finish failed: %s", llhttp_errno_name(error));
         return cat_false;
     }
@@ -345,3 +456,126 @@ CAT_API cat_bool_t cat_http_parser_is_upgrade(const cat_http_parser_t *parser)
 {
     return !!parser->llhttp.upgrade;
 }
+
+/* header table */
+
+static cat_always_inline char cat_http_header_tolower(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (c | 0x20) : c;
+}
+
+CAT_API uint32_t cat_http_header_hash(const char *name, size_t length)
+{
+    /* FNV-1a of the lower-case name */
+    uint32_t hash = 2166136261u;
+    size_t n;
+
+    for (n = 0; n < length; n++) {
+        hash ^= (uint8_t) cat_http_header_tolower(name[n]);
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+CAT_API cat_http_header_id_t cat_http_header_get_id(const char *name, size_t length)
+{
+#define CAT_HTTP_HEADER_ID_MATCH_GEN(id, string) \
+    if (length == CAT_STRLEN(string) && strncasecmp(name, string, CAT_STRLEN(string)) == 0) { \
+        return CAT_HTTP_HEADER_##id; \
+    }
+    CAT_HTTP_HEADER_MAP(CAT_HTTP_HEADER_ID_MATCH_GEN)
+#undef CAT_HTTP_HEADER_ID_MATCH_GEN
+
+    return CAT_HTTP_HEADER_UNKNOWN;
+}
+
+CAT_API const char *cat_http_header_get_name(cat_http_header_id_t id)
+{
+    switch (id) {
+#define CAT_HTTP_HEADER_NAME_GEN(id, string) case CAT_HTTP_HEADER_##id: return string;
+    CAT_HTTP_HEADER_MAP(CAT_HTTP_HEADER_NAME_GEN)
+#undef CAT_HTTP_HEADER_NAME_GEN
+        default:
+            break;
+    }
+    return NULL;
+}
+
+CAT_API void cat_http_header_table_init(cat_http_header_table_t *table)
+{
+    table->headers = NULL;
+    table->size = 0;
+    cat_http_header_table_clear(table);
+}
+
+CAT_API void cat_http_header_table_clear(cat_http_header_table_t *table)
+{
+    table->count = 0;
+    table->line_offset = 0;
+    table->line_length = 0;
+    table->head_length = 0;
+    table->base = NULL;
+    memset(table->known, 0, sizeof(table->known));
+}
+
+CAT_API void cat_http_header_table_close(cat_http_header_table_t *table)
+{
+    if (table->headers != NULL) {
+        cat_free(table->headers);
+    }
+    cat_http_header_table_init(table);
+}
+
+static cat_always_inline cat_bool_t cat_http_header_match(const cat_http_header_t *header, const char *head, const char *name, size_t length, uint32_t hash)
+{
+    return header->hash == hash && header->name_length == length &&
+           strncasecmp(head + header->name_offset, name, length) == 0;
+}
+
+CAT_API const cat_http_header_t *cat_http_header_table_find(const cat_http_header_table_t *table, const char *head, const char *name, size_t length)
+{
+    cat_http_header_id_t id = cat_http_header_get_id(name, length);
+    uint32_t hash, n;
+
+    if (id != CAT_HTTP_HEADER_UNKNOWN) {
+        return cat_http_header_table_find_by_id(table, id);
+    }
+    hash = cat_http_header_hash(name, length);
+    for (n = 0; n < table->count; n++) {
+        const cat_http_header_t *header = &table->headers[n];
+        if (cat_http_header_match(header, head, name, length, hash)) {
+            return header;
+        }
+    }
+
+    return NULL;
+}
+
+CAT_API const cat_http_header_t *cat_http_header_table_find_by_id(const cat_http_header_table_t *table, cat_http_header_id_t id)
+{
+    uint32_t index;
+
+    if (unlikely(id <= CAT_HTTP_HEADER_UNKNOWN || id >= CAT_HTTP_HEADER_ID_COUNT)) {
+        return NULL;
+    }
+    index = table->known[id];
+
+    return index != 0 ? &table->headers[index - 1] : NULL;
+}
+
+CAT_API const cat_http_header_t *cat_http_header_table_find_next(const cat_http_header_table_t *table, const char *head, const cat_http_header_t *header)
+{
+    const cat_http_header_t *end = table->headers + table->count;
+    const char *name = head + header->name_offset;
+    size_t length = header->name_length;
+    uint32_t hash = header->hash;
+
+    while (++header < end) {
+        if (cat_http_header_match(header, head, name, length, hash)) {
+            return header;
+        }
+    }
+
+    return NULL;
+}
@@ -0,0 +1,850 @@
+/*
+  +--------------------------------------------------------------------------+
+  | libcat                                                                   |
+  +--------------------------------------------------------------------------+
+  | Licensed under the Apache License, Version 2.0 (the "License");          |
+  | you may not use this file except in compliance with the License.         |
+  | You may obtain a copy of the License at                                  |
+  | http://www.apache.org/licenses/LICENSE-2.0                               |
+  | Unless required by applicable law or agreed to in writing, software      |
+  | distributed under the License is distributed on an "AS IS" BASIS,        |
+  | WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. |
+  | See the License for the specific language governing permissions and      |
+  | limitations under the License. See accompanying LICENSE file.            |
+  +--------------------------------------------------------------------------+
+  | Author: Twosee <twosee@php.net>                                          |
+  +--------------------------------------------------------------------------+
+ */
+
+#include "cat_http2.h"
+
+CAT_API const char *cat_http2_frame_type_name(uint8_t type)
+{
+    switch (type) {
+#define CAT_HTTP2_FRAME_TYPE_NAME_GEN(name, value) case value: return #name;
+        CAT_HTTP2_FRAME_TYPE_MAP(CAT_HTTP2_FRAME_TYPE_NAME_GEN)
+#undef CAT_HTTP2_FRAME_TYPE_NAME_GEN
+    }
+    return "UNKNOWN";
+}
+
+CAT_API const char *cat_http2_error_code_name(uint32_t code)
+{
+    switch (code) {
+#define CAT_HTTP2_ERROR_CODE_NAME_GEN(name, value, unused) case value: return #name;
+        CAT_HTTP2_ERROR_CODE_MAP(CAT_HTTP2_ERROR_CODE_NAME_GEN)
+#undef CAT_HTTP2_ERROR_CODE_NAME_GEN
+    }
+    return "UNKNOWN";
+}
+
+CAT_API const char *cat_http2_error_code_get_description(uint32_t code)
+{
+    switch (code) {
+#define CAT_HTTP2_ERROR_CODE_DESCRIPTION_GEN(name, value, description) case value: return description;
+        CAT_HTTP2_ERROR_CODE_MAP(CAT_HTTP2_ERROR_CODE_DESCRIPTION_GEN)
+#undef CAT_HTTP2_ERROR_CODE_DESCRIPTION_GEN
+    }
+    return "Unknown error";
+}
+
+CAT_API void cat_http2_frame_header_pack(const cat_http2_frame_header_t *header, char *buffer)
+{
+    unsigned char *p = (unsigned char *) buffer;
+
+    p[0] = (unsigned char) (header->length >> 16);
+    p[1] = (unsigned char) (header->length >> 8);
+    p[2] = (unsigned char) header->length;
+    p[3] = header->type;
+    p[4] = header->flags;
+    p[5] = (unsigned char) ((header->stream_id >> 24) & 0x7f);
+    p[6] = (unsigned char) (header->stream_id >> 16);
+    p[7] = (unsigned char) (header->stream_id >> 8);
+    p[8] = (unsigned char) header->stream_id;
+}
+
+CAT_API void cat_http2_frame_header_unpack(cat_http2_frame_header_t *header, const char *buffer)
+{
+    const unsigned char *p = (const unsigned char *) buffer;
+
+    header->length = ((uint32_t) p[0] << 16) | ((uint32_t) p[1] << 8) | p[2];
+    header->type = p[3];
+    header->flags = p[4];
+    header->stream_id = (((uint32_t) p[5] & 0x7f) << 24) | ((uint32_t) p[6] << 16) | ((uint32_t) p[7] << 8) | p[8];
+}
+
+/* HPACK */
+
+typedef struct {
+    const char *name;
+    uint8_t name_length;
+    const char *value;
+    uint8_t value_length;
+} cat_hpack_static_entry_t;
+
+#define CAT_HPACK_STATIC_ENTRY(name, value) { name, sizeof(name) - 1, value, sizeof(value) - 1 }
+
+static const cat_hpack_static_entry_t cat_hpack_static_table[CAT_HPACK_STATIC_TABLE_COUNT] = {
+    CAT_HPACK_STATIC_ENTRY(":authority", ""),
+    CAT_HPACK_STATIC_ENTRY(":method", "GET"),
+    CAT_HPACK_STATIC_ENTRY(":method", "POST"),
+    CAT_HPACK_STATIC_ENTRY(":path", "/"),
+    CAT_HPACK_STATIC_ENTRY(":path", "/index.html"),
+    CAT_HPACK_STATIC_ENTRY(":scheme", "http"),
+    CAT_HPACK_STATIC_ENTRY(":scheme", "https"),
+    CAT_HPACK_STATIC_ENTRY(":status", "200"),
+    CAT_HPACK_STATIC_ENTRY(":status", "204"),
+    CAT_HPACK_STATIC_ENTRY(":status", "206"),
+    CAT_HPACK_STATIC_ENTRY(":status", "304"),
+    CAT_HPACK_STATIC_ENTRY(":status", "400"),
+    CAT_HPACK_STATIC_ENTRY(":status", "404"),
+    CAT_HPACK_STATIC_ENTRY(":status", "500"),
+    CAT_HPACK_STATIC_ENTRY("accept-charset", ""),
+    CAT_HPACK_STATIC_ENTRY("accept-encoding", "gzip, deflate"),
+    CAT_HPACK_STATIC_ENTRY("accept-language", ""),
+    CAT_HPACK_STATIC_ENTRY("accept-ranges", ""),
+    CAT_HPACK_STATIC_ENTRY("accept", ""),
+    CAT_HPACK_STATIC_ENTRY("access-control-allow-origin", ""),
+    CAT_HPACK_STATIC_ENTRY("age", ""),
+    CAT_HPACK_STATIC_ENTRY("allow", ""),
+    CAT_HPACK_STATIC_ENTRY("authorization", ""),
+    CAT_HPACK_STATIC_ENTRY("cache-control", ""),
+    CAT_HPACK_STATIC_ENTRY("content-disposition", ""),
+    CAT_HPACK_STATIC_ENTRY("content-encoding", ""),
+    CAT_HPACK_STATIC_ENTRY("content-language", ""),
+    CAT_HPACK_STATIC_ENTRY("content-length", ""),
+    CAT_HPACK_STATIC_ENTRY("content-location", ""),
+    CAT_HPACK_STATIC_ENTRY("content-range", ""),
+    CAT_HPACK_STATIC_ENTRY("content-type", ""),
+    CAT_HPACK_STATIC_ENTRY("cookie", ""),
+    CAT_HPACK_STATIC_ENTRY("date", ""),
+    CAT_HPACK_STATIC_ENTRY("etag", ""),
+    CAT_HPACK_STATIC_ENTRY("expect", ""),
+    CAT_HPACK_STATIC_ENTRY("expires", ""),
+    CAT_HPACK_STATIC_ENTRY("from", ""),
+    CAT_HPACK_STATIC_ENTRY("host", ""),
+    CAT_HPACK_STATIC_ENTRY("if-match", ""),
+    CAT_HPACK_STATIC_ENTRY("if-modified-since", ""),
+    CAT_HPACK_STATIC_ENTRY("if-none-match", ""),
+    CAT_HPACK_STATIC_ENTRY("if-range", ""),
+    CAT_HPACK_STATIC_ENTRY("if-unmodified-since", ""),
+    CAT_HPACK_STATIC_ENTRY("last-modified", ""),
+    CAT_HPACK_STATIC_ENTRY("link", ""),
+    CAT_HPACK_STATIC_ENTRY("location", ""),
+    CAT_HPACK_STATIC_ENTRY("max-forwards", ""),
+    CAT_HPACK_STATIC_ENTRY("proxy-authenticate", ""),
+    CAT_HPACK_STATIC_ENTRY("proxy-authorization", ""),
+    CAT_HPACK_STATIC_ENTRY("range", ""),
+    CAT_HPACK_STATIC_ENTRY("referer", ""),
+    CAT_HPACK_STATIC_ENTRY("refresh", ""),
+    CAT_HPACK_STATIC_ENTRY("retry-after", ""),
+    CAT_HPACK_STATIC_ENTRY("server", ""),
+    CAT_HPACK_STATIC_ENTRY("set-cookie", ""),
+    CAT_HPACK_STATIC_ENTRY("strict-transport-security", ""),
+    CAT_HPACK_STATIC_ENTRY("transfer-encoding", ""),
+    CAT_HPACK_STATIC_ENTRY("user-agent", ""),
+    CAT_HPACK_STATIC_ENTRY("vary", ""),
+    CAT_HPACK_STATIC_ENTRY("via", ""),
+    CAT_HPACK_STATIC_ENTRY("www-authenticate", ""),
+};
+
+#undef CAT_HPACK_STATIC_ENTRY
+
+/* Huffman code (RFC 7541 Appendix B), the last one is EOS */
+
+static const uint32_t cat_hpack_huffman_codes[257] = {
+    0x00001ff8, 0x007fffd8, 0x0fffffe2, 0x0fffffe3, 0x0fffffe4, 0x0fffffe5, 0x0fffffe6, 0x0fffffe7,
+    0x0fffffe8, 0x00ffffea, 0x3ffffffc, 0x0fffffe9, 0x0fffffea, 0x3ffffffd, 0x0fffffeb, 0x0fffffec,
+    0x0fffffed, 0x0fffffee, 0x0fffffef, 0x0ffffff0, 0x0ffffff1, 0x0ffffff2, 0x3ffffffe, 0x0ffffff3,
+    0x0ffffff4, 0x0ffffff5, 0x0ffffff6, 0x0ffffff7, 0x0ffffff8, 0x0ffffff9, 0x0ffffffa, 0x0ffffffb,
+    0x00000014, 0x000003f8, 0x000003f9, 0x00000ffa, 0x00001ff9, 0x00000015, 0x000000f8, 0x000007fa,
+    0x000003fa, 0x000003fb, 0x000000f9, 0x000007fb, 0x000000fa, 0x00000016, 0x00000017, 0x00000018,
+    0x00000000, 0x00000001, 0x00000002, 0x00000019, 0x0000001a, 0x0000001b, 0x0000001c, 0x0000001d,
+    0x0000001e, 0x0000001f, 0x0000005c, 0x000000fb, 0x00007ffc, 0x00000020, 0x00000ffb, 0x000003fc,
+    0x00001ffa, 0x00000021, 0x0000005d, 0x0000005e, 0x0000005f, 0x00000060, 0x00000061, 0x00000062,
+    0x00000063, 0x00000064, 0x00000065, 0x00000066, 0x00000067, 0x00000068, 0x00000069, 0x0000006a,
+    0x0000006b, 0x0000006c, 0x0000006d, 0x0000006e, 0x0000006f, 0x00000070, 0x00000071, 0x00000072,
+    0x000000fc, 0x00000073, 0x000000fd, 0x00001ffb, 0x0007fff0, 0x00001ffc, 0x00003ffc, 0x00000022,
+    0x00007ffd, 0x00000003, 0x00000023, 0x00000004, 0x00000024, 0x00000005, 0x00000025, 0x00000026,
+    0x00000027, 0x00000006, 0x00000074, 0x00000075, 0x00000028, 0x00000029, 0x0000002a, 0x00000007,
+    0x0000002b, 0x00000076, 0x0000002c, 0x00000008, 0x00000009, 0x0000002d, 0x00000077, 0x00000078,
+    0x00000079, 0x0000007a, 0x0000007b, 0x00007ffe, 0x000007fc, 0x00003ffd, 0x00001ffd, 0x0ffffffc,
+    0x000fffe6, 0x003fffd2, 0x000fffe7, 0x000fffe8, 0x003fffd3, 0x003fffd4, 0x003fffd5, 0x007fffd9,
+    0x003fffd6, 0x007fffda, 0x007fffdb, 0x007fffdc, 0x007fffdd, 0x007fffde, 0x00ffffeb, 0x007fffdf,
+    0x00ffffec, 0x00ffffed, 0x003fffd7, 0x007fffe0, 0x00ffffee, 0x007fffe1, 0x007fffe2, 0x007fffe3,
+    0x007fffe4, 0x001fffdc, 0x003fffd8, 0x007fffe5, 0x003fffd9, 0x007fffe6, 0x007fffe7, 0x00ffffef,
+    0x003fffda, 0x001fffdd, 0x000fffe9, 0x003fffdb, 0x003fffdc, 0x007fffe8, 0x007fffe9, 0x001fffde,
+    0x007fffea, 0x003fffdd, 0x003fffde, 0x00fffff0, 0x001fffdf, 0x003fffdf, 0x007fffeb, 0x007fffec,
+    0x001fffe0, 0x001fffe1, 0x003fffe0, 0x001fffe2, 0x007fffed, 0x003fffe1, 0x007fffee, 0x007fffef,
+    0x000fffea, 0x003fffe2, 0x003fffe3, 0x003fffe4, 0x007ffff0, 0x003fffe5, 0x003fffe6, 0x007ffff1,
+    0x03ffffe0, 0x03ffffe1, 0x000fffeb, 0x0007fff1, 0x003fffe7, 0x007ffff2, 0x003fffe8, 0x01ffffec,
+    0x03ffffe2, 0x03ffffe3, 0x03ffffe4, 0x07ffffde, 0x07ffffdf, 0x03ffffe5, 0x00fffff1, 0x01ffffed,
+    0x0007fff2, 0x001fffe3, 0x03ffffe6, 0x07ffffe0, 0x07ffffe1, 0x03ffffe7, 0x07ffffe2, 0x00fffff2,
+    0x001fffe4, 0x001fffe5, 0x03ffffe8, 0x03ffffe9, 0x0ffffffd, 0x07ffffe3, 0x07ffffe4, 0x07ffffe5,
+    0x000fffec, 0x00fffff3, 0x000fffed, 0x001fffe6, 0x003fffe9, 0x001fffe7, 0x001fffe8, 0x007ffff3,
+    0x003fffea, 0x003fffeb, 0x01ffffee, 0x01ffffef, 0x00fffff4, 0x00fffff5, 0x03ffffea, 0x007ffff4,
+    0x03ffffeb, 0x07ffffe6, 0x03ffffec, 0x03ffffed, 0x07ffffe7, 0x07ffffe8, 0x07ffffe9, 0x07ffffea,
+    0x07ffffeb, 0x0ffffffe, 0x07ffffec, 0x07ffffed, 0x07ffffee, 0x07ffffef, 0x07fffff0, 0x03ffffee,
+    0x3fffffff,
+};
+
+static const uint8_t cat_hpack_huffman_lengths[257] = {
+    13, 23, 28, 28, 28, 28, 28, 28, 28, 24, 30, 28, 28, 30, 28, 28,
+    28, 28, 28, 28, 28, 28, 30, 28, 28, 28, 28, 28, 28, 28, 28, 28,
+     6, 10, 10, 12, 13,  6,  8, 11, 10, 10,  8, 11,  8,  6,  6,  6,
+     5,  5,  5,  6,  6,  6,  6,  6,  6,  6,  7,  8, 15,  6, 12, 10,
+    13,  6,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,
+     7,  7,  7,  7,  7,  7,  7,  7,  8,  7,  8, 13, 19, 13, 14,  6,
+    15,  5,  6,  5,  6,  5,  6,  6,  6,  5,  7,  7,  6,  6,  6,  5,
+     6,  7,  6,  5,  5,  6,  7,  7,  7,  7,  7, 15, 11, 14, 13, 28,
+    20, 22, 20, 20, 22, 22, 22, 23, 22, 23, 23, 23, 23, 23, 24, 23,
+    24, 24, 22, 23, 24, 23, 23, 23, 23, 21, 22, 23, 22, 23, 23, 24,
+    22, 21, 20, 22, 22, 23, 23, 21, 23, 22, 22, 24, 21, 22, 23, 23,
+    21, 21, 22, 21, 23, 22, 23, 23, 20, 22, 22, 22, 23, 22, 22, 23,
+    26, 26, 20, 19, 22, 23, 22, 25, 26, 26, 26, 27, 27, 26, 24, 25,
+    19, 21, 26, 27, 27, 26, 27, 24, 21, 21, 26, 26, 28, 27, 27, 27,
+    20, 24, 20, 21, 22, 21, 21, 23, 22, 22, 25, 25, 24, 24, 26, 23,
+    26, 27, 26, 26, 27, 27, 27, 27, 27, 28, 27, 27, 27, 27, 27, 26,
+    30,
+};
+
+/* symbols sorted by their codes (the code is canonical) */
+static const uint16_t cat_hpack_huffman_symbols[257] = {
+     48,  49,  50,  97,  99, 101, 105, 111, 115, 116,  32,  37,  45,  46,  47,  51,
+     52,  53,  54,  55,  56,  57,  61,  65,  95,  98, 100, 102, 103, 104, 108, 109,
+    110, 112, 114, 117,  58,  66,  67,  68,  69,  70,  71,  72,  73,  74,  75,  76,
+     77,  78,  79,  80,  81,  82,  83,  84,  85,  86,  87,  89, 106, 107, 113, 118,
+    119, 120, 121, 122,  38,  42,  44,  59,  88,  90,  33,  34,  40,  41,  63,  39,
+     43, 124,  35,  62,   0,  36,  64,  91,  93, 126,  94, 125,  60,  96, 123,  92,
+    195, 208, 128, 130, 131, 162, 184, 194, 224, 226, 153, 161, 167, 172, 176, 177,
+    179, 209, 216, 217, 227, 229, 230, 129, 132, 133, 134, 136, 146, 154, 156, 160,
+    163, 164, 169, 170, 173, 178, 181, 185, 186, 187, 189, 190, 196, 198, 228, 232,
+    233,   1, 135, 137, 138, 139, 140, 141, 143, 147, 149, 150, 151, 152, 155, 157,
+    158, 165, 166, 168, 174, 175, 180, 182, 183, 188, 191, 197, 231, 239,   9, 142,
+    144, 145, 148, 159, 171, 206, 215, 225, 236, 237, 199, 207, 234, 235, 192, 193,
+    200, 201, 202, 205, 210, 213, 218, 219, 238, 240, 242, 243, 255, 203, 204, 211,
+    212, 214, 221, 222, 223, 241, 244, 245, 246, 247, 248, 250, 251, 252, 253, 254,
+      2,   3,   4,   5,   6,   7,   8,  11,  12,  14,  15,  16,  17,  18,  19,  20,
+     21,  23,  24,  25,  26,  27,  28,  29,  30,  31, 127, 220, 249,  10,  13,  22,
+    256,
+};
+
+typedef struct {
+    uint32_t limit; /* left-justified, the first code of the next length */
+    uint32_t first_code;
+    uint16_t offset;
+} cat_hpack_huffman_length_t;
+
+/* from 5 to 30 bits */
+static const cat_hpack_huffman_length_t cat_hpack_huffman_length_table[26] = {
+    { 0x50000000, 0x00000000,   0 }, /*  5 */
+    { 0xb8000000, 0x00000014,  10 }, /*  6 */
+    { 0xf8000000, 0x0000005c,  36 }, /*  7 */
+    { 0xfe000000, 0x000000f8,  68 }, /*  8 */
+    { 0xfe000000, 0x00000000,   0 }, /*  9 */
+    { 0xff400000, 0x000003f8,  74 }, /* 10 */
+    { 0xffa00000, 0x000007fa,  79 }, /* 11 */
+    { 0xffc00000, 0x00000ffa,  82 }, /* 12 */
+    { 0xfff00000, 0x00001ff8,  84 }, /* 13 */
+    { 0xfff80000, 0x00003ffc,  90 }, /* 14 */
+    { 0xfffe0000, 0x00007ffc,  92 }, /* 15 */
+    { 0xfffe0000, 0x00000000,   0 }, /* 16 */
+    { 0xfffe0000, 0x00000000,   0 }, /* 17 */
+    { 0xfffe0000, 0x00000000,   0 }, /* 18 */
+    { 0xfffe6000, 0x0007fff0,  95 }, /* 19 */
+    { 0xfffee000, 0x000fffe6,  98 }, /* 20 */
+    { 0xffff4800, 0x001fffdc, 106 }, /* 21 */
+    { 0xffffb000, 0x003fffd2, 119 }, /* 22 */
+    { 0xffffea00, 0x007fffd8, 145 }, /* 23 */
+    { 0xfffff600, 0x00ffffea, 174 }, /* 24 */
+    { 0xfffff800, 0x01ffffec, 186 }, /* 25 */
+    { 0xfffffbc0, 0x03ffffe0, 190 }, /* 26 */
+    { 0xfffffe20, 0x07ffffde, 205 }, /* 27 */
+    { 0xfffffff0, 0x0fffffe2, 224 }, /* 28 */
+    { 0xfffffff0, 0x00000000,   0 }, /* 29 */
+    { 0xffffffff, 0x3ffffffc, 253 }, /* 30 */
+};
+
+CAT_API size_t cat_hpack_huffman_encoded_length(const char *data, size_t length)
+{
+    const unsigned char *p = (const unsigned char *) data, *pe = p + length;
+    size_t bits = 0;
+
+    while (p < pe) {
+        bits += cat_hpack_huffman_lengths[*p++];
+    }
+
+    return (bits + 7) / 8;
+}
+
+CAT_API size_t cat_hpack_huffman_encode(char *out, const char *data, size_t length)
+{
+    const unsigned char *p = (const unsigned char *) data, *pe = p + length;
+    unsigned char *o = (unsigned char *) out;
+    uint64_t bits = 0;
+    unsigned int bits_count = 0;
+
+    while (p < pe) {
+        unsigned char c = *p++;
+        bits = (bits << cat_hpack_huffman_lengths[c]) | cat_hpack_huffman_codes[c];
+        bits_count += cat_hpack_huffman_lengths[c];
+        while (bits_count >= 8) {
+            bits_count -= 8;
+            *o++ = (unsigned char) (bits >> bits_count);
+        }
+    }
+    if (bits_count > 0) {
+        /* pad with the most significant bits of EOS */
+        *o++ = (unsigned char) ((bits << (8 - bits_count)) | (0xff >> bits_count));
+    }
+
+    return o - (unsigned char *) out;
+}
+
+CAT_API cat_bool_t cat_hpack_huffman_decode(cat_buffer_t *buffer, const char *data, size_t length)
+{
+    const unsigned char *p = (const unsigned char *) data, *pe = p + length;
+    char stack_out[256], *out, *o;
+    uint64_t bits = 0;
+    unsigned int bits_count = 0;
+    cat_bool_t ret = cat_false;
+
+    /* the shortest code is 5 bits */
+    if (length * 8 / 5 <= sizeof(stack_out)) {
+        out = stack_out;
+    } else {
+        out = (char *) cat_malloc(length * 8 / 5);
+        if (unlikely(out == NULL)) {
+            cat_update_last_error_of_syscall("Malloc for Huffman decoding failed");
+            return cat_false;
+        }
+    }
+    o = out;
+
+    while (p < pe) {
+        bits = (bits << 8) | *p++;
+        bits_count += 8;
+        while (bits_count >= 5) {
+            /* left-justified, zeros are padded if there are less than 32 bits */
+            uint32_t window = (uint32_t) ((bits << (64 - bits_count)) >> 32);
+            const cat_hpack_huffman_length_t *entry = cat_hpack_huffman_length_table;
+            unsigned int code_length = 5;
+            uint16_t symbol;
+            while (window >= entry->limit && code_length < 30) {
+                entry++;
+                code_length++;
+            }
+            if (code_length > bits_count) {
+                break; /* need more bits */
+            }
+            symbol = cat_hpack_huffman_symbols[entry->offset + ((window >> (32 - code_length)) - entry->first_code)];
+            if (unlikely(symbol == 256)) {
+                cat_update_last_error(CAT_EPROTO, "HPACK Huffman string contains EOS");
+                goto _out;
+            }
+            *o++ = (char) symbol;
+            bits_count -= code_length;
+        }
+    }
+    /* padding must be the most significant bits of EOS and shorter than 8 bits */
+    if (unlikely(bits_count > 7 || (bits & ((1u << bits_count) - 1)) != ((1u << bits_count) - 1))) {
+        cat_update_last_error(CAT_EPROTO, "HPACK Huffman string has invalid padding");
+        goto _out;
+    }
+    ret = cat_buffer_append(buffer, out, o - out);
+
+    _out:
+    if (out != stack_out) {
+        cat_free(out);
+    }
+    return ret;
+}
+
+/* primitive type representations */
+
+static cat_always_inline size_t cat_hpack_integer_pack(char *buffer, uint8_t first, uint8_t prefix_bits, size_t value)
+{
+    unsigned char *p = (unsigned char *) buffer;
+    size_t max_prefix = (1u << prefix_bits) - 1;
+
+    if (value < max_prefix) {
+        *p = first | (unsigned char) value;
+        return 1;
+    }
+    *p++ = first | (unsigned char) max_prefix;
+    value -= max_prefix;
+    while (value >= 0x80) {
+        *p++ = (unsigned char) ((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    *p++ = (unsigned char) value;
+
+    return p - (unsigned char *) buffer;
+}
+
+/* returns false on error or if data is incomplete (header blocks must be complete) */
+static cat_bool_t cat_hpack_integer_unpack(const unsigned char **pp, const unsigned char *pe, uint8_t prefix_bits, uint32_t *value)
+{
+    const unsigned char *p = *pp;
+    uint32_t max_prefix = (1u << prefix_bits) - 1;
+    uint64_t result;
+    unsigned int shift = 0;
+
+    if (unlikely(p >= pe)) {
+        goto _error;
+    }
+    result = *p++ & max_prefix;
+    if (result == max_prefix) {
+        while (1) {
+            if (unlikely(p >= pe || shift > 28)) {
+                goto _error;
+            }
+            result += (uint64_t) (*p & 0x7f) << shift;
+            shift += 7;
+            if (!(*p++ & 0x80)) {
+                break;
+            }
+        }
+        if (unlikely(result > UINT32_MAX)) {
+            goto _error;
+        }
+    }
+    *pp = p;
+    *value = (uint32_t) result;
+
+    return cat_true;
+
+    _error:
+    cat_update_last_error(CAT_EPROTO, "HPACK integer is truncated or too large");
+    return cat_false;
+}
+
+static cat_bool_t cat_hpack_string_pack(cat_buffer_t *buffer, const char *data, size_t length, cat_hpack_flags_t flags)
+{
+    char stack_buffer[256], *huffman = NULL;
+    char header[16];
+    size_t huffman_length;
+    cat_bool_t ret;
+
+    if (!(flags & CAT_HPACK_FLAG_NO_HUFFMAN) && length > 0) {
+        huffman_length = cat_hpack_huffman_encoded_length(data, length);
+        if (huffman_length < length) {
+            if (huffman_length <= sizeof(stack_buffer)) {
+                huffman = stack_buffer;
+            } else {
+                huffman = (char *) cat_malloc(huffman_length);
+                if (unlikely(huffman == NULL)) {
+                    cat_update_last_error_of_syscall("Malloc for Huffman encoding failed");
+                    return cat_false;
+                }
+            }
+            (void) cat_hpack_huffman_encode(huffman, data, length);
+            data = huffman;
+            length = huffman_length;
+        }
+    }
+    ret = cat_buffer_append(buffer, header, cat_hpack_integer_pack(header, huffman != NULL ? 0x80 : 0, 7, length)) &&
+          cat_buffer_append(buffer, data, length);
+    if (huffman != NULL && huffman != stack_buffer) {
+        cat_free(huffman);
+    }
+
+    return ret;
+}
+
+/* string is decoded into the buffer of context if it is Huffman encoded, so only the offset is returned for them */
+static cat_bool_t cat_hpack_string_unpack(cat_hpack_t *hpack, const unsigned char **pp, const unsigned char *pe, const char **data, size_t *offset, size_t *length)
+{
+    cat_bool_t huffman;
+    uint32_t string_length;
+
+    if (unlikely(*pp >= pe)) {
+        cat_update_last_error(CAT_EPROTO, "HPACK string is truncated");
+        return cat_false;
+    }
+    huffman = (**pp & 0x80) != 0;
+    if (unlikely(!cat_hpack_integer_unpack(pp, pe, 7, &string_length))) {
+        return cat_false;
+    }
+    if (unlikely((size_t) (pe - *pp) < string_length)) {
+        cat_update_last_error(CAT_EPROTO, "HPACK string is truncated");
+        return cat_false;
+    }
+    if (!huffman) {
+        *data = (const char *) *pp;
+        *length = string_length;
+    } else {
+        size_t buffer_offset = hpack->buffer.length;
+        if (unlikely(!cat_hpack_huffman_decode(&hpack->buffer, (const char *) *pp, string_length))) {
+            return cat_false;
+        }
+        *data = NULL;
+        *offset = buffer_offset;
+        *length = hpack->buffer.length - buffer_offset;
+    }
+    *pp += string_length;
+
+    return cat_true;
+}
+
+/* dynamic table */
+
+CAT_API void cat_hpack_init(cat_hpack_t *hpack)
+{
+    hpack->entries = NULL;
+    hpack->capacity = 0;
+    hpack->first = 0;
+    hpack->count = 0;
+    hpack->size = 0;
+    hpack->max_size = CAT_HTTP2_DEFAULT_HEADER_TABLE_SIZE;
+    hpack->size_limit = CAT_HTTP2_DEFAULT_HEADER_TABLE_SIZE;
+    hpack->pending_min_size = 0;
+    hpack->size_update_pending = cat_false;
+    cat_buffer_init(&hpack->buffer);
+}
+
+static cat_always_inline cat_hpack_entry_t *cat_hpack_get_entry(const cat_hpack_t *hpack, uint32_t index)
+{
+    return hpack->entries[(hpack->first + index) % hpack->capacity];
+}
+
+static void cat_hpack_evict(cat_hpack_t *hpack, size_t max_size)
+{
+    while (hpack->size > max_size) {
+        cat_hpack_entry_t *entry = cat_hpack_get_entry(hpack, hpack->count - 1);
+        hpack->size -= CAT_HPACK_ENTRY_OVERHEAD + entry->name_length + entry->value_length;
+        hpack->count--;
+        cat_free(entry);
+    }
+}
+
+CAT_API void cat_hpack_close(cat_hpack_t *hpack)
+{
+    cat_hpack_evict(hpack, 0);
+    if (hpack->entries != NULL) {
+        cat_free(hpack->entries);
+        hpack->entries = NULL;
+    }
+    hpack->capacity = 0;
+    cat_buffer_close(&hpack->buffer);
+}
+
+CAT_API size_t cat_hpack_get_size(const cat_hpack_t *hpack)
+{
+    return hpack->size;
+}
+
+CAT_API size_t cat_hpack_get_max_size(const cat_hpack_t *hpack)
+{
+    return hpack->max_size;
+}
+
+CAT_API uint32_t cat_hpack_get_count(const cat_hpack_t *hpack)
+{
+    return hpack->count;
+}
+
+CAT_API void cat_hpack_set_size_limit(cat_hpack_t *hpack, size_t size_limit)
+{
+    hpack->size_limit = size_limit;
+}
+
+CAT_API void cat_hpack_update_size(cat_hpack_t *hpack, size_t max_size)
+{
+    if (max_size == hpack->max_size && !hpack->size_update_pending) {
+        return;
+    }
+    if (!hpack->size_update_pending || max_size < hpack->pending_min_size) {
+        hpack->pending_min_size = max_size;
+    }
+    hpack->size_update_pending = cat_true;
+    hpack->max_size = max_size;
+    cat_hpack_evict(hpack, max_size);
+}
+
+static cat_bool_t cat_hpack_add(cat_hpack_t *hpack, const char *name, size_t name_length, const char *value, size_t value_length)
+{
+    size_t size = CAT_HPACK_ENTRY_OVERHEAD + name_length + value_length;
+    cat_hpack_entry_t *entry;
+
+    if (size > hpack->max_size) {
+        /* it is not an error, the table is just emptied */
+        cat_hpack_evict(hpack, 0);
+        return cat_true;
+    }
+    /* name may refer to an entry which will be evicted, so copy it first */
+    entry = (cat_hpack_entry_t *) cat_malloc(offsetof(cat_hpack_entry_t, data) + name_length + value_length);
+    if (unlikely(entry == NULL)) {
+        cat_update_last_error_of_syscall("Malloc for HPACK entry failed");
+        return cat_false;
+    }
+    entry->name_length = (uint32_t) name_length;
+    entry->value_length = (uint32_t) value_length;
+    memcpy(entry->data, name, name_length);
+    memcpy(entry->data + name_length, value, value_length);
+    cat_hpack_evict(hpack, hpack->max_size - size);
+    if (hpack->count == hpack->capacity) {
+        uint32_t new_capacity = hpack->capacity == 0 ? 16 : hpack->capacity * 2, n;
+        cat_hpack_entry_t **entries = (cat_hpack_entry_t **) cat_malloc(sizeof(*entries) * new_capacity);
+        if (unlikely(entries == NULL)) {
+            cat_update_last_error_of_syscall("Malloc for HPACK table failed");
+            cat_free(entry);
+            return cat_false;
+        }
+        for (n = 0; n < hpack->count; n++) {
+            entries[n] = cat_hpack_get_entry(hpack, n);
+        }
+        if (hpack->entries != NULL) {
+            cat_free(hpack->entries);
+        }
+        hpack->entries = entries;
+        hpack->capacity = new_capacity;
+        hpack->first = 0;
+    }
+    hpack->first = (hpack->first + hpack->capacity - 1) % hpack->capacity;
+    hpack->entries[hpack->first] = entry;
+    hpack->count++;
+    hpack->size += size;
+
+    return cat_true;
+}
+
+/* index starts from 1, static entries come first */
+static cat_bool_t cat_hpack_lookup(const cat_hpack_t *hpack, uint32_t index, const char **name, size_t *name_length, const char **value, size_t *value_length)
+{
+    if (index == 0) {
+        goto _error;
+    }
+    if (index <= CAT_HPACK_STATIC_TABLE_COUNT) {
+        const cat_hpack_static_entry_t *entry = &cat_hpack_static_table[index - 1];
+        *name = entry->name;
+        *name_length = entry->name_length;
+        *value = entry->value;
+        *value_length = entry->value_length;
+    } else {
+        const cat_hpack_entry_t *entry;
+        index -= CAT_HPACK_STATIC_TABLE_COUNT + 1;
+        if (index >= hpack->count) {
+            goto _error;
+        }
+        entry = cat_hpack_get_entry(hpack, index);
+        *name = entry->data;
+        *name_length = entry->name_length;
+        *value = entry->data + entry->name_length;
+        *value_length = entry->value_length;
+    }
+
+    return cat_true;
+
+    _error:
+    cat_update_last_error(CAT_EPROTO, "HPACK index %u is out of range", index);
+    return cat_false;
+}
+
+/* header block decoding */
+
+CAT_API cat_bool_t cat_hpack_decode(cat_hpack_t *hpack, const char *data, size_t length, cat_hpack_header_handler_t handler, void *arg)
+{
+    const unsigned char *p = (const unsigned char *) data, *pe = p + length;
+    cat_bool_t header_decoded = cat_false;
+
+    while (p < pe) {
+        const char *name = NULL, *value = NULL;
+        size_t name_offset = 0, name_length = 0, value_offset = 0, value_length = 0;
+        cat_hpack_flags_t flags = CAT_HPACK_FLAG_NONE;
+        uint8_t prefix_bits;
+        uint32_t index;
+
+        if (*p & 0x80) {
+            /* indexed header field */
+            if (unlikely(!cat_hpack_integer_unpack(&p, pe, 7, &index) ||
+                         !cat_hpack_lookup(hpack, index, &name, &name_length, &value, &value_length))) {
+                return cat_false;
+            }
+            if (unlikely(!handler(arg, name, name_length, value, value_length, flags))) {
+                return cat_false;
+            }
+            header_decoded = cat_true;
+            continue;
+        }
+        if ((*p & 0xe0) == 0x20) {
+            /* dynamic table size update, it must be at the beginning of the block */
+            uint32_t max_size;
+            if (unlikely(header_decoded)) {
+                cat_update_last_error(CAT_EPROTO, "HPACK dynamic table size update must be at the beginning of header block");
+                return cat_false;
+            }
+            if (unlikely(!cat_hpack_integer_unpack(&p, pe, 5, &max_size))) {
+                return cat_false;
+            }
+            if (unlikely(max_size > hpack->size_limit)) {
+                cat_update_last_error(CAT_EPROTO, "HPACK dynamic table size update %u exceeds the limit %zu", max_size, hpack->size_limit);
+                return cat_false;
+            }
+            hpack->max_size = max_size;
+            cat_hpack_evict(hpack, max_size);
+            continue;
+        }
+        /* literal header field */
+        if (*p & 0x40) {
+            prefix_bits = 6;
+        } else {
+            prefix_bits = 4;
+            if (*p & 0x10) {
+                flags |= CAT_HPACK_FLAG_NEVER_INDEX;
+            }
+            flags |= CAT_HPACK_FLAG_NO_INDEX;
+        }
+        cat_buffer_clear(&hpack->buffer);
+        if (unlikely(!cat_hpack_integer_unpack(&p, pe, prefix_bits, &index))) {
+            return cat_false;
+        }
+        if (index != 0) {
+            const char *unused_value;
+            size_t unused_value_length;
+            if (unlikely(!cat_hpack_lookup(hpack, index, &name, &name_length, &unused_value, &unused_value_length))) {
+                return cat_false;
+            }
+        } else if (unlikely(!cat_hpack_string_unpack(hpack, &p, pe, &name, &name_offset, &name_length))) {
+            return cat_false;
+        }
+        if (unlikely(!cat_hpack_string_unpack(hpack, &p, pe, &value, &value_offset, &value_length))) {
+            return cat_false;
+        }
+        /* buffer may be reallocated, so resolve them at last */
+        if (name == NULL) {
+            name = name_length != 0 ? hpack->buffer.value + name_offset : "";
+        }
+        if (value == NULL) {
+            value = value_length != 0 ? hpack->buffer.value + value_offset : "";
+        }
+        if (unlikely(!handler(arg, name, name_length, value, value_length, flags))) {
+            return cat_false;
+        }
+        if (!(flags & CAT_HPACK_FLAG_NO_INDEX)) {
+            if (unlikely(!cat_hpack_add(hpack, name, name_length, value, value_length))) {
+                return cat_false;
+            }
+        }
+        header_decoded = cat_true;
+    }
+
+    return cat_true;
+}
+
+/* header block encoding */
+
+static cat_always_inline cat_bool_t cat_hpack_string_equals(const char *s1, size_t l1, const char *s2, size_t l2)
+{
+    return l1 == l2 && memcmp(s1, s2, l1) == 0;
+}
+
+/* returns the index of the best matched entry (0 if nothing is matched), value_matched is set if both matched */
+static uint32_t cat_hpack_search(const cat_hpack_t *hpack, const char *name, size_t name_length, const char *value, size_t value_length, cat_bool_t *value_matched)
+{
+    uint32_t n, name_index = 0;
+
+    *value_matched = cat_false;
+    for (n = 0; n < CAT_HPACK_STATIC_TABLE_COUNT; n++) {
+        const cat_hpack_static_entry_t *entry = &cat_hpack_static_table[n];
+        if (!cat_hpack_string_equals(entry->name, entry->name_length, name, name_length)) {
+            continue;
+        }
+        if (cat_hpack_string_equals(entry->value, entry->value_length, value, value_length)) {
+            *value_matched = cat_true;
+            return n + 1;
+        }
+        if (name_index == 0) {
+            name_index = n + 1;
+        }
+    }
+    for (n = 0; n < hpack->count; n++) {
+        const cat_hpack_entry_t *entry = cat_hpack_get_entry(hpack, n);
+        if (!cat_hpack_string_equals(entry->data, entry->name_length, name, name_length)) {
+            continue;
+        }
+        if (cat_hpack_string_equals(entry->data + entry->name_length, entry->value_length, value, value_length)) {
+            *value_matched = cat_true;
+            return CAT_HPACK_STATIC_TABLE_COUNT + 1 + n;
+        }
+        if (name_index == 0) {
+            name_index = CAT_HPACK_STATIC_TABLE_COUNT + 1 + n;
+        }
+    }
+
+    return name_index;
+}
+
+static cat_hpack_flags_t cat_hpack_get_default_flags(const char *name, size_t name_length, size_t value_length)
+{
+#define CAT_HPACK_NAME_IS(string) cat_hpack_string_equals(name, name_length, string, sizeof(string) - 1)
+    if (CAT_HPACK_NAME_IS("authorization") || CAT_HPACK_NAME_IS("proxy-authorization")) {
+        return CAT_HPACK_FLAG_NEVER_INDEX;
+    }
+    /* short cookies are easy to be guessed (the same as nghttp2) */
+    if (CAT_HPACK_NAME_IS("cookie") && value_length < 20) {
+        return CAT_HPACK_FLAG_NEVER_INDEX;
+    }
+    /* they are changed in almost every response */
+    if (CAT_HPACK_NAME_IS("content-length") || CAT_HPACK_NAME_IS("date") || CAT_HPACK_NAME_IS("etag") ||
+        CAT_HPACK_NAME_IS("last-modified") || CAT_HPACK_NAME_IS(":path")) {
+        return CAT_HPACK_FLAG_NO_INDEX;
+    }
+#undef CAT_HPACK_NAME_IS
+    return CAT_HPACK_FLAG_NONE;
+}
+
+CAT_API cat_bool_t cat_hpack_encode(cat_hpack_t *hpack, cat_buffer_t *buffer, const char *name, size_t name_length, const char *value, size_t value_length, cat_hpack_flags_t flags)
+{
+    char integer[16];
+    cat_bool_t value_matched;
+    uint32_t index;
+
+    if (hpack->size_update_pending) {
+        /* the smallest one must be notified if the size was reduced then increased */
+        if (hpack->pending_min_size < hpack->max_size) {
+            if (unlikely(!cat_buffer_append(buffer, integer, cat_hpack_integer_pack(integer, 0x20, 5, hpack->pending_min_size)))) {
+                return cat_false;
+            }
+        }
+        if (unlikely(!cat_buffer_append(buffer, integer, cat_hpack_integer_pack(integer, 0x20, 5, hpack->max_size)))) {
+            return cat_false;
+        }
+        hpack->size_update_pending = cat_false;
+    }
+    flags |= cat_hpack_get_default_flags(name, name_length, value_length);
+    if (flags & CAT_HPACK_FLAG_NEVER_INDEX) {
+        flags |= CAT_HPACK_FLAG_NO_INDEX;
+    } else if (CAT_HPACK_ENTRY_OVERHEAD + name_length + value_length > hpack->max_size * 3 / 4) {
+        /* it would evict too many entries */
+        flags |= CAT_HPACK_FLAG_NO_INDEX;
+    }
+
+    index = cat_hpack_search(hpack, name, name_length, value, value_length, &value_matched);
+    if (value_matched && !(flags & CAT_HPACK_FLAG_NEVER_INDEX)) {
+        return cat_buffer_append(buffer, integer, cat_hpack_integer_pack(integer, 0x80, 7, index));
+    }
+    if (!(flags & CAT_HPACK_FLAG_NO_INDEX)) {
+        if (unlikely(!cat_buffer_append(buffer, integer, cat_hpack_integer_pack(integer, 0x40, 6, index)))) {
+            return cat_false;
+        }
+    } else {
+        uint8_t first = (flags & CAT_HPACK_FLAG_NEVER_INDEX) ? 0x10 : 0x00;
+        if (unlikely(!cat_buffer_append(buffer, integer, cat_hpack_integer_pack(integer, first, 4, index)))) {
+            return cat_false;
+        }
+    }
+    if (index == 0) {
+        if (unlikely(!cat_hpack_string_pack(buffer, name, name_length, flags))) {
+            return cat_false;
+        }
+    }
+    if (unlikely(!cat_hpack_string_pack(buffer, value, value_length, flags))) {
+        return cat_false;
+    }
+    if (!(flags & CAT_HPACK_FLAG_NO_INDEX)) {
+        return cat_hpack_add(hpack, name, name_length, value, value_length);
+    }
+
+    return cat_true;
+}
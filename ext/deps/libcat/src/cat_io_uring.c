@@ -0,0 +1,493 @@
+/*
+  +--------------------------------------------------------------------------+
+  | libcat                                                                   |
+  +--------------------------------------------------------------------------+
+  | Licensed under the Apache License, Version 2.0 (the "License");          |
+  | you may not use this file except in compliance with the License.         |
+  | You may obtain a copy of the License at                                  |
+  | http://www.apache.org/licenses/LICENSE-2.0                               |
+  | Unless required by applicable law or agreed to in writing, software      |
+  | distributed under the License is distributed on an "AS IS" BASIS,        |
+  | WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. |
+  | See the License for the specific language governing permissions and      |
+  | limitations under the License. See accompanying LICENSE file.            |
+  +--------------------------------------------------------------------------+
+  | Author: Twosee <twosee@php.net>                                          |
+  +--------------------------------------------------------------------------+
+ */
+
+#include "cat_io_uring.h"
+#include "cat_coroutine.h"
+#include "cat_event.h"
+#include "cat_time.h"
+
+#ifdef CAT_IO_URING
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+CAT_API CAT_GLOBALS_DECLARE(cat_io_uring)
+
+CAT_GLOBALS_CTOR_DECLARE_SZ(cat_io_uring)
+
+/* lives on the stack of the waiting coroutine */
+typedef struct
+{
+    cat_coroutine_t *coroutine;
+    int result;
+    cat_bool_t done;
+} cat_io_uring_op_t;
+
+#define CAT_IO_URING_LOAD_ACQUIRE(p)      __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define CAT_IO_URING_STORE_RELEASE(p, v)  __atomic_store_n(p, v, __ATOMIC_RELEASE)
+
+static cat_always_inline int cat_io_uring_setup(unsigned int entries, struct io_uring_params *params)
+{
+    return (int) syscall(__NR_io_uring_setup, entries, params);
+}
+
+static cat_always_inline int cat_io_uring_enter(int fd, unsigned int to_submit, unsigned int min_complete, unsigned int flags)
+{
+    return (int) syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static void cat_io_uring_reap(void)
+{
+    struct io_uring_cqe *cqes = (struct io_uring_cqe *) CAT_IO_URING_G(cqes);
+    unsigned int mask = *CAT_IO_URING_G(cq_mask);
+    unsigned int head;
+
+    while (1) {
+        struct io_uring_cqe *cqe;
+        cat_io_uring_op_t *op;
+        cat_coroutine_t *coroutine;
+
+        head = *CAT_IO_URING_G(cq_head);
+        if (head == CAT_IO_URING_LOAD_ACQUIRE(CAT_IO_URING_G(cq_tail))) {
+            break;
+        }
+        cqe = &cqes[head & mask];
+        op = (cat_io_uring_op_t *) (uintptr_t) cqe->user_data;
+        /* consume it before resuming, coroutine may enter the ring again */
+        CAT_IO_URING_STORE_RELEASE(CAT_IO_URING_G(cq_head), head + 1);
+        CAT_IO_URING_G(stats).completed++;
+        if (op == NULL) {
+            /* cancel request */
+            continue;
+        }
+        op->result = cqe->res;
+        op->done = cat_true;
+        CAT_IO_URING_G(inflight)--;
+        coroutine = op->coroutine;
+        if (coroutine != NULL) {
+            op->coroutine = NULL;
+            if (unlikely(!cat_coroutine_resume(coroutine, NULL, NULL))) {
+                cat_core_error_with_last(EVENT, "io_uring schedule failed");
+            }
+        }
+    }
+
+    if (CAT_IO_URING_G(inflight) == 0) {
+        uv_unref((uv_handle_t *) &CAT_IO_URING_G(poll));
+    }
+}
+
+static int cat_io_uring_submit(void)
+{
+    unsigned int to_submit = (unsigned int) CAT_IO_URING_G(unsubmitted);
+    int n;
+
+    if (to_submit == 0) {
+        return 0;
+    }
+    while (1) {
+        n = cat_io_uring_enter(CAT_IO_URING_G(fd), to_submit, 0, 0);
+        if (unlikely(n < 0)) {
+            if (errno == EINTR) {
+                continue;
+            }
+            /* EAGAIN or EBUSY, try it again in next round */
+            return cat_translate_sys_error(errno);
+        }
+        break;
+    }
+    CAT_IO_URING_G(stats).submit_calls++;
+    CAT_IO_URING_G(stats).submitted += n;
+    CAT_IO_URING_G(unsubmitted) -= n;
+
+    return 0;
+}
+
+static void cat_io_uring_poll_callback(uv_poll_t *poll, int status, int events)
+{
+    (void) poll;
+    (void) status;
+    (void) events;
+    cat_io_uring_reap();
+}
+
+static void cat_io_uring_prepare_callback(uv_prepare_t *prepare)
+{
+    (void) prepare;
+    /* submit all SQEs of this round by one syscall */
+    (void) cat_io_uring_submit();
+}
+
+static struct io_uring_sqe *cat_io_uring_get_sqe(void)
+{
+    unsigned int tail = *CAT_IO_URING_G(sq_tail);
+    unsigned int mask = *CAT_IO_URING_G(sq_mask);
+    struct io_uring_sqe *sqe;
+
+    if (unlikely(tail - CAT_IO_URING_LOAD_ACQUIRE(CAT_IO_URING_G(sq_head)) > mask)) {
+        /* SQ is full, flush it now */
+        if (unlikely(cat_io_uring_submit() != 0)) {
+            return NULL;
+        }
+        if (unlikely(tail - CAT_IO_URING_LOAD_ACQUIRE(CAT_IO_URING_G(sq_head)) > mask)) {
+            return NULL;
+        }
+    }
+    sqe = &((struct io_uring_sqe *) CAT_IO_URING_G(sqes))[tail & mask];
+    memset(sqe, 0, sizeof(*sqe));
+    CAT_IO_URING_G(sq_array)[tail & mask] = tail & mask;
+    CAT_IO_URING_STORE_RELEASE(CAT_IO_URING_G(sq_tail), tail + 1);
+    CAT_IO_URING_G(unsubmitted)++;
+
+    return sqe;
+}
+
+static void cat_io_uring_close(void)
+{
+    if (CAT_IO_URING_G(sqes) != NULL) {
+        munmap(CAT_IO_URING_G(sqes), CAT_IO_URING_G(sqes_size));
+    }
+    if (CAT_IO_URING_G(cq_ring) != NULL && CAT_IO_URING_G(cq_ring) != CAT_IO_URING_G(sq_ring)) {
+        munmap(CAT_IO_URING_G(cq_ring), CAT_IO_URING_G(cq_ring_size));
+    }
+    if (CAT_IO_URING_G(sq_ring) != NULL) {
+        munmap(CAT_IO_URING_G(sq_ring), CAT_IO_URING_G(sq_ring_size));
+    }
+    if (CAT_IO_URING_G(fd) >= 0) {
+        close(CAT_IO_URING_G(fd));
+    }
+    CAT_IO_URING_G(sqes) = NULL;
+    CAT_IO_URING_G(cq_ring) = NULL;
+    CAT_IO_URING_G(sq_ring) = NULL;
+    CAT_IO_URING_G(fd) = -1;
+    CAT_IO_URING_G(inflight) = 0;
+    CAT_IO_URING_G(unsubmitted) = 0;
+}
+
+static cat_bool_t cat_io_uring_open(void)
+{
+    struct io_uring_params params;
+    char *sq_ring, *cq_ring;
+    int fd, error;
+
+    memset(&params, 0, sizeof(params));
+    fd = cat_io_uring_setup(CAT_IO_URING_ENTRIES, &params);
+    if (unlikely(fd < 0)) {
+        cat_update_last_error_of_syscall("io_uring setup failed");
+        return cat_false;
+    }
+    CAT_IO_URING_G(fd) = fd;
+    /* recv/read/async-cancel and current file position are available since 5.6,
+     * fast-poll (5.7) makes socket operations not be punted to io-wq */
+    if (unlikely(
+        !(params.features & IORING_FEAT_SINGLE_MMAP) ||
+        !(params.features & IORING_FEAT_RW_CUR_POS) ||
+        !(params.features & IORING_FEAT_FAST_POLL)
+    )) {
+        cat_update_last_error(CAT_ENOTSUP, "io_uring features are not supported by kernel (requires Linux 5.7+)");
+        goto _error;
+    }
+
+    CAT_IO_URING_G(sq_ring_size) = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    CAT_IO_URING_G(cq_ring_size) = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (CAT_IO_URING_G(cq_ring_size) > CAT_IO_URING_G(sq_ring_size)) {
+        CAT_IO_URING_G(sq_ring_size) = CAT_IO_URING_G(cq_ring_size);
+    }
+    CAT_IO_URING_G(cq_ring_size) = CAT_IO_URING_G(sq_ring_size);
+    sq_ring = (char *) mmap(
+        NULL, CAT_IO_URING_G(sq_ring_size), PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING
+    );
+    if (unlikely(sq_ring == MAP_FAILED)) {
+        cat_update_last_error_of_syscall("io_uring mmap ring failed");
+        goto _error;
+    }
+    /* single mmap: CQ ring shares the mapping with SQ ring */
+    cq_ring = sq_ring;
+    CAT_IO_URING_G(sq_ring) = sq_ring;
+    CAT_IO_URING_G(cq_ring) = cq_ring;
+    CAT_IO_URING_G(sqes_size) = params.sq_entries * sizeof(struct io_uring_sqe);
+    CAT_IO_URING_G(sqes) = mmap(
+        NULL, CAT_IO_URING_G(sqes_size), PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES
+    );
+    if (unlikely(CAT_IO_URING_G(sqes) == MAP_FAILED)) {
+        CAT_IO_URING_G(sqes) = NULL;
+        cat_update_last_error_of_syscall("io_uring mmap SQEs failed");
+        goto _error;
+    }
+    CAT_IO_URING_G(sq_head) = (unsigned int *) (sq_ring + params.sq_off.head);
+    CAT_IO_URING_G(sq_tail) = (unsigned int *) (sq_ring + params.sq_off.tail);
+    CAT_IO_URING_G(sq_mask) = (unsigned int *) (sq_ring + params.sq_off.ring_mask);
+    CAT_IO_URING_G(sq_array) = (unsigned int *) (sq_ring + params.sq_off.array);
+    CAT_IO_URING_G(cq_head) = (unsigned int *) (cq_ring + params.cq_off.head);
+    CAT_IO_URING_G(cq_tail) = (unsigned int *) (cq_ring + params.cq_off.tail);
+    CAT_IO_URING_G(cq_mask) = (unsigned int *) (cq_ring + params.cq_off.ring_mask);
+    CAT_IO_URING_G(cqes) = cq_ring + params.cq_off.cqes;
+
+    /* CQEs are reaped when the ring fd becomes readable,
+     * SQEs are submitted in batch once per loop round */
+    error = uv_poll_init(cat_event_loop, &CAT_IO_URING_G(poll), fd);
+    if (unlikely(error != 0)) {
+        cat_update_last_error_with_reason(error, "io_uring poll init failed");
+        goto _error;
+    }
+    (void) uv_poll_start(&CAT_IO_URING_G(poll), UV_READABLE, cat_io_uring_poll_callback);
+    uv_unref((uv_handle_t *) &CAT_IO_URING_G(poll));
+    (void) uv_prepare_init(cat_event_loop, &CAT_IO_URING_G(prepare));
+    (void) uv_prepare_start(&CAT_IO_URING_G(prepare), cat_io_uring_prepare_callback);
+    uv_unref((uv_handle_t *) &CAT_IO_URING_G(prepare));
+
+    return cat_true;
+
+    _error:
+    cat_io_uring_close();
+    return cat_false;
+}
+
+static cat_always_inline cat_bool_t cat_io_uring_is_opened(void)
+{
+    return CAT_IO_URING_G(fd) >= 0;
+}
+
+static ssize_t cat_io_uring_wait(cat_io_uring_op_t *op, cat_timeout_t timeout)
+{
+    cat_bool_t ret;
+    int error;
+
+    if (CAT_IO_URING_G(inflight)++ == 0) {
+        /* keep event loop alive until all operations were completed */
+        uv_ref((uv_handle_t *) &CAT_IO_URING_G(poll));
+    }
+
+    op->coroutine = CAT_COROUTINE_G(current);
+    cat_coroutine_set_wait_type(CAT_COROUTINE_WAIT_TYPE_IO);
+    ret = cat_time_wait(timeout);
+    if (likely(op->done)) {
+        return op->result;
+    }
+    op->coroutine = NULL;
+    error = ret ? CAT_ECANCELED : cat_get_last_error_code();
+
+    /* timed out or interrupted, but kernel still owns the buffer,
+     * cancel it and wait for the final completion */
+    do {
+        struct io_uring_sqe *sqe = cat_io_uring_get_sqe();
+        if (likely(sqe != NULL)) {
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->fd = -1;
+            sqe->addr = (uint64_t) (uintptr_t) op;
+            sqe->user_data = 0;
+        }
+        CAT_IO_URING_G(stats).canceled++;
+    } while (0);
+    while (!op->done) {
+        op->coroutine = CAT_COROUTINE_G(current);
+        if (unlikely(!cat_coroutine_yield(NULL, NULL))) {
+            /* we can not yield, wait for it synchronously */
+            op->coroutine = NULL;
+            (void) cat_io_uring_submit();
+            (void) cat_io_uring_enter(CAT_IO_URING_G(fd), 0, 1, IORING_ENTER_GETEVENTS);
+            cat_io_uring_reap();
+        }
+    }
+    op->coroutine = NULL;
+    /* it may be completed before cancellation */
+    if (op->result >= 0) {
+        return op->result;
+    }
+
+    return error;
+}
+
+CAT_API cat_bool_t cat_io_uring_module_init(void)
+{
+    CAT_GLOBALS_REGISTER(cat_io_uring, CAT_GLOBALS_CTOR(cat_io_uring), NULL);
+    CAT_IO_URING_G(fd) = -1;
+    return cat_true;
+}
+
+CAT_API cat_bool_t cat_io_uring_runtime_init(void)
+{
+    CAT_IO_URING_G(enabled) = cat_false;
+    CAT_IO_URING_G(fd) = -1;
+    CAT_IO_URING_G(inflight) = 0;
+    CAT_IO_URING_G(unsubmitted) = 0;
+    memset(&CAT_IO_URING_G(stats), 0, sizeof(CAT_IO_URING_G(stats)));
+
+    return cat_true;
+}
+
+CAT_API cat_bool_t cat_io_uring_runtime_shutdown(void)
+{
+    CAT_IO_URING_G(enabled) = cat_false;
+    if (cat_io_uring_is_opened()) {
+        /* handles are closed by the last round of event loop,
+         * and the ring is closed right now (kernel will cancel the rest) */
+        uv_close((uv_handle_t *) &CAT_IO_URING_G(poll), NULL);
+        uv_close((uv_handle_t *) &CAT_IO_URING_G(prepare), NULL);
+        cat_io_uring_close();
+    }
+
+    return cat_true;
+}
+
+CAT_API cat_bool_t cat_io_uring_is_available(void)
+{
+    return cat_true;
+}
+
+CAT_API cat_bool_t cat_io_uring_is_enabled(void)
+{
+    return CAT_IO_URING_G(enabled);
+}
+
+CAT_API cat_bool_t cat_io_uring_enable(void)
+{
+    if (!cat_io_uring_is_opened()) {
+        if (unlikely(!cat_io_uring_open())) {
+            cat_update_last_error_with_previous("io_uring enable failed");
+            return cat_false;
+        }
+    }
+    CAT_IO_URING_G(enabled) = cat_true;
+
+    return cat_true;
+}
+
+CAT_API void cat_io_uring_disable(void)
+{
+    CAT_IO_URING_G(enabled) = cat_false;
+}
+
+CAT_API void cat_io_uring_get_stats(cat_io_uring_stats_t *stats)
+{
+    *stats = CAT_IO_URING_G(stats);
+}
+
+CAT_API void cat_io_uring_reset_stats(void)
+{
+    memset(&CAT_IO_URING_G(stats), 0, sizeof(CAT_IO_URING_G(stats)));
+}
+
+static ssize_t cat_io_uring_rw(uint8_t opcode, int fd, void *buffer, size_t size, uint64_t offset, int flags, cat_timeout_t timeout)
+{
+    struct io_uring_sqe *sqe;
+    cat_io_uring_op_t op;
+
+    if (unlikely(!cat_io_uring_is_opened())) {
+        return CAT_ENOTSUP;
+    }
+    sqe = cat_io_uring_get_sqe();
+    if (unlikely(sqe == NULL)) {
+        return CAT_EAGAIN;
+    }
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t) (uintptr_t) buffer;
+    /* the length of SQE is 32-bit, larger ones become short reads/writes which callers handle */
+    sqe->len = (uint32_t) CAT_MIN(size, UINT32_MAX);
+    sqe->off = offset;
+    sqe->msg_flags = (uint32_t) flags;
+    sqe->user_data = (uint64_t) (uintptr_t) &op;
+    op.coroutine = NULL;
+    op.result = 0;
+    op.done = cat_false;
+
+    return cat_io_uring_wait(&op, timeout);
+}
+
+CAT_API ssize_t cat_io_uring_recv(int fd, void *buffer, size_t size, int flags, cat_timeout_t timeout)
+{
+    return cat_io_uring_rw(IORING_OP_RECV, fd, buffer, size, 0, flags, timeout);
+}
+
+CAT_API ssize_t cat_io_uring_read(int fd, void *buffer, size_t size, int64_t offset, cat_timeout_t timeout)
+{
+    return cat_io_uring_rw(IORING_OP_READ, fd, buffer, size, (uint64_t) offset, 0, timeout);
+}
+
+CAT_API ssize_t cat_io_uring_write(int fd, const void *buffer, size_t length, int64_t offset, cat_timeout_t timeout)
+{
+    return cat_io_uring_rw(IORING_OP_WRITE, fd, (void *) buffer, length, (uint64_t) offset, 0, timeout);
+}
+
+#else
+
+CAT_API cat_bool_t cat_io_uring_module_init(void)
+{
+    return cat_true;
+}
+
+CAT_API cat_bool_t cat_io_uring_runtime_init(void)
+{
+    return cat_true;
+}
+
+CAT_API cat_bool_t cat_io_uring_runtime_shutdown(void)
+{
+    return cat_true;
+}
+
+CAT_API cat_bool_t cat_io_uring_is_available(void)
+{
+    return cat_false;
+}
+
+CAT_API cat_bool_t cat_io_uring_is_enabled(void)
+{
+    return cat_false;
+}
+
+CAT_API cat_bool_t cat_io_uring_enable(void)
+{
+    cat_update_last_error(CAT_ENOTSUP, "io_uring is not available on this platform");
+    return cat_false;
+}
+
+CAT_API void cat_io_uring_disable(void)
+{
+}
+
+CAT_API void cat_io_uring_get_stats(cat_io_uring_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+CAT_API void cat_io_uring_reset_stats(void)
+{
+}
+
+CAT_API ssize_t cat_io_uring_recv(int fd, void *buffer, size_t size, int flags, cat_timeout_t timeout)
+{
+    return CAT_ENOTSUP;
+}
+
+CAT_API ssize_t cat_io_uring_read(int fd, void *buffer, size_t size, int64_t offset, cat_timeout_t timeout)
+{
+    return CAT_ENOTSUP;
+}
+
+CAT_API ssize_t cat_io_uring_write(int fd, const void *buffer, size_t length, int64_t offset, cat_timeout_t timeout)
+{
+    return CAT_ENOTSUP;
+}
+
+#endif /* CAT_IO_URING */
@@ -19,6 +19,8 @@
 #include "cat_socket.h"
 #include "cat_event.h"
 #include "cat_time.h"
+#include "cat_io_uring.h"
+#include "cat_fs.h"
 
 #include "uv-common.h"
 
@@ -30,8 +32,14 @@
 #include <sys/socket.h>
 /* for sockaddr_un*/
 #include <sys/un.h>
+/* for uv__recvmmsg/uv__sendmmsg */
+#include "../deps/libuv/src/unix/internal.h"
 #endif /* CAT_OS_UNIX_LIKE */
 
+#ifdef CAT_OS_LINUX
+#include <sys/sendfile.h>
+#endif
+
 #ifdef CAT_OS_WIN
 #include <winsock2.h>
 #endif /* CAT_OS_WIN */
@@ -374,8 +382,27 @@ CAT_API cat_bool_t cat_socket_runtime_init(void)
 {
     CAT_SOCKET_G(options.timeout) = cat_socket_default_global_timeout_options;
     CAT_SOCKET_G(options.tcp_keepalive_delay) = 60;
+    CAT_SOCKET_G(options.try_write) = cat_false;
+    CAT_SOCKET_G(options.sticky_read) = cat_false;
 
-    return cat_true;
+    cat_queue_init(&CAT_SOCKET_G(write_request_pool));
+    CAT_SOCKET_G(write_request_pool_count) = 0;
+    memset(&CAT_SOCKET_G(write_stats), 0, sizeof(CAT_SOCKET_G(write_stats)));
+
+    return cat_dns_runtime_init();
+}
+
+CAT_API cat_bool_t cat_socket_runtime_shutdown(void)
+{
+    cat_socket_write_request_t *request;
+
+    while ((request = cat_queue_front_data(&CAT_SOCKET_G(write_request_pool), cat_socket_write_request_t, u.node))) {
+        cat_queue_remove(&request->u.node);
+        cat_free(request);
+    }
+    CAT_SOCKET_G(write_request_pool_count) = 0;
+
+    return cat_dns_runtime_shutdown();
 }
 
 #define CAT_SOCKET_INTERNAL_GETTER_WITHOUT_ERROR(_socket, _isocket, _failure) \
@@ -449,6 +476,12 @@ static cat_always_inline cat_bool_t cat_socket_internal_is_established(cat_socke
 #define CAT_SOCKET_TCP_ONLY(_socket, _failure) \
     CAT_SOCKET_WHICH_ONLY(_socket, CAT_SOCKET_TYPE_TCP, "Socket is not of type TCP", _failure)
 
+#define CAT_SOCKET_STREAM_ONLY(_socket, _failure) \
+    CAT_SOCKET_WHICH_ONLY(_socket, CAT_SOCKET_TYPE_FLAG_STREAM, "Socket is not of type STREAM", _failure)
+
+#define CAT_SOCKET_DGRAM_ONLY(_socket, _failure) \
+    CAT_SOCKET_WHICH_ONLY(_socket, CAT_SOCKET_TYPE_FLAG_DGRAM, "Socket is not of type DGRAM", _failure)
+
 #define CAT_SOCKET_WHICH_SIDE_ONLY(_socket, _name, _errstr, _failure) do { \
     if (!cat_socket_is_##_name(_socket)) { \
         cat_update_last_error(CAT_EMISUSE, _errstr); \
@@ -468,6 +501,15 @@ static cat_always_inline cat_bool_t cat_socket_internal_is_established(cat_socke
 } while (0)
 
 static void cat_socket_internal_close(cat_socket_internal_t *isocket);
+static void cat_socket_internal_free(cat_socket_internal_t *isocket);
+
+static cat_always_inline cat_bool_t cat_socket_type_support_sticky_read(cat_socket_type_t type)
+{
+    /* TTY and IPC pipe have their own read semantics */
+    return (type & CAT_SOCKET_TYPE_FLAG_STREAM) &&
+           (type & CAT_SOCKET_TYPE_TTY) != CAT_SOCKET_TYPE_TTY &&
+           !((type & CAT_SOCKET_TYPE_PIPE) == CAT_SOCKET_TYPE_PIPE && (type & CAT_SOCKET_TYPE_FLAG_IPC));
+}
 
 #ifdef CAT_OS_UNIX_LIKE
 static int socket_create(int domain, int type, int protocol)
@@ -724,6 +766,10 @@ CAT_API cat_socket_t *cat_socket_create_ex(cat_socket_t *socket, cat_socket_type
     isocket->io_flags = CAT_SOCKET_IO_FLAG_NONE;
     memset(&isocket->context.io.read, 0, sizeof(isocket->context.io.read));
     cat_queue_init(&isocket->context.io.write.coroutines);
+    memset(&isocket->sticky_read_buffer, 0, sizeof(isocket->sticky_read_buffer));
+    if (CAT_SOCKET_G(options.sticky_read) && cat_socket_type_support_sticky_read(type)) {
+        isocket->flags |= CAT_SOCKET_INTERNAL_FLAG_STICKY_READ;
+    }
     /* part of cache */
     isocket->cache.sockname = NULL;
     isocket->cache.peername = NULL;
@@ -964,6 +1010,36 @@ CAT_SOCKET_TIMEOUT_API_GEN(write)
 
 #undef CAT_SOCKET_TIMEOUT_API_GEN
 
+CAT_API cat_bool_t cat_socket_get_global_try_write(void)
+{
+    return CAT_SOCKET_G(options.try_write);
+}
+
+CAT_API void cat_socket_set_global_try_write(cat_bool_t enable)
+{
+    CAT_SOCKET_G(options.try_write) = enable;
+}
+
+CAT_API cat_bool_t cat_socket_get_global_sticky_read(void)
+{
+    return CAT_SOCKET_G(options.sticky_read);
+}
+
+CAT_API void cat_socket_set_global_sticky_read(cat_bool_t enable)
+{
+    CAT_SOCKET_G(options.sticky_read) = enable;
+}
+
+CAT_API void cat_socket_get_write_stats(cat_socket_write_stats_t *stats)
+{
+    *stats = CAT_SOCKET_G(write_stats);
+}
+
+CAT_API void cat_socket_reset_write_stats(void)
+{
+    memset(&CAT_SOCKET_G(write_stats), 0, sizeof(CAT_SOCKET_G(write_stats)));
+}
+
 static cat_bool_t cat_socket__bind(
     cat_socket_t *socket, cat_socket_internal_t *isocket,
     const cat_sockaddr_t *address, cat_socklen_t address_length,
@@ -1152,6 +1228,7 @@ CAT_API cat_socket_t *cat_socket_accept_ex(cat_socket_t *server, cat_socket_t *c
         iserver->context.accept.data.status = CAT_ECANCELED;
         iserver->context.accept.coroutine = CAT_COROUTINE_G(current);
         iserver->io_flags = CAT_SOCKET_IO_FLAG_ACCEPT;
+        cat_coroutine_set_wait_type(CAT_COROUTINE_WAIT_TYPE_IO);
         ret = cat_time_wait(timeout);
         iserver->io_flags = CAT_SOCKET_IO_FLAG_NONE;
         iserver->context.accept.coroutine = NULL;
@@ -1235,6 +1312,7 @@ static cat_bool_t cat_socket__connect(
         isocket->context.connect.data.status = CAT_ECANCELED;
         isocket->context.connect.coroutine = CAT_COROUTINE_G(current);
         isocket->io_flags = CAT_SOCKET_IO_FLAG_CONNECT;
+        cat_coroutine_set_wait_type(CAT_COROUTINE_WAIT_TYPE_IO);
         ret = cat_time_wait(timeout);
         isocket->io_flags = CAT_SOCKET_IO_FLAG_NONE;
         isocket->context.connect.coroutine = NULL;
@@ -1639,21 +1717,76 @@ typedef struct
     ssize_t error;
 } cat_socket_read_context_t;
 
+static void cat_socket_sticky_read_alloc(cat_socket_internal_t *isocket, uv_buf_t *buf)
+{
+    cat_socket_sticky_read_buffer_t *read_buffer = &isocket->sticky_read_buffer;
+
+    if (read_buffer->value == NULL) {
+        read_buffer->value = (char *) cat_malloc(CAT_SOCKET_STICKY_READ_BUFFER_SIZE);
+        if (unlikely(read_buffer->value == NULL)) {
+            /* ENOBUFS will stop reading */
+            buf->base = NULL;
+            buf->len = 0;
+            return;
+        }
+        read_buffer->offset = 0;
+        read_buffer->length = 0;
+    } else if (read_buffer->offset != 0) {
+        memmove(read_buffer->value, read_buffer->value + read_buffer->offset, read_buffer->length);
+        read_buffer->offset = 0;
+    }
+    buf->base = read_buffer->value + read_buffer->length;
+    buf->len = CAT_SOCKET_STICKY_READ_BUFFER_SIZE - read_buffer->length;
+}
+
 static void cat_socket_read_alloc_callback(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf)
 {
     cat_socket_internal_t *isocket = cat_container_of(handle, cat_socket_internal_t, u.handle);
     cat_socket_read_context_t *context = (cat_socket_read_context_t *) isocket->context.io.read.data.ptr;
 
+    if (unlikely(context == NULL)) {
+        /* no reader (sticky read) */
+        if (isocket->flags & CAT_SOCKET_INTERNAL_FLAG_STICKY_READ) {
+            cat_socket_sticky_read_alloc(isocket, buf);
+        } else {
+            buf->base = NULL;
+            buf->len = 0;
+        }
+        return;
+    }
+
     buf->base = context->buffer + context->nread;
     buf->len = context->size - context->nread;
 }
 
+static void cat_socket_sticky_read_callback(cat_socket_internal_t *isocket, ssize_t nread)
+{
+    cat_socket_sticky_read_buffer_t *read_buffer = &isocket->sticky_read_buffer;
+
+    if (nread > 0) {
+        read_buffer->length += nread;
+        return;
+    }
+    if (nread == CAT_ENOBUFS) {
+        /* buffer is full, stop reading until someone consumes it */
+        uv_read_stop(&isocket->u.stream);
+        return;
+    }
+    /* libuv has stopped reading, save it for the next reader */
+    read_buffer->error = nread;
+}
+
 static void cat_socket_read_callback(uv_stream_t *stream, ssize_t nread, const uv_buf_t *buf)
 {
     cat_socket_internal_t *isocket = cat_container_of(stream, cat_socket_internal_t, u.stream);
     cat_socket_read_context_t *context = (cat_socket_read_context_t *) isocket->context.io.read.data.ptr;
 
-    CAT_ASSERT(context != NULL);
+    if (unlikely(context == NULL)) {
+        if (nread != 0) {
+            cat_socket_sticky_read_callback(isocket, nread);
+        }
+        return;
+    }
 
     /* 0 == EAGAIN */
     if (nread == 0) {
@@ -1737,6 +1870,24 @@ static void cat_socket_udp_recv_callback(uv_udp_t *udp, ssize_t nread, const uv_
     } while (0);
 }
 
+static size_t cat_socket_internal_consume_sticky_read_buffer(cat_socket_internal_t *isocket, char *buffer, size_t size)
+{
+    cat_socket_sticky_read_buffer_t *read_buffer = &isocket->sticky_read_buffer;
+    size_t n = CAT_MIN(read_buffer->length, size);
+
+    memcpy(buffer, read_buffer->value + read_buffer->offset, n);
+    read_buffer->offset += n;
+    read_buffer->length -= n;
+    if (read_buffer->length == 0) {
+        /* do not hold memory for idle connections */
+        cat_free(read_buffer->value);
+        read_buffer->value = NULL;
+        read_buffer->offset = 0;
+    }
+
+    return n;
+}
+
 static ssize_t cat_socket_internal_read_raw(
     cat_socket_internal_t *isocket,
     char *buffer, size_t size,
@@ -1752,6 +1903,7 @@ static ssize_t cat_socket_internal_read_raw(
     cat_bool_t is_udg = (socket->type & CAT_SOCKET_TYPE_UDG) == CAT_SOCKET_TYPE_UDG;
     cat_bool_t support_inline_read = isocket->u.stream.type != UV_TTY && !(isocket->u.stream.type == UV_NAMED_PIPE && isocket->u.pipe.ipc);
 #endif
+    cat_bool_t is_sticky = !!(isocket->flags & CAT_SOCKET_INTERNAL_FLAG_STICKY_READ);
     size_t nread = 0;
     ssize_t error;
 
@@ -1766,6 +1918,24 @@ static ssize_t cat_socket_internal_read_raw(
         if (unlikely(address_length != NULL)) {
             *address_length = 0;
         }
+        /* consume data (or error) which was read ahead */
+        if (isocket->sticky_read_buffer.length > 0) {
+            nread = cat_socket_internal_consume_sticky_read_buffer(isocket, buffer, size);
+            if (once || nread == size) {
+                return (ssize_t) nread;
+            }
+        }
+        if (unlikely(isocket->sticky_read_buffer.error != 0)) {
+            error = isocket->sticky_read_buffer.error;
+            isocket->sticky_read_buffer.error = 0;
+            if (error == CAT_EOF) {
+                if (once) {
+                    return 0;
+                }
+                error = CAT_ECONNRESET;
+            }
+            goto _error;
+        }
     }
 
 #ifdef CAT_OS_UNIX_LIKE /* (TODO: io_uring way) do not inline read on WIN, proactor way is faster */
@@ -1809,8 +1979,57 @@ static ssize_t cat_socket_internal_read_raw(
     } while (0);
 #endif
 
+#ifdef CAT_IO_URING
+    if (!is_dgram && !is_sticky && support_inline_read && cat_io_uring_is_enabled()) {
+        /* kernel polls and receives for us, no need to start the read watcher */
+        cat_socket_fd_t fd = cat_socket_internal_get_fd_fast(isocket);
+        isocket->context.io.read.coroutine = CAT_COROUTINE_G(current);
+        isocket->io_flags |= CAT_SOCKET_IO_FLAG_READ;
+        isocket->flags |= CAT_SOCKET_INTERNAL_FLAG_IO_URING_READING;
+        while (1) {
+            CAT_TIME_WAIT_START() {
+                error = cat_io_uring_recv(fd, buffer + nread, size - nread, 0, timeout);
+            } CAT_TIME_WAIT_END(timeout);
+            if (unlikely(isocket->flags & CAT_SOCKET_INTERNAL_FLAG_CLOSED)) {
+                /* it was closed while we were waiting, we are the last one who holds it,
+                 * callers must not touch it anymore, so partial data is dropped */
+                cat_socket_internal_free(isocket);
+                cat_update_last_error(CAT_ECANCELED, "Socket read has been canceled");
+                return -1;
+            }
+            if (error <= 0) {
+                if (error == 0 && !once) {
+                    error = CAT_ECONNRESET;
+                }
+                break;
+            }
+            nread += error;
+            if (once || nread == size) {
+                error = 0;
+                break;
+            }
+        }
+        isocket->flags ^= CAT_SOCKET_INTERNAL_FLAG_IO_URING_READING;
+        isocket->io_flags ^= CAT_SOCKET_IO_FLAG_READ;
+        isocket->context.io.read.coroutine = NULL;
+        if (unlikely(error != 0)) {
+            if (error == CAT_ETIMEDOUT) {
+                cat_update_last_error_with_previous("Socket read wait failed");
+                goto _wait_error;
+            }
+            goto _error;
+        }
+        return (ssize_t) nread;
+    }
+#endif
+
     if (!is_udp) {
-        error = uv_read_start(&isocket->u.stream, cat_socket_read_alloc_callback, cat_socket_read_callback);
+        if (!is_sticky || !(isocket->u.handle.flags & UV_HANDLE_READING)) {
+            error = uv_read_start(&isocket->u.stream, cat_socket_read_alloc_callback, cat_socket_read_callback);
+        } else {
+            /* still reading since last time */
+            error = 0;
+        }
     } else {
         error = uv_udp_recv_start(&isocket->u.udp, cat_socket_read_alloc_callback, cat_socket_udp_recv_callback);
     }
@@ -1842,13 +2061,16 @@ static ssize_t cat_socket_internal_read_raw(
         isocket->context.io.read.data.ptr = &context;
         isocket->context.io.read.coroutine = CAT_COROUTINE_G(current);
         isocket->io_flags |= CAT_SOCKET_IO_FLAG_READ;
+        cat_coroutine_set_wait_type(CAT_COROUTINE_WAIT_TYPE_IO);
         ret = cat_time_wait(timeout);
         isocket->io_flags ^= CAT_SOCKET_IO_FLAG_READ;
         isocket->context.io.read.coroutine = NULL;
         isocket->context.io.read.data.ptr = NULL;
-        /* read stop */
+        /* read stop (keep reading in sticky mode) */
         if (!is_udp) {
-            uv_read_stop(&isocket->u.stream);
+            if (!is_sticky) {
+                uv_read_stop(&isocket->u.stream);
+            }
         } else {
             uv_udp_recv_stop(&isocket->u.udp);
         }
@@ -1958,12 +2180,21 @@ static cat_always_inline ssize_t cat_socket_internal_read(
     cat_bool_t once
 )
 {
+    ssize_t nread;
+
 #ifdef CAT_SSL
     if (isocket->ssl != NULL) {
-        return cat_socket_internal_read_decrypted(isocket, buffer, size, address, address_length, timeout, once);
-    }
+        nread = cat_socket_internal_read_decrypted(isocket, buffer, size, address, address_length, timeout, once);
+    } else
 #endif
-    return cat_socket_internal_read_raw(isocket, buffer, size, address, address_length, timeout, once);
+    {
+        nread = cat_socket_internal_read_raw(isocket, buffer, size, address, address_length, timeout, once);
+    }
+    if (likely(nread > 0)) {
+        cat_coroutine_add_bytes_read(nread);
+    }
+
+    return nread;
 }
 
 CAT_STATIC_ASSERT(sizeof(cat_socket_write_vector_t) == sizeof(uv_buf_t));
@@ -1975,18 +2206,51 @@ CAT_API size_t cat_socket_write_vector_length(const cat_socket_write_vector_t *v
     return cat_io_vector_length((const cat_io_vector_t *) vector, vector_count);
 }
 
-typedef struct {
-    int error;
-    union {
-        cat_coroutine_t *coroutine;
-        uv_write_t stream;
-        uv_udp_send_t udp;
-    } u;
-} cat_socket_write_request_t;
-
-/* u is variable-length */
+/* u must be the last one */
 CAT_STATIC_ASSERT(cat_offsize_of(cat_socket_write_request_t, u) == sizeof(cat_socket_write_request_t));
 
+static cat_always_inline cat_socket_write_request_t *cat_socket_internal_write_request_acquire(cat_socket_internal_t *isocket)
+{
+    cat_socket_write_request_t *request;
+
+    /* the common case: only one writer at the same time */
+    if (likely(!(isocket->flags & CAT_SOCKET_INTERNAL_FLAG_WRITE_REQUEST_IN_USE))) {
+        isocket->flags |= CAT_SOCKET_INTERNAL_FLAG_WRITE_REQUEST_IN_USE;
+        CAT_SOCKET_G(write_stats.inline_requests)++;
+        return &isocket->write_request;
+    }
+    /* queued writes */
+    request = cat_queue_front_data(&CAT_SOCKET_G(write_request_pool), cat_socket_write_request_t, u.node);
+    if (request != NULL) {
+        cat_queue_remove(&request->u.node);
+        CAT_SOCKET_G(write_request_pool_count)--;
+        CAT_SOCKET_G(write_stats.pooled_requests)++;
+        return request;
+    }
+    request = (cat_socket_write_request_t *) cat_malloc(sizeof(*request));
+    if (unlikely(request == NULL)) {
+        cat_update_last_error_of_syscall("Malloc for write reuqest failed");
+        return NULL;
+    }
+    CAT_SOCKET_G(write_stats.allocated_requests)++;
+
+    return request;
+}
+
+static cat_always_inline void cat_socket_internal_write_request_release(cat_socket_internal_t *isocket, cat_socket_write_request_t *request)
+{
+    if (request == &isocket->write_request) {
+        isocket->flags &= ~CAT_SOCKET_INTERNAL_FLAG_WRITE_REQUEST_IN_USE;
+        return;
+    }
+    if (CAT_SOCKET_G(write_request_pool_count) < CAT_SOCKET_WRITE_REQUEST_POOL_MAX_SIZE) {
+        cat_queue_push_back(&CAT_SOCKET_G(write_request_pool), &request->u.node);
+        CAT_SOCKET_G(write_request_pool_count)++;
+    } else {
+        cat_free(request);
+    }
+}
+
 /* IOCP/io_uring may not support wait writable */
 static cat_always_inline void cat_socket_internal_write_callback(cat_socket_internal_t *isocket, cat_socket_write_request_t *request, int status)
 {
@@ -1997,13 +2261,17 @@ static cat_always_inline void cat_socket_internal_write_callback(cat_socket_inte
         CAT_ASSERT(isocket->u.socket != NULL);
         CAT_ASSERT(isocket->io_flags & CAT_SOCKET_IO_FLAG_WRITE);
         request->error = status;
-        /* just resume and it will retry to send on while loop */
+        request->u.coroutine = NULL;
+        /* just resume and it will retry to send on while loop,
+         * request will be released by the writer (so it can be reused immediately) */
         if (unlikely(!cat_coroutine_resume(coroutine, NULL, NULL))) {
             cat_core_error_with_last(SOCKET, "UDP send schedule failed");
         }
+        return;
     }
 
-    cat_free(request);
+    /* writer has gone */
+    cat_socket_internal_write_request_release(isocket, request);
 }
 
 static void cat_socket_write_callback(uv_write_t *request, int status)
@@ -2082,7 +2350,7 @@ static cat_bool_t cat_socket_internal_write_raw(
     cat_bool_t is_dgram = (socket->type & CAT_SOCKET_TYPE_FLAG_DGRAM);
     cat_bool_t ret = cat_false;
     cat_socket_write_request_t *request;
-    size_t context_size;
+    cat_socket_write_vector_t *rest_vector = NULL;
     ssize_t error;
 
 #ifdef CAT_OS_UNIX_LIKE
@@ -2100,15 +2368,45 @@ static cat_bool_t cat_socket_internal_write_raw(
     }
 #endif
 
-    /* why we do not try write: on high-traffic scenarios, try_write will instead lead to performance */
-    if (!is_udp) {
-        context_size = cat_offsize_of(cat_socket_write_request_t, u.stream);
-    } else {
-        context_size = cat_offsize_of(cat_socket_write_request_t, u.udp);
+    /* we do not try write by default: on high-traffic scenarios, try_write will instead lead to performance,
+     * it only makes sense when there is no queued writes (otherwise data would be out of order) */
+    if (
+        CAT_SOCKET_G(options.try_write) && !is_dgram &&
+        isocket->u.stream.write_queue_size == 0 &&
+        cat_queue_empty(&isocket->context.io.write.coroutines)
+    ) {
+        error = uv_try_write(&isocket->u.stream, (const uv_buf_t *) vector, vector_count);
+        if (error > 0) {
+            size_t nwrite = (size_t) error;
+            while (vector_count > 0 && nwrite >= vector->length) {
+                nwrite -= vector->length;
+                vector++;
+                vector_count--;
+            }
+            if (vector_count == 0) {
+                CAT_SOCKET_G(write_stats.direct_writes)++;
+                ret = cat_true;
+                goto _out;
+            }
+            CAT_SOCKET_G(write_stats.partial_writes)++;
+            if (nwrite > 0) {
+                /* vector is read-only, copy the rest of it (uv_write() will copy it again, so it is temporary) */
+                rest_vector = (cat_socket_write_vector_t *) cat_malloc(sizeof(*rest_vector) * vector_count);
+                if (unlikely(rest_vector == NULL)) {
+                    cat_update_last_error_of_syscall("Malloc for write vector failed");
+                    goto _out;
+                }
+                memcpy(rest_vector, vector, sizeof(*rest_vector) * vector_count);
+                rest_vector[0].base += nwrite;
+                rest_vector[0].length -= nwrite;
+                vector = rest_vector;
+            }
+        }
+        /* otherwise (e.g. EAGAIN), fallback to uv_write(), it will report the real error if necessary */
     }
-    request = (cat_socket_write_request_t *) cat_malloc(context_size);
+
+    request = cat_socket_internal_write_request_acquire(isocket);
     if (unlikely(request == NULL)) {
-        cat_update_last_error_of_syscall("Malloc for write reuqest failed");
         goto _out;
     }
     if (!is_dgram) {
@@ -2124,30 +2422,40 @@ static cat_bool_t cat_socket_internal_write_raw(
             cat_socket_udp_send_callback
         );
     }
+    if (rest_vector != NULL) {
+        cat_free(rest_vector);
+    }
     if (likely(error == 0)) {
         request->error = CAT_ECANCELED;
         request->u.coroutine = CAT_COROUTINE_G(current);
         cat_queue_push_back(&isocket->context.io.write.coroutines, &CAT_COROUTINE_G(current)->waiter.node);
         isocket->io_flags |= CAT_SOCKET_IO_FLAG_WRITE;
+        cat_coroutine_set_wait_type(CAT_COROUTINE_WAIT_TYPE_IO);
         ret = cat_time_wait(timeout);
         cat_queue_remove(&CAT_COROUTINE_G(current)->waiter.node);
-        request->u.coroutine = NULL;
         if (cat_queue_empty(&isocket->context.io.write.coroutines)) {
             isocket->io_flags ^= CAT_SOCKET_IO_FLAG_WRITE;
         }
-        if (request->error == CAT_ECANCELED) {
-            /* write request is in progress, we must cancel it by close */
+        if (request->u.coroutine != NULL) {
+            /* write request is in progress, we must cancel it by close,
+             * and the request will be released in write callback */
+            request->u.coroutine = NULL;
             cat_socket_internal_close(isocket);
 #if 0
             /* event scheduler will wake up the current coroutine on cat_socket_write_callback with ECANCELED */
             cat_coroutine_wait_for(CAT_COROUTINE_G(scheduler));
 #endif
+            error = CAT_ECANCELED;
+        } else {
+            error = request->error;
+            cat_socket_internal_write_request_release(isocket, request);
         }
         if (unlikely(!ret)) {
             cat_update_last_error_with_previous("Socket write wait failed");
             goto _out;
         }
-        error = request->error;
+    } else {
+        cat_socket_internal_write_request_release(isocket, request);
     }
     ret = error == 0;
     if (unlikely(!ret)) {
@@ -2206,12 +2514,139 @@ static cat_always_inline cat_bool_t cat_socket_internal_write(
     cat_timeout_t timeout
 )
 {
+    cat_bool_t ret;
+
 #ifdef CAT_SSL
     if (isocket->ssl != NULL) {
-        return cat_socket_internal_write_encrypted(isocket, vector, vector_count, address, address_length, timeout);
+        ret = cat_socket_internal_write_encrypted(isocket, vector, vector_count, address, address_length, timeout);
+    } else
+#endif
+    {
+        ret = cat_socket_internal_write_raw(isocket, vector, vector_count, address, address_length, timeout);
     }
+    if (likely(ret)) {
+        cat_coroutine_add_bytes_written(cat_socket_write_vector_length(vector, vector_count));
+    }
+
+    return ret;
+}
+
+typedef struct cat_socket_shared_write_request_s {
+    uv_write_t request;
+    cat_socket_shared_data_t *data;
+    char *encrypted; /* encrypted data is owned by the request */
+} cat_socket_shared_write_request_t;
+
+static void cat_socket_shared_write_callback(uv_write_t *request, int status)
+{
+    cat_socket_shared_write_request_t *context = cat_container_of(request, cat_socket_shared_write_request_t, request);
+
+    (void) status; /* nobody is waiting for it, error will be reported by the next read or write */
+    if (context->data != NULL) {
+        cat_socket_shared_data_release(context->data);
+    }
+    if (context->encrypted != NULL) {
+        cat_free(context->encrypted);
+    }
+    cat_free(context);
+}
+
+#ifdef CAT_SSL
+/* encrypted data is different for every socket, so we have to copy it */
+static cat_never_inline char *cat_socket_internal_encrypt_shared(cat_socket_internal_t *isocket, const cat_socket_shared_data_t *data, size_t *length)
+{
+    cat_ssl_t *ssl = isocket->ssl;
+    cat_io_vector_t input;
+    cat_io_vector_t ssl_vector[8];
+    unsigned int ssl_vector_count = CAT_ARRAY_SIZE(ssl_vector), n;
+    char *encrypted, *p;
+
+    input.base = (char *) data->value;
+    input.length = data->length;
+    if (unlikely(!cat_ssl_encrypt(ssl, &input, 1, ssl_vector, &ssl_vector_count))) {
+        cat_update_last_error_with_previous("Socket SSL write failed");
+        return NULL;
+    }
+    *length = cat_io_vector_length(ssl_vector, ssl_vector_count);
+    encrypted = (char *) cat_malloc(*length);
+    if (unlikely(encrypted == NULL)) {
+        cat_update_last_error_of_syscall("Malloc for encrypted data failed");
+    } else for (p = encrypted, n = 0; n < ssl_vector_count; n++) {
+        memcpy(p, ssl_vector[n].base, ssl_vector[n].length);
+        p += ssl_vector[n].length;
+    }
+    cat_ssl_encrypted_vector_free(ssl, ssl_vector, ssl_vector_count);
+
+    return encrypted;
+}
 #endif
-    return cat_socket_internal_write_raw(isocket, vector, vector_count, address, address_length, timeout);
+
+static cat_bool_t cat_socket_internal_write_shared(cat_socket_internal_t *isocket, cat_socket_shared_data_t *data, size_t high_water_mark)
+{
+    cat_socket_shared_write_request_t *request;
+    uv_buf_t buf = uv_buf_init(data->value, (unsigned int) data->length);
+    char *encrypted = NULL;
+    int error;
+
+    if (high_water_mark != 0 && isocket->u.stream.write_queue_size > high_water_mark) {
+        CAT_SOCKET_G(write_stats.skipped_writes)++;
+        cat_update_last_error(CAT_EAGAIN, "Socket write queue size %zu is over the high-water mark %zu", isocket->u.stream.write_queue_size, high_water_mark);
+        return cat_false;
+    }
+#ifdef CAT_SSL
+    if (isocket->ssl != NULL) {
+        size_t length;
+        encrypted = cat_socket_internal_encrypt_shared(isocket, data, &length);
+        if (unlikely(encrypted == NULL)) {
+            return cat_false;
+        }
+        buf = uv_buf_init(encrypted, (unsigned int) length);
+    }
+#endif
+    /* most of sockets are idle when broadcasting, try to send it directly without request */
+    if (isocket->u.stream.write_queue_size == 0 && cat_queue_empty(&isocket->context.io.write.coroutines)) {
+        error = uv_try_write(&isocket->u.stream, &buf, 1);
+        if (error > 0) {
+            if ((size_t) error == buf.len) {
+                CAT_SOCKET_G(write_stats.direct_writes)++;
+                if (encrypted != NULL) {
+                    cat_free(encrypted);
+                }
+                return cat_true;
+            }
+            CAT_SOCKET_G(write_stats.partial_writes)++;
+            buf.base += error;
+            buf.len -= error;
+        }
+    }
+    request = (cat_socket_shared_write_request_t *) cat_malloc(sizeof(*request));
+    if (unlikely(request == NULL)) {
+        cat_update_last_error_of_syscall("Malloc for shared write request failed");
+        goto _error;
+    }
+    error = uv_write(&request->request, &isocket->u.stream, &buf, 1, cat_socket_shared_write_callback);
+    if (unlikely(error != 0)) {
+        cat_free(request);
+        cat_update_last_error_with_reason(error, "Socket write failed");
+        goto _error;
+    }
+    if (encrypted != NULL) {
+        request->data = NULL;
+        request->encrypted = encrypted;
+    } else {
+        cat_socket_shared_data_addref(data);
+        request->data = data;
+        request->encrypted = NULL;
+    }
+    CAT_SOCKET_G(write_stats.shared_writes)++;
+
+    return cat_true;
+
+    _error:
+    if (encrypted != NULL) {
+        cat_free(encrypted);
+    }
+    return cat_false;
 }
 
 #define CAT_SOCKET_IO_CHECK(_socket, _isocket, _io_flag) \
@@ -2314,6 +2749,415 @@ static cat_always_inline cat_bool_t cat_socket__send_to(cat_socket_t *socket, co
     return cat_socket__write_to(socket, &vector, 1, name, name_length, port, timeout);
 }
 
+/* batch */
+
+#ifdef CAT_OS_UNIX_LIKE
+/* returns the number of datagrams transferred or a negative error code (e.g. EAGAIN) */
+static ssize_t cat_socket_internal_batch_nowait(cat_socket_fd_t fd, cat_socket_datagram_t *datagrams, size_t count, cat_bool_t is_send)
+{
+#if HAVE_MMSG
+    struct uv__mmsghdr messages[CAT_SOCKET_BATCH_SIZE];
+    struct iovec iov[CAT_SOCKET_BATCH_SIZE];
+    unsigned int n = (unsigned int) CAT_MIN(count, CAT_SOCKET_BATCH_SIZE), i;
+    int ret;
+
+    memset(messages, 0, sizeof(messages[0]) * n);
+    for (i = 0; i < n; i++) {
+        cat_socket_datagram_t *datagram = &datagrams[i];
+        struct msghdr *header = &messages[i].msg_hdr;
+        iov[i].iov_base = datagram->buffer;
+        iov[i].iov_len = datagram->length;
+        header->msg_iov = &iov[i];
+        header->msg_iovlen = 1;
+        if (!is_send) {
+            header->msg_name = &datagram->address.address;
+            header->msg_namelen = sizeof(datagram->address.address);
+        } else if (datagram->address.length != 0) {
+            header->msg_name = &datagram->address.address;
+            header->msg_namelen = datagram->address.length;
+        }
+    }
+    do {
+        /* fd is always in non-blocking mode */
+        ret = is_send ? uv__sendmmsg(fd, messages, n) : uv__recvmmsg(fd, messages, n);
+    } while (unlikely(ret < 0 && cat_sys_errno == EINTR));
+    if (unlikely(ret < 0)) {
+        return cat_translate_sys_error(cat_sys_errno);
+    }
+    if (!is_send) {
+        for (i = 0; i < (unsigned int) ret; i++) {
+            datagrams[i].length = messages[i].msg_len;
+            datagrams[i].address.length = messages[i].msg_hdr.msg_namelen;
+        }
+    }
+
+    return ret;
+#else
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        cat_socket_datagram_t *datagram = &datagrams[i];
+        ssize_t n;
+        if (!is_send) {
+            datagram->address.length = sizeof(datagram->address.address);
+            n = recvfrom(fd, datagram->buffer, datagram->length, 0, &datagram->address.address.common, &datagram->address.length);
+        } else {
+            n = sendto(fd, datagram->buffer, datagram->length, 0,
+                datagram->address.length != 0 ? &datagram->address.address.common : NULL, datagram->address.length);
+        }
+        if (unlikely(n < 0)) {
+            int error = cat_translate_sys_error(cat_sys_errno);
+            if (error == CAT_EINTR) {
+                i--;
+                continue;
+            }
+            if (i == 0) {
+                return error;
+            }
+            break;
+        }
+        if (!is_send) {
+            datagram->length = (size_t) n;
+        }
+    }
+
+    return i;
+#endif
+}
+#endif
+
+static ssize_t cat_socket_internal_recv_batch(cat_socket_internal_t *isocket, cat_socket_datagram_t *datagrams, size_t count, cat_timeout_t timeout)
+{
+    size_t nrecv = 0;
+    ssize_t n;
+
+    if (unlikely(count == 0)) {
+        return 0;
+    }
+
+    while (1) {
+#ifdef CAT_OS_UNIX_LIKE
+        cat_socket_fd_t fd = cat_socket_internal_get_fd_fast(isocket);
+        /* fd is unavailable if UDP socket has not been bound yet */
+        if (likely(fd != CAT_SOCKET_INVALID_FD)) {
+            n = cat_socket_internal_batch_nowait(fd, datagrams + nrecv, count - nrecv, cat_false);
+            if (n > 0) {
+                nrecv += n;
+                if (nrecv == count || n < CAT_SOCKET_BATCH_SIZE) {
+                    break; /* full, or it has been drained */
+                }
+                continue;
+            }
+            if (unlikely(n != CAT_EAGAIN && n != CAT_ENOSYS)) {
+                if (nrecv > 0) {
+                    break; /* report it next time */
+                }
+                cat_update_last_error_with_reason(n, "Socket recv batch failed");
+                return -1;
+            }
+        }
+#endif
+        if (nrecv > 0) {
+            break;
+        }
+        /* nothing available, wait for the first one in the usual way */
+        do {
+            cat_socket_datagram_t *datagram = &datagrams[0];
+            datagram->address.length = sizeof(datagram->address.address);
+            n = cat_socket_internal_read(
+                isocket, datagram->buffer, datagram->length,
+                &datagram->address.address.common, &datagram->address.length,
+                timeout, cat_true
+            );
+            if (unlikely(n < 0)) {
+                cat_update_last_error_with_previous("Socket recv batch failed");
+                return -1;
+            }
+            datagram->length = (size_t) n;
+            nrecv = 1;
+        } while (0);
+#ifndef CAT_OS_UNIX_LIKE
+        break;
+#endif
+    }
+
+    return nrecv;
+}
+
+static ssize_t cat_socket_internal_send_batch(cat_socket_internal_t *isocket, const cat_socket_datagram_t *datagrams, size_t count, cat_timeout_t timeout)
+{
+    size_t nsent = 0;
+
+    while (nsent < count) {
+        const cat_socket_datagram_t *datagram;
+        cat_socket_write_vector_t vector;
+        cat_bool_t ret;
+#ifdef CAT_OS_UNIX_LIKE
+        cat_socket_fd_t fd = cat_socket_internal_get_fd_fast(isocket);
+        /* keep order with the queued writes */
+        if (
+            likely(fd != CAT_SOCKET_INVALID_FD) &&
+            cat_queue_empty(&isocket->context.io.write.coroutines)
+        ) {
+            ssize_t n = cat_socket_internal_batch_nowait(fd, (cat_socket_datagram_t *) datagrams + nsent, count - nsent, cat_true);
+            if (n > 0) {
+                nsent += n;
+                continue;
+            }
+            if (unlikely(n != CAT_EAGAIN && n != CAT_ENOSYS)) {
+                cat_update_last_error_with_reason(n, "Socket send batch failed");
+                goto _error;
+            }
+        }
+#endif
+        /* wait for writable (or bind it), send one in the usual way, then try again */
+        datagram = &datagrams[nsent];
+        vector = cat_socket_write_vector_init(datagram->buffer, (cat_socket_vector_length_t) datagram->length);
+        CAT_TIME_WAIT_START() {
+            ret = cat_socket_internal_write(
+                isocket, &vector, 1,
+                datagram->address.length != 0 ? &datagram->address.address.common : NULL,
+                datagram->address.length, timeout
+            );
+        } CAT_TIME_WAIT_END(timeout);
+        if (unlikely(!ret)) {
+            cat_update_last_error_with_previous("Socket send batch failed");
+            goto _error;
+        }
+        nsent++;
+    }
+
+    return nsent;
+
+    _error:
+    return nsent > 0 ? (ssize_t) nsent : -1;
+}
+
+static cat_always_inline ssize_t cat_socket__recv_batch(cat_socket_t *socket, cat_socket_datagram_t *datagrams, size_t count, cat_timeout_t timeout)
+{
+    CAT_SOCKET_DGRAM_ONLY(socket, return -1);
+    CAT_SOCKET_IO_CHECK(socket, isocket, CAT_SOCKET_IO_FLAG_READ);
+    return cat_socket_internal_recv_batch(isocket, datagrams, count, timeout);
+}
+
+static cat_always_inline ssize_t cat_socket__send_batch(cat_socket_t *socket, const cat_socket_datagram_t *datagrams, size_t count, cat_timeout_t timeout)
+{
+    CAT_SOCKET_DGRAM_ONLY(socket, return -1);
+    CAT_SOCKET_IO_CHECK(socket, isocket, CAT_SOCKET_IO_FLAG_NONE);
+    return cat_socket_internal_send_batch(isocket, datagrams, count, timeout);
+}
+
+/* sendfile */
+
+#ifndef CAT_SOCKET_SENDFILE_CHUNK_SIZE
+/* buffer size for the fallback (copying) way */
+#define CAT_SOCKET_SENDFILE_CHUNK_SIZE (64 * 1024)
+#endif
+
+#ifdef CAT_OS_LINUX
+/* sendfile(2) transfers at most 0x7ffff000 bytes per call */
+#define CAT_SOCKET_SENDFILE_MAX_SIZE 0x7ffff000
+
+typedef struct
+{
+    uv_poll_t poll;
+    cat_coroutine_t *coroutine;
+    /* libuv allows only one IO watcher per fd, so we poll on a duplicate one */
+    int fd;
+} cat_socket_sendfile_poller_t;
+
+static void cat_socket_sendfile_poll_callback(uv_poll_t *handle, int status, int events)
+{
+    cat_socket_sendfile_poller_t *poller = cat_container_of(handle, cat_socket_sendfile_poller_t, poll);
+    cat_coroutine_t *coroutine = poller->coroutine;
+
+    (void) uv_poll_stop(handle);
+    if (coroutine != NULL) {
+        poller->coroutine = NULL;
+        if (unlikely(!cat_coroutine_resume(coroutine, NULL, NULL))) {
+            cat_core_error_with_last(SOCKET, "Socket sendfile schedule failed");
+        }
+    }
+}
+
+static void cat_socket_sendfile_poller_close_callback(uv_handle_t *handle)
+{
+    cat_socket_sendfile_poller_t *poller = cat_container_of(handle, cat_socket_sendfile_poller_t, poll);
+
+    (void) close(poller->fd);
+    cat_free(poller);
+}
+
+static cat_socket_sendfile_poller_t *cat_socket_sendfile_poller_create(cat_socket_fd_t fd)
+{
+    cat_socket_sendfile_poller_t *poller;
+    int error;
+
+    poller = (cat_socket_sendfile_poller_t *) cat_malloc(sizeof(*poller));
+    if (unlikely(poller == NULL)) {
+        cat_update_last_error_of_syscall("Malloc for sendfile poller failed");
+        return NULL;
+    }
+    poller->fd = dup(fd);
+    if (unlikely(poller->fd < 0)) {
+        cat_update_last_error_of_syscall("Dup socket fd for sendfile failed");
+        cat_free(poller);
+        return NULL;
+    }
+    error = uv_poll_init(cat_event_loop, &poller->poll, poller->fd);
+    if (unlikely(error != 0)) {
+        cat_update_last_error_with_reason(error, "Sendfile poller init failed");
+        (void) close(poller->fd);
+        cat_free(poller);
+        return NULL;
+    }
+    poller->coroutine = NULL;
+
+    return poller;
+}
+
+static ssize_t cat_socket_internal_sendfile(cat_socket_internal_t *isocket, int file, int64_t offset, size_t length, cat_timeout_t timeout)
+{
+    cat_socket_fd_t fd = cat_socket_internal_get_fd_fast(isocket);
+    cat_socket_sendfile_poller_t *poller = NULL;
+    size_t nsent = 0;
+    ssize_t n;
+    int error;
+
+    while (length == 0 || nsent < length) {
+        cat_bool_t ret;
+        /* data queued by uv_write() must be sent first */
+        if (isocket->u.stream.write_queue_size == 0) {
+            off_t off = (off_t) (offset + nsent);
+            size_t size = length == 0 ? CAT_SOCKET_SENDFILE_MAX_SIZE : CAT_MIN(length - nsent, CAT_SOCKET_SENDFILE_MAX_SIZE);
+            n = sendfile(fd, file, &off, size);
+            if (n > 0) {
+                nsent += n;
+                continue;
+            }
+            if (n == 0) {
+                break; /* EOF */
+            }
+            error = cat_translate_sys_error(cat_sys_errno);
+            if (unlikely(error == CAT_EINTR)) {
+                continue;
+            }
+            if (unlikely(error != CAT_EAGAIN)) {
+                cat_update_last_error_with_reason(error, "Socket sendfile failed");
+                goto _error;
+            }
+        }
+        /* wait for writable */
+        if (poller == NULL) {
+            poller = cat_socket_sendfile_poller_create(fd);
+            if (unlikely(poller == NULL)) {
+                cat_update_last_error_with_previous("Socket sendfile wait failed");
+                goto _error;
+            }
+        }
+        error = uv_poll_start(&poller->poll, UV_WRITABLE, cat_socket_sendfile_poll_callback);
+        if (unlikely(error != 0)) {
+            cat_update_last_error_with_reason(error, "Socket sendfile poll failed");
+            goto _error;
+        }
+        poller->coroutine = CAT_COROUTINE_G(current);
+        cat_queue_push_back(&isocket->context.io.write.coroutines, &CAT_COROUTINE_G(current)->waiter.node);
+        isocket->io_flags |= CAT_SOCKET_IO_FLAG_WRITE;
+        cat_coroutine_set_wait_type(CAT_COROUTINE_WAIT_TYPE_IO);
+        CAT_TIME_WAIT_START() {
+            ret = cat_time_wait(timeout);
+        } CAT_TIME_WAIT_END(timeout);
+        cat_queue_remove(&CAT_COROUTINE_G(current)->waiter.node);
+        if (cat_queue_empty(&isocket->context.io.write.coroutines)) {
+            isocket->io_flags ^= CAT_SOCKET_IO_FLAG_WRITE;
+        }
+        if (unlikely(poller->coroutine != NULL)) {
+            /* timed out, or canceled (socket may have been closed, do not touch it anymore) */
+            poller->coroutine = NULL;
+            (void) uv_poll_stop(&poller->poll);
+            if (!ret) {
+                cat_update_last_error_with_previous("Socket sendfile wait failed");
+            } else {
+                cat_update_last_error(CAT_ECANCELED, "Socket sendfile has been canceled");
+            }
+            goto _error;
+        }
+    }
+
+    if (0) {
+        _error:
+        nsent = (size_t) -1;
+    }
+    if (poller != NULL) {
+        uv_close((uv_handle_t *) &poller->poll, cat_socket_sendfile_poller_close_callback);
+    }
+
+    return (ssize_t) nsent;
+}
+#endif
+
+/* copy file data to buffer and write it, it works for all kinds of sockets (e.g. SSL) */
+static ssize_t cat_socket_sendfile_chunked(cat_socket_t *socket, int file, int64_t offset, size_t length, cat_timeout_t timeout)
+{
+    char *buffer;
+    size_t nsent = 0;
+
+    buffer = (char *) cat_malloc(CAT_SOCKET_SENDFILE_CHUNK_SIZE);
+    if (unlikely(buffer == NULL)) {
+        cat_update_last_error_of_syscall("Malloc for sendfile buffer failed");
+        return -1;
+    }
+    while (length == 0 || nsent < length) {
+        size_t size = length == 0 ? CAT_SOCKET_SENDFILE_CHUNK_SIZE : CAT_MIN(length - nsent, CAT_SOCKET_SENDFILE_CHUNK_SIZE);
+        cat_socket_write_vector_t vector;
+        ssize_t n;
+        cat_bool_t ret;
+        n = cat_fs_pread(file, buffer, size, offset + nsent);
+        if (unlikely(n < 0)) {
+            cat_update_last_error_with_previous("Socket sendfile read file failed");
+            goto _error;
+        }
+        if (n == 0) {
+            break; /* EOF */
+        }
+        vector = cat_socket_write_vector_init(buffer, (cat_socket_vector_length_t) n);
+        /* socket may be closed during reading, so we always use the public API here */
+        CAT_TIME_WAIT_START() {
+            ret = cat_socket_write_ex(socket, &vector, 1, timeout);
+        } CAT_TIME_WAIT_END(timeout);
+        if (unlikely(!ret)) {
+            cat_update_last_error_with_previous("Socket sendfile failed");
+            goto _error;
+        }
+        nsent += n;
+    }
+
+    if (0) {
+        _error:
+        nsent = (size_t) -1;
+    }
+    cat_free(buffer);
+
+    return (ssize_t) nsent;
+}
+
+static ssize_t cat_socket__sendfile(cat_socket_t *socket, int file, int64_t offset, size_t length, cat_timeout_t timeout)
+{
+    CAT_SOCKET_STREAM_ONLY(socket, return -1);
+    CAT_SOCKET_IO_CHECK(socket, isocket, CAT_SOCKET_IO_FLAG_NONE);
+
+#ifdef CAT_OS_LINUX
+#ifdef CAT_SSL
+    if (isocket->ssl == NULL)
+#endif
+    {
+        return cat_socket_internal_sendfile(isocket, file, offset, length, timeout);
+    }
+#endif
+    (void) isocket;
+    return cat_socket_sendfile_chunked(socket, file, offset, length, timeout);
+}
+
 CAT_API ssize_t cat_socket_read(cat_socket_t *socket, char *buffer, size_t length)
 {
     return cat_socket__read(socket, buffer, length, 0, NULL, cat_socket_get_read_timeout_fast(socket), cat_false);
@@ -2334,6 +3178,63 @@ CAT_API cat_bool_t cat_socket_write_ex(cat_socket_t *socket, const cat_socket_wr
     return cat_socket__write(socket, vector, vector_count, NULL, 0, timeout);
 }
 
+CAT_API cat_bool_t cat_socket_write_shared(cat_socket_t *socket, cat_socket_shared_data_t *data, size_t high_water_mark)
+{
+    CAT_SOCKET_INTERNAL_GETTER(socket, isocket, return cat_false);
+    CAT_SOCKET_INTERNAL_ESTABLISHED_ONLY(isocket, return cat_false);
+
+    if (unlikely(socket->type & CAT_SOCKET_TYPE_FLAG_DGRAM)) {
+        cat_update_last_error(CAT_ENOTSUP, "Socket shared write only supports stream sockets");
+        return cat_false;
+    }
+
+    return cat_socket_internal_write_shared(isocket, data, high_water_mark);
+}
+
+CAT_API size_t cat_socket_get_write_queue_size(const cat_socket_t *socket)
+{
+    CAT_SOCKET_INTERNAL_GETTER_WITHOUT_ERROR(socket, isocket, return 0);
+
+    if (socket->type & CAT_SOCKET_TYPE_FLAG_DGRAM) {
+        return isocket->u.udp.send_queue_size;
+    }
+
+    return isocket->u.stream.write_queue_size;
+}
+
+CAT_API cat_socket_shared_data_t *cat_socket_shared_data_create(const cat_socket_write_vector_t *vector, unsigned int vector_count)
+{
+    size_t length = cat_socket_write_vector_length(vector, vector_count);
+    cat_socket_shared_data_t *data;
+    char *p;
+
+    data = (cat_socket_shared_data_t *) cat_malloc(offsetof(cat_socket_shared_data_t, value) + length);
+    if (unlikely(data == NULL)) {
+        cat_update_last_error_of_syscall("Malloc for shared data failed");
+        return NULL;
+    }
+    data->refcount = 1;
+    data->length = length;
+    for (p = data->value; vector_count > 0; vector++, vector_count--) {
+        memcpy(p, vector->base, vector->length);
+        p += vector->length;
+    }
+
+    return data;
+}
+
+CAT_API void cat_socket_shared_data_addref(cat_socket_shared_data_t *data)
+{
+    data->refcount++;
+}
+
+CAT_API void cat_socket_shared_data_release(cat_socket_shared_data_t *data)
+{
+    if (--data->refcount == 0) {
+        cat_free(data);
+    }
+}
+
 CAT_API ssize_t cat_socket_read_from(cat_socket_t *socket, char *buffer, size_t size, char *name, size_t *name_length, int *port)
 {
     return cat_socket__read_from(socket, buffer, size, name, name_length, port, cat_socket_get_read_timeout_fast(socket));
@@ -2421,8 +3322,21 @@ static ssize_t cat_socket_internal_peekfrom(
 )
 {
     CAT_SOCKET_INTERNAL_FD_GETTER(isocket, fd, return cat_false);
+    const cat_socket_sticky_read_buffer_t *read_buffer = &isocket->sticky_read_buffer;
+    size_t buffered = 0;
     ssize_t nread;
 
+    if (read_buffer->length > 0) {
+        /* data read ahead comes first */
+        buffered = CAT_MIN(read_buffer->length, size);
+        memcpy(buffer, read_buffer->value + read_buffer->offset, buffered);
+        if (buffered == size) {
+            return (ssize_t) buffered;
+        }
+        buffer += buffered;
+        size -= buffered;
+    }
+
 #ifdef CAT_OS_UNIX_LIKE
     do {
 #endif
@@ -2432,6 +3346,9 @@ static ssize_t cat_socket_internal_peekfrom(
 #endif
     if (nread < 0) {
         if (unlikely(nread != CAT_EAGAIN && nread != CAT_EMSGSIZE)) {
+            if (buffered > 0) {
+                return (ssize_t) buffered;
+            }
             /* there was an unrecoverable error */
             cat_update_last_error_of_syscall("Socket peek failed");
         } else {
@@ -2440,7 +3357,37 @@ static ssize_t cat_socket_internal_peekfrom(
         }
     }
 
-    return nread;
+    return nread + buffered;
+}
+
+CAT_API ssize_t cat_socket_recv_batch(cat_socket_t *socket, cat_socket_datagram_t *datagrams, size_t count)
+{
+    return cat_socket__recv_batch(socket, datagrams, count, cat_socket_get_read_timeout_fast(socket));
+}
+
+CAT_API ssize_t cat_socket_recv_batch_ex(cat_socket_t *socket, cat_socket_datagram_t *datagrams, size_t count, cat_timeout_t timeout)
+{
+    return cat_socket__recv_batch(socket, datagrams, count, timeout);
+}
+
+CAT_API ssize_t cat_socket_send_batch(cat_socket_t *socket, const cat_socket_datagram_t *datagrams, size_t count)
+{
+    return cat_socket__send_batch(socket, datagrams, count, cat_socket_get_write_timeout_fast(socket));
+}
+
+CAT_API ssize_t cat_socket_send_batch_ex(cat_socket_t *socket, const cat_socket_datagram_t *datagrams, size_t count, cat_timeout_t timeout)
+{
+    return cat_socket__send_batch(socket, datagrams, count, timeout);
+}
+
+CAT_API ssize_t cat_socket_sendfile(cat_socket_t *socket, int file, int64_t offset, size_t length)
+{
+    return cat_socket__sendfile(socket, file, offset, length, cat_socket_get_write_timeout_fast(socket));
+}
+
+CAT_API ssize_t cat_socket_sendfile_ex(cat_socket_t *socket, int file, int64_t offset, size_t length, cat_timeout_t timeout)
+{
+    return cat_socket__sendfile(socket, file, offset, length, timeout);
 }
 
 CAT_API ssize_t cat_socket_peek(const cat_socket_t *socket, char *buffer, size_t size)
@@ -2478,6 +3425,30 @@ static cat_always_inline void cat_socket_cancel_io(cat_coroutine_t *coroutine, c
     }
 }
 
+static void cat_socket_internal_free(cat_socket_internal_t *isocket)
+{
+    if (isocket->sticky_read_buffer.value != NULL) {
+        cat_free(isocket->sticky_read_buffer.value);
+    }
+#ifdef CAT_SSL
+    if (isocket->ssl_peer_name != NULL) {
+        cat_free(isocket->ssl_peer_name);
+    }
+    if (isocket->ssl != NULL) {
+        cat_ssl_close(isocket->ssl);
+    }
+#endif
+
+    if (isocket->cache.sockname != NULL) {
+        cat_free(isocket->cache.sockname);
+    }
+    if (isocket->cache.peername != NULL) {
+        cat_free(isocket->cache.peername);
+    }
+
+    cat_free(isocket);
+}
+
 static void cat_socket_close_callback(uv_handle_t *handle)
 {
     cat_socket_internal_t *isocket = cat_container_of(handle, cat_socket_internal_t, u.handle);
@@ -2503,23 +3474,13 @@ static void cat_socket_close_callback(uv_handle_t *handle)
         }
     }
 
-#ifdef CAT_SSL
-    if (isocket->ssl_peer_name != NULL) {
-        cat_free(isocket->ssl_peer_name);
-    }
-    if (isocket->ssl != NULL) {
-        cat_ssl_close(isocket->ssl);
-    }
-#endif
-
-    if (isocket->cache.sockname != NULL) {
-        cat_free(isocket->cache.sockname);
-    }
-    if (isocket->cache.peername != NULL) {
-        cat_free(isocket->cache.peername);
+    if (unlikely(isocket->flags & CAT_SOCKET_INTERNAL_FLAG_IO_URING_READING)) {
+        /* reader is still waiting for the ring to return its buffer */
+        isocket->flags |= CAT_SOCKET_INTERNAL_FLAG_CLOSED;
+        return;
     }
 
-    cat_free(isocket);
+    cat_socket_internal_free(isocket);
 }
 
 /* Notice: socket may be freed before isocket closed, so we can not use socket anymore after IO wait failure  */
@@ -2607,6 +3568,16 @@ CAT_API cat_bool_t cat_socket_check_liveness(const cat_socket_t *socket)
     char buffer;
     ssize_t error;
 
+    if (isocket->sticky_read_buffer.length > 0) {
+        /* there is data which has not been consumed */
+        return cat_true;
+    }
+    if (unlikely(isocket->sticky_read_buffer.error != 0)) {
+        error = isocket->sticky_read_buffer.error;
+        cat_update_last_error(error == CAT_EOF ? CAT_ECONNRESET : error, "Socket connection is unavailable");
+        return cat_false;
+    }
+
 #ifdef CAT_OS_UNIX_LIKE
     do {
 #endif
@@ -2877,6 +3848,36 @@ CAT_API cat_bool_t cat_socket_set_tcp_keepalive(cat_socket_t *socket, cat_bool_t
     return cat_true;
 }
 
+CAT_API cat_bool_t cat_socket_is_sticky_read(const cat_socket_t *socket)
+{
+    CAT_SOCKET_INTERNAL_GETTER_WITHOUT_ERROR(socket, isocket, return cat_false);
+
+    return !!(isocket->flags & CAT_SOCKET_INTERNAL_FLAG_STICKY_READ);
+}
+
+CAT_API cat_bool_t cat_socket_set_sticky_read(cat_socket_t *socket, cat_bool_t enable)
+{
+    CAT_SOCKET_INTERNAL_GETTER(socket, isocket, return cat_false);
+
+    if (!enable) {
+        if (isocket->flags & CAT_SOCKET_INTERNAL_FLAG_STICKY_READ) {
+            isocket->flags ^= CAT_SOCKET_INTERNAL_FLAG_STICKY_READ;
+            /* stop it if nobody is reading now (data read ahead will still be consumed first) */
+            if (!(isocket->io_flags & CAT_SOCKET_IO_FLAG_READ) && !(socket->type & CAT_SOCKET_TYPE_FLAG_DGRAM)) {
+                uv_read_stop(&isocket->u.stream);
+            }
+        }
+        return cat_true;
+    }
+    if (unlikely(!cat_socket_type_support_sticky_read(socket->type))) {
+        cat_update_last_error(CAT_ENOTSUP, "Socket of type %s does not support sticky read", cat_socket_type_name(socket->type));
+        return cat_false;
+    }
+    isocket->flags |= CAT_SOCKET_INTERNAL_FLAG_STICKY_READ;
+
+    return cat_true;
+}
+
 CAT_API cat_bool_t cat_socket_set_tcp_accept_balance(cat_socket_t *socket, cat_bool_t enable)
 {
     CAT_SOCKET_TCP_ONLY(socket, return cat_false);
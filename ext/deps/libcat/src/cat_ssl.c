@@ -185,6 +185,12 @@ CAT_API cat_ssl_context_t *cat_ssl_context_create(cat_ssl_method_t method)
 
 CAT_API void cat_ssl_context_close(cat_ssl_context_t *context)
 {
+    cat_string_t *alpn_protocols = (cat_string_t *) SSL_CTX_get_ex_data(context, cat_ssl_context_index);
+
+    if (alpn_protocols != NULL) {
+        cat_string_close(alpn_protocols);
+        cat_free(alpn_protocols);
+    }
     SSL_CTX_free(context);
 }
 
@@ -263,6 +269,75 @@ CAT_API void cat_ssl_context_set_verify_depth(cat_ssl_context_t *context, int de
     SSL_CTX_set_verify_depth(context, depth);
 }
 
+#ifdef TLSEXT_TYPE_application_layer_protocol_negotiation
+static int cat_ssl_alpn_select_callback(cat_ssl_connection_t *connection, const unsigned char **out, unsigned char *out_length, const unsigned char *in, unsigned int in_length, void *arg)
+{
+    const cat_string_t *alpn_protocols = (const cat_string_t *) arg;
+    unsigned char *selected;
+    int error;
+
+    error = SSL_select_next_proto(
+        &selected, out_length,
+        (const unsigned char *) alpn_protocols->value, (unsigned int) alpn_protocols->length,
+        in, in_length
+    );
+    if (error != OPENSSL_NPN_NEGOTIATED) {
+        /* fallback to the default protocol (e.g. HTTP/1.1) */
+        return SSL_TLSEXT_ERR_NOACK;
+    }
+    *out = selected;
+    cat_debug(SSL, "ALPN selected \"%.*s\"", (int) *out_length, (const char *) *out);
+
+    return SSL_TLSEXT_ERR_OK;
+}
+#endif
+
+CAT_API cat_bool_t cat_ssl_context_set_alpn_protocols(cat_ssl_context_t *context, cat_bool_t is_server, const char *protocols, size_t length)
+{
+#ifdef TLSEXT_TYPE_application_layer_protocol_negotiation
+    cat_string_t *alpn_protocols;
+
+    if (unlikely(length == 0 || length > UINT16_MAX)) {
+        cat_update_last_error(CAT_EINVAL, "SSL ALPN protocols length is invalid");
+        return cat_false;
+    }
+    if (!is_server) {
+        /* notice: it returns 0 on success */
+        if (unlikely(SSL_CTX_set_alpn_protos(context, (const unsigned char *) protocols, (unsigned int) length) != 0)) {
+            cat_ssl_update_last_error(CAT_ESSL, "SSL_CTX_set_alpn_protos() failed");
+            return cat_false;
+        }
+        return cat_true;
+    }
+    alpn_protocols = (cat_string_t *) SSL_CTX_get_ex_data(context, cat_ssl_context_index);
+    if (alpn_protocols == NULL) {
+        alpn_protocols = (cat_string_t *) cat_malloc(sizeof(*alpn_protocols));
+        if (unlikely(alpn_protocols == NULL)) {
+            cat_update_last_error_of_syscall("Malloc for SSL ALPN protocols failed");
+            return cat_false;
+        }
+        cat_string_init(alpn_protocols);
+        if (unlikely(SSL_CTX_set_ex_data(context, cat_ssl_context_index, alpn_protocols) != 1)) {
+            cat_free(alpn_protocols);
+            cat_ssl_update_last_error(CAT_ESSL, "SSL_CTX_set_ex_data() failed");
+            return cat_false;
+        }
+    }
+    cat_string_close(alpn_protocols);
+    cat_string_init(alpn_protocols);
+    if (unlikely(!cat_string_create(alpn_protocols, protocols, length))) {
+        cat_update_last_error_of_syscall("Malloc for SSL ALPN protocols failed");
+        return cat_false;
+    }
+    SSL_CTX_set_alpn_select_cb(context, cat_ssl_alpn_select_callback, alpn_protocols);
+
+    return cat_true;
+#else
+    cat_update_last_error(CAT_ENOTSUP, "SSL library version is too low to support ALPN");
+    return cat_false;
+#endif
+}
+
 CAT_API cat_ssl_t *cat_ssl_create(cat_ssl_t *ssl, cat_ssl_context_t *context)
 {
     if (ssl == NULL) {
@@ -440,6 +515,22 @@ CAT_API cat_bool_t cat_ssl_set_passphrase(cat_ssl_t *ssl, const char *passphrase
     return cat_true;
 }
 
+CAT_API const char *cat_ssl_get_alpn_protocol(const cat_ssl_t *ssl, size_t *length)
+{
+#ifdef TLSEXT_TYPE_application_layer_protocol_negotiation
+    const unsigned char *protocol = NULL;
+    unsigned int protocol_length = 0;
+
+    SSL_get0_alpn_selected(ssl->connection, &protocol, &protocol_length);
+    *length = protocol_length;
+
+    return protocol_length != 0 ? (const char *) protocol : NULL;
+#else
+    *length = 0;
+    return NULL;
+#endif
+}
+
 CAT_API cat_bool_t cat_ssl_is_established(const cat_ssl_t *ssl)
 {
     return ssl->flags & CAT_SSL_FLAG_HANDSHAKED;
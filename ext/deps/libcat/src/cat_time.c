@@ -28,6 +28,48 @@
 #include "windows.h"
 #endif
 
+CAT_API CAT_GLOBALS_DECLARE(cat_time)
+
+CAT_GLOBALS_CTOR_DECLARE_SZ(cat_time)
+
+typedef struct
+{
+    union {
+        uv_handle_t handle;
+        uv_timer_t timer;
+    } u;
+    cat_coroutine_t *coroutine;
+    cat_queue_node_t node;
+} cat_timer_t;
+
+CAT_API cat_bool_t cat_time_module_init(void)
+{
+    CAT_GLOBALS_REGISTER(cat_time, CAT_GLOBALS_CTOR(cat_time), NULL);
+    return cat_true;
+}
+
+CAT_API cat_bool_t cat_time_runtime_init(void)
+{
+    cat_queue_init(&CAT_TIME_G(timer_pool));
+    CAT_TIME_G(timer_pool_count) = 0;
+
+    return cat_true;
+}
+
+CAT_API cat_bool_t cat_time_runtime_shutdown(void)
+{
+    cat_timer_t *timer;
+
+    /* idle timers are still open, close them and let the event loop free them */
+    while ((timer = cat_queue_front_data(&CAT_TIME_G(timer_pool), cat_timer_t, node))) {
+        cat_queue_remove(&timer->node);
+        uv_close(&timer->u.handle, (uv_close_cb) cat_free_function);
+    }
+    CAT_TIME_G(timer_pool_count) = 0;
+
+    return cat_true;
+}
+
 CAT_API cat_nsec_t cat_time_nsec(void)
 {
     return uv_hrtime();
@@ -82,16 +124,9 @@ CAT_API char *cat_time_format_msec(cat_msec_t msec)
 #undef SECOND
 }
 
-typedef union
-{
-    cat_coroutine_t *coroutine;
-    uv_handle_t handle;
-    uv_timer_t timer;
-} cat_timer_t;
-
 static void cat_sleep_timer_callback(uv_timer_t* handle)
 {
-    cat_timer_t *timer = (cat_timer_t *) handle;
+    cat_timer_t *timer = cat_container_of(handle, cat_timer_t, u.timer);
     cat_coroutine_t *coroutine = timer->coroutine;
 
     timer->coroutine = NULL;
@@ -101,20 +136,58 @@ static void cat_sleep_timer_callback(uv_timer_t* handle)
     }
 }
 
-static cat_timer_t *cat_timer_wait(cat_msec_t msec)
+static cat_always_inline cat_timer_t *cat_timer_acquire(void)
 {
     cat_timer_t *timer;
-    cat_bool_t ret;
 
-    timer = (cat_timer_t *) cat_malloc(sizeof(*timer));;
+    timer = cat_queue_front_data(&CAT_TIME_G(timer_pool), cat_timer_t, node);
+
+    if (likely(timer != NULL)) {
+        cat_queue_remove(&timer->node);
+        CAT_TIME_G(timer_pool_count)--;
+        return timer;
+    }
+
+    timer = (cat_timer_t *) cat_malloc(sizeof(*timer));
 
     if (unlikely(timer == NULL)) {
         cat_update_last_error_of_syscall("Malloc for timer failed");
         return NULL;
     }
 
-    (void) uv_timer_init(cat_event_loop, &timer->timer);
-    (void) uv_timer_start(&timer->timer, cat_sleep_timer_callback, msec, 0);
+    (void) uv_timer_init(cat_event_loop, &timer->u.timer);
+
+    return timer;
+}
+
+static cat_always_inline void cat_timer_release(cat_timer_t *timer)
+{
+    /* it is no-op if timer has been expired */
+    (void) uv_timer_stop(&timer->u.timer);
+
+    if (likely(CAT_TIME_G(timer_pool_count) < CAT_TIME_TIMER_POOL_MAX_SIZE)) {
+        cat_queue_push_back(&CAT_TIME_G(timer_pool), &timer->node);
+        CAT_TIME_G(timer_pool_count)++;
+    } else {
+        uv_close(&timer->u.handle, (uv_close_cb) cat_free_function);
+    }
+}
+
+/* returns cat_false if yield failed,
+ * otherwise expired shows whether the timer has been expired or we were canceled,
+ * and reserve is the left time when we were canceled (if it was required) */
+static cat_bool_t cat_timer_wait(cat_msec_t msec, cat_bool_t *expired, cat_msec_t *reserve)
+{
+    cat_timer_t *timer;
+    cat_bool_t ret;
+
+    timer = cat_timer_acquire();
+
+    if (unlikely(timer == NULL)) {
+        return cat_false;
+    }
+
+    (void) uv_timer_start(&timer->u.timer, cat_sleep_timer_callback, msec, 0);
 #ifdef CAT_DEBUG
     do {
         char *tmp = NULL;
@@ -127,14 +200,19 @@ static cat_timer_t *cat_timer_wait(cat_msec_t msec)
 
     ret = cat_coroutine_yield(NULL, NULL);
 
-    uv_close(&timer->handle, (uv_close_cb) cat_free_function);
+    *expired = timer->coroutine == NULL;
+    if (reserve != NULL && !*expired) {
+        *reserve = timer->u.timer.timeout - cat_event_loop->time;
+    }
+
+    cat_timer_release(timer);
 
     if (unlikely(!ret)) {
         cat_update_last_error_with_previous("Time sleep failed");
-        return NULL;
+        return cat_false;
     }
 
-    return timer;
+    return cat_true;
 }
 
 CAT_API cat_bool_t cat_time_wait(cat_timeout_t timeout)
@@ -142,14 +220,12 @@ CAT_API cat_bool_t cat_time_wait(cat_timeout_t timeout)
     if (timeout < 0) {
         return cat_coroutine_yield(NULL, NULL);
     } else {
-        cat_timer_t *timer;
-
-        timer = cat_timer_wait(timeout);
+        cat_bool_t expired;
 
-        if (unlikely(timer == NULL)) {
+        if (unlikely(!cat_timer_wait(timeout, &expired, NULL))) {
             return cat_false;
         }
-        if (unlikely(timer->coroutine == NULL)) {
+        if (unlikely(expired)) {
             cat_update_last_error(CAT_ETIMEDOUT, "Timed out for " CAT_TIMEOUT_FMT " ms", timeout);
             return cat_false;
         }
@@ -169,18 +245,16 @@ CAT_API unsigned int cat_time_sleep(unsigned int seconds)
 
 CAT_API cat_msec_t cat_time_msleep(cat_msec_t msec)
 {
-    cat_timer_t *timer;
-
-    timer = cat_timer_wait(msec);
+    cat_bool_t expired;
+    cat_msec_t reserve;
 
-    if (unlikely(timer == NULL)) {
+    cat_coroutine_set_wait_type(CAT_COROUTINE_WAIT_TYPE_TIMER);
+    if (unlikely(!cat_timer_wait(msec, &expired, &reserve))) {
         return -1;
     }
 
-    if (unlikely(timer->coroutine != NULL)) {
-        cat_msec_t reserve;
+    if (unlikely(!expired)) {
         cat_update_last_error(CAT_ECANCELED, "Time waiter has been canceled");
-        reserve = timer->timer.timeout - cat_event_loop->time;
         if (unlikely(reserve <= 0)) {
             /* blocking IO lead it to be negative or 0
              * we can not know the real reserve time */
@@ -68,6 +68,9 @@ static void cat_watch_dog_loop(void* arg)
         } else {
             watch_dog->alert_count = 0;
         }
+        if (watch_dog->sampler != NULL) {
+            watch_dog->sampler(watch_dog);
+        }
     }
 }
 
@@ -125,6 +128,7 @@ CAT_API cat_bool_t cat_watch_dog_run(cat_watch_dog_t *watch_dog, cat_nsec_t quan
     watch_dog->quantum = cat_watch_dog_align_quantum(quantum);
     watch_dog->threshold = cat_watch_dog_align_threshold(threshold);
     watch_dog->alerter = alerter != NULL ? alerter : cat_watch_dog_alert_standard;
+    watch_dog->sampler = NULL;
     watch_dog->alert_count = 0;
     watch_dog->stop = cat_false;
     watch_dog->pid = uv_os_getpid();
@@ -214,6 +218,22 @@ CAT_API cat_bool_t cat_watch_dog_stop(void)
     return cat_true;
 }
 
+CAT_API cat_bool_t cat_watch_dog_set_sampler(cat_watch_dog_sampler_t sampler)
+{
+    cat_watch_dog_t *watch_dog = CAT_WATCH_DOG_G(watch_dog);
+
+    if (watch_dog == NULL) {
+        cat_update_last_error(CAT_EMISUSE, "Watch-Dog is not running");
+        return cat_false;
+    }
+
+    /* Notice: it is read by watch-dog thread without lock,
+     * the sampler may still be called once after it was unset */
+    watch_dog->sampler = sampler;
+
+    return cat_true;
+}
+
 CAT_API cat_bool_t cat_watch_dog_is_running(void)
 {
     return CAT_WATCH_DOG_G(watch_dog) != NULL;
@@ -28,6 +28,22 @@ CAT_API const char* cat_websocket_opcode_name(cat_websocket_opcode_t opcode)
     return "UNKNOWN";
 }
 
+CAT_API cat_bool_t cat_websocket_opcode_is_valid(cat_websocket_opcode_t opcode)
+{
+    switch(opcode) {
+#define CAT_WEBSOCKET_OPCODE_VALID_GEN(name, value) case value:
+        CAT_WEBSOCKET_OPCODE_MAP(CAT_WEBSOCKET_OPCODE_VALID_GEN)
+#undef CAT_WEBSOCKET_OPCODE_VALID_GEN
+            return cat_true;
+    }
+    return cat_false;
+}
+
+CAT_API cat_bool_t cat_websocket_opcode_is_control(cat_websocket_opcode_t opcode)
+{
+    return (opcode & 0x8) != 0;
+}
+
 CAT_API const char* cat_websocket_status_get_description(cat_websocket_status_code_t code)
 {
     switch(code)
@@ -40,6 +56,31 @@ CAT_API const char* cat_websocket_status_get_description(cat_websocket_status_co
     return "Unknown websocket status code";
 }
 
+CAT_API cat_bool_t cat_websocket_status_code_is_valid(cat_websocket_status_code_t code)
+{
+    if (code >= 3000 && code <= 4999) {
+        /* reserved for libraries, frameworks and applications */
+        return cat_true;
+    }
+    switch (code) {
+        case CAT_WEBSOCKET_STATUS_NORMAL_CLOSURE:
+        case CAT_WEBSOCKET_STATUS_GOING_AWAY:
+        case CAT_WEBSOCKET_STATUS_PROTOCOL_ERROR:
+        case CAT_WEBSOCKET_STATUS_UNSUPPORTED_DATA:
+        case CAT_WEBSOCKET_STATUS_INVALID_FRAME_PAYLOAD_DATA:
+        case CAT_WEBSOCKET_STATUS_POLICY_VIOLATION:
+        case CAT_WEBSOCKET_STATUS_MESSAGE_TOO_BIG:
+        case CAT_WEBSOCKET_STATUS_MISSING_EXTENSION:
+        case CAT_WEBSOCKET_STATUS_INTERNAL_ERROR:
+        case CAT_WEBSOCKET_STATUS_SERVICE_RESTART:
+        case CAT_WEBSOCKET_STATUS_TRY_AGAIN_LATER:
+        case CAT_WEBSOCKET_STATUS_BAD_GATEWAY:
+            return cat_true;
+        /* NO_STATUS_RECEIVED, ABNORMAL_CLOSURE and TLS_HANDSHAKE must not be set in close frames */
+    }
+    return cat_false;
+}
+
 CAT_API void cat_websocket_header_init(cat_websocket_header_t *header)
 {
     memset(header, 0, sizeof(*header));
@@ -81,18 +122,20 @@ CAT_API uint8_t cat_websocket_header_pack(cat_websocket_header_t *header, char *
     if (likely(header->payload_length <= CAT_WEBSOCKET_EXT8_MAX_LENGTH)) {
         header->len = header->payload_length;
     } else if (likely(header->payload_length <= CAT_WEBSOCKET_EXT16_MAX_LENGTH)) {
+        uint16_t payload_length = htons(header->payload_length);
         if (unlikely(p + sizeof(uint16_t) > pe)) {
             return 0;
         }
         header->len = CAT_WEBSOCKET_EXT16_LENGTH;
-        *((uint16_t *) p) = htons(header->payload_length);
+        memcpy(p, &payload_length, sizeof(payload_length));
         p += sizeof(uint16_t);
     } else {
+        uint64_t payload_length = cat_hton64(header->payload_length);
         if (unlikely(p + sizeof(uint64_t) > pe)) {
             return 0;
         }
         header->len = CAT_WEBSOCKET_EXT64_LENGTH;
-        *((uint64_t *) p) = cat_hton64(header->payload_length);
+        memcpy(p, &payload_length, sizeof(payload_length));
         p += sizeof(uint64_t);
     }
     memcpy(buffer, header, CAT_WEBSOCKET_HEADER_LENGTH);
@@ -122,16 +165,20 @@ CAT_API uint8_t cat_websocket_header_unpack(cat_websocket_header_t *header, cons
     if (header->len < CAT_WEBSOCKET_EXT16_LENGTH) {
         header->payload_length = header->len;
     } else if (header->len != CAT_WEBSOCKET_EXT64_LENGTH) {
+        uint16_t payload_length;
         if (unlikely(p + sizeof(uint16_t) > pe)) {
             return 0;
         }
-        header->payload_length = ntohs(*((uint16_t *) p));
+        memcpy(&payload_length, p, sizeof(payload_length));
+        header->payload_length = ntohs(payload_length);
         p += sizeof(uint16_t);
     } else {
+        uint64_t payload_length;
         if (unlikely(p + sizeof(uint64_t) > pe)) {
             return 0;
         }
-        header->payload_length = cat_ntoh64(*((uint64_t *) p));
+        memcpy(&payload_length, p, sizeof(payload_length));
+        header->payload_length = cat_ntoh64(payload_length);
         p += sizeof(uint64_t);
     }
 
@@ -146,46 +193,392 @@ CAT_API uint8_t cat_websocket_header_unpack(cat_websocket_header_t *header, cons
     return p - data;
 }
 
-CAT_API void cat_websocket_mask(char *to, char *from, uint64_t length, const char *mask_key)
+/* mask kernels: each one XORs [from, from + length) with the mask key (started at key[0]) into to,
+ * to may be equal to from, no alignment is required */
+
+typedef void (*cat_websocket_mask_function_t)(char *to, const char *from, size_t length, const char *mask_key);
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CAT_WEBSOCKET_MASK_USE_X86 1
+#include <immintrin.h>
+#define CAT_WEBSOCKET_MASK_TARGET(features) __attribute__((target(features)))
+#elif defined(_MSC_VER) && defined(_M_X64)
+/* SSE2 is always available on x64, AVX kernels need GCC/Clang for now */
+#define CAT_WEBSOCKET_MASK_USE_X64_MSVC 1
+#include <emmintrin.h>
+#define CAT_WEBSOCKET_MASK_TARGET(features)
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define CAT_WEBSOCKET_MASK_USE_NEON 1
+#include <arm_neon.h>
+#endif
+
+static cat_always_inline void cat_websocket_mask_bytes(char *to, const char *from, size_t start, size_t end, const char *mask_key)
 {
-    if (memcmp(mask_key, CAT_STRS(CAT_WEBSOCKET_EMPTY_MASK_KEY)) == 0) {
-        return;
+    size_t i;
+
+    for (i = start; i < end; i++) {
+        to[i] = from[i] ^ mask_key[i & 3];
+    }
+}
+
+/* mask byte by byte until "to" is aligned (or the end), returns the number of bytes processed */
+static cat_always_inline size_t cat_websocket_mask_head(char *to, const char *from, size_t length, const char *mask_key, size_t alignment)
+{
+    size_t n = (alignment - (((uintptr_t) to) & (alignment - 1))) & (alignment - 1);
+
+    if (n > length) {
+        n = length;
+    }
+    cat_websocket_mask_bytes(to, from, 0, n, mask_key);
+
+    return n;
+}
+
+/* mask key rotated by offset, as a native 32-bit word */
+static cat_always_inline uint32_t cat_websocket_mask_key_u32(const char *mask_key, size_t offset)
+{
+    char rotated[CAT_WEBSOCKET_MASK_KEY_LENGTH];
+    uint32_t key;
+    size_t i;
+
+    for (i = 0; i < CAT_WEBSOCKET_MASK_KEY_LENGTH; i++) {
+        rotated[i] = mask_key[(offset + i) & 3];
     }
-#ifndef CAT_L64
-    uint64_t i = 0;
+    memcpy(&key, rotated, sizeof(key));
+
+    return key;
+}
+
+static void cat_websocket_mask_generic(char *to, const char *from, size_t length, const char *mask_key)
+{
+    uint64_t key = cat_websocket_mask_key_u32(mask_key, 0);
+    size_t i = 0;
+
+    key |= key << 32;
+    /* memcpy() keeps it alignment-safe, compilers turn it into plain loads/stores */
+    for (; i + 8 <= length; i += 8) {
+        uint64_t chunk;
+        memcpy(&chunk, from + i, sizeof(chunk));
+        chunk ^= key;
+        memcpy(to + i, &chunk, sizeof(chunk));
+    }
+    cat_websocket_mask_bytes(to, from, i, length, mask_key);
+}
+
+#if defined(CAT_WEBSOCKET_MASK_USE_X86) || defined(CAT_WEBSOCKET_MASK_USE_X64_MSVC)
+CAT_WEBSOCKET_MASK_TARGET("sse2")
+static void cat_websocket_mask_sse2(char *to, const char *from, size_t length, const char *mask_key)
+{
+    size_t i = cat_websocket_mask_head(to, from, length, mask_key, 16);
+    __m128i key = _mm_set1_epi32((int) cat_websocket_mask_key_u32(mask_key, i));
+
+    for (; i + 64 <= length; i += 64) {
+        __m128i a = _mm_loadu_si128((const __m128i *) (from + i));
+        __m128i b = _mm_loadu_si128((const __m128i *) (from + i + 16));
+        __m128i c = _mm_loadu_si128((const __m128i *) (from + i + 32));
+        __m128i d = _mm_loadu_si128((const __m128i *) (from + i + 48));
+        _mm_store_si128((__m128i *) (to + i), _mm_xor_si128(a, key));
+        _mm_store_si128((__m128i *) (to + i + 16), _mm_xor_si128(b, key));
+        _mm_store_si128((__m128i *) (to + i + 32), _mm_xor_si128(c, key));
+        _mm_store_si128((__m128i *) (to + i + 48), _mm_xor_si128(d, key));
+    }
+    for (; i + 16 <= length; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *) (from + i));
+        _mm_store_si128((__m128i *) (to + i), _mm_xor_si128(a, key));
+    }
+    cat_websocket_mask_bytes(to, from, i, length, mask_key);
+}
+#endif
+
+#ifdef CAT_WEBSOCKET_MASK_USE_X86
+CAT_WEBSOCKET_MASK_TARGET("avx2")
+static void cat_websocket_mask_avx2(char *to, const char *from, size_t length, const char *mask_key)
+{
+    size_t i = cat_websocket_mask_head(to, from, length, mask_key, 32);
+    __m256i key = _mm256_set1_epi32((int) cat_websocket_mask_key_u32(mask_key, i));
+
+    for (; i + 128 <= length; i += 128) {
+        __m256i a = _mm256_loadu_si256((const __m256i *) (from + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *) (from + i + 32));
+        __m256i c = _mm256_loadu_si256((const __m256i *) (from + i + 64));
+        __m256i d = _mm256_loadu_si256((const __m256i *) (from + i + 96));
+        _mm256_store_si256((__m256i *) (to + i), _mm256_xor_si256(a, key));
+        _mm256_store_si256((__m256i *) (to + i + 32), _mm256_xor_si256(b, key));
+        _mm256_store_si256((__m256i *) (to + i + 64), _mm256_xor_si256(c, key));
+        _mm256_store_si256((__m256i *) (to + i + 96), _mm256_xor_si256(d, key));
+    }
+    for (; i + 32 <= length; i += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i *) (from + i));
+        _mm256_store_si256((__m256i *) (to + i), _mm256_xor_si256(a, key));
+    }
+    _mm256_zeroupper();
+    cat_websocket_mask_bytes(to, from, i, length, mask_key);
+}
+
+CAT_WEBSOCKET_MASK_TARGET("avx512f")
+static void cat_websocket_mask_avx512(char *to, const char *from, size_t length, const char *mask_key)
+{
+    size_t i = cat_websocket_mask_head(to, from, length, mask_key, 64);
+    __m512i key = _mm512_set1_epi32((int) cat_websocket_mask_key_u32(mask_key, i));
+
+    for (; i + 256 <= length; i += 256) {
+        __m512i a = _mm512_loadu_si512((const void *) (from + i));
+        __m512i b = _mm512_loadu_si512((const void *) (from + i + 64));
+        __m512i c = _mm512_loadu_si512((const void *) (from + i + 128));
+        __m512i d = _mm512_loadu_si512((const void *) (from + i + 192));
+        _mm512_store_si512((void *) (to + i), _mm512_xor_si512(a, key));
+        _mm512_store_si512((void *) (to + i + 64), _mm512_xor_si512(b, key));
+        _mm512_store_si512((void *) (to + i + 128), _mm512_xor_si512(c, key));
+        _mm512_store_si512((void *) (to + i + 192), _mm512_xor_si512(d, key));
+    }
+    for (; i + 64 <= length; i += 64) {
+        __m512i a = _mm512_loadu_si512((const void *) (from + i));
+        _mm512_store_si512((void *) (to + i), _mm512_xor_si512(a, key));
+    }
+    _mm256_zeroupper();
+    cat_websocket_mask_bytes(to, from, i, length, mask_key);
+}
+#endif
+
+#ifdef CAT_WEBSOCKET_MASK_USE_NEON
+static void cat_websocket_mask_neon(char *to, const char *from, size_t length, const char *mask_key)
+{
+    size_t i = cat_websocket_mask_head(to, from, length, mask_key, 16);
+    uint8x16_t key = vreinterpretq_u8_u32(vdupq_n_u32(cat_websocket_mask_key_u32(mask_key, i)));
+
+    for (; i + 64 <= length; i += 64) {
+        uint8x16_t a = vld1q_u8((const uint8_t *) (from + i));
+        uint8x16_t b = vld1q_u8((const uint8_t *) (from + i + 16));
+        uint8x16_t c = vld1q_u8((const uint8_t *) (from + i + 32));
+        uint8x16_t d = vld1q_u8((const uint8_t *) (from + i + 48));
+        vst1q_u8((uint8_t *) (to + i), veorq_u8(a, key));
+        vst1q_u8((uint8_t *) (to + i + 16), veorq_u8(b, key));
+        vst1q_u8((uint8_t *) (to + i + 32), veorq_u8(c, key));
+        vst1q_u8((uint8_t *) (to + i + 48), veorq_u8(d, key));
+    }
+    for (; i + 16 <= length; i += 16) {
+        uint8x16_t a = vld1q_u8((const uint8_t *) (from + i));
+        vst1q_u8((uint8_t *) (to + i), veorq_u8(a, key));
+    }
+    cat_websocket_mask_bytes(to, from, i, length, mask_key);
+}
+#endif
+
+static const struct {
+    const char *name;
+    cat_websocket_mask_function_t function;
+} cat_websocket_mask_kernels[CAT_WEBSOCKET_MASK_KERNEL_COUNT] = {
+    { "generic", cat_websocket_mask_generic },
+#if defined(CAT_WEBSOCKET_MASK_USE_X86) || defined(CAT_WEBSOCKET_MASK_USE_X64_MSVC)
+    { "sse2", cat_websocket_mask_sse2 },
 #else
-    uint64_t i, chunk = length / 8;
-    if (chunk > 0) {
-        uint64_t mask_key_u64 = ((uint64_t) (*((uint32_t *) mask_key)) << 32) | *((uint32_t *) mask_key);
-        for (i = 0; i < chunk; i++) {
-            ((uint64_t *) to)[i] = ((uint64_t *) from)[i] ^ mask_key_u64;
-        }
+    { "sse2", NULL },
+#endif
+#ifdef CAT_WEBSOCKET_MASK_USE_X86
+    { "avx2", cat_websocket_mask_avx2 },
+    { "avx512", cat_websocket_mask_avx512 },
+#else
+    { "avx2", NULL },
+    { "avx512", NULL },
+#endif
+#ifdef CAT_WEBSOCKET_MASK_USE_NEON
+    { "neon", cat_websocket_mask_neon },
+#else
+    { "neon", NULL },
+#endif
+};
+
+/* resolved on the first use (it is idempotent, so races are harmless) */
+static cat_websocket_mask_kernel_t cat_websocket_mask_kernel = CAT_WEBSOCKET_MASK_KERNEL_COUNT;
+
+CAT_API const char *cat_websocket_mask_kernel_name(cat_websocket_mask_kernel_t kernel)
+{
+    if (unlikely(kernel >= CAT_WEBSOCKET_MASK_KERNEL_COUNT)) {
+        return "unknown";
+    }
+    return cat_websocket_mask_kernels[kernel].name;
+}
+
+CAT_API cat_bool_t cat_websocket_mask_kernel_is_available(cat_websocket_mask_kernel_t kernel)
+{
+    if (unlikely(kernel >= CAT_WEBSOCKET_MASK_KERNEL_COUNT ||
+                 cat_websocket_mask_kernels[kernel].function == NULL)) {
+        return cat_false;
+    }
+#ifdef CAT_WEBSOCKET_MASK_USE_X86
+    __builtin_cpu_init();
+    switch (kernel) {
+        case CAT_WEBSOCKET_MASK_KERNEL_SSE2:
+            return !!__builtin_cpu_supports("sse2");
+        case CAT_WEBSOCKET_MASK_KERNEL_AVX2:
+            return !!__builtin_cpu_supports("avx2");
+        case CAT_WEBSOCKET_MASK_KERNEL_AVX512:
+            return !!__builtin_cpu_supports("avx512f");
+        default:
+            break;
     }
-    i = chunk * 8;
 #endif
-    for (; i < length; i++) {
-        to[i] = from[i] ^ mask_key[i % CAT_WEBSOCKET_MASK_KEY_LENGTH];
+    return cat_true;
+}
+
+CAT_API cat_websocket_mask_kernel_t cat_websocket_mask_kernel_get(void)
+{
+    if (unlikely(cat_websocket_mask_kernel == CAT_WEBSOCKET_MASK_KERNEL_COUNT)) {
+        cat_websocket_mask_kernel_t kernel = CAT_WEBSOCKET_MASK_KERNEL_COUNT;
+        /* the later the better */
+        while (kernel-- > CAT_WEBSOCKET_MASK_KERNEL_GENERIC) {
+            if (cat_websocket_mask_kernel_is_available(kernel)) {
+                break;
+            }
+        }
+        cat_websocket_mask_kernel = kernel;
     }
+
+    return cat_websocket_mask_kernel;
 }
 
-CAT_API void cat_websocket_unmask(char *data, uint64_t length, const char *mask_key)
+CAT_API cat_bool_t cat_websocket_mask_kernel_set(cat_websocket_mask_kernel_t kernel)
+{
+    if (unlikely(!cat_websocket_mask_kernel_is_available(kernel))) {
+        cat_update_last_error(CAT_ENOTSUP, "WebSocket mask kernel \"%s\" is not available", cat_websocket_mask_kernel_name(kernel));
+        return cat_false;
+    }
+    cat_websocket_mask_kernel = kernel;
+
+    return cat_true;
+}
+
+CAT_API void cat_websocket_mask_ex(char *to, const char *from, uint64_t length, const char *mask_key, uint64_t index)
 {
-    if (memcmp(mask_key, CAT_STRS(CAT_WEBSOCKET_EMPTY_MASK_KEY)) == 0) {
+    char rotated_mask_key[CAT_WEBSOCKET_MASK_KEY_LENGTH];
+
+    if (memcmp(mask_key, CAT_WEBSOCKET_EMPTY_MASK_KEY, CAT_WEBSOCKET_MASK_KEY_LENGTH) == 0) {
+        if (to != from) {
+            memmove(to, from, length);
+        }
         return;
     }
-#ifndef CAT_L64
-    uint64_t i = 0;
-#else
-    uint64_t i, chunk = length / 8;
-    if (chunk > 0) {
-        uint64_t mask_key_u64 = ((uint64_t) (*((uint32_t *) mask_key)) << 32) | *((uint32_t *) mask_key);
-        for (i = 0; i < chunk; i++) {
-            ((uint64_t *) data)[i] ^= mask_key_u64;
+    if ((index & 3) != 0) {
+        size_t i;
+        for (i = 0; i < CAT_WEBSOCKET_MASK_KEY_LENGTH; i++) {
+            rotated_mask_key[i] = mask_key[(index + i) & 3];
         }
+        mask_key = rotated_mask_key;
     }
-    i = chunk * 8;
+
+    cat_websocket_mask_kernels[cat_websocket_mask_kernel_get()].function(to, from, length, mask_key);
+}
+
+CAT_API void cat_websocket_mask(char *to, char *from, uint64_t length, const char *mask_key)
+{
+    cat_websocket_mask_ex(to, from, length, mask_key, 0);
+}
+
+CAT_API void cat_websocket_unmask(char *data, uint64_t length, const char *mask_key)
+{
+    cat_websocket_mask_ex(data, data, length, mask_key, 0);
+}
+
+/* UTF-8 validation: ASCII is skipped in blocks (vectorized if possible),
+ * the others go through a small state machine,
+ * state is (remaining continuation bytes << 16) | (upper bound << 8) | lower bound
+ * of the next continuation byte */
+
+#define CAT_WEBSOCKET_UTF8_STATE(remaining, lower, upper) \
+    ((((uint32_t) (remaining)) << 16) | (((uint32_t) (upper)) << 8) | ((uint32_t) (lower)))
+
+#if (defined(CAT_WEBSOCKET_MASK_USE_X86) && defined(__SSE2__)) || defined(CAT_WEBSOCKET_MASK_USE_X64_MSVC)
+#define CAT_WEBSOCKET_UTF8_ASCII_BLOCK_SIZE 32
+static cat_always_inline cat_bool_t cat_websocket_utf8_block_is_ascii(const uint8_t *p)
+{
+    __m128i a = _mm_loadu_si128((const __m128i *) p);
+    __m128i b = _mm_loadu_si128((const __m128i *) (p + 16));
+
+    return _mm_movemask_epi8(_mm_or_si128(a, b)) == 0;
+}
+#elif defined(CAT_WEBSOCKET_MASK_USE_NEON) && defined(__aarch64__)
+#define CAT_WEBSOCKET_UTF8_ASCII_BLOCK_SIZE 32
+static cat_always_inline cat_bool_t cat_websocket_utf8_block_is_ascii(const uint8_t *p)
+{
+    uint8x16_t v = vorrq_u8(vld1q_u8(p), vld1q_u8(p + 16));
+
+    return vmaxvq_u8(v) < 0x80;
+}
+#else
+#define CAT_WEBSOCKET_UTF8_ASCII_BLOCK_SIZE 16
+static cat_always_inline cat_bool_t cat_websocket_utf8_block_is_ascii(const uint8_t *p)
+{
+    uint64_t a, b;
+
+    memcpy(&a, p, sizeof(a));
+    memcpy(&b, p + sizeof(a), sizeof(b));
+
+    return ((a | b) & UINT64_C(0x8080808080808080)) == 0;
+}
 #endif
-    for (; i < length; i++) {
-        data[i] ^= mask_key[i % CAT_WEBSOCKET_MASK_KEY_LENGTH];
+
+CAT_API cat_bool_t cat_websocket_utf8_validate(cat_websocket_utf8_state_t *state, const char *data, size_t length)
+{
+    const uint8_t *p = (const uint8_t *) data, *pe = p + length;
+    uint32_t remaining = *state >> 16;
+    uint8_t lower = *state & 0xff, upper = (*state >> 8) & 0xff;
+
+    while (p < pe) {
+        uint8_t c;
+        if (remaining == 0) {
+            while ((size_t) (pe - p) >= CAT_WEBSOCKET_UTF8_ASCII_BLOCK_SIZE &&
+                    cat_websocket_utf8_block_is_ascii(p)) {
+                p += CAT_WEBSOCKET_UTF8_ASCII_BLOCK_SIZE;
+            }
+            if (p == pe) {
+                break;
+            }
+            c = *p++;
+            if (c < 0x80) {
+                continue;
+            }
+            lower = 0x80;
+            upper = 0xbf;
+            if (c >= 0xc2 && c <= 0xdf) {
+                remaining = 1;
+            } else if (c >= 0xe0 && c <= 0xef) {
+                remaining = 2;
+                if (c == 0xe0) {
+                    lower = 0xa0; /* overlong */
+                } else if (c == 0xed) {
+                    upper = 0x9f; /* surrogates */
+                }
+            } else if (c >= 0xf0 && c <= 0xf4) {
+                remaining = 3;
+                if (c == 0xf0) {
+                    lower = 0x90; /* overlong */
+                } else if (c == 0xf4) {
+                    upper = 0x8f; /* > U+10FFFF */
+                }
+            } else {
+                return cat_false;
+            }
+            continue;
+        }
+        c = *p++;
+        if (unlikely(c < lower || c > upper)) {
+            return cat_false;
+        }
+        remaining--;
+        lower = 0x80;
+        upper = 0xbf;
     }
+
+    *state = remaining == 0 ? CAT_WEBSOCKET_UTF8_ACCEPT : CAT_WEBSOCKET_UTF8_STATE(remaining, lower, upper);
+
+    return cat_true;
+}
+
+CAT_API cat_bool_t cat_websocket_utf8_check(const char *data, size_t length)
+{
+    cat_websocket_utf8_state_t state = CAT_WEBSOCKET_UTF8_ACCEPT;
+
+    return cat_websocket_utf8_validate(&state, data, length) && state == CAT_WEBSOCKET_UTF8_ACCEPT;
 }
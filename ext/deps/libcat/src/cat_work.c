@@ -21,6 +21,10 @@
 #include "cat_event.h"
 #include "cat_time.h"
 
+CAT_API CAT_GLOBALS_DECLARE(cat_work)
+
+CAT_GLOBALS_CTOR_DECLARE_SZ(cat_work)
+
 typedef struct
 {
     union {
@@ -29,8 +33,10 @@ typedef struct
         uv_work_t work;
     } request;
     cat_work_function_t function;
+    cat_data_dtor_t cleanup;
     cat_data_t *data;
     int status;
+    cat_bool_t done;
 } cat_work_context_t;
 
 void cat_work_callback(uv_work_t *request)
@@ -45,15 +51,24 @@ static void cat_work_after_done(uv_work_t *request, int status)
 
     if (likely(context->request.coroutine != NULL)) {
         context->status = status;
+        context->done = cat_true;
         if (unlikely(!cat_coroutine_resume(context->request.coroutine, NULL, NULL))) {
             cat_core_error_with_last(WORK, "Work schedule failed");
         }
+    } else if (context->cleanup != NULL) {
+        /* waiter has gone, we own the data now */
+        context->cleanup(context->data);
     }
 
     cat_free(context);
 }
 
 CAT_API cat_bool_t cat_work(cat_work_function_t function, cat_data_t *data, cat_timeout_t timeout)
+{
+    return cat_work_ex(NULL, function, NULL, data, timeout);
+}
+
+CAT_API cat_bool_t cat_work_ex(cat_work_pool_t *pool, cat_work_function_t function, cat_data_dtor_t cleanup, cat_data_t *data, cat_timeout_t timeout)
 {
     cat_work_context_t *context = (cat_work_context_t *) cat_malloc(sizeof(*context));
     int error;
@@ -61,33 +76,213 @@ CAT_API cat_bool_t cat_work(cat_work_function_t function, cat_data_t *data, cat_
 
     if (unlikely(context == NULL)) {
         cat_update_last_error_of_syscall("Malloc for work context failed");
-        return cat_false;
+        goto _error;
     }
     context->function = function;
+    context->cleanup = cleanup;
     context->data = data;
-    error = uv_queue_work(cat_event_loop, &context->request.work, cat_work_callback, cat_work_after_done);
+    error = uv_queue_work_ex(cat_event_loop, &context->request.work, pool, cat_work_callback, cat_work_after_done);
     if (unlikely(error != 0)) {
         cat_update_last_error_with_reason(error, "Work queue failed");
-        return cat_false;
+        cat_free(context);
+        goto _error;
     }
     context->status = CAT_ECANCELED;
+    context->done = cat_false;
     context->request.coroutine = CAT_COROUTINE_G(current);
     ret = cat_time_wait(timeout);
     context->request.coroutine = NULL;
-    if (unlikely(!ret)) {
-        cat_update_last_error_with_previous("Work wait failed");
+    if (unlikely(!context->done)) {
+        /* work may be still running on the thread,
+         * data will be cleaned up in after_done() */
+        if (!ret) {
+            cat_update_last_error_with_previous("Work wait failed");
+        } else {
+            cat_update_last_error(CAT_ECANCELED, "Work has been canceled");
+        }
         (void) uv_cancel(&context->request.req);
         return cat_false;
     }
     if (unlikely(context->status != 0)) {
-        if (context->status == CAT_ECANCELED) {
-            cat_update_last_error(CAT_ECANCELED, "Work has been canceled");
-            (void) uv_cancel(&context->request.req);
-        } else {
-            cat_update_last_error_with_reason(context->status, "Work failed");
+        cat_update_last_error_with_reason(context->status, "Work failed");
+        goto _error;
+    }
+
+    return cat_true;
+
+    _error:
+    if (cleanup != NULL) {
+        cleanup(data);
+    }
+    return cat_false;
+}
+
+/* pool */
+
+CAT_API cat_work_pool_t *cat_work_pool_create(const char *name, size_t size, size_t max_queue_size, int priority)
+{
+    cat_work_pool_t *pool;
+    int error;
+
+    if (unlikely(name == NULL || *name == '\0' || strlen(name) >= CAT_WORK_POOL_NAME_SIZE)) {
+        cat_update_last_error(CAT_EINVAL, "Work pool name must be non-empty and shorter than %d", CAT_WORK_POOL_NAME_SIZE);
+        return NULL;
+    }
+    if (unlikely(size == 0 || size > UINT_MAX || max_queue_size > UINT_MAX)) {
+        cat_update_last_error(CAT_EINVAL, "Work pool size is invalid");
+        return NULL;
+    }
+    if (unlikely(cat_work_pool_get(name) != NULL)) {
+        cat_update_last_error(CAT_EEXIST, "Work pool \"%s\" already exists", name);
+        return NULL;
+    }
+    if (unlikely(CAT_WORK_G(pool_count) == CAT_WORK_POOL_MAX_COUNT)) {
+        cat_update_last_error(CAT_ENOSPC, "Too many work pools (max %d)", CAT_WORK_POOL_MAX_COUNT);
+        return NULL;
+    }
+
+    error = uv_threadpool_create(&pool, name, (unsigned int) size, (unsigned int) max_queue_size, priority);
+    if (unlikely(error != 0)) {
+        cat_update_last_error_with_reason(error, "Work pool create failed");
+        return NULL;
+    }
+    CAT_WORK_G(pools)[CAT_WORK_G(pool_count)++] = pool;
+
+    return pool;
+}
+
+CAT_API cat_bool_t cat_work_pool_close(cat_work_pool_t *pool)
+{
+    size_t i, n;
+    int error;
+
+    for (n = 0; n < CAT_WORK_G(pool_count); n++) {
+        if (CAT_WORK_G(pools)[n] == pool) {
+            break;
         }
+    }
+    if (unlikely(n == CAT_WORK_G(pool_count))) {
+        cat_update_last_error(CAT_EINVAL, "Work pool \"%s\" can not be closed", uv_threadpool_name(pool));
         return cat_false;
     }
 
+    error = uv_threadpool_close(pool);
+    if (unlikely(error != 0)) {
+        cat_update_last_error_with_reason(error, "Work pool \"%s\" close failed", uv_threadpool_name(pool));
+        return cat_false;
+    }
+    for (i = 0; i < CAT_WORK_KIND_COUNT; i++) {
+        if (uv_loop_get_threadpool(cat_event_loop, (uv_threadpool_kind_t) i) == pool) {
+            uv_loop_set_threadpool(cat_event_loop, (uv_threadpool_kind_t) i, NULL);
+        }
+    }
+    CAT_WORK_G(pool_count)--;
+    memmove(&CAT_WORK_G(pools)[n], &CAT_WORK_G(pools)[n + 1], (CAT_WORK_G(pool_count) - n) * sizeof(CAT_WORK_G(pools)[0]));
+
+    return cat_true;
+}
+
+CAT_API cat_work_pool_t *cat_work_pool_get_default(void)
+{
+    return uv_threadpool_default();
+}
+
+CAT_API cat_work_pool_t *cat_work_pool_get(const char *name)
+{
+    size_t i;
+
+    if (strcmp(name, CAT_WORK_POOL_DEFAULT_NAME) == 0) {
+        return cat_work_pool_get_default();
+    }
+    for (i = 0; i < CAT_WORK_G(pool_count); i++) {
+        cat_work_pool_t *pool = CAT_WORK_G(pools)[i];
+        if (strcmp(uv_threadpool_name(pool), name) == 0) {
+            return pool;
+        }
+    }
+
+    return NULL;
+}
+
+CAT_API cat_work_pool_t *cat_work_pool_get_by_index(size_t index)
+{
+    if (index == 0) {
+        return cat_work_pool_get_default();
+    }
+    if (index > CAT_WORK_G(pool_count)) {
+        return NULL;
+    }
+
+    return CAT_WORK_G(pools)[index - 1];
+}
+
+CAT_API size_t cat_work_pool_get_count(void)
+{
+    return CAT_WORK_G(pool_count) + 1;
+}
+
+CAT_API const char *cat_work_pool_get_name(const cat_work_pool_t *pool)
+{
+    return uv_threadpool_name(pool);
+}
+
+CAT_API int cat_work_pool_get_priority(const cat_work_pool_t *pool)
+{
+    return uv_threadpool_priority(pool);
+}
+
+CAT_API void cat_work_pool_set_max_queue_size(cat_work_pool_t *pool, size_t max_queue_size)
+{
+    uv_threadpool_set_max_queue_size(pool, (unsigned int) CAT_MIN(max_queue_size, UINT_MAX));
+}
+
+CAT_API void cat_work_pool_get_stats(cat_work_pool_t *pool, cat_work_pool_stats_t *stats)
+{
+    uv_threadpool_get_stats(pool, stats);
+}
+
+CAT_API void cat_work_pool_reset_stats(cat_work_pool_t *pool)
+{
+    uv_threadpool_reset_stats(pool);
+}
+
+/* kind */
+
+CAT_API cat_work_pool_t *cat_work_get_pool(cat_work_kind_t kind)
+{
+    return uv_loop_get_threadpool(cat_event_loop, (uv_threadpool_kind_t) kind);
+}
+
+CAT_API void cat_work_set_pool(cat_work_kind_t kind, cat_work_pool_t *pool)
+{
+    uv_loop_set_threadpool(cat_event_loop, (uv_threadpool_kind_t) kind, pool);
+}
+
+/* module/runtime */
+
+CAT_API cat_bool_t cat_work_module_init(void)
+{
+    CAT_GLOBALS_REGISTER(cat_work, CAT_GLOBALS_CTOR(cat_work), NULL);
+    return cat_true;
+}
+
+CAT_API cat_bool_t cat_work_runtime_init(void)
+{
+    CAT_WORK_G(pool_count) = 0;
+
+    return cat_true;
+}
+
+CAT_API cat_bool_t cat_work_runtime_shutdown(void)
+{
+    /* all works should have been done since event loop has stopped */
+    while (CAT_WORK_G(pool_count) > 0) {
+        cat_work_pool_t *pool = CAT_WORK_G(pools)[CAT_WORK_G(pool_count) - 1];
+        if (unlikely(!cat_work_pool_close(pool))) {
+            cat_warn_with_last(WORK, "Work pool \"%s\" is leaked", cat_work_pool_get_name(pool));
+            CAT_WORK_G(pool_count)--;
+        }
+    }
+
     return cat_true;
 }
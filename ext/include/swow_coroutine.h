@@ -31,6 +31,9 @@ extern "C" {
 #define SWOW_COROUTINE_DEFAULT_STACK_PAGE_SIZE (4 * 1024)
 #define SWOW_COROUTINE_MAX_STACK_PAGE_SIZE     (256 * 1024)
 
+/* the executor pool is disabled by default */
+#define SWOW_COROUTINE_DEFAULT_EXECUTOR_POOL_SIZE 0
+
 #if PHP_VERSION_ID >= 80000
 #define SWOW_COROUTINE_SWAP_JIT_GLOBALS     1
 #endif
@@ -103,6 +106,9 @@ typedef struct
     cat_coroutine_t coroutine;
     /* php things... */
     int exit_status;
+    /* how long it can run without yielding before it is preempted by watch-dog,
+     * 0 means the time slice of watch-dog, and negative means it is never preempted */
+    cat_nsec_t time_slice;
     swow_coroutine_executor_t *executor;
     zend_object std;
 } swow_coroutine_t;
@@ -148,6 +154,13 @@ CAT_GLOBALS_STRUCT_BEGIN(swow_coroutine)
     swow_coroutine_rated_t rated;
 #endif
     zval ztransfer_data;
+    /* recycled VM stack pages of finished coroutines (executors are at the beginning of them),
+     * they are linked by prev, and all of them are in the size of default_stack_page_size */
+    zend_vm_stack executor_pool;
+    uint32_t executor_pool_count;
+    uint32_t executor_pool_size;
+    zend_ulong executor_pool_hits;
+    zend_ulong executor_pool_misses;
 CAT_GLOBALS_STRUCT_END(swow_coroutine)
 
 typedef zval *(*swow_coroutine_resume_t)(swow_coroutine_t *scoroutine, zval *zdata);
@@ -253,6 +266,10 @@ SWOW_API swow_coroutine_t *swow_coroutine_get_previous(const swow_coroutine_t *s
 SWOW_API size_t swow_coroutine_set_default_stack_page_size(size_t size);
 SWOW_API size_t swow_coroutine_set_default_c_stack_size(size_t size);
 SWOW_API void swow_coroutine_set_readonly(cat_bool_t enable);
+/* executors of finished coroutines are recycled with their VM stack pages (C stacks are pooled by libcat),
+ * size is the max number of them in pool, 0 means disabled */
+SWOW_API uint32_t swow_coroutine_set_executor_pool_size(uint32_t size);
+SWOW_API uint32_t swow_coroutine_clear_executor_pool(void);
 
 /* globals (getter) */
 SWOW_API swow_coroutine_t *swow_coroutine_get_current(void);
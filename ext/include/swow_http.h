@@ -37,6 +37,9 @@ typedef struct
     cat_http_parser_t parser;
     size_t data_offset;
     size_t parsed_length;
+    /* head mode: header table and the copy of the head which it refers to */
+    cat_http_header_table_t header_table;
+    cat_buffer_t head;
     zend_object std;
 } swow_http_parser_t;
 
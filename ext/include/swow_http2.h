@@ -0,0 +1,64 @@
+/*
+  +--------------------------------------------------------------------------+
+  | Swow                                                                     |
+  +--------------------------------------------------------------------------+
+  | Licensed under the Apache License, Version 2.0 (the "License");          |
+  | you may not use this file except in compliance with the License.         |
+  | You may obtain a copy of the License at                                  |
+  | http://www.apache.org/licenses/LICENSE-2.0                               |
+  | Unless required by applicable law or agreed to in writing, software      |
+  | distributed under the License is distributed on an "AS IS" BASIS,        |
+  | WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. |
+  | See the License for the specific language governing permissions and      |
+  | limitations under the License. See accompanying LICENSE file.            |
+  +--------------------------------------------------------------------------+
+  | Author: Twosee <twosee@php.net>                                          |
+  +--------------------------------------------------------------------------+
+ */
+
+#ifndef SWOW_HTTP2_H
+#define SWOW_HTTP2_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "swow.h"
+
+#include "cat_http2.h"
+
+extern SWOW_API zend_class_entry *swow_http2_frame_type_ce;
+
+extern SWOW_API zend_class_entry *swow_http2_flag_ce;
+
+extern SWOW_API zend_class_entry *swow_http2_setting_ce;
+
+extern SWOW_API zend_class_entry *swow_http2_error_code_ce;
+
+extern SWOW_API zend_class_entry *swow_http2_hpack_ce;
+extern SWOW_API zend_object_handlers swow_http2_hpack_handlers;
+
+extern SWOW_API zend_class_entry *swow_http2_exception_ce;
+
+typedef struct
+{
+    cat_hpack_t hpack;
+    /* header blocks are encoded into it */
+    cat_buffer_t buffer;
+    zend_object std;
+} swow_http2_hpack_t;
+
+/* loader */
+
+int swow_http2_module_init(INIT_FUNC_ARGS);
+
+/* helper*/
+
+static cat_always_inline swow_http2_hpack_t* swow_http2_hpack_get_from_object(zend_object *object)
+{
+    return cat_container_of(object, swow_http2_hpack_t, std);
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* SWOW_HTTP2_H */
@@ -31,6 +31,12 @@ extern SWOW_API zend_object_handlers swow_socket_handlers;
 
 extern SWOW_API zend_class_entry *swow_socket_exception_ce;
 
+/* upper bounds of recvBatch() arguments, buffers of them are allocated at once */
+#define SWOW_SOCKET_MAX_BATCH_COUNT   (CAT_SOCKET_BATCH_SIZE * 16)
+#define SWOW_SOCKET_MAX_DATAGRAM_SIZE (64 * 1024)
+/* fewer datagrams are received at once if count * size exceeds it */
+#define SWOW_SOCKET_MAX_BATCH_BUFFER_SIZE (1024 * 1024)
+
 typedef struct
 {
     cat_socket_t socket;
@@ -41,6 +47,7 @@ typedef struct
 
 int swow_socket_module_init(INIT_FUNC_ARGS);
 int swow_socket_runtime_init(INIT_FUNC_ARGS);
+int swow_socket_runtime_shutdown(SHUTDOWN_FUNC_ARGS);
 
 /* helper*/
 
@@ -28,6 +28,19 @@ extern "C" {
 #undef AF_UNIX
 #endif
 
+#ifndef PHP_WIN32
+#define SWOW_STREAM_ASYNC_FILE_IO 1
+#endif
+
+/* reading or writing on regular files which is not larger than it
+ * is done synchronously, it is usually served by page cache and
+ * much cheaper than a round-trip to the thread-pool
+ * (it must be less than the PHP stream chunk size (8192),
+ * otherwise buffered reads and writes never go asynchronously) */
+#ifndef SWOW_STREAM_FILE_SYNC_IO_THRESHOLD
+#define SWOW_STREAM_FILE_SYNC_IO_THRESHOLD 4096
+#endif
+
 extern SWOW_API const php_stream_ops swow_stream_generic_socket_ops;
 extern SWOW_API const php_stream_ops swow_stream_tcp_socket_ops;
 extern SWOW_API const php_stream_ops swow_stream_udp_socket_ops;
@@ -31,6 +31,11 @@ extern SWOW_API zend_object_handlers swow_watch_dog_handlers;
 
 extern SWOW_API zend_class_entry *swow_watch_dog_exception_ce;
 
+/* frames deeper than it are truncated (from the outermost one) */
+#define SWOW_WATCH_DOG_PROFILER_MAX_DEPTH 128
+/* samples of new stacks are counted into "{dropped}" after there are so many different stacks */
+#define SWOW_WATCH_DOG_PROFILER_MAX_STACKS 16384
+
 typedef struct
 {
     cat_watch_dog_t watch_dog;
@@ -39,6 +44,15 @@ typedef struct
     cat_msec_t delay;
     zval zalerter;
     zend_fcall_info_cache alerter;
+    /* coroutine is preempted (or alerter is called)
+     * after it has run for more than it without yielding */
+    cat_nsec_t time_slice;
+    /* profiler */
+    zend_bool profiling;
+    zend_bool profiling_per_coroutine;
+    zend_bool sample_requested;
+    /* folded stack => count, it is only accessed in the PHP thread */
+    HashTable *samples;
 } swow_watch_dog_t;
 
 /* loader */
@@ -62,11 +76,17 @@ static cat_always_inline swow_watch_dog_t *swow_watch_dog_get_current(void)
 
 /* APIs */
 
-SWOW_API cat_bool_t swow_watch_dog_run(cat_usec_t quantum, cat_nsec_t threshold, zval *zalerter);
+SWOW_API cat_bool_t swow_watch_dog_run(cat_usec_t quantum, cat_nsec_t threshold, zval *zalerter, cat_nsec_t time_slice);
 SWOW_API cat_bool_t swow_watch_dog_stop(void);
 
 SWOW_API void swow_watch_dog_alert_standard(cat_watch_dog_t *watch_dog);
 
+SWOW_API cat_bool_t swow_watch_dog_start_profiling(cat_bool_t per_coroutine);
+SWOW_API cat_bool_t swow_watch_dog_stop_profiling(void);
+/* returns NULL if there is no sample */
+SWOW_API HashTable *swow_watch_dog_get_samples(void);
+SWOW_API zend_string *swow_watch_dog_get_folded_samples(void);
+
 #ifdef __cplusplus
 }
 #endif
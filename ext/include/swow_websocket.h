@@ -24,6 +24,7 @@ extern "C" {
 
 #include "swow.h"
 #include "swow_buffer.h"
+#include "swow_socket.h"
 
 #include "cat_websocket.h"
 
@@ -34,6 +35,11 @@ extern SWOW_API zend_class_entry *swow_websocket_status_ce;
 extern SWOW_API zend_class_entry *swow_websocket_frame_ce;
 extern SWOW_API zend_object_handlers swow_websocket_frame_handlers;
 
+extern SWOW_API zend_class_entry *swow_websocket_connection_ce;
+extern SWOW_API zend_object_handlers swow_websocket_connection_handlers;
+
+extern SWOW_API zend_class_entry *swow_websocket_exception_ce;
+
 typedef struct
 {
     cat_websocket_header_t header;
@@ -42,6 +48,31 @@ typedef struct
     zend_object std;
 } swow_websocket_frame_t;
 
+#define SWOW_WEBSOCKET_DEFAULT_MAX_MESSAGE_SIZE (16 * 1024 * 1024)
+/* broadcast skips the targets which have more pending data than it */
+#define SWOW_WEBSOCKET_DEFAULT_BROADCAST_HIGH_WATER_MARK (1024 * 1024)
+
+typedef struct swow_websocket_deflate_s swow_websocket_deflate_t;
+
+typedef struct
+{
+    /* Swow\Socket */
+    zend_object *socket;
+    /* frames are read ahead into it */
+    cat_buffer_t buffer;
+    size_t buffer_offset;
+    size_t max_message_size;
+    /* server expects masked frames and sends unmasked ones, client does the opposite */
+    cat_bool_t is_server;
+    cat_bool_t receiving;
+    cat_bool_t sending;
+    cat_bool_t close_sent;
+    /* NULL if permessage-deflate is not enabled */
+    swow_websocket_deflate_t *deflate;
+    ZEND_GET_GC_BUFFER_DECLARE;
+    zend_object std;
+} swow_websocket_connection_t;
+
 /* loader */
 
 int swow_websocket_module_init(INIT_FUNC_ARGS);
@@ -53,6 +84,11 @@ static cat_always_inline swow_websocket_frame_t* swow_websocket_frame_get_from_o
     return cat_container_of(object, swow_websocket_frame_t, std);
 }
 
+static cat_always_inline swow_websocket_connection_t* swow_websocket_connection_get_from_object(zend_object *object)
+{
+    return cat_container_of(object, swow_websocket_connection_t, std);
+}
+
 #ifdef __cplusplus
 }
 #endif
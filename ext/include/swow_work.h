@@ -0,0 +1,43 @@
+/*
+  +--------------------------------------------------------------------------+
+  | Swow                                                                     |
+  +--------------------------------------------------------------------------+
+  | Licensed under the Apache License, Version 2.0 (the "License");          |
+  | you may not use this file except in compliance with the License.         |
+  | You may obtain a copy of the License at                                  |
+  | http://www.apache.org/licenses/LICENSE-2.0                               |
+  | Unless required by applicable law or agreed to in writing, software      |
+  | distributed under the License is distributed on an "AS IS" BASIS,        |
+  | WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. |
+  | See the License for the specific language governing permissions and      |
+  | limitations under the License. See accompanying LICENSE file.            |
+  +--------------------------------------------------------------------------+
+  | Author: Twosee <twosee@php.net>                                          |
+  +--------------------------------------------------------------------------+
+ */
+
+#ifndef SWOW_WORK_H
+#define SWOW_WORK_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "swow.h"
+
+#include "cat_work.h"
+
+extern SWOW_API zend_class_entry *swow_work_ce;
+extern SWOW_API zend_object_handlers swow_work_handlers;
+
+extern SWOW_API zend_class_entry *swow_work_exception_ce;
+
+/* loader */
+
+int swow_work_module_init(INIT_FUNC_ARGS);
+int swow_work_runtime_init(INIT_FUNC_ARGS);
+int swow_work_runtime_shutdown(INIT_FUNC_ARGS);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* SWOW_WORK_H */
@@ -29,9 +29,12 @@
 #include "swow_stream.h"
 #include "swow_signal.h"
 #include "swow_watch_dog.h"
+#include "swow_work.h"
 #include "swow_debug.h"
 #include "swow_http.h"
 #include "swow_websocket.h"
+#include "swow_http2.h"
+#include "swow_metrics.h"
 
 #include "cat_api.h"
 
@@ -86,9 +89,12 @@ PHP_MINIT_FUNCTION(swow)
         swow_stream_module_init,
         swow_signal_module_init,
         swow_watch_dog_module_init,
+        swow_work_module_init,
         swow_debug_module_init,
         swow_http_module_init,
         swow_websocket_module_init,
+        swow_http2_module_init,
+        swow_metrics_module_init,
     };
 
     size_t i = 0;
@@ -174,6 +180,7 @@ PHP_RINIT_FUNCTION(swow)
         swow_runtime_init,
         swow_coroutine_runtime_init,
         swow_event_runtime_init,
+        swow_work_runtime_init,
         swow_socket_runtime_init,
         swow_stream_runtime_init,
         swow_watch_dog_runtime_init,
@@ -206,6 +213,8 @@ PHP_RSHUTDOWN_FUNCTION(swow)
         swow_watch_dog_runtime_shudtown,
         swow_stream_runtime_shutdown,
         swow_event_runtime_shutdown,
+        swow_work_runtime_shutdown,
+        swow_socket_runtime_shutdown,
         swow_coroutine_runtime_shutdown,
         swow_runtime_shutdown,
     };
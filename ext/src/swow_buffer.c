@@ -205,6 +205,23 @@ static void swow_buffer_separate_by_handle(cat_buffer_t *buffer)
     } \
 } while (0)
 
+SWOW_API cat_bool_t swow_buffer_reserve_writable_space(swow_buffer_t *sbuffer, size_t size)
+{
+    CAT_BUFFER_GETTER(sbuffer, buffer);
+
+    if (EXPECTED(buffer->value != NULL && buffer->size - sbuffer->offset >= size)) {
+        SWOW_BUFFER_TRY_UNSHARED(sbuffer, buffer);
+        return cat_true;
+    }
+    SWOW_BUFFER_UNSHARED_CHECK_START(sbuffer, buffer) {
+        if (UNEXPECTED(!cat_buffer_extend(buffer, sbuffer->offset + size))) {
+            return cat_false;
+        }
+    } SWOW_BUFFER_UNSHARED_CHECK_END(sbuffer, buffer);
+
+    return cat_true;
+}
+
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Buffer_alignSize, ZEND_RETURN_VALUE, 0, IS_LONG, 0)
     ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, size, IS_LONG, 0, "0")
     ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, alignment, IS_LONG, 0, "0")
@@ -341,9 +341,9 @@ static HashTable *swow_channel_get_gc(ZEND_GET_GC_PARAMATERS)
 
     ZEND_GET_GC_BUFFER_CREATE(schannel, channel->length);
 
-    CAT_QUEUE_FOREACH_DATA_START(&channel->u.buffered.storage, cat_channel_bucket_t, node, bucket) {
-        ZEND_GET_GC_BUFFER_ADD((zval *) bucket->data);
-    } CAT_QUEUE_FOREACH_DATA_END();
+    CAT_CHANNEL_BUFFERED_FOREACH_DATA_START(channel, data) {
+        ZEND_GET_GC_BUFFER_ADD((zval *) data);
+    } CAT_CHANNEL_BUFFERED_FOREACH_DATA_END();
 
     ZEND_GET_GC_BUFFER_DONE();
 }
@@ -66,6 +66,57 @@ static cat_always_inline size_t swow_coroutine_align_stack_page_size(size_t size
     return size;
 }
 
+/* executor pool */
+
+static cat_always_inline zend_vm_stack swow_coroutine_executor_pool_pop(size_t stack_page_size)
+{
+    zend_vm_stack vm_stack = SWOW_COROUTINE_G(executor_pool);
+
+    if (vm_stack == NULL || stack_page_size != SWOW_COROUTINE_G(default_stack_page_size)) {
+        if (SWOW_COROUTINE_G(executor_pool_size) != 0) {
+            SWOW_COROUTINE_G(executor_pool_misses)++;
+        }
+        return NULL;
+    }
+    SWOW_COROUTINE_G(executor_pool) = vm_stack->prev;
+    SWOW_COROUTINE_G(executor_pool_count)--;
+    SWOW_COROUTINE_G(executor_pool_hits)++;
+
+    return vm_stack;
+}
+
+/* vm_stack must be the first page (which the executor belongs to) */
+static cat_always_inline cat_bool_t swow_coroutine_executor_pool_push(zend_vm_stack vm_stack)
+{
+    size_t stack_page_size = ((char *) vm_stack->end) - ((char *) vm_stack);
+
+    if (SWOW_COROUTINE_G(executor_pool_count) >= SWOW_COROUTINE_G(executor_pool_size) ||
+        stack_page_size != SWOW_COROUTINE_G(default_stack_page_size) ||
+        SWOW_COROUTINE_G(runtime_state) != SWOW_COROUTINE_RUNTIME_STATE_RUNNING) {
+        return cat_false;
+    }
+    vm_stack->prev = SWOW_COROUTINE_G(executor_pool);
+    SWOW_COROUTINE_G(executor_pool) = vm_stack;
+    SWOW_COROUTINE_G(executor_pool_count)++;
+
+    return cat_true;
+}
+
+static uint32_t swow_coroutine_executor_pool_trim(uint32_t count)
+{
+    uint32_t n = 0;
+
+    while (SWOW_COROUTINE_G(executor_pool_count) > count) {
+        zend_vm_stack vm_stack = SWOW_COROUTINE_G(executor_pool);
+        SWOW_COROUTINE_G(executor_pool) = vm_stack->prev;
+        SWOW_COROUTINE_G(executor_pool_count)--;
+        efree(vm_stack);
+        n++;
+    }
+
+    return n;
+}
+
 static zend_object *swow_coroutine_create_object(zend_class_entry *ce)
 {
     swow_coroutine_t *scoroutine = swow_object_alloc(swow_coroutine_t, ce, swow_coroutine_handlers);
@@ -74,6 +125,7 @@ static zend_object *swow_coroutine_create_object(zend_class_entry *ce)
 
     scoroutine->executor = NULL;
     scoroutine->exit_status = 0;
+    scoroutine->time_slice = 0;
 
     return &scoroutine->std;
 }
@@ -327,8 +379,11 @@ static cat_bool_t swow_coroutine_construct(swow_coroutine_t *scoroutine, zval *z
         coroutine->opcodes |= SWOW_COROUTINE_OPCODE_ACCEPT_ZDATA;
         /* align stack page size */
         stack_page_size = swow_coroutine_align_stack_page_size(stack_page_size);
-        /* alloc vm stack memory */
-        vm_stack = (zend_vm_stack) emalloc(stack_page_size);
+        /* alloc vm stack memory (or reuse the one of finished coroutine) */
+        vm_stack = swow_coroutine_executor_pool_pop(stack_page_size);
+        if (vm_stack == NULL) {
+            vm_stack = (zend_vm_stack) emalloc(stack_page_size);
+        }
         /* assign the end to executor */
         executor = (swow_coroutine_executor_t *) ZEND_VM_STACK_ELEMENTS(vm_stack);
         /* init executor */
@@ -399,14 +454,17 @@ static void swow_coroutine_shutdown(swow_coroutine_t *scoroutine)
         zval_ptr_dtor(&executor->zcallable);
     }
 
-    /* free zend vm stack */
+    /* free zend vm stack (the first page which executor belongs to may be recycled) */
     if (EXPECTED(executor->vm_stack != NULL)) {
         zend_vm_stack stack = executor->vm_stack;
-        do {
+        while (stack->prev != NULL) {
             zend_vm_stack prev = stack->prev;
             efree(stack);
             stack = prev;
-        } while (stack);
+        }
+        if (!swow_coroutine_executor_pool_push(stack)) {
+            efree(stack);
+        }
     } else {
         efree(executor);
     }
@@ -812,6 +870,10 @@ SWOW_API size_t swow_coroutine_set_default_stack_page_size(size_t size)
 {
     size_t original_size = SWOW_COROUTINE_G(default_stack_page_size);
     SWOW_COROUTINE_G(default_stack_page_size) = swow_coroutine_align_stack_page_size(size);
+    if (SWOW_COROUTINE_G(default_stack_page_size) != original_size) {
+        /* pages in pool are in the original size */
+        (void) swow_coroutine_executor_pool_trim(0);
+    }
     return original_size;
 }
 
@@ -820,6 +882,19 @@ SWOW_API size_t swow_coroutine_set_default_c_stack_size(size_t size)
     return cat_coroutine_set_default_stack_size(size);
 }
 
+SWOW_API uint32_t swow_coroutine_set_executor_pool_size(uint32_t size)
+{
+    uint32_t original_size = SWOW_COROUTINE_G(executor_pool_size);
+    SWOW_COROUTINE_G(executor_pool_size) = size;
+    (void) swow_coroutine_executor_pool_trim(size);
+    return original_size;
+}
+
+SWOW_API uint32_t swow_coroutine_clear_executor_pool(void)
+{
+    return swow_coroutine_executor_pool_trim(0);
+}
+
 static cat_bool_t swow_coroutine_resume_deny(cat_coroutine_t *coroutine, cat_data_t *data, cat_data_t **retval)
 {
     cat_update_last_error(CAT_EMISUSE, "Unexpected coroutine switching");
@@ -1543,6 +1618,58 @@ static PHP_METHOD(Swow_Coroutine, getElapsedAsString)
     cat_free(elapsed);
 }
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Coroutine_getStats, ZEND_RETURN_VALUE, 0, IS_ARRAY, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Coroutine, getStats)
+{
+    const cat_coroutine_stats_t *stats;
+    zval zwait_time;
+    int type;
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    stats = cat_coroutine_get_stats(&getThisCoroutine()->coroutine);
+
+    array_init(&zwait_time);
+    for (type = 0; type < CAT_COROUTINE_WAIT_TYPE_COUNT; type++) {
+        add_assoc_long(&zwait_time, cat_coroutine_wait_type_name((cat_coroutine_wait_type_t) type), stats->wait_time[type]);
+    }
+
+    array_init(return_value);
+    add_assoc_long(return_value, "run_time", stats->run_time);
+    add_assoc_long(return_value, "switches", stats->switches);
+    add_assoc_zval(return_value, "wait_time", &zwait_time);
+    add_assoc_long(return_value, "bytes_read", stats->bytes_read);
+    add_assoc_long(return_value, "bytes_written", stats->bytes_written);
+}
+
+#define arginfo_class_Swow_Coroutine_getTimeSlice arginfo_class_Swow_Coroutine_getLong
+
+static PHP_METHOD(Swow_Coroutine, getTimeSlice)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_LONG(getThisCoroutine()->time_slice);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_THIS_INFO_EX(arginfo_class_Swow_Coroutine_setTimeSlice, 1)
+    ZEND_ARG_TYPE_INFO(0, timeSlice, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Coroutine, setTimeSlice)
+{
+    zend_long time_slice;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_LONG(time_slice)
+    ZEND_PARSE_PARAMETERS_END();
+
+    getThisCoroutine()->time_slice = time_slice;
+
+    RETURN_THIS();
+}
+
 #define arginfo_class_Swow_Coroutine_getExitStatus arginfo_class_Swow_Coroutine_getLong
 
 static PHP_METHOD(Swow_Coroutine, getExitStatus)
@@ -1925,6 +2052,113 @@ static PHP_METHOD(Swow_Coroutine, getAll)
     RETURN_ARR(zend_array_dup(map));
 }
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Coroutine_setStackPoolWatermarks, ZEND_RETURN_VALUE, 2, IS_VOID, 0)
+    ZEND_ARG_TYPE_INFO(0, lowWatermark, IS_LONG, 0)
+    ZEND_ARG_TYPE_INFO(0, highWatermark, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Coroutine, setStackPoolWatermarks)
+{
+    zend_long low_watermark;
+    zend_long high_watermark;
+
+    ZEND_PARSE_PARAMETERS_START(2, 2)
+        Z_PARAM_LONG(low_watermark)
+        Z_PARAM_LONG(high_watermark)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(low_watermark < 0 || low_watermark > UINT32_MAX)) {
+        zend_argument_value_error(1, "must be between 0 and %u", UINT32_MAX);
+        RETURN_THROWS();
+    }
+    if (UNEXPECTED(high_watermark < 0 || high_watermark > UINT32_MAX)) {
+        zend_argument_value_error(2, "must be between 0 and %u", UINT32_MAX);
+        RETURN_THROWS();
+    }
+
+    if (UNEXPECTED(!cat_coroutine_set_stack_pool_watermarks((cat_coroutine_count_t) low_watermark, (cat_coroutine_count_t) high_watermark))) {
+        swow_throw_exception_with_last(swow_coroutine_exception_ce);
+        RETURN_THROWS();
+    }
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Coroutine_getStackPoolStats, ZEND_RETURN_VALUE, 0, IS_ARRAY, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Coroutine, getStackPoolStats)
+{
+    cat_coroutine_stack_pool_stats_t stats;
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    cat_coroutine_get_stack_pool_stats(&stats);
+
+    array_init(return_value);
+    add_assoc_long(return_value, "low_watermark", stats.low_watermark);
+    add_assoc_long(return_value, "high_watermark", stats.high_watermark);
+    add_assoc_long(return_value, "hot_count", stats.hot_count);
+    add_assoc_long(return_value, "cold_count", stats.cold_count);
+    add_assoc_long(return_value, "hot_size", stats.hot_size);
+    add_assoc_long(return_value, "cold_size", stats.cold_size);
+    add_assoc_long(return_value, "hits", stats.hits);
+    add_assoc_long(return_value, "misses", stats.misses);
+    add_assoc_long(return_value, "recycled", stats.recycled);
+    add_assoc_long(return_value, "trimmed", stats.trimmed);
+    add_assoc_long(return_value, "released", stats.released);
+}
+
+#define arginfo_class_Swow_Coroutine_clearStackPool arginfo_class_Swow_Coroutine_getLong
+
+static PHP_METHOD(Swow_Coroutine, clearStackPool)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_LONG(cat_coroutine_stack_pool_clear());
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Coroutine_setExecutorPoolSize, ZEND_RETURN_VALUE, 1, IS_VOID, 0)
+    ZEND_ARG_TYPE_INFO(0, size, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Coroutine, setExecutorPoolSize)
+{
+    zend_long size;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_LONG(size)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(size < 0 || size > UINT32_MAX)) {
+        zend_argument_value_error(1, "must be between 0 and %u", UINT32_MAX);
+        RETURN_THROWS();
+    }
+
+    (void) swow_coroutine_set_executor_pool_size((uint32_t) size);
+}
+
+#define arginfo_class_Swow_Coroutine_getExecutorPoolStats arginfo_class_Swow_Coroutine_getStackPoolStats
+
+static PHP_METHOD(Swow_Coroutine, getExecutorPoolStats)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    array_init(return_value);
+    add_assoc_long(return_value, "size", SWOW_COROUTINE_G(executor_pool_size));
+    add_assoc_long(return_value, "count", SWOW_COROUTINE_G(executor_pool_count));
+    add_assoc_long(return_value, "page_size", SWOW_COROUTINE_G(default_stack_page_size));
+    add_assoc_long(return_value, "hits", SWOW_COROUTINE_G(executor_pool_hits));
+    add_assoc_long(return_value, "misses", SWOW_COROUTINE_G(executor_pool_misses));
+}
+
+#define arginfo_class_Swow_Coroutine_clearExecutorPool arginfo_class_Swow_Coroutine_getLong
+
+static PHP_METHOD(Swow_Coroutine, clearExecutorPool)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_LONG(swow_coroutine_clear_executor_pool());
+}
+
 #ifdef SWOW_COROUTINE_ENABLE_CUSTOM_ENTRY
 ZEND_BEGIN_ARG_INFO_EX(arginfo_class_Swow_Coroutine_extends, 0, ZEND_RETURN_VALUE, 1)
     ZEND_ARG_TYPE_INFO(0, class, IS_STRING, 0)
@@ -2022,6 +2256,9 @@ static const zend_function_entry swow_coroutine_methods[] = {
     PHP_ME(Swow_Coroutine, getCurrentRound,         arginfo_class_Swow_Coroutine_getCurrentRound,         ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Coroutine, getElapsed,              arginfo_class_Swow_Coroutine_getElapsed,              ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Coroutine, getElapsedAsString,      arginfo_class_Swow_Coroutine_getElapsedAsString,      ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Coroutine, getStats,                arginfo_class_Swow_Coroutine_getStats,                ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Coroutine, getTimeSlice,            arginfo_class_Swow_Coroutine_getTimeSlice,            ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Coroutine, setTimeSlice,            arginfo_class_Swow_Coroutine_setTimeSlice,            ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Coroutine, getExitStatus,           arginfo_class_Swow_Coroutine_getExitStatus,           ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Coroutine, isAvailable,             arginfo_class_Swow_Coroutine_isAvailable,             ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Coroutine, isAlive,                 arginfo_class_Swow_Coroutine_isAlive,                 ZEND_ACC_PUBLIC)
@@ -2041,6 +2278,12 @@ static const zend_function_entry swow_coroutine_methods[] = {
     PHP_ME(Swow_Coroutine, count,                   arginfo_class_Swow_Coroutine_count,                   ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Swow_Coroutine, get,                     arginfo_class_Swow_Coroutine_get,                     ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Swow_Coroutine, getAll,                  arginfo_class_Swow_Coroutine_getAll,                  ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Coroutine, setStackPoolWatermarks,  arginfo_class_Swow_Coroutine_setStackPoolWatermarks,  ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Coroutine, getStackPoolStats,       arginfo_class_Swow_Coroutine_getStackPoolStats,       ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Coroutine, clearStackPool,          arginfo_class_Swow_Coroutine_clearStackPool,          ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Coroutine, setExecutorPoolSize,     arginfo_class_Swow_Coroutine_setExecutorPoolSize,     ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Coroutine, getExecutorPoolStats,    arginfo_class_Swow_Coroutine_getExecutorPoolStats,    ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Coroutine, clearExecutorPool,       arginfo_class_Swow_Coroutine_clearExecutorPool,       ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
 #ifdef SWOW_COROUTINE_ENABLE_CUSTOM_ENTRY
     PHP_ME(Swow_Coroutine, extends,                 arginfo_class_Swow_Coroutine_extends,                 ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
 #endif
@@ -2380,6 +2623,12 @@ int swow_coroutine_runtime_init(INIT_FUNC_ARGS)
 
     SWOW_COROUTINE_G(silent_exception_in_main) = cat_false;
 
+    SWOW_COROUTINE_G(executor_pool) = NULL;
+    SWOW_COROUTINE_G(executor_pool_count) = 0;
+    SWOW_COROUTINE_G(executor_pool_size) = SWOW_COROUTINE_DEFAULT_EXECUTOR_POOL_SIZE; /* TODO: get php.ini */
+    SWOW_COROUTINE_G(executor_pool_hits) = 0;
+    SWOW_COROUTINE_G(executor_pool_misses) = 0;
+
     /* create scoroutine map */
     do {
         zval ztmp;
@@ -2430,6 +2679,9 @@ int swow_coroutine_runtime_shutdown(SHUTDOWN_FUNC_ARGS)
     zend_array_destroy(SWOW_COROUTINE_G(map));
     SWOW_COROUTINE_G(map) = NULL;
 
+    /* release recycled executors (nothing can be recycled after the runtime is not running) */
+    (void) swow_coroutine_executor_pool_trim(0);
+
     /* recover resume */
     cat_coroutine_register_resume(
         SWOW_COROUTINE_G(original_resume)
@@ -59,8 +59,82 @@ static PHP_METHOD(Swow_Event, wait)
 #endif
 }
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Event_isIoUringAvailable, ZEND_RETURN_VALUE, 0, _IS_BOOL, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Event, isIoUringAvailable)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_BOOL(cat_io_uring_is_available());
+}
+
+#define arginfo_class_Swow_Event_isIoUringEnabled arginfo_class_Swow_Event_isIoUringAvailable
+
+static PHP_METHOD(Swow_Event, isIoUringEnabled)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_BOOL(cat_io_uring_is_enabled());
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Event_setIoUringEnabled, ZEND_RETURN_VALUE, 1, IS_VOID, 0)
+    ZEND_ARG_TYPE_INFO(0, enable, _IS_BOOL, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Event, setIoUringEnabled)
+{
+    zend_bool enable;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_BOOL(enable)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (!enable) {
+        cat_io_uring_disable();
+        return;
+    }
+    if (UNEXPECTED(!cat_io_uring_enable())) {
+        swow_throw_exception_with_last(swow_exception_ce);
+        RETURN_THROWS();
+    }
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Event_getIoUringStats, ZEND_RETURN_VALUE, 0, IS_ARRAY, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Event, getIoUringStats)
+{
+    cat_io_uring_stats_t stats;
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    cat_io_uring_get_stats(&stats);
+
+    array_init(return_value);
+    add_assoc_long(return_value, "submit_calls", stats.submit_calls);
+    add_assoc_long(return_value, "submitted", stats.submitted);
+    add_assoc_long(return_value, "completed", stats.completed);
+    add_assoc_long(return_value, "canceled", stats.canceled);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Event_resetIoUringStats, ZEND_RETURN_VALUE, 0, IS_VOID, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Event, resetIoUringStats)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    cat_io_uring_reset_stats();
+}
+
 static const zend_function_entry swow_event_methods[] = {
-    PHP_ME(Swow_Event, wait, arginfo_class_Swow_Event_wait, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Event, wait,               arginfo_class_Swow_Event_wait,               ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Event, isIoUringAvailable, arginfo_class_Swow_Event_isIoUringAvailable, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Event, isIoUringEnabled,   arginfo_class_Swow_Event_isIoUringEnabled,   ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Event, setIoUringEnabled,  arginfo_class_Swow_Event_setIoUringEnabled,  ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Event, getIoUringStats,    arginfo_class_Swow_Event_getIoUringStats,    ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Event, resetIoUringStats,  arginfo_class_Swow_Event_resetIoUringStats,  ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_FE_END
 };
 
@@ -111,6 +185,14 @@ int swow_event_module_init(INIT_FUNC_ARGS)
         return FAILURE;
     }
 
+    if (!cat_time_module_init()) {
+        return FAILURE;
+    }
+
+    if (!cat_io_uring_module_init()) {
+        return FAILURE;
+    }
+
     swow_event_ce = swow_register_internal_class(
         "Swow\\Event", NULL, swow_event_methods,
         &swow_event_handlers, NULL,
@@ -136,6 +218,14 @@ int swow_event_runtime_init(INIT_FUNC_ARGS)
         return FAILURE;
     }
 
+    if (!cat_time_runtime_init()) {
+        return FAILURE;
+    }
+
+    if (!cat_io_uring_runtime_init()) {
+        return FAILURE;
+    }
+
     if (!swow_event_scheduler_run()) {
         return FAILURE;
     }
@@ -173,6 +263,16 @@ int swow_event_runtime_shutdown(SHUTDOWN_FUNC_ARGS)
         return FAILURE;
     }
 
+    /* close idle timers before the last round of event loop */
+    if (!cat_time_runtime_shutdown()) {
+        return FAILURE;
+    }
+
+    /* close the ring and its handles before the last round of event loop */
+    if (!cat_io_uring_runtime_shutdown()) {
+        return FAILURE;
+    }
+
     if (!cat_event_runtime_shutdown()) {
         return FAILURE;
     }
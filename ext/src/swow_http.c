@@ -19,6 +19,7 @@
 #include "swow_http.h"
 
 #include "swow_buffer.h"
+#include "swow_socket.h"
 
 SWOW_API zend_class_entry *swow_http_status_ce;
 
@@ -56,10 +57,22 @@ static zend_object *swow_http_parser_create_object(zend_class_entry *ce)
 
     cat_http_parser_init(&sparser->parser);
     sparser->data_offset = 0;
+    cat_http_header_table_init(&sparser->header_table);
+    cat_buffer_init(&sparser->head);
 
     return &sparser->std;
 }
 
+static void swow_http_parser_free_object(zend_object *object)
+{
+    swow_http_parser_t *sparser = swow_http_parser_get_from_object(object);
+
+    cat_http_header_table_close(&sparser->header_table);
+    cat_buffer_close(&sparser->head);
+
+    zend_object_std_dtor(&sparser->std);
+}
+
 #define getThisParser() (swow_http_parser_get_from_object(Z_OBJ_P(ZEND_THIS)))
 
 #define SWOW_HTTP_PARSER_GETTER(_sparser, _parser) \
@@ -188,6 +201,244 @@ static PHP_METHOD(Swow_Http_Parser, execute)
     RETURN_LONG(parser->event);
 }
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Http_Parser_executeHead, ZEND_RETURN_VALUE, 1, IS_LONG, 0)
+    ZEND_ARG_OBJ_INFO(0, buffer, Swow\\Buffer, 0)
+ZEND_END_ARG_INFO()
+
+/* head mode: the whole head is parsed at once into the header table,
+ * returns EVENT_HEADERS_COMPLETE, or EVENT_NONE if the head is incomplete (nothing is consumed),
+ * then the rest of message can be parsed by execute() as usual */
+static PHP_METHOD(Swow_Http_Parser, executeHead)
+{
+    SWOW_HTTP_PARSER_GETTER(sparser, parser);
+    cat_http_header_table_t *table = &sparser->header_table;
+    zval *zbuffer;
+    swow_buffer_t *sbuffer;
+    const char *buffer;
+    size_t length;
+    cat_bool_t ret;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_OBJECT_OF_CLASS(zbuffer, swow_buffer_ce)
+    ZEND_PARSE_PARAMETERS_END();
+
+    sbuffer = swow_buffer_get_from_object(Z_OBJ_P(zbuffer));
+    length = swow_buffer_get_readable_space(sbuffer, &buffer);
+
+    ret = cat_http_parser_execute_head(parser, table, buffer, length);
+
+    if (UNEXPECTED(!ret)) {
+        sparser->parsed_length = cat_http_parser_get_parsed_length(parser, buffer);
+        swow_buffer_virtual_read(sbuffer, sparser->parsed_length);
+        swow_throw_exception_with_last(swow_http_parser_exception_ce);
+        RETURN_THROWS();
+    }
+    if (parser->event == CAT_HTTP_PARSER_EVENT_NONE) {
+        sparser->parsed_length = 0;
+        RETURN_LONG(parser->event);
+    }
+    /* buffer may be changed later, keep a copy of the head (it is reused between messages) */
+    sparser->head.length = 0;
+    if (UNEXPECTED(!cat_buffer_append(&sparser->head, buffer, table->head_length))) {
+        cat_http_header_table_clear(table);
+        swow_throw_exception_with_last(swow_http_parser_exception_ce);
+        RETURN_THROWS();
+    }
+    sparser->parsed_length = table->head_length;
+    swow_buffer_virtual_read(sbuffer, sparser->parsed_length);
+
+    RETURN_LONG(parser->event);
+}
+
+#define SWOW_HTTP_PARSER_HEADER_VALUE_STR(_sparser, _header) \
+    zend_string_init((_sparser)->head.value + (_header)->value_offset, (_header)->value_length, 0)
+
+#define SWOW_HTTP_PARSER_HEADER_NAME_STR(_sparser, _header) \
+    zend_string_init((_sparser)->head.value + (_header)->name_offset, (_header)->name_length, 0)
+
+#define arginfo_class_Swow_Http_Parser_getHeaderCount arginfo_class_Swow_Http_Parser_getLong
+
+static PHP_METHOD(Swow_Http_Parser, getHeaderCount)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_LONG(getThisParser()->header_table.count);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Http_Parser_getUriOrReasonPhrase, ZEND_RETURN_VALUE, 0, IS_STRING, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Http_Parser, getUriOrReasonPhrase)
+{
+    swow_http_parser_t *sparser = getThisParser();
+    cat_http_header_table_t *table = &sparser->header_table;
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    if (table->line_length == 0) {
+        RETURN_EMPTY_STRING();
+    }
+    RETURN_STRINGL(sparser->head.value + table->line_offset, table->line_length);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Http_Parser_hasHeader, ZEND_RETURN_VALUE, 1, _IS_BOOL, 0)
+    ZEND_ARG_TYPE_INFO(0, name, IS_STRING, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Http_Parser, hasHeader)
+{
+    swow_http_parser_t *sparser = getThisParser();
+    zend_string *name;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_STR(name)
+    ZEND_PARSE_PARAMETERS_END();
+
+    RETURN_BOOL(cat_http_header_table_find(&sparser->header_table, sparser->head.value, ZSTR_VAL(name), ZSTR_LEN(name)) != NULL);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Http_Parser_getHeader, ZEND_RETURN_VALUE, 1, IS_STRING, 1)
+    ZEND_ARG_TYPE_INFO(0, name, IS_STRING, 0)
+ZEND_END_ARG_INFO()
+
+/* returns the first value of the header (case-insensitive) */
+static PHP_METHOD(Swow_Http_Parser, getHeader)
+{
+    swow_http_parser_t *sparser = getThisParser();
+    const cat_http_header_t *header;
+    zend_string *name;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_STR(name)
+    ZEND_PARSE_PARAMETERS_END();
+
+    header = cat_http_header_table_find(&sparser->header_table, sparser->head.value, ZSTR_VAL(name), ZSTR_LEN(name));
+    if (header == NULL) {
+        RETURN_NULL();
+    }
+    RETURN_STR(SWOW_HTTP_PARSER_HEADER_VALUE_STR(sparser, header));
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Http_Parser_getHeaderValues, ZEND_RETURN_VALUE, 1, IS_ARRAY, 0)
+    ZEND_ARG_TYPE_INFO(0, name, IS_STRING, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Http_Parser, getHeaderValues)
+{
+    swow_http_parser_t *sparser = getThisParser();
+    cat_http_header_table_t *table = &sparser->header_table;
+    const cat_http_header_t *header;
+    zend_string *name;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_STR(name)
+    ZEND_PARSE_PARAMETERS_END();
+
+    array_init(return_value);
+    header = cat_http_header_table_find(table, sparser->head.value, ZSTR_VAL(name), ZSTR_LEN(name));
+    while (header != NULL) {
+        add_next_index_str(return_value, SWOW_HTTP_PARSER_HEADER_VALUE_STR(sparser, header));
+        header = cat_http_header_table_find_next(table, sparser->head.value, header);
+    }
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Http_Parser_getKnownHeader, ZEND_RETURN_VALUE, 1, IS_STRING, 1)
+    ZEND_ARG_TYPE_INFO(0, id, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+/* O(1) lookup by the HEADER_* constants without hashing the name */
+static PHP_METHOD(Swow_Http_Parser, getKnownHeader)
+{
+    swow_http_parser_t *sparser = getThisParser();
+    const cat_http_header_t *header;
+    zend_long id;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_LONG(id)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(id <= CAT_HTTP_HEADER_UNKNOWN || id >= CAT_HTTP_HEADER_ID_COUNT)) {
+        zend_argument_value_error(1, "is not a known header id");
+        RETURN_THROWS();
+    }
+    header = cat_http_header_table_find_by_id(&sparser->header_table, (cat_http_header_id_t) id);
+    if (header == NULL) {
+        RETURN_NULL();
+    }
+    RETURN_STR(SWOW_HTTP_PARSER_HEADER_VALUE_STR(sparser, header));
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Http_Parser_getArray, ZEND_RETURN_VALUE, 0, IS_ARRAY, 0)
+ZEND_END_ARG_INFO()
+
+#define arginfo_class_Swow_Http_Parser_getHeaders arginfo_class_Swow_Http_Parser_getArray
+
+/* [name => [value, ...]], names are in the case they first appeared */
+static PHP_METHOD(Swow_Http_Parser, getHeaders)
+{
+    swow_http_parser_t *sparser = getThisParser();
+    cat_http_header_table_t *table = &sparser->header_table;
+    uint32_t n;
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    array_init_size(return_value, table->count);
+    for (n = 0; n < table->count; n++) {
+        const cat_http_header_t *header = &table->headers[n];
+        zval *zvalues, zvalue;
+        /* values with the same name are added when the first one is found */
+        if (header->id != CAT_HTTP_HEADER_UNKNOWN ?
+            table->known[header->id] != n + 1 :
+            cat_http_header_table_find(table, sparser->head.value, sparser->head.value + header->name_offset, header->name_length) != header) {
+            continue;
+        }
+        zvalues = zend_hash_str_add_empty_element(Z_ARRVAL_P(return_value), sparser->head.value + header->name_offset, header->name_length);
+        if (UNEXPECTED(zvalues == NULL)) {
+            /* should not happen, names are grouped case-insensitively */
+            continue;
+        }
+        array_init(zvalues);
+        do {
+            ZVAL_STR(&zvalue, SWOW_HTTP_PARSER_HEADER_VALUE_STR(sparser, header));
+            zend_hash_next_index_insert_new(Z_ARRVAL_P(zvalues), &zvalue);
+            header = cat_http_header_table_find_next(table, sparser->head.value, header);
+        } while (header != NULL);
+    }
+}
+
+#define arginfo_class_Swow_Http_Parser_getHeaderNames arginfo_class_Swow_Http_Parser_getArray
+
+/* [lower-case name => name] */
+static PHP_METHOD(Swow_Http_Parser, getHeaderNames)
+{
+    swow_http_parser_t *sparser = getThisParser();
+    cat_http_header_table_t *table = &sparser->header_table;
+    uint32_t n;
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    array_init_size(return_value, table->count);
+    for (n = 0; n < table->count; n++) {
+        const cat_http_header_t *header = &table->headers[n];
+        zend_string *name, *lower_name;
+        zval zname;
+        if (header->id != CAT_HTTP_HEADER_UNKNOWN) {
+            if (table->known[header->id] != n + 1) {
+                continue;
+            }
+            lower_name = zend_string_init(cat_http_header_get_name((cat_http_header_id_t) header->id), header->name_length, 0);
+        } else {
+            lower_name = zend_string_tolower(name = SWOW_HTTP_PARSER_HEADER_NAME_STR(sparser, header));
+            zend_string_release(name);
+        }
+        ZVAL_STR(&zname, SWOW_HTTP_PARSER_HEADER_NAME_STR(sparser, header));
+        if (zend_symtable_add_new(Z_ARRVAL_P(return_value), lower_name, &zname) == NULL) {
+            zval_ptr_dtor(&zname);
+        }
+        zend_string_release(lower_name);
+    }
+}
+
 #if 0
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Http_Parser_executeString, ZEND_RETURN_VALUE, 1, IS_LONG, 0)
     ZEND_ARG_TYPE_INFO(0, string, IS_STRING, 0)
@@ -429,6 +680,7 @@ static PHP_METHOD(Swow_Http_Parser, reset)
     cat_http_parser_reset(parser);
     sparser->parsed_length = 0;
     sparser->data_offset = 0;
+    cat_http_header_table_clear(&sparser->header_table);
 
     RETURN_THIS();
 }
@@ -439,6 +691,15 @@ static const zend_function_entry swow_http_parser_methods[] = {
     PHP_ME(Swow_Http_Parser, getEvents,          arginfo_class_Swow_Http_Parser_getEvents,          ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Http_Parser, setEvents,          arginfo_class_Swow_Http_Parser_setEvents,          ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Http_Parser, execute,            arginfo_class_Swow_Http_Parser_execute,            ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, executeHead,        arginfo_class_Swow_Http_Parser_executeHead,        ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, getHeaderCount,     arginfo_class_Swow_Http_Parser_getHeaderCount,     ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, getUriOrReasonPhrase, arginfo_class_Swow_Http_Parser_getUriOrReasonPhrase, ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, hasHeader,          arginfo_class_Swow_Http_Parser_hasHeader,          ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, getHeader,          arginfo_class_Swow_Http_Parser_getHeader,          ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, getHeaderValues,    arginfo_class_Swow_Http_Parser_getHeaderValues,    ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, getKnownHeader,     arginfo_class_Swow_Http_Parser_getKnownHeader,     ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, getHeaders,         arginfo_class_Swow_Http_Parser_getHeaders,         ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, getHeaderNames,     arginfo_class_Swow_Http_Parser_getHeaderNames,     ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Http_Parser, getEvent,           arginfo_class_Swow_Http_Parser_getEvent,           ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Http_Parser, getEventName,       arginfo_class_Swow_Http_Parser_getEventName,       ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Http_Parser, getDataOffset,      arginfo_class_Swow_Http_Parser_getDataOffset,      ZEND_ACC_PUBLIC)
@@ -471,7 +732,7 @@ static cat_always_inline size_t swow_http_get_header_length(zend_string *header_
     return size;
 }
 
-static cat_always_inline size_t swow_http_get_message_length(HashTable *headers, zend_string *body)
+static cat_always_inline size_t swow_http_get_headers_length(HashTable *headers)
 {
     zend_string *header_name;
     zval *zheader_value;
@@ -490,13 +751,14 @@ static cat_always_inline size_t swow_http_get_message_length(HashTable *headers,
         }
     } ZEND_HASH_FOREACH_END();
 
-    size += CAT_STRLEN("\r\n");
-
-    size += ZSTR_LEN(body);
-
     return size;
 }
 
+static cat_always_inline size_t swow_http_get_message_length(HashTable *headers, zend_string *body)
+{
+    return swow_http_get_headers_length(headers) + CAT_STRLEN("\r\n") + ZSTR_LEN(body);
+}
+
 static cat_always_inline char *swow_http_pack_header(char *p, zend_string *header_name, zval *zheader_value)
 {
     zend_string *header_value, *tmp_header_value;
@@ -547,6 +809,60 @@ static cat_always_inline char* swow_http_pack_message(char *p, HashTable *header
     return p;
 }
 
+typedef struct swow_http_status_line_s {
+    const char *protocol_version;
+    size_t protocol_version_length;
+    char status_code_buffer[MAX_LENGTH_OF_LONG + 1];
+    const char *status_code;
+    size_t status_code_length;
+    const char *reason_phrase;
+    size_t reason_phrase_length;
+} swow_http_status_line_t;
+
+static void swow_http_status_line_init(
+    swow_http_status_line_t *line, zend_long status_code,
+    const char *reason_phrase, size_t reason_phrase_length,
+    const char *protocol_version, size_t protocol_version_length
+)
+{
+    char *status_code_eof = line->status_code_buffer + sizeof(line->status_code_buffer) - 1;
+
+    if (protocol_version_length == 0) {
+        protocol_version = "1.1";
+        protocol_version_length = CAT_STRLEN("1.1");
+    }
+    line->protocol_version = protocol_version;
+    line->protocol_version_length = protocol_version_length;
+    line->status_code = zend_print_long_to_buf(status_code_eof, status_code);
+    line->status_code_length = status_code_eof - line->status_code;
+    if (reason_phrase_length == 0) {
+        reason_phrase = cat_http_status_get_reason(status_code);
+        reason_phrase_length = strlen(reason_phrase);
+    }
+    line->reason_phrase = reason_phrase;
+    line->reason_phrase_length = reason_phrase_length;
+}
+
+static cat_always_inline size_t swow_http_status_line_get_length(const swow_http_status_line_t *line)
+{
+    return CAT_STRLEN("HTTP/") + line->protocol_version_length + CAT_STRLEN(" ") +
+           line->status_code_length + CAT_STRLEN(" ") +
+           line->reason_phrase_length + CAT_STRLEN("\r\n");
+}
+
+static cat_always_inline char *swow_http_pack_status_line(char *p, const swow_http_status_line_t *line)
+{
+    p = cat_memcpy(p, CAT_STRL("HTTP/"));
+    p = cat_memcpy(p, line->protocol_version, line->protocol_version_length);
+    p = cat_memcpy(p, CAT_STRL(" "));
+    p = cat_memcpy(p, line->status_code, line->status_code_length);
+    p = cat_memcpy(p, CAT_STRL(" "));
+    p = cat_memcpy(p, line->reason_phrase, line->reason_phrase_length);
+    p = cat_memcpy(p, CAT_STRL("\r\n"));
+
+    return p;
+}
+
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_Swow_Http_packMessage, ZEND_RETURN_VALUE, 0, IS_STRING, 0)
     ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, headers, IS_ARRAY, 0, "[]")
     ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, body, IS_STRING, 0, "\"\"")
@@ -648,17 +964,15 @@ static PHP_FUNCTION(Swow_Http_packResponse)
 {
     zend_string *response;
     /* arguments */
-    char *protocol_version = (char *) "1.1";
-    size_t protocol_version_length = CAT_STRLEN("1.1");
+    char *protocol_version = NULL;
+    size_t protocol_version_length = 0;
     zend_long status_code = CAT_HTTP_STATUS_OK;
-    char status_code_buffer[MAX_LENGTH_OF_LONG + 1];
-    char *status_code_string, *status_code_string_eof;
-    size_t status_code_length;
     char *reason_phrase = NULL;
     size_t reason_phrase_length = 0;
     HashTable *headers = (HashTable *) &zend_empty_array;
     zend_string *body = zend_empty_string;
     /* pack */
+    swow_http_status_line_t line;
     char *p;
     size_t size;
 
@@ -671,40 +985,136 @@ static PHP_FUNCTION(Swow_Http_packResponse)
         Z_PARAM_STRING(protocol_version, protocol_version_length)
     ZEND_PARSE_PARAMETERS_END();
 
-    status_code_string_eof = status_code_buffer + sizeof(status_code_buffer) - 1;
-    status_code_string = zend_print_long_to_buf(status_code_string_eof, status_code);
-    status_code_length = status_code_string_eof - status_code_string;
-    if (reason_phrase_length == 0) {
-        reason_phrase = (char *) cat_http_status_get_reason(status_code);
-        reason_phrase_length = strlen(reason_phrase);
-    }
+    swow_http_status_line_init(&line, status_code, reason_phrase, reason_phrase_length, protocol_version, protocol_version_length);
 
-    size = CAT_STRLEN("HTTP/") + protocol_version_length + CAT_STRLEN(" ") +
-           status_code_length + CAT_STRLEN(" ") +
-           reason_phrase_length + CAT_STRLEN("\r\n");
+    size = swow_http_status_line_get_length(&line);
 
     size += swow_http_get_message_length(headers, body);
 
     response = zend_string_alloc(size, 0);
 
     p = ZSTR_VAL(response);
-    p = cat_memcpy(p, CAT_STRL("HTTP/"));
-    p = cat_memcpy(p, protocol_version, protocol_version_length);
-    p = cat_memcpy(p, CAT_STRL(" "));
-    p = cat_memcpy(p, status_code_string, status_code_length);
-    p = cat_memcpy(p, CAT_STRL(" "));
-    p = cat_memcpy(p, reason_phrase, reason_phrase_length);
-    p = cat_memcpy(p, CAT_STRL("\r\n"));
+    p = swow_http_pack_status_line(p, &line);
 
     (void) swow_http_pack_message(p, headers, body);
 
     RETURN_STR(response);
 }
 
+#define SWOW_HTTP_RESPONSE_HEAD_STACK_SIZE 1024
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_Swow_Http_sendResponse, ZEND_RETURN_VALUE, 1, IS_VOID, 0)
+    ZEND_ARG_OBJ_INFO(0, socket, Swow\\Socket, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, statusCode, IS_LONG, 0, "0")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, headers, IS_ARRAY, 0, "[]")
+    ZEND_ARG_INFO_WITH_DEFAULT_VALUE(0, body, "\"\"")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, reasonPhrase, IS_STRING, 0, "\"\"")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, protocolVersion, IS_STRING, 0, "\"\"")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, timeout, IS_LONG, 1, "\'$socket->getWriteTimeout()\'")
+ZEND_END_ARG_INFO()
+
+/* Same as $socket->write([packResponse($statusCode, $headers), $body]),
+ * but only the head is packed (on the stack if it is small enough),
+ * the body (string or the whole content of Buffer) is written as the second vector without being copied,
+ * it is pinned (and the buffer is locked) until the write completes */
+static PHP_FUNCTION(Swow_Http_sendResponse)
+{
+    /* arguments */
+    zval *zsocket;
+    zend_long status_code = CAT_HTTP_STATUS_OK;
+    HashTable *headers = (HashTable *) &zend_empty_array;
+    zval *zbody = NULL;
+    char *reason_phrase = NULL;
+    size_t reason_phrase_length = 0;
+    char *protocol_version = NULL;
+    size_t protocol_version_length = 0;
+    zend_long timeout = 0;
+    zend_bool timeout_is_null = 1;
+    /* write */
+    cat_socket_t *socket;
+    zend_string *body_string = NULL;
+    zend_object *body_object = NULL;
+    swow_buffer_t *sbuffer = NULL;
+    swow_http_status_line_t line;
+    char head_buffer[SWOW_HTTP_RESPONSE_HEAD_STACK_SIZE], *head, *p;
+    size_t head_length;
+    cat_socket_write_vector_t vector[2];
+    uint32_t vector_count = 1;
+    cat_bool_t ret;
+
+    ZEND_PARSE_PARAMETERS_START(1, 7)
+        Z_PARAM_OBJECT_OF_CLASS(zsocket, swow_socket_ce)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG(status_code)
+        Z_PARAM_ARRAY_HT(headers)
+        Z_PARAM_ZVAL(zbody)
+        Z_PARAM_STRING(reason_phrase, reason_phrase_length)
+        Z_PARAM_STRING(protocol_version, protocol_version_length)
+        Z_PARAM_LONG_OR_NULL(timeout, timeout_is_null)
+    ZEND_PARSE_PARAMETERS_END();
+
+    socket = &swow_socket_get_from_object(Z_OBJ_P(zsocket))->socket;
+    if (zbody == NULL) {
+        /* no body */
+    } else if (Z_TYPE_P(zbody) == IS_STRING) {
+        body_string = Z_STR_P(zbody);
+    } else if (Z_TYPE_P(zbody) == IS_OBJECT && instanceof_function(Z_OBJCE_P(zbody), swow_buffer_ce)) {
+        body_object = Z_OBJ_P(zbody);
+        sbuffer = swow_buffer_get_from_object(body_object);
+        /* it can not be changed during the write */
+        SWOW_BUFFER_CHECK_LOCK(sbuffer);
+    } else {
+        zend_argument_type_error(4, "must be of type string or %s, %s given", ZSTR_VAL(swow_buffer_ce->name), zend_zval_type_name(zbody));
+        RETURN_THROWS();
+    }
+    if (timeout_is_null) {
+        timeout = cat_socket_get_write_timeout(socket);
+    }
+
+    swow_http_status_line_init(&line, status_code, reason_phrase, reason_phrase_length, protocol_version, protocol_version_length);
+    head_length = swow_http_status_line_get_length(&line) + swow_http_get_headers_length(headers) + CAT_STRLEN("\r\n");
+    head = EXPECTED(head_length <= sizeof(head_buffer)) ? head_buffer : emalloc(head_length);
+    p = swow_http_pack_status_line(head, &line);
+    p = swow_http_pack_headers(p, headers);
+    p = cat_memcpy(p, CAT_STRL("\r\n"));
+    CAT_ASSERT((size_t) (p - head) == head_length);
+    vector[0] = cat_socket_write_vector_init(head, head_length);
+
+    if (body_string != NULL && ZSTR_LEN(body_string) > 0) {
+        /* it may be released by others during the write (e.g. it is a property) */
+        zend_string_addref(body_string);
+        vector[vector_count++] = cat_socket_write_vector_init(ZSTR_VAL(body_string), ZSTR_LEN(body_string));
+    } else if (sbuffer != NULL && sbuffer->buffer.length > 0) {
+        GC_ADDREF(body_object);
+        sbuffer->locked = cat_true;
+        vector[vector_count++] = cat_socket_write_vector_init(sbuffer->buffer.value, sbuffer->buffer.length);
+    } else {
+        body_string = NULL;
+        body_object = NULL;
+    }
+
+    ret = cat_socket_write_ex(socket, vector, vector_count, timeout);
+
+    if (body_string != NULL) {
+        zend_string_release(body_string);
+    } else if (body_object != NULL) {
+        SWOW_BUFFER_UNLOCK(sbuffer);
+        OBJ_RELEASE(body_object);
+    }
+    if (UNEXPECTED(head != head_buffer)) {
+        efree(head);
+    }
+    if (UNEXPECTED(!ret)) {
+        swow_throw_call_exception_with_last(swow_socket_exception_ce);
+        RETURN_THROWS();
+    }
+}
+
 static const zend_function_entry swow_http_functions[] = {
     PHP_FENTRY(Swow\\Http\\packMessage,  PHP_FN(Swow_Http_packMessage),  arginfo_Swow_Http_packMessage,  0)
     PHP_FENTRY(Swow\\Http\\packRequest,  PHP_FN(Swow_Http_packRequest),  arginfo_Swow_Http_packRequest,  0)
     PHP_FENTRY(Swow\\Http\\packResponse, PHP_FN(Swow_Http_packResponse), arginfo_Swow_Http_packResponse, 0)
+    PHP_FENTRY(Swow\\Http\\sendResponse, PHP_FN(Swow_Http_sendResponse), arginfo_Swow_Http_sendResponse, 0)
     PHP_FE_END
 };
 
@@ -725,7 +1135,7 @@ int swow_http_module_init(INIT_FUNC_ARGS)
         "Swow\\Http\\Parser", NULL, swow_http_parser_methods,
         &swow_http_parser_handlers, NULL,
         cat_false, cat_false, cat_false,
-        swow_http_parser_create_object, NULL,
+        swow_http_parser_create_object, swow_http_parser_free_object,
         XtOffsetOf(swow_http_parser_t, std)
     );
     zend_declare_class_constant_long(swow_http_parser_ce, ZEND_STRL("TYPE_BOTH"), CAT_HTTP_PARSER_TYPE_BOTH);
@@ -739,6 +1149,9 @@ int swow_http_module_init(INIT_FUNC_ARGS)
 #undef SWOW_HTTP_PARSER_EVENT_GEN
     zend_declare_class_constant_long(swow_http_parser_ce, ZEND_STRL("EVENTS_NONE"), CAT_HTTP_PARSER_EVENTS_NONE);
     zend_declare_class_constant_long(swow_http_parser_ce, ZEND_STRL("EVENTS_ALL"), CAT_HTTP_PARSER_EVENTS_ALL);
+#define SWOW_HTTP_PARSER_HEADER_GEN(name, unused) zend_declare_class_constant_long(swow_http_parser_ce, ZEND_STRL("HEADER_" #name), CAT_HTTP_HEADER_##name);
+    CAT_HTTP_HEADER_MAP(SWOW_HTTP_PARSER_HEADER_GEN)
+#undef SWOW_HTTP_PARSER_HEADER_GEN
     /* Parser\\Exception */
     swow_http_parser_exception_ce = swow_register_internal_class(
         "Swow\\Http\\Parser\\Exception", swow_exception_ce, NULL, NULL, NULL, cat_true, cat_true, cat_true, NULL, NULL, 0
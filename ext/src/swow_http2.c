@@ -0,0 +1,415 @@
+/*
+  +--------------------------------------------------------------------------+
+  | Swow                                                                     |
+  +--------------------------------------------------------------------------+
+  | Licensed under the Apache License, Version 2.0 (the "License");          |
+  | you may not use this file except in compliance with the License.         |
+  | You may obtain a copy of the License at                                  |
+  | http://www.apache.org/licenses/LICENSE-2.0                               |
+  | Unless required by applicable law or agreed to in writing, software      |
+  | distributed under the License is distributed on an "AS IS" BASIS,        |
+  | WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. |
+  | See the License for the specific language governing permissions and      |
+  | limitations under the License. See accompanying LICENSE file.            |
+  +--------------------------------------------------------------------------+
+  | Author: Twosee <twosee@php.net>                                          |
+  +--------------------------------------------------------------------------+
+ */
+
+#include "swow_http2.h"
+
+SWOW_API zend_class_entry *swow_http2_frame_type_ce;
+
+SWOW_API zend_class_entry *swow_http2_flag_ce;
+
+SWOW_API zend_class_entry *swow_http2_setting_ce;
+
+SWOW_API zend_class_entry *swow_http2_error_code_ce;
+
+SWOW_API zend_class_entry *swow_http2_hpack_ce;
+SWOW_API zend_object_handlers swow_http2_hpack_handlers;
+
+SWOW_API zend_class_entry *swow_http2_exception_ce;
+
+/* it limits the decoded size of a header block (RFC 7540 Section 6.5.2),
+ * indexed representations are tiny, so it is necessary to resist decompression bomb */
+#define SWOW_HTTP2_DEFAULT_MAX_HEADER_LIST_SIZE (64 * 1024)
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Http2_FrameType_getName, ZEND_RETURN_VALUE, 1, IS_STRING, 0)
+    ZEND_ARG_TYPE_INFO(0, type, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Http2_FrameType, getName)
+{
+    zend_long type;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_LONG(type)
+    ZEND_PARSE_PARAMETERS_END();
+
+    RETURN_STRING(cat_http2_frame_type_name((uint8_t) type));
+}
+
+static const zend_function_entry swow_http2_frame_type_methods[] = {
+    PHP_ME(Swow_Http2_FrameType, getName, arginfo_class_Swow_Http2_FrameType_getName, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_FE_END
+};
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Http2_ErrorCode_getName, ZEND_RETURN_VALUE, 1, IS_STRING, 0)
+    ZEND_ARG_TYPE_INFO(0, code, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Http2_ErrorCode, getName)
+{
+    zend_long code;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_LONG(code)
+    ZEND_PARSE_PARAMETERS_END();
+
+    RETURN_STRING(cat_http2_error_code_name((uint32_t) code));
+}
+
+#define arginfo_class_Swow_Http2_ErrorCode_getDescription arginfo_class_Swow_Http2_ErrorCode_getName
+
+static PHP_METHOD(Swow_Http2_ErrorCode, getDescription)
+{
+    zend_long code;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_LONG(code)
+    ZEND_PARSE_PARAMETERS_END();
+
+    RETURN_STRING(cat_http2_error_code_get_description((uint32_t) code));
+}
+
+static const zend_function_entry swow_http2_error_code_methods[] = {
+    PHP_ME(Swow_Http2_ErrorCode, getName,        arginfo_class_Swow_Http2_ErrorCode_getName,        ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Http2_ErrorCode, getDescription, arginfo_class_Swow_Http2_ErrorCode_getDescription, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_FE_END
+};
+
+static zend_object *swow_http2_hpack_create_object(zend_class_entry *ce)
+{
+    swow_http2_hpack_t *shpack = swow_object_alloc(swow_http2_hpack_t, ce, swow_http2_hpack_handlers);
+
+    cat_hpack_init(&shpack->hpack);
+    cat_buffer_init(&shpack->buffer);
+
+    return &shpack->std;
+}
+
+static void swow_http2_hpack_free_object(zend_object *object)
+{
+    swow_http2_hpack_t *shpack = swow_http2_hpack_get_from_object(object);
+
+    cat_hpack_close(&shpack->hpack);
+    cat_buffer_close(&shpack->buffer);
+
+    zend_object_std_dtor(&shpack->std);
+}
+
+#define getThisHpack() (swow_http2_hpack_get_from_object(Z_OBJ_P(ZEND_THIS)))
+
+#define SWOW_HTTP2_HPACK_GETTER(_shpack, _hpack) \
+    swow_http2_hpack_t *_shpack = getThisHpack(); \
+    cat_hpack_t *_hpack = &_shpack->hpack
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Http2_Hpack_encode, ZEND_RETURN_VALUE, 1, IS_STRING, 0)
+    ZEND_ARG_TYPE_INFO(0, headers, IS_ARRAY, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, flags, IS_LONG, 0, "Swow\\Http2\\Hpack::FLAG_NONE")
+ZEND_END_ARG_INFO()
+
+static cat_bool_t swow_http2_hpack_encode_header(cat_hpack_t *hpack, cat_buffer_t *buffer, zend_string *name, zval *zvalue, cat_hpack_flags_t flags)
+{
+    zend_string *value, *tmp_value;
+    cat_bool_t ret;
+
+    value = zval_get_tmp_string(zvalue, &tmp_value);
+    if (UNEXPECTED(EG(exception) != NULL)) {
+        return cat_false;
+    }
+    ret = cat_hpack_encode(hpack, buffer, ZSTR_VAL(name), ZSTR_LEN(name), ZSTR_VAL(value), ZSTR_LEN(value), flags);
+    zend_tmp_string_release(tmp_value);
+    if (UNEXPECTED(!ret)) {
+        swow_throw_exception_with_last(swow_http2_exception_ce);
+    }
+
+    return ret;
+}
+
+static PHP_METHOD(Swow_Http2_Hpack, encode)
+{
+    SWOW_HTTP2_HPACK_GETTER(shpack, hpack);
+    HashTable *headers;
+    zend_long flags = CAT_HPACK_FLAG_NONE;
+    zend_string *key;
+    zend_ulong index;
+    zval *zheader;
+
+    ZEND_PARSE_PARAMETERS_START(1, 2)
+        Z_PARAM_ARRAY_HT(headers)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG(flags)
+    ZEND_PARSE_PARAMETERS_END();
+
+    cat_buffer_clear(&shpack->buffer);
+    /* $headers is name => value or name => [value, ...] (pseudo-header fields must come first) */
+    ZEND_HASH_FOREACH_KEY_VAL(headers, index, key, zheader) {
+        zend_string *name;
+        cat_bool_t ret = cat_true;
+        if (key != NULL) {
+            /* field names must be lowercase in HTTP/2 */
+            name = zend_string_tolower(key);
+        } else {
+            name = zend_long_to_str((zend_long) index);
+        }
+        ZVAL_DEREF(zheader);
+        if (Z_TYPE_P(zheader) == IS_ARRAY) {
+            zval *zvalue;
+            ZEND_HASH_FOREACH_VAL(Z_ARRVAL_P(zheader), zvalue) {
+                ret = swow_http2_hpack_encode_header(hpack, &shpack->buffer, name, zvalue, (cat_hpack_flags_t) flags);
+                if (UNEXPECTED(!ret)) {
+                    break;
+                }
+            } ZEND_HASH_FOREACH_END();
+        } else {
+            ret = swow_http2_hpack_encode_header(hpack, &shpack->buffer, name, zheader, (cat_hpack_flags_t) flags);
+        }
+        zend_string_release(name);
+        if (UNEXPECTED(!ret)) {
+            RETURN_THROWS();
+        }
+    } ZEND_HASH_FOREACH_END();
+
+    RETURN_STRINGL(shpack->buffer.value != NULL ? shpack->buffer.value : "", shpack->buffer.length);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Http2_Hpack_decode, ZEND_RETURN_VALUE, 1, IS_ARRAY, 0)
+    ZEND_ARG_TYPE_INFO(0, headerBlock, IS_STRING, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, maxHeaderListSize, IS_LONG, 0, "Swow\\Http2\\Hpack::DEFAULT_MAX_HEADER_LIST_SIZE")
+ZEND_END_ARG_INFO()
+
+typedef struct {
+    zval *headers;
+    size_t header_list_size;
+    size_t max_header_list_size;
+} swow_http2_hpack_decode_context_t;
+
+static cat_bool_t swow_http2_hpack_decode_handler(void *arg, const char *name, size_t name_length, const char *value, size_t value_length, cat_hpack_flags_t flags)
+{
+    swow_http2_hpack_decode_context_t *context = (swow_http2_hpack_decode_context_t *) arg;
+    zval zheader, ztmp;
+    (void) flags;
+
+    context->header_list_size += CAT_HPACK_ENTRY_OVERHEAD + name_length + value_length;
+    if (UNEXPECTED(context->header_list_size > context->max_header_list_size)) {
+        cat_update_last_error(CAT_EMSGSIZE, "Header list size exceeds the limit %zu", context->max_header_list_size);
+        return cat_false;
+    }
+    array_init_size(&zheader, 2);
+    ZVAL_STRINGL(&ztmp, name, name_length);
+    zend_hash_next_index_insert_new(Z_ARRVAL(zheader), &ztmp);
+    ZVAL_STRINGL(&ztmp, value, value_length);
+    zend_hash_next_index_insert_new(Z_ARRVAL(zheader), &ztmp);
+    zend_hash_next_index_insert_new(Z_ARRVAL_P(context->headers), &zheader);
+
+    return cat_true;
+}
+
+static PHP_METHOD(Swow_Http2_Hpack, decode)
+{
+    SWOW_HTTP2_HPACK_GETTER(shpack, hpack);
+    swow_http2_hpack_decode_context_t context;
+    zend_string *header_block;
+    zend_long max_header_list_size = SWOW_HTTP2_DEFAULT_MAX_HEADER_LIST_SIZE;
+
+    ZEND_PARSE_PARAMETERS_START(1, 2)
+        Z_PARAM_STR(header_block)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG(max_header_list_size)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(max_header_list_size <= 0)) {
+        zend_argument_value_error(2, "must be greater than 0");
+        RETURN_THROWS();
+    }
+
+    /* it returns a list of [name, value], because the order and duplicates matter */
+    array_init(return_value);
+    context.headers = return_value;
+    context.header_list_size = 0;
+    context.max_header_list_size = (size_t) max_header_list_size;
+    if (UNEXPECTED(!cat_hpack_decode(hpack, ZSTR_VAL(header_block), ZSTR_LEN(header_block), swow_http2_hpack_decode_handler, &context))) {
+        /* the table state is broken after failure, it is a connection error of COMPRESSION_ERROR */
+        swow_throw_exception_with_last(swow_http2_exception_ce);
+        RETURN_THROWS();
+    }
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Http2_Hpack_getLong, ZEND_RETURN_VALUE, 0, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+#define arginfo_class_Swow_Http2_Hpack_getSize arginfo_class_Swow_Http2_Hpack_getLong
+
+static PHP_METHOD(Swow_Http2_Hpack, getSize)
+{
+    SWOW_HTTP2_HPACK_GETTER(shpack, hpack);
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_LONG(cat_hpack_get_size(hpack));
+}
+
+#define arginfo_class_Swow_Http2_Hpack_getMaxSize arginfo_class_Swow_Http2_Hpack_getLong
+
+static PHP_METHOD(Swow_Http2_Hpack, getMaxSize)
+{
+    SWOW_HTTP2_HPACK_GETTER(shpack, hpack);
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_LONG(cat_hpack_get_max_size(hpack));
+}
+
+#define arginfo_class_Swow_Http2_Hpack_getCount arginfo_class_Swow_Http2_Hpack_getLong
+
+static PHP_METHOD(Swow_Http2_Hpack, getCount)
+{
+    SWOW_HTTP2_HPACK_GETTER(shpack, hpack);
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_LONG(cat_hpack_get_count(hpack));
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_THIS_INFO_EX(arginfo_class_Swow_Http2_Hpack_setSizeLimit, 1)
+    ZEND_ARG_TYPE_INFO(0, sizeLimit, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Http2_Hpack, setSizeLimit)
+{
+    SWOW_HTTP2_HPACK_GETTER(shpack, hpack);
+    zend_long size_limit;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_LONG(size_limit)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(size_limit < 0 || size_limit > UINT32_MAX)) {
+        zend_argument_value_error(1, "must be between 0 and %u", UINT32_MAX);
+        RETURN_THROWS();
+    }
+    cat_hpack_set_size_limit(hpack, (size_t) size_limit);
+
+    RETURN_THIS();
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_THIS_INFO_EX(arginfo_class_Swow_Http2_Hpack_updateSize, 1)
+    ZEND_ARG_TYPE_INFO(0, maxSize, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Http2_Hpack, updateSize)
+{
+    SWOW_HTTP2_HPACK_GETTER(shpack, hpack);
+    zend_long max_size;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_LONG(max_size)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(max_size < 0 || max_size > UINT32_MAX)) {
+        zend_argument_value_error(1, "must be between 0 and %u", UINT32_MAX);
+        RETURN_THROWS();
+    }
+    cat_hpack_update_size(hpack, (size_t) max_size);
+
+    RETURN_THIS();
+}
+
+static const zend_function_entry swow_http2_hpack_methods[] = {
+    PHP_ME(Swow_Http2_Hpack, encode,       arginfo_class_Swow_Http2_Hpack_encode,       ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http2_Hpack, decode,       arginfo_class_Swow_Http2_Hpack_decode,       ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http2_Hpack, getSize,      arginfo_class_Swow_Http2_Hpack_getSize,      ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http2_Hpack, getMaxSize,   arginfo_class_Swow_Http2_Hpack_getMaxSize,   ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http2_Hpack, getCount,     arginfo_class_Swow_Http2_Hpack_getCount,     ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http2_Hpack, setSizeLimit, arginfo_class_Swow_Http2_Hpack_setSizeLimit, ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http2_Hpack, updateSize,   arginfo_class_Swow_Http2_Hpack_updateSize,   ZEND_ACC_PUBLIC)
+    PHP_FE_END
+};
+
+int swow_http2_module_init(INIT_FUNC_ARGS)
+{
+#define SWOW_HTTP2_REGISTER_LONG_CONSTANT(name) \
+    REGISTER_LONG_CONSTANT("Swow\\Http2\\" #name, CAT_HTTP2_##name, CONST_CS | CONST_PERSISTENT)
+
+#define SWOW_HTTP2_REGISTER_STRING_CONSTANT(name) \
+    REGISTER_STRING_CONSTANT("Swow\\Http2\\" #name, (char *) CAT_HTTP2_##name, CONST_CS | CONST_PERSISTENT)
+
+    SWOW_HTTP2_REGISTER_STRING_CONSTANT(CONNECTION_PREFACE);
+    SWOW_HTTP2_REGISTER_STRING_CONSTANT(ALPN_PROTOCOL);
+    SWOW_HTTP2_REGISTER_LONG_CONSTANT(FRAME_HEADER_LENGTH);
+    SWOW_HTTP2_REGISTER_LONG_CONSTANT(DEFAULT_HEADER_TABLE_SIZE);
+    SWOW_HTTP2_REGISTER_LONG_CONSTANT(DEFAULT_WINDOW_SIZE);
+    SWOW_HTTP2_REGISTER_LONG_CONSTANT(MAX_WINDOW_SIZE);
+    SWOW_HTTP2_REGISTER_LONG_CONSTANT(DEFAULT_MAX_FRAME_SIZE);
+    SWOW_HTTP2_REGISTER_LONG_CONSTANT(MAX_MAX_FRAME_SIZE);
+    SWOW_HTTP2_REGISTER_LONG_CONSTANT(MAX_STREAM_ID);
+    SWOW_HTTP2_REGISTER_LONG_CONSTANT(SETTINGS_ENTRY_LENGTH);
+
+    swow_http2_frame_type_ce = swow_register_internal_class(
+        "Swow\\Http2\\FrameType", NULL, swow_http2_frame_type_methods,
+        NULL, NULL, cat_false, cat_false, cat_false,
+        swow_create_object_deny, NULL, 0
+    );
+#define SWOW_HTTP2_FRAME_TYPE_GEN(name, value) zend_declare_class_constant_long(swow_http2_frame_type_ce, ZEND_STRL(#name), value);
+    CAT_HTTP2_FRAME_TYPE_MAP(SWOW_HTTP2_FRAME_TYPE_GEN)
+#undef SWOW_HTTP2_FRAME_TYPE_GEN
+
+    swow_http2_flag_ce = swow_register_internal_class(
+        "Swow\\Http2\\Flag", NULL, NULL,
+        NULL, NULL, cat_false, cat_false, cat_false,
+        swow_create_object_deny, NULL, 0
+    );
+#define SWOW_HTTP2_FLAG_GEN(name, value) zend_declare_class_constant_long(swow_http2_flag_ce, ZEND_STRL(#name), value);
+    CAT_HTTP2_FLAG_MAP(SWOW_HTTP2_FLAG_GEN)
+#undef SWOW_HTTP2_FLAG_GEN
+
+    swow_http2_setting_ce = swow_register_internal_class(
+        "Swow\\Http2\\Setting", NULL, NULL,
+        NULL, NULL, cat_false, cat_false, cat_false,
+        swow_create_object_deny, NULL, 0
+    );
+#define SWOW_HTTP2_SETTINGS_GEN(name, value) zend_declare_class_constant_long(swow_http2_setting_ce, ZEND_STRL(#name), value);
+    CAT_HTTP2_SETTINGS_MAP(SWOW_HTTP2_SETTINGS_GEN)
+#undef SWOW_HTTP2_SETTINGS_GEN
+
+    swow_http2_error_code_ce = swow_register_internal_class(
+        "Swow\\Http2\\ErrorCode", NULL, swow_http2_error_code_methods,
+        NULL, NULL, cat_false, cat_false, cat_false,
+        swow_create_object_deny, NULL, 0
+    );
+#define SWOW_HTTP2_ERROR_CODE_GEN(name, value, description) zend_declare_class_constant_long(swow_http2_error_code_ce, ZEND_STRL(#name), value);
+    CAT_HTTP2_ERROR_CODE_MAP(SWOW_HTTP2_ERROR_CODE_GEN)
+#undef SWOW_HTTP2_ERROR_CODE_GEN
+
+    swow_http2_hpack_ce = swow_register_internal_class(
+        "Swow\\Http2\\Hpack", NULL, swow_http2_hpack_methods,
+        &swow_http2_hpack_handlers, NULL,
+        cat_false, cat_false, cat_false,
+        swow_http2_hpack_create_object,
+        swow_http2_hpack_free_object,
+        XtOffsetOf(swow_http2_hpack_t, std)
+    );
+    zend_declare_class_constant_long(swow_http2_hpack_ce, ZEND_STRL("FLAG_NONE"), CAT_HPACK_FLAG_NONE);
+    zend_declare_class_constant_long(swow_http2_hpack_ce, ZEND_STRL("FLAG_NO_INDEX"), CAT_HPACK_FLAG_NO_INDEX);
+    zend_declare_class_constant_long(swow_http2_hpack_ce, ZEND_STRL("FLAG_NEVER_INDEX"), CAT_HPACK_FLAG_NEVER_INDEX);
+    zend_declare_class_constant_long(swow_http2_hpack_ce, ZEND_STRL("FLAG_NO_HUFFMAN"), CAT_HPACK_FLAG_NO_HUFFMAN);
+    zend_declare_class_constant_long(swow_http2_hpack_ce, ZEND_STRL("DEFAULT_MAX_HEADER_LIST_SIZE"), SWOW_HTTP2_DEFAULT_MAX_HEADER_LIST_SIZE);
+
+    swow_http2_exception_ce = swow_register_internal_class(
+        "Swow\\Http2\\Exception", swow_exception_ce, NULL, NULL, NULL, cat_true, cat_true, cat_true, NULL, NULL, 0
+    );
+
+    return SUCCESS;
+}
@@ -0,0 +1,145 @@
+/*
+  +--------------------------------------------------------------------------+
+  | Swow                                                                     |
+  +--------------------------------------------------------------------------+
+  | Licensed under the Apache License, Version 2.0 (the "License");          |
+  | you may not use this file except in compliance with the License.         |
+  | You may obtain a copy of the License at                                  |
+  | http://www.apache.org/licenses/LICENSE-2.0                               |
+  | Unless required by applicable law or agreed to in writing, software      |
+  | distributed under the License is distributed on an "AS IS" BASIS,        |
+  | WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. |
+  | See the License for the specific language governing permissions and      |
+  | limitations under the License. See accompanying LICENSE file.            |
+  +--------------------------------------------------------------------------+
+  | Author: Twosee <twosee@php.net>                                          |
+  +--------------------------------------------------------------------------+
+ */
+
+#include "swow_metrics.h"
+
+#include "cat_coroutine.h"
+#include "cat_event.h"
+
+SWOW_API zend_class_entry *swow_metrics_ce;
+SWOW_API zend_object_handlers swow_metrics_handlers;
+
+SWOW_API zend_class_entry *swow_metrics_exception_ce;
+
+static void swow_metrics_histogram_to_array(zval *zhistogram, const uint64_t *histogram)
+{
+    size_t i;
+
+    array_init_size(zhistogram, CAT_EVENT_HISTOGRAM_SIZE);
+    for (i = 0; i < CAT_EVENT_HISTOGRAM_SIZE; i++) {
+        add_next_index_long(zhistogram, histogram[i]);
+    }
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Metrics_enable, ZEND_RETURN_VALUE, 0, IS_VOID, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Metrics, enable)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    if (UNEXPECTED(!cat_event_set_stats_enabled(cat_true))) {
+        swow_throw_exception_with_last(swow_metrics_exception_ce);
+        RETURN_THROWS();
+    }
+    cat_coroutine_set_stats_enabled(cat_true);
+}
+
+#define arginfo_class_Swow_Metrics_disable arginfo_class_Swow_Metrics_enable
+
+static PHP_METHOD(Swow_Metrics, disable)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    (void) cat_event_set_stats_enabled(cat_false);
+    cat_coroutine_set_stats_enabled(cat_false);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Metrics_isEnabled, ZEND_RETURN_VALUE, 0, _IS_BOOL, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Metrics, isEnabled)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_BOOL(cat_coroutine_is_stats_enabled());
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Metrics_snapshot, ZEND_RETURN_VALUE, 0, IS_ARRAY, 0)
+ZEND_END_ARG_INFO()
+
+/* it only reads counters, so it is cheap enough to be scraped frequently */
+static PHP_METHOD(Swow_Metrics, snapshot)
+{
+    cat_event_stats_t stats;
+    zval zcoroutine, zevent, zmemory, zhistogram;
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    cat_event_get_stats(&stats);
+
+    array_init(return_value);
+    add_assoc_bool(return_value, "enabled", cat_coroutine_is_stats_enabled());
+
+    array_init(&zcoroutine);
+    add_assoc_long(&zcoroutine, "count", cat_coroutine_get_count());
+    add_assoc_long(&zcoroutine, "peak_count", cat_coroutine_get_peak_count());
+    add_assoc_long(&zcoroutine, "switches", cat_coroutine_get_current_round());
+    add_assoc_zval(return_value, "coroutine", &zcoroutine);
+
+    array_init(&zevent);
+    add_assoc_long(&zevent, "rounds", stats.rounds);
+    add_assoc_long(&zevent, "busy_time", stats.busy_time);
+    add_assoc_long(&zevent, "idle_time", stats.idle_time);
+    swow_metrics_histogram_to_array(&zhistogram, stats.latency_histogram);
+    add_assoc_zval(&zevent, "latency_histogram", &zhistogram);
+    swow_metrics_histogram_to_array(&zhistogram, stats.run_queue_histogram);
+    add_assoc_zval(&zevent, "run_queue_histogram", &zhistogram);
+    add_assoc_zval(return_value, "event", &zevent);
+
+    array_init(&zmemory);
+    add_assoc_long(&zmemory, "usage", zend_memory_usage(0));
+    add_assoc_long(&zmemory, "real_usage", zend_memory_usage(1));
+    add_assoc_long(&zmemory, "peak_usage", zend_memory_peak_usage(0));
+    add_assoc_zval(return_value, "memory", &zmemory);
+}
+
+#define arginfo_class_Swow_Metrics_reset arginfo_class_Swow_Metrics_enable
+
+static PHP_METHOD(Swow_Metrics, reset)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    cat_event_reset_stats();
+}
+
+static const zend_function_entry swow_metrics_methods[] = {
+    PHP_ME(Swow_Metrics, enable,    arginfo_class_Swow_Metrics_enable,    ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Metrics, disable,   arginfo_class_Swow_Metrics_disable,   ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Metrics, isEnabled, arginfo_class_Swow_Metrics_isEnabled, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Metrics, snapshot,  arginfo_class_Swow_Metrics_snapshot,  ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Metrics, reset,     arginfo_class_Swow_Metrics_reset,     ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_FE_END
+};
+
+int swow_metrics_module_init(INIT_FUNC_ARGS)
+{
+    swow_metrics_ce = swow_register_internal_class(
+        "Swow\\Metrics", NULL, swow_metrics_methods,
+        &swow_metrics_handlers, NULL,
+        cat_false, cat_false, cat_false,
+        swow_create_object_deny, NULL, 0
+    );
+    zend_declare_class_constant_long(swow_metrics_ce, ZEND_STRL("HISTOGRAM_SIZE"), CAT_EVENT_HISTOGRAM_SIZE);
+
+    swow_metrics_exception_ce = swow_register_internal_class(
+        "Swow\\Metrics\\Exception", swow_exception_ce, NULL, NULL, NULL, cat_true, cat_true, cat_true, NULL, NULL, 0
+    );
+
+    return SUCCESS;
+}
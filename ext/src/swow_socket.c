@@ -19,6 +19,10 @@
 #include "swow_socket.h"
 #include "swow_buffer.h"
 
+#include "cat_fs.h"
+
+#include <fcntl.h>
+
 SWOW_API zend_class_entry *swow_socket_ce;
 SWOW_API zend_object_handlers swow_socket_handlers;
 
@@ -122,6 +126,18 @@ static PHP_METHOD(Swow_Socket, getFd)
     RETURN_LONG(cat_socket_get_fd(socket));
 }
 
+#define arginfo_class_Swow_Socket_getWriteQueueSize arginfo_class_Swow_Socket_getLong
+
+/* bytes which are waiting to be written */
+static PHP_METHOD(Swow_Socket, getWriteQueueSize)
+{
+    SWOW_SOCKET_GETTER(ssocket, socket);
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_LONG(cat_socket_get_write_queue_size(socket));
+}
+
 #define arginfo_class_Swow_Socket_getGlobalTimeout arginfo_class_Swow_Socket_getLong
 
 ZEND_BEGIN_ARG_INFO_EX(arginfo_class_Swow_Socket_setGlobalTimeout, 0, ZEND_RETURN_VALUE, 1)
@@ -231,6 +247,349 @@ SWOW_SOCKET_TIMEOUT_API_GEN(Write,         write);
 
 #undef SWOW_SOCKET_TIMEOUT_API_GEN
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_getGlobalTryWrite, ZEND_RETURN_VALUE, 0, _IS_BOOL, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, getGlobalTryWrite)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_BOOL(cat_socket_get_global_try_write());
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_setGlobalTryWrite, ZEND_RETURN_VALUE, 1, IS_VOID, 0)
+    ZEND_ARG_TYPE_INFO(0, enable, _IS_BOOL, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, setGlobalTryWrite)
+{
+    zend_bool enable;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_BOOL(enable)
+    ZEND_PARSE_PARAMETERS_END();
+
+    cat_socket_set_global_try_write(enable);
+}
+
+#define arginfo_class_Swow_Socket_getGlobalStickyRead arginfo_class_Swow_Socket_getGlobalTryWrite
+
+static PHP_METHOD(Swow_Socket, getGlobalStickyRead)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_BOOL(cat_socket_get_global_sticky_read());
+}
+
+#define arginfo_class_Swow_Socket_setGlobalStickyRead arginfo_class_Swow_Socket_setGlobalTryWrite
+
+static PHP_METHOD(Swow_Socket, setGlobalStickyRead)
+{
+    zend_bool enable;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_BOOL(enable)
+    ZEND_PARSE_PARAMETERS_END();
+
+    cat_socket_set_global_sticky_read(enable);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_getWriteStats, ZEND_RETURN_VALUE, 0, IS_ARRAY, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, getWriteStats)
+{
+    cat_socket_write_stats_t stats;
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    cat_socket_get_write_stats(&stats);
+
+    array_init(return_value);
+    add_assoc_long(return_value, "inline_requests", stats.inline_requests);
+    add_assoc_long(return_value, "pooled_requests", stats.pooled_requests);
+    add_assoc_long(return_value, "allocated_requests", stats.allocated_requests);
+    add_assoc_long(return_value, "direct_writes", stats.direct_writes);
+    add_assoc_long(return_value, "partial_writes", stats.partial_writes);
+    add_assoc_long(return_value, "shared_writes", stats.shared_writes);
+    add_assoc_long(return_value, "skipped_writes", stats.skipped_writes);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_resetWriteStats, ZEND_RETURN_VALUE, 0, IS_VOID, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, resetWriteStats)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    cat_socket_reset_write_stats();
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_getGlobalDnsCacheSize, ZEND_RETURN_VALUE, 0, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, getGlobalDnsCacheSize)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_LONG(cat_dns_cache_get_size());
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_setGlobalDnsCacheSize, ZEND_RETURN_VALUE, 1, IS_VOID, 0)
+    ZEND_ARG_TYPE_INFO(0, size, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, setGlobalDnsCacheSize)
+{
+    zend_long size;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_LONG(size)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(size < 0)) {
+        zend_argument_value_error(1, "must be greater than or equal to 0");
+        RETURN_THROWS();
+    }
+
+    cat_dns_cache_set_size(size);
+}
+
+#define arginfo_class_Swow_Socket_getGlobalDnsCacheTtl arginfo_class_Swow_Socket_getGlobalDnsCacheSize
+
+static PHP_METHOD(Swow_Socket, getGlobalDnsCacheTtl)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_LONG(cat_dns_cache_get_ttl());
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_setGlobalDnsCacheTtl, ZEND_RETURN_VALUE, 1, IS_VOID, 0)
+    ZEND_ARG_TYPE_INFO(0, ttl, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, setGlobalDnsCacheTtl)
+{
+    zend_long ttl;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_LONG(ttl)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(ttl < 0)) {
+        zend_argument_value_error(1, "must be greater than or equal to 0");
+        RETURN_THROWS();
+    }
+
+    cat_dns_cache_set_ttl(ttl);
+}
+
+#define arginfo_class_Swow_Socket_getGlobalDnsCacheNegativeTtl arginfo_class_Swow_Socket_getGlobalDnsCacheSize
+
+static PHP_METHOD(Swow_Socket, getGlobalDnsCacheNegativeTtl)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_LONG(cat_dns_cache_get_negative_ttl());
+}
+
+#define arginfo_class_Swow_Socket_setGlobalDnsCacheNegativeTtl arginfo_class_Swow_Socket_setGlobalDnsCacheTtl
+
+static PHP_METHOD(Swow_Socket, setGlobalDnsCacheNegativeTtl)
+{
+    zend_long ttl;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_LONG(ttl)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(ttl < 0)) {
+        zend_argument_value_error(1, "must be greater than or equal to 0");
+        RETURN_THROWS();
+    }
+
+    cat_dns_cache_set_negative_ttl(ttl);
+}
+
+#define arginfo_class_Swow_Socket_flushDnsCache arginfo_class_Swow_Socket_resetWriteStats
+
+static PHP_METHOD(Swow_Socket, flushDnsCache)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    cat_dns_cache_flush();
+}
+
+#define arginfo_class_Swow_Socket_getDnsCacheStats arginfo_class_Swow_Socket_getWriteStats
+
+static PHP_METHOD(Swow_Socket, getDnsCacheStats)
+{
+    cat_dns_cache_stats_t stats;
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    cat_dns_cache_get_stats(&stats);
+
+    array_init(return_value);
+    add_assoc_long(return_value, "count", cat_dns_cache_get_count());
+    add_assoc_long(return_value, "hits", stats.hits);
+    add_assoc_long(return_value, "negative_hits", stats.negative_hits);
+    add_assoc_long(return_value, "misses", stats.misses);
+    add_assoc_long(return_value, "coalesced", stats.coalesced);
+    add_assoc_long(return_value, "evictions", stats.evictions);
+}
+
+#define arginfo_class_Swow_Socket_resetDnsCacheStats arginfo_class_Swow_Socket_resetWriteStats
+
+static PHP_METHOD(Swow_Socket, resetDnsCacheStats)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    cat_dns_cache_reset_stats();
+}
+
+#define arginfo_class_Swow_Socket_isDnsResolverEnabled arginfo_class_Swow_Socket_getGlobalTryWrite
+
+static PHP_METHOD(Swow_Socket, isDnsResolverEnabled)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_BOOL(cat_dns_resolver_is_enabled());
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_setDnsResolverEnabled, ZEND_RETURN_VALUE, 1, IS_VOID, 0)
+    ZEND_ARG_TYPE_INFO(0, enable, _IS_BOOL, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, setDnsResolverEnabled)
+{
+    zend_bool enable;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_BOOL(enable)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (!enable) {
+        cat_dns_resolver_disable();
+        return;
+    }
+    if (UNEXPECTED(!cat_dns_resolver_enable())) {
+        swow_throw_exception_with_last(swow_socket_exception_ce);
+        RETURN_THROWS();
+    }
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_loadDnsResolverConfig, ZEND_RETURN_VALUE, 0, IS_VOID, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, resolvConf, IS_STRING, 1, "null")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, hosts, IS_STRING, 1, "null")
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, loadDnsResolverConfig)
+{
+    zend_string *resolv_conf = NULL;
+    zend_string *hosts = NULL;
+
+    ZEND_PARSE_PARAMETERS_START(0, 2)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_PATH_STR_EX(resolv_conf, 1, 0)
+        Z_PARAM_PATH_STR_EX(hosts, 1, 0)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED((resolv_conf != NULL && php_check_open_basedir_ex(ZSTR_VAL(resolv_conf), 0)) ||
+                   (hosts != NULL && php_check_open_basedir_ex(ZSTR_VAL(hosts), 0)))) {
+        swow_throw_exception(swow_socket_exception_ce, CAT_EPERM, "open_basedir restriction in effect, config files are not within the allowed path(s)");
+        RETURN_THROWS();
+    }
+
+    if (UNEXPECTED(!cat_dns_resolver_load_config(resolv_conf != NULL ? ZSTR_VAL(resolv_conf) : NULL, hosts != NULL ? ZSTR_VAL(hosts) : NULL))) {
+        swow_throw_exception_with_last(swow_socket_exception_ce);
+        RETURN_THROWS();
+    }
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_setDnsResolverNameservers, ZEND_RETURN_VALUE, 1, IS_VOID, 0)
+    ZEND_ARG_TYPE_INFO(0, nameservers, IS_ARRAY, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, setDnsResolverNameservers)
+{
+    HashTable *nameservers;
+    const char *addresses[CAT_DNS_RESOLVER_MAX_NAMESERVERS];
+    zend_long ports[CAT_DNS_RESOLVER_MAX_NAMESERVERS];
+    uint32_t count = 0, n;
+    zval *znameserver;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_ARRAY_HT(nameservers)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(zend_hash_num_elements(nameservers) > CAT_DNS_RESOLVER_MAX_NAMESERVERS)) {
+        zend_argument_value_error(1, "can not have more than %u elements", CAT_DNS_RESOLVER_MAX_NAMESERVERS);
+        RETURN_THROWS();
+    }
+    /* check all of them before we apply them */
+    ZEND_HASH_FOREACH_VAL(nameservers, znameserver) {
+        unsigned char buffer[sizeof(struct in6_addr)];
+        zval *zaddress, *zport = NULL;
+        ZVAL_DEREF(znameserver);
+        if (Z_TYPE_P(znameserver) == IS_ARRAY) {
+            zaddress = zend_hash_index_find(Z_ARRVAL_P(znameserver), 0);
+            zport = zend_hash_index_find(Z_ARRVAL_P(znameserver), 1);
+        } else {
+            zaddress = znameserver;
+        }
+        if (UNEXPECTED(zaddress == NULL || Z_TYPE_P(zaddress) != IS_STRING || (zport != NULL && Z_TYPE_P(zport) != IS_LONG))) {
+            zend_argument_value_error(1, "[%u] must be type of string or array with address and port", count);
+            RETURN_THROWS();
+        }
+        if (UNEXPECTED(uv_inet_pton(AF_INET, Z_STRVAL_P(zaddress), buffer) != 0 &&
+                       uv_inet_pton(AF_INET6, Z_STRVAL_P(zaddress), buffer) != 0)) {
+            zend_argument_value_error(1, "[%u] must be a valid IP address", count);
+            RETURN_THROWS();
+        }
+        addresses[count] = Z_STRVAL_P(zaddress);
+        ports[count] = zport != NULL ? Z_LVAL_P(zport) : 0;
+        count++;
+    } ZEND_HASH_FOREACH_END();
+
+    if (UNEXPECTED(!cat_dns_resolver_clear_nameservers())) {
+        swow_throw_exception_with_last(swow_socket_exception_ce);
+        RETURN_THROWS();
+    }
+    for (n = 0; n < count; n++) {
+        if (UNEXPECTED(!cat_dns_resolver_add_nameserver(addresses[n], (int) ports[n]))) {
+            swow_throw_exception_with_last(swow_socket_exception_ce);
+            RETURN_THROWS();
+        }
+    }
+}
+
+#define arginfo_class_Swow_Socket_getDnsResolverStats arginfo_class_Swow_Socket_getWriteStats
+
+static PHP_METHOD(Swow_Socket, getDnsResolverStats)
+{
+    cat_dns_resolver_stats_t stats;
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    cat_dns_resolver_get_stats(&stats);
+
+    array_init(return_value);
+    add_assoc_long(return_value, "queries", stats.queries);
+    add_assoc_long(return_value, "tcp_queries", stats.tcp_queries);
+    add_assoc_long(return_value, "timeouts", stats.timeouts);
+    add_assoc_long(return_value, "hosts_hits", stats.hosts_hits);
+}
+
+#define arginfo_class_Swow_Socket_resetDnsResolverStats arginfo_class_Swow_Socket_resetWriteStats
+
+static PHP_METHOD(Swow_Socket, resetDnsResolverStats)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    cat_dns_resolver_reset_stats();
+}
+
 ZEND_BEGIN_ARG_WITH_RETURN_THIS_INFO_EX(arginfo_class_Swow_Socket_bind, 1)
     ZEND_ARG_TYPE_INFO(0, name, IS_STRING, 0)
     ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, port, IS_LONG, 0, "0")
@@ -1161,6 +1520,285 @@ static PHP_METHOD(Swow_Socket, sendStringTo)
     PHP_METHOD_CALL(Swow_Socket, _sendString, 1);
 }
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_recvBatch, ZEND_RETURN_VALUE, 0, IS_ARRAY, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, count, IS_LONG, 0, "Swow\\Socket::DEFAULT_BATCH_COUNT")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, size, IS_LONG, 1, "null")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, timeout, IS_LONG, 1, "\'$this->getReadTimeout()\'")
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, recvBatch)
+{
+    SWOW_SOCKET_GETTER(ssocket, socket);
+    zend_long count = CAT_SOCKET_BATCH_SIZE;
+    zend_long size;
+    zend_bool size_is_null = 1;
+    zend_long timeout;
+    zend_bool timeout_is_null = 1;
+    cat_socket_datagram_t *datagrams, sdatagrams[8];
+    char *buffer;
+    zend_long slot_size;
+    ssize_t n, i;
+
+    ZEND_PARSE_PARAMETERS_START(0, 3)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG(count)
+        Z_PARAM_LONG_OR_NULL(size, size_is_null)
+        Z_PARAM_LONG_OR_NULL(timeout, timeout_is_null)
+    ZEND_PARSE_PARAMETERS_END();
+
+    /* check args and initialize */
+    if (UNEXPECTED(count <= 0)) {
+        zend_argument_value_error(1, "must be greater than 0");
+        RETURN_THROWS();
+    }
+    if (size_is_null) {
+        size = CAT_BUFFER_DEFAULT_SIZE;
+    } else if (UNEXPECTED(size <= 0)) {
+        zend_argument_value_error(2, "must be greater than 0");
+        RETURN_THROWS();
+    }
+    if (timeout_is_null) {
+        timeout = cat_socket_get_read_timeout(socket);
+    }
+    /* fewer datagrams are returned anyway, and no datagram is larger than 64K */
+    size = CAT_MIN(size, SWOW_SOCKET_MAX_DATAGRAM_SIZE);
+    /* one more byte is received to find out whether the datagram has been truncated */
+    slot_size = size + 1;
+    count = CAT_MIN(count, SWOW_SOCKET_MAX_BATCH_COUNT);
+    count = CAT_MIN(count, CAT_MAX(SWOW_SOCKET_MAX_BATCH_BUFFER_SIZE / slot_size, 1));
+    if (count <= (zend_long) CAT_ARRAY_SIZE(sdatagrams)) {
+        datagrams = sdatagrams;
+    } else {
+        datagrams = safe_emalloc(count, sizeof(*datagrams), 0);
+    }
+    /* datagrams are usually small, receive them into one block and copy them out */
+    buffer = safe_emalloc(count, slot_size, 0);
+    for (i = 0; i < count; i++) {
+        datagrams[i].buffer = buffer + (i * slot_size);
+        datagrams[i].length = slot_size;
+    }
+
+    n = cat_socket_recv_batch_ex(socket, datagrams, count, timeout);
+
+    array_init_size(return_value, n > 0 ? n : 0);
+    for (i = 0; i < n; i++) {
+        cat_socket_datagram_t *datagram = &datagrams[i];
+        char address[CAT_SOCKADDR_MAX_PATH];
+        size_t address_length = sizeof(address);
+        int port;
+        zend_bool truncated = datagram->length > (size_t) size;
+        zval ztuple, ztmp;
+        (void) cat_sockaddr_to_name(&datagram->address.address.common, datagram->address.length, address, &address_length, &port);
+        /* [data, address, port, truncated] */
+        array_init_size(&ztuple, 4);
+        ZVAL_STRINGL(&ztmp, datagram->buffer, truncated ? (size_t) size : datagram->length);
+        zend_hash_next_index_insert_new(Z_ARR(ztuple), &ztmp);
+        if (address_length == 0 || address_length > sizeof(address)) {
+            ZVAL_EMPTY_STRING(&ztmp);
+        } else {
+            ZVAL_STRINGL(&ztmp, address, address_length);
+        }
+        zend_hash_next_index_insert_new(Z_ARR(ztuple), &ztmp);
+        ZVAL_LONG(&ztmp, port);
+        zend_hash_next_index_insert_new(Z_ARR(ztuple), &ztmp);
+        ZVAL_BOOL(&ztmp, truncated);
+        zend_hash_next_index_insert_new(Z_ARR(ztuple), &ztmp);
+        zend_hash_next_index_insert_new(Z_ARR_P(return_value), &ztuple);
+    }
+
+    efree(buffer);
+    if (datagrams != sdatagrams) {
+        efree(datagrams);
+    }
+
+    if (UNEXPECTED(n < 0)) {
+        swow_throw_call_exception_with_last(swow_socket_exception_ce);
+        RETURN_THROWS();
+    }
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_sendBatch, ZEND_RETURN_VALUE, 1, IS_LONG, 0)
+    ZEND_ARG_TYPE_INFO(0, datagrams, IS_ARRAY, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, timeout, IS_LONG, 1, "\'$this->getWriteTimeout()\'")
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, sendBatch)
+{
+    SWOW_SOCKET_GETTER(ssocket, socket);
+    HashTable *datagram_array;
+    zend_long timeout;
+    zend_bool timeout_is_null = 1;
+    cat_socket_datagram_t *datagrams, sdatagrams[8];
+    uint32_t count = 0;
+    ssize_t n;
+    zval *ztmp;
+
+    ZEND_PARSE_PARAMETERS_START(1, 2)
+        Z_PARAM_ARRAY_HT(datagram_array)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG_OR_NULL(timeout, timeout_is_null)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (timeout_is_null) {
+        timeout = cat_socket_get_write_timeout(socket);
+    }
+    if (zend_hash_num_elements(datagram_array) <= CAT_ARRAY_SIZE(sdatagrams)) {
+        datagrams = sdatagrams;
+    } else {
+        datagrams = safe_emalloc(zend_hash_num_elements(datagram_array), sizeof(*datagrams), 0);
+    }
+
+    ZEND_HASH_FOREACH_VAL(datagram_array, ztmp) {
+        cat_socket_datagram_t *datagram = &datagrams[count];
+        zval *zdata, *zaddress = NULL, *zport = NULL;
+        ZVAL_DEREF(ztmp);
+        if (Z_TYPE_P(ztmp) == IS_STRING) {
+            /* just a string (to the connected peer) */
+            zdata = ztmp;
+        } else if (Z_TYPE_P(ztmp) == IS_ARRAY) {
+            /* [string, address, port] */
+            zdata = zend_hash_index_find(Z_ARR_P(ztmp), 0);
+            zaddress = zend_hash_index_find(Z_ARR_P(ztmp), 1);
+            zport = zend_hash_index_find(Z_ARR_P(ztmp), 2);
+            if (UNEXPECTED(zdata == NULL || Z_TYPE_P(zdata) != IS_STRING)) {
+                zend_argument_value_error(1, "[%u][0] must be type of string", count);
+                goto _error;
+            }
+            if (zaddress != NULL && Z_TYPE_P(zaddress) == IS_NULL) {
+                zaddress = NULL;
+            }
+            if (UNEXPECTED(zaddress != NULL && Z_TYPE_P(zaddress) != IS_STRING)) {
+                zend_argument_value_error(1, "[%u][1] must be type of string or null", count);
+                goto _error;
+            }
+            if (UNEXPECTED(zport != NULL && Z_TYPE_P(zport) != IS_LONG)) {
+                zend_argument_value_error(1, "[%u][2] must be type of int", count);
+                goto _error;
+            }
+        } else {
+            zend_argument_value_error(1, "[%u] must be type of string or array, %s given", count, zend_zval_type_name(ztmp));
+            goto _error;
+        }
+        datagram->buffer = Z_STRVAL_P(zdata);
+        datagram->length = Z_STRLEN_P(zdata);
+        datagram->address.length = 0;
+        if (zaddress != NULL && Z_STRLEN_P(zaddress) != 0) {
+            /* only IP address is accepted here, resolving names per datagram makes no sense */
+            datagram->address.address.common.sa_family = cat_socket_get_af(socket);
+            datagram->address.length = sizeof(datagram->address.address);
+            if (UNEXPECTED(!cat_sockaddr_getbyname(
+                &datagram->address.address.common, &datagram->address.length,
+                Z_STRVAL_P(zaddress), Z_STRLEN_P(zaddress), zport != NULL ? (int) Z_LVAL_P(zport) : 0
+            ))) {
+                swow_throw_exception_with_last(swow_socket_exception_ce);
+                goto _error;
+            }
+        }
+        count++;
+    } ZEND_HASH_FOREACH_END();
+
+    n = cat_socket_send_batch_ex(socket, datagrams, count, timeout);
+
+    /* also for socket exception getReturnValue */
+    RETVAL_LONG(n > 0 ? n : 0);
+
+    if (UNEXPECTED(n != (ssize_t) count)) {
+        swow_throw_call_exception_with_last(swow_socket_exception_ce);
+        goto _error;
+    }
+
+    if (0) {
+        _error:
+        RETURN_THROWS_ASSERTION();
+    }
+    if (datagrams != sdatagrams) {
+        efree(datagrams);
+    }
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_sendFile, ZEND_RETURN_VALUE, 1, IS_LONG, 0)
+    ZEND_ARG_INFO(0, file)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, offset, IS_LONG, 0, "0")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, length, IS_LONG, 0, "0")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, timeout, IS_LONG, 1, "\'$this->getWriteTimeout()\'")
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, sendFile)
+{
+    SWOW_SOCKET_GETTER(ssocket, socket);
+    zval *zfile;
+    zend_long offset = 0;
+    zend_long length = 0;
+    zend_long timeout;
+    zend_bool timeout_is_null = 1;
+    int fd;
+    zend_bool opened = 0;
+    ssize_t ret;
+
+    ZEND_PARSE_PARAMETERS_START(1, 4)
+        Z_PARAM_ZVAL(zfile)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG(offset)
+        Z_PARAM_LONG(length)
+        Z_PARAM_LONG_OR_NULL(timeout, timeout_is_null)
+    ZEND_PARSE_PARAMETERS_END();
+
+    /* check args and initialize */
+    if (UNEXPECTED(offset < 0)) {
+        zend_argument_value_error(2, "must be greater than or equal to 0");
+        RETURN_THROWS();
+    }
+    if (UNEXPECTED(length < 0)) {
+        zend_argument_value_error(3, "must be greater than or equal to 0");
+        RETURN_THROWS();
+    }
+    if (timeout_is_null) {
+        timeout = cat_socket_get_write_timeout(socket);
+    }
+    if (Z_TYPE_P(zfile) == IS_STRING) {
+        /* file path */
+        if (UNEXPECTED(zend_str_has_nul_byte(Z_STR_P(zfile)))) {
+            zend_argument_value_error(1, "must not contain any null bytes");
+            RETURN_THROWS();
+        }
+        if (php_check_open_basedir_ex(Z_STRVAL_P(zfile), 0)) {
+            swow_throw_exception(swow_socket_exception_ce, CAT_EPERM, "open_basedir restriction in effect, file(%s) is not within the allowed path(s)", Z_STRVAL_P(zfile));
+            RETURN_THROWS();
+        }
+        fd = cat_fs_open(Z_STRVAL_P(zfile), O_RDONLY);
+        if (UNEXPECTED(fd < 0)) {
+            swow_throw_exception_with_last(swow_socket_exception_ce);
+            RETURN_THROWS();
+        }
+        opened = 1;
+    } else if (Z_TYPE_P(zfile) == IS_RESOURCE) {
+        /* plain file stream */
+        php_stream *stream;
+        php_stream_from_zval(stream, zfile);
+        if (UNEXPECTED(php_stream_cast(stream, PHP_STREAM_AS_FD, (void **) &fd, REPORT_ERRORS) != SUCCESS)) {
+            RETURN_THROWS();
+        }
+    } else {
+        zend_argument_type_error(1, "must be of type string or resource, %s given", zend_zval_type_name(zfile));
+        RETURN_THROWS();
+    }
+
+    ret = cat_socket_sendfile_ex(socket, fd, offset, length, timeout);
+
+    if (opened) {
+        CAT_PROTECT_LAST_ERROR_START() {
+            (void) cat_fs_close(fd);
+        } CAT_PROTECT_LAST_ERROR_END();
+    }
+
+    if (UNEXPECTED(ret < 0)) {
+        swow_throw_call_exception_with_last(swow_socket_exception_ce);
+        RETURN_THROWS();
+    }
+
+    RETURN_LONG(ret);
+}
+
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_close, ZEND_RETURN_VALUE, 0, _IS_BOOL, 0)
 ZEND_END_ARG_INFO()
 
@@ -1203,6 +1841,17 @@ static PHP_METHOD(Swow_Socket, isEstablished)
     RETURN_BOOL(cat_socket_is_established(socket));
 }
 
+#define arginfo_class_Swow_Socket_isStickyRead arginfo_class_Swow_Socket_getBool
+
+static PHP_METHOD(Swow_Socket, isStickyRead)
+{
+    SWOW_SOCKET_GETTER(ssocket, socket);
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_BOOL(cat_socket_is_sticky_read(socket));
+}
+
 ZEND_BEGIN_ARG_WITH_RETURN_THIS_INFO_EX(arginfo_class_Swow_Socket_checkLiveness, 0)
 ZEND_END_ARG_INFO()
 
@@ -1409,6 +2058,29 @@ static PHP_METHOD(Swow_Socket, setTcpAcceptBalance)
     RETURN_THIS();
 }
 
+#define arginfo_class_Swow_Socket_setStickyRead arginfo_class_Swow_Socket_setBool
+
+static PHP_METHOD(Swow_Socket, setStickyRead)
+{
+    SWOW_SOCKET_GETTER(ssocket, socket);
+    zend_bool enable = cat_true;
+    cat_bool_t ret;
+
+    ZEND_PARSE_PARAMETERS_START(0, 1)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_BOOL(enable)
+    ZEND_PARSE_PARAMETERS_END();
+
+    ret = cat_socket_set_sticky_read(socket, enable);
+
+    if (UNEXPECTED(!ret)) {
+        swow_throw_exception_with_last(swow_socket_exception_ce);
+        RETURN_THROWS();
+    }
+
+    RETURN_THIS();
+}
+
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket___debugInfo, ZEND_RETURN_VALUE, 0, IS_ARRAY, 0)
 ZEND_END_ARG_INFO()
 
@@ -1469,6 +2141,7 @@ static const zend_function_entry swow_socket_methods[] = {
     PHP_ME(Swow_Socket, getType,                   arginfo_class_Swow_Socket_getType,             ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, getTypeName,               arginfo_class_Swow_Socket_getTypeName,         ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, getFd,                     arginfo_class_Swow_Socket_getFd,               ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Socket, getWriteQueueSize,         arginfo_class_Swow_Socket_getWriteQueueSize,   ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, getDnsTimeout,             arginfo_class_Swow_Socket_getTimeout,          ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, getAcceptTimeout,          arginfo_class_Swow_Socket_getTimeout,          ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, getConnectTimeout,         arginfo_class_Swow_Socket_getTimeout,          ZEND_ACC_PUBLIC)
@@ -1510,10 +2183,14 @@ static const zend_function_entry swow_socket_methods[] = {
     PHP_ME(Swow_Socket, sendTo,                    arginfo_class_Swow_Socket_sendTo,              ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, sendString,                arginfo_class_Swow_Socket_sendString,          ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, sendStringTo,              arginfo_class_Swow_Socket_sendStringTo,        ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Socket, recvBatch,                 arginfo_class_Swow_Socket_recvBatch,           ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Socket, sendBatch,                 arginfo_class_Swow_Socket_sendBatch,           ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Socket, sendFile,                  arginfo_class_Swow_Socket_sendFile,            ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, close,                     arginfo_class_Swow_Socket_close,               ZEND_ACC_PUBLIC)
     /* status */
     PHP_ME(Swow_Socket, isAvailable,               arginfo_class_Swow_Socket_isAvailable,         ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, isEstablished,             arginfo_class_Swow_Socket_isEstablished,       ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Socket, isStickyRead,              arginfo_class_Swow_Socket_isStickyRead,        ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, checkLiveness,             arginfo_class_Swow_Socket_checkLiveness,       ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, getIoState,                arginfo_class_Swow_Socket_getIoState,          ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, getIoStateName,            arginfo_class_Swow_Socket_getIoStateName,      ZEND_ACC_PUBLIC)
@@ -1526,6 +2203,7 @@ static const zend_function_entry swow_socket_methods[] = {
     PHP_ME(Swow_Socket, setTcpNodelay,             arginfo_class_Swow_Socket_setTcpNodelay,       ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, setTcpKeepAlive,           arginfo_class_Swow_Socket_setTcpKeepAlive,     ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, setTcpAcceptBalance,       arginfo_class_Swow_Socket_setTcpAcceptBalance, ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Socket, setStickyRead,             arginfo_class_Swow_Socket_setStickyRead,       ZEND_ACC_PUBLIC)
     /* magic */
     PHP_ME(Swow_Socket, __debugInfo,               arginfo_class_Swow_Socket___debugInfo,         ZEND_ACC_PUBLIC)
     /* globals */
@@ -1542,6 +2220,27 @@ static const zend_function_entry swow_socket_methods[] = {
     PHP_ME(Swow_Socket, setGlobalHandshakeTimeout, arginfo_class_Swow_Socket_setGlobalTimeout,    ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Swow_Socket, setGlobalReadTimeout,      arginfo_class_Swow_Socket_setGlobalTimeout,    ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Swow_Socket, setGlobalWriteTimeout,     arginfo_class_Swow_Socket_setGlobalTimeout,    ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, getGlobalTryWrite,         arginfo_class_Swow_Socket_getGlobalTryWrite,   ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, setGlobalTryWrite,         arginfo_class_Swow_Socket_setGlobalTryWrite,   ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, getGlobalStickyRead,       arginfo_class_Swow_Socket_getGlobalStickyRead, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, setGlobalStickyRead,       arginfo_class_Swow_Socket_setGlobalStickyRead, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, getWriteStats,             arginfo_class_Swow_Socket_getWriteStats,       ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, resetWriteStats,           arginfo_class_Swow_Socket_resetWriteStats,     ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, getGlobalDnsCacheSize,        arginfo_class_Swow_Socket_getGlobalDnsCacheSize,        ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, setGlobalDnsCacheSize,        arginfo_class_Swow_Socket_setGlobalDnsCacheSize,        ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, getGlobalDnsCacheTtl,         arginfo_class_Swow_Socket_getGlobalDnsCacheTtl,         ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, setGlobalDnsCacheTtl,         arginfo_class_Swow_Socket_setGlobalDnsCacheTtl,         ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, getGlobalDnsCacheNegativeTtl, arginfo_class_Swow_Socket_getGlobalDnsCacheNegativeTtl, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, setGlobalDnsCacheNegativeTtl, arginfo_class_Swow_Socket_setGlobalDnsCacheNegativeTtl, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, flushDnsCache,                arginfo_class_Swow_Socket_flushDnsCache,                ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, getDnsCacheStats,             arginfo_class_Swow_Socket_getDnsCacheStats,             ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, resetDnsCacheStats,           arginfo_class_Swow_Socket_resetDnsCacheStats,           ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, isDnsResolverEnabled,         arginfo_class_Swow_Socket_isDnsResolverEnabled,         ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, setDnsResolverEnabled,        arginfo_class_Swow_Socket_setDnsResolverEnabled,        ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, loadDnsResolverConfig,        arginfo_class_Swow_Socket_loadDnsResolverConfig,        ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, setDnsResolverNameservers,    arginfo_class_Swow_Socket_setDnsResolverNameservers,    ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, getDnsResolverStats,          arginfo_class_Swow_Socket_getDnsResolverStats,          ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, resetDnsResolverStats,        arginfo_class_Swow_Socket_resetDnsResolverStats,        ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_FE_END
 };
 
@@ -1562,6 +2261,7 @@ int swow_socket_module_init(INIT_FUNC_ARGS)
     /* constants */
     zend_declare_class_constant_long(swow_socket_ce, ZEND_STRL("INVALID_FD"), CAT_SOCKET_INVALID_FD);
     zend_declare_class_constant_long(swow_socket_ce, ZEND_STRL("DEFAULT_BACKLOG"), CAT_SOCKET_DEFAULT_BACKLOG);
+    zend_declare_class_constant_long(swow_socket_ce, ZEND_STRL("DEFAULT_BATCH_COUNT"), CAT_SOCKET_BATCH_SIZE);
 #define SWOW_SOCKET_TYPE_FLAG_GEN(name, value) \
     zend_declare_class_constant_long(swow_socket_ce, ZEND_STRL("TYPE_FLAG_" #name), (value));
     CAT_SOCKET_TYPE_FLAG_MAP(SWOW_SOCKET_TYPE_FLAG_GEN)
@@ -1594,3 +2294,12 @@ int swow_socket_runtime_init(INIT_FUNC_ARGS)
 
     return SUCCESS;
 }
+
+int swow_socket_runtime_shutdown(SHUTDOWN_FUNC_ARGS)
+{
+    if (!cat_socket_runtime_shutdown()) {
+        return FAILURE;
+    }
+
+    return SUCCESS;
+}
@@ -21,6 +21,7 @@
 #include "swow_hook.h"
 
 #include "cat_socket.h"
+#include "cat_fs.h"
 #include "cat_time.h" /* for time_tv2to() */
 
 #include "php.h"
@@ -854,6 +855,9 @@ typedef struct {
 
 static php_stream_ops swow_stream_stdio_raw_ops;
 static cat_socket_t *swow_stream_tty_sockets[3];
+#ifdef SWOW_STREAM_ASYNC_FILE_IO
+static cat_bool_t swow_stream_async_file_io;
+#endif
 
 static cat_socket_t *swow_stream_stdio_init(php_stream *stream)
 {
@@ -883,11 +887,103 @@ static cat_socket_t *swow_stream_stdio_init(php_stream *stream)
     return socket;
 }
 
+#ifdef SWOW_STREAM_ASYNC_FILE_IO
+/* regular files which are opened by fd (without FILE *) can be operated by cat_fs,
+ * (pipes, sockets and other character devices are not seekable) */
+static int swow_stream_stdio_get_async_file(php_stream *stream)
+{
+    php_stdio_stream_data *data = (php_stdio_stream_data *) stream->abstract;
+
+    if (!swow_stream_async_file_io ||
+        data->file != NULL || data->fd < 0 ||
+        (stream->flags & PHP_STREAM_FLAG_NO_SEEK)) {
+        return -1;
+    }
+
+    return data->fd;
+}
+
+static void swow_stream_file_report_error(php_stream *stream, const char *operation, size_t size)
+{
+    errno = -cat_get_last_error_code();
+#ifdef PHP_STREAM_FLAG_SUPPRESS_ERRORS
+    if (!(stream->flags & PHP_STREAM_FLAG_SUPPRESS_ERRORS))
+#endif
+    {
+        php_error_docref(NULL, E_NOTICE, "%s of %zu bytes failed with errno=%d %s", operation, size, errno, strerror(errno));
+    }
+}
+
+static bytes_t swow_stream_file_read(php_stream *stream, int fd, char *buffer, size_t size)
+{
+    ssize_t n;
+
+    n = cat_fs_read(fd, buffer, size);
+
+    if (unlikely(n < 0)) {
+        swow_stream_file_report_error(stream, "Read", size);
+        if (errno != EBADF) {
+            stream->eof = 1;
+        }
+        return PHP_STREAM_SOCKET_RETURN_ERR;
+    }
+    if (n == 0) {
+        stream->eof = 1;
+    }
+
+    return n;
+}
+
+static bytes_t swow_stream_file_write(php_stream *stream, int fd, const char *buffer, size_t length)
+{
+    ssize_t n;
+
+    n = cat_fs_write(fd, buffer, length);
+
+    if (unlikely(n < 0)) {
+        swow_stream_file_report_error(stream, "Write", length);
+        return PHP_STREAM_SOCKET_RETURN_ERR;
+    }
+
+    return n;
+}
+
+static void swow_stream_file_stat_convert(zend_stat_t *sb, const cat_stat_t *statbuf)
+{
+    memset(sb, 0, sizeof(*sb));
+    sb->st_dev = statbuf->st_dev;
+    sb->st_ino = statbuf->st_ino;
+    sb->st_mode = statbuf->st_mode;
+    sb->st_nlink = statbuf->st_nlink;
+    sb->st_uid = statbuf->st_uid;
+    sb->st_gid = statbuf->st_gid;
+    sb->st_rdev = statbuf->st_rdev;
+    sb->st_size = statbuf->st_size;
+#ifdef HAVE_STRUCT_STAT_ST_BLKSIZE
+    sb->st_blksize = statbuf->st_blksize;
+#endif
+#ifdef HAVE_STRUCT_STAT_ST_BLOCKS
+    sb->st_blocks = statbuf->st_blocks;
+#endif
+    sb->st_atime = statbuf->st_atim.tv_sec;
+    sb->st_mtime = statbuf->st_mtim.tv_sec;
+    sb->st_ctime = statbuf->st_ctim.tv_sec;
+}
+#endif
+
 static bytes_t swow_stream_stdio_read(php_stream *stream, char *buffer, size_t size)
 {
     cat_socket_t *socket = swow_stream_stdio_init(stream);
 
     if (socket == NULL) {
+#ifdef SWOW_STREAM_ASYNC_FILE_IO
+        if (size > SWOW_STREAM_FILE_SYNC_IO_THRESHOLD) {
+            int fd = swow_stream_stdio_get_async_file(stream);
+            if (fd >= 0) {
+                return swow_stream_file_read(stream, fd, buffer, size);
+            }
+        }
+#endif
         return swow_stream_stdio_raw_ops.read(stream, buffer, size);
     }
 
@@ -900,6 +996,14 @@ static bytes_t swow_stream_stdio_write(php_stream *stream, const char *buffer, s
     cat_bool_t ret;
 
     if (socket == NULL) {
+#ifdef SWOW_STREAM_ASYNC_FILE_IO
+        if (length > SWOW_STREAM_FILE_SYNC_IO_THRESHOLD) {
+            int fd = swow_stream_stdio_get_async_file(stream);
+            if (fd >= 0) {
+                return swow_stream_file_write(stream, fd, buffer, length);
+            }
+        }
+#endif
         return swow_stream_stdio_raw_ops.write(stream, buffer, length);
     }
 
@@ -934,11 +1038,40 @@ static int swow_stream_stdio_cast(php_stream *stream, int castas, void **ret)
 
 static int swow_stream_stdio_stat(php_stream *stream, php_stream_statbuf *ssb)
 {
+#ifdef SWOW_STREAM_ASYNC_FILE_IO
+    int fd = swow_stream_stdio_get_async_file(stream);
+
+    if (fd >= 0) {
+        cat_stat_t statbuf;
+        if (unlikely(cat_fs_fstat(fd, &statbuf) != 0)) {
+            errno = -cat_get_last_error_code();
+            return -1;
+        }
+        swow_stream_file_stat_convert(&ssb->sb, &statbuf);
+        return 0;
+    }
+#endif
+
     return swow_stream_stdio_raw_ops.stat(stream, ssb);
 }
 
 static int swow_stream_stdio_set_option(php_stream *stream, int option, int value, void *ptrparam)
 {
+#if defined(SWOW_STREAM_ASYNC_FILE_IO) && defined(PHP_STREAM_OPTION_SYNC_API)
+    if (option == PHP_STREAM_OPTION_SYNC_API &&
+        (value == PHP_STREAM_SYNC_FSYNC || value == PHP_STREAM_SYNC_FDSYNC)) {
+        int fd = swow_stream_stdio_get_async_file(stream);
+        if (fd >= 0) {
+            int ret = value == PHP_STREAM_SYNC_FSYNC ? cat_fs_fsync(fd) : cat_fs_fdatasync(fd);
+            if (unlikely(ret != 0)) {
+                errno = -cat_get_last_error_code();
+                return PHP_STREAM_OPTION_RETURN_ERR;
+            }
+            return PHP_STREAM_OPTION_RETURN_OK;
+        }
+    }
+#endif
+
     return swow_stream_stdio_raw_ops.set_option(stream, option, value, ptrparam);
 }
 
@@ -952,6 +1085,61 @@ SWOW_API const php_stream_ops swow_stream_stdio_ops = {
     swow_stream_stdio_set_option,
 };
 
+#ifdef SWOW_STREAM_ASYNC_FILE_IO
+static const php_stream_wrapper_ops *swow_stream_plain_files_wrapper_raw_ops;
+static php_stream_wrapper_ops swow_stream_plain_files_wrapper_ops;
+
+static php_stream *swow_stream_plain_files_opener(
+    php_stream_wrapper *wrapper, const char *path, const char *mode,
+    int options, zend_string **opened_path, php_stream_context *context STREAMS_DC
+)
+{
+    char realpath[MAXPATHLEN];
+    php_stream *stream;
+    int open_flags;
+    int fd;
+
+    /* persistent or include streams need some private handling, leave them to PHP */
+    if (!swow_stream_async_file_io || (options & (STREAM_OPEN_PERSISTENT | STREAM_OPEN_FOR_INCLUDE))
+#ifdef STREAM_USE_BLOCKING_PIPE
+        || (options & STREAM_USE_BLOCKING_PIPE)
+#endif
+    ) {
+        return swow_stream_plain_files_wrapper_raw_ops->stream_opener(wrapper, path, mode, options, opened_path, context STREAMS_REL_CC);
+    }
+
+    if (((options & STREAM_DISABLE_OPEN_BASEDIR) == 0) && php_check_open_basedir(path)) {
+        return NULL;
+    }
+    if (php_stream_parse_fopen_modes(mode, &open_flags) == FAILURE) {
+        php_stream_wrapper_log_error(wrapper, options, "`%s' is not a valid mode for fopen", mode);
+        return NULL;
+    }
+    if (options & STREAM_ASSUME_REALPATH) {
+        strlcpy(realpath, path, sizeof(realpath));
+    } else if (expand_filepath(path, realpath) == NULL) {
+        return NULL;
+    }
+
+    fd = cat_fs_open(realpath, open_flags, 0666);
+    if (fd < 0) {
+        /* it will be reported by php_stream_display_wrapper_errors() */
+        errno = -cat_get_last_error_code();
+        return NULL;
+    }
+    stream = php_stream_fopen_from_fd(fd, mode, NULL);
+    if (stream == NULL) {
+        close(fd);
+        return NULL;
+    }
+    if (opened_path != NULL) {
+        *opened_path = zend_string_init(realpath, strlen(realpath), 0);
+    }
+
+    return stream;
+}
+#endif
+
 #undef INVALID_TTY_SOCKET
 #undef IS_TTY
 
@@ -1037,6 +1225,14 @@ int swow_stream_module_init(INIT_FUNC_ARGS)
         memcpy(&swow_stream_stdio_raw_ops, &php_stream_stdio_ops, sizeof(php_stream_stdio_ops));
         memcpy(&php_stream_stdio_ops, &swow_stream_stdio_ops, sizeof(php_stream_stdio_ops));
     }
+#ifdef SWOW_STREAM_ASYNC_FILE_IO
+    if ("file") {
+        swow_stream_plain_files_wrapper_raw_ops = php_plain_files_wrapper.wops;
+        memcpy(&swow_stream_plain_files_wrapper_ops, php_plain_files_wrapper.wops, sizeof(swow_stream_plain_files_wrapper_ops));
+        swow_stream_plain_files_wrapper_ops.stream_opener = swow_stream_plain_files_opener;
+        php_plain_files_wrapper.wops = &swow_stream_plain_files_wrapper_ops;
+    }
+#endif
     if (!swow_hook_internal_functions(swow_stream_functions)) {
         return FAILURE;
     }
@@ -1047,6 +1243,9 @@ int swow_stream_module_init(INIT_FUNC_ARGS)
 int swow_stream_runtime_init(INIT_FUNC_ARGS)
 {
     memset(swow_stream_tty_sockets, 0, sizeof(swow_stream_tty_sockets));
+#ifdef SWOW_STREAM_ASYNC_FILE_IO
+    swow_stream_async_file_io = cat_true;
+#endif
 
     return SUCCESS;
 }
@@ -1054,6 +1253,11 @@ int swow_stream_runtime_init(INIT_FUNC_ARGS)
 int swow_stream_runtime_shutdown(INIT_FUNC_ARGS)
 {
     size_t i = 0;
+
+#ifdef SWOW_STREAM_ASYNC_FILE_IO
+    /* event loop will be unavailable soon */
+    swow_stream_async_file_io = cat_false;
+#endif
     for (; i < CAT_ARRAY_SIZE(swow_stream_tty_sockets); i++) {
         cat_socket_t *socket = swow_stream_tty_sockets[i];
         if (socket != NULL) {
@@ -18,6 +18,8 @@
 
 #include "swow_watch_dog.h"
 
+#include "swow_coroutine.h" /* for time slice */
+
 #include "cat_time.h" /* for time_wait() */
 
 SWOW_API zend_class_entry *swow_watch_dog_ce;
@@ -53,14 +55,105 @@ SWOW_API void swow_watch_dog_alert_standard(cat_watch_dog_t *watch_dog)
     }
 }
 
+/* it is called in watch-dog thread */
+static void swow_watch_dog_sampler(cat_watch_dog_t *watch_dog)
+{
+    swow_watch_dog_t *swatch_dog = swow_watch_dog_get_from_handle(watch_dog);
+
+    /* scheduler is running, PHP thread is idle or it is handling IO events */
+    if (watch_dog->globals->current == watch_dog->globals->scheduler) {
+        return;
+    }
+
+    swatch_dog->sample_requested = 1;
+    *swatch_dog->vm_interrupt_ptr = 1;
+}
+
+/* fold the call stack of current coroutine into "outermost;...;innermost" and count it */
+static void swow_watch_dog_take_sample(swow_watch_dog_t *swatch_dog, zend_execute_data *execute_data)
+{
+    zend_execute_data *frames[SWOW_WATCH_DOG_PROFILER_MAX_DEPTH];
+    uint32_t depth = 0;
+    smart_str str = { 0 };
+    zval *zcount;
+
+    for (; execute_data != NULL && depth < SWOW_WATCH_DOG_PROFILER_MAX_DEPTH; execute_data = execute_data->prev_execute_data) {
+        /* skip dummy frames */
+        if (execute_data->func != NULL) {
+            frames[depth++] = execute_data;
+        }
+    }
+    if (swatch_dog->profiling_per_coroutine) {
+        smart_str_appendl(&str, ZEND_STRL("coroutine#"));
+        smart_str_append_unsigned(&str, cat_coroutine_get_current_id());
+    }
+    while (depth-- > 0) {
+        zend_function *function = frames[depth]->func;
+        if (str.s != NULL) {
+            smart_str_appendc(&str, ';');
+        }
+        if (function->common.function_name == NULL) {
+            smart_str_appendl(&str, ZEND_STRL("{main}"));
+            continue;
+        }
+        if (function->common.scope != NULL) {
+            smart_str_append(&str, function->common.scope->name);
+            smart_str_appendl(&str, ZEND_STRL("::"));
+        }
+        smart_str_append(&str, function->common.function_name);
+    }
+    if (str.s == NULL) {
+        return;
+    }
+    smart_str_0(&str);
+
+    zcount = zend_hash_find(swatch_dog->samples, str.s);
+    if (zcount == NULL && zend_hash_num_elements(swatch_dog->samples) >= SWOW_WATCH_DOG_PROFILER_MAX_STACKS) {
+        /* e.g. there are too many short-lived coroutines in per-coroutine mode */
+        zcount = zend_hash_str_find(swatch_dog->samples, ZEND_STRL("{dropped}"));
+        if (zcount == NULL) {
+            zval ztmp;
+            ZVAL_LONG(&ztmp, 0);
+            zcount = zend_hash_str_add_new(swatch_dog->samples, ZEND_STRL("{dropped}"), &ztmp);
+        }
+    }
+    if (zcount != NULL) {
+        Z_LVAL_P(zcount)++;
+    } else {
+        zval ztmp;
+        ZVAL_LONG(&ztmp, 1);
+        zend_hash_add_new(swatch_dog->samples, str.s, &ztmp);
+    }
+    smart_str_free(&str);
+}
+
 static void swow_watch_dog_interrupt_function(zend_execute_data *execute_data)
 {
     if (cat_watch_dog_is_running()) {
         swow_watch_dog_t *swatch_dog = swow_watch_dog_get_current();
         cat_watch_dog_t *watch_dog = &swatch_dog->watch_dog;
+        if (swatch_dog->sample_requested) {
+            swatch_dog->sample_requested = 0;
+            if (swatch_dog->profiling) {
+                swow_watch_dog_take_sample(swatch_dog, execute_data);
+            }
+        }
+        /* it is not interrupted by alerter (but by sampler or others) */
+        if (swatch_dog->vm_interrupted) {
+            goto _original;
+        }
         swatch_dog->vm_interrupted = 1;
         /* re-check if current round still equal to last_round  */
         if (CAT_COROUTINE_G(round) == watch_dog->last_round) {
+            cat_nsec_t time_slice = swow_coroutine_get_current()->time_slice;
+            if (time_slice == 0) {
+                time_slice = swatch_dog->time_slice;
+            }
+            if (time_slice < 0 || ((cat_nsec_t) (watch_dog->quantum * watch_dog->alert_count)) < time_slice) {
+                /* not preemptible, or its time slice has not been used up yet
+                 * (watch-dog will alert again on the next quantum) */
+                goto _original;
+            }
             if (swatch_dog->alerter.function_handler == NULL) {
                 if (!cat_time_wait(swatch_dog->delay) &&
                     cat_get_last_error_code() != CAT_ETIMEDOUT
@@ -86,12 +179,13 @@ static void swow_watch_dog_interrupt_function(zend_execute_data *execute_data)
         }
     }
 
+    _original:
     if (original_zend_interrupt_function != NULL) {
         original_zend_interrupt_function(execute_data);
     }
 }
 
-SWOW_API cat_bool_t swow_watch_dog_run(cat_usec_t quantum, cat_nsec_t threshold, zval *zalerter)
+SWOW_API cat_bool_t swow_watch_dog_run(cat_usec_t quantum, cat_nsec_t threshold, zval *zalerter, cat_nsec_t time_slice)
 {
     swow_watch_dog_t *swatch_dog;
     zend_fcall_info_cache fcc = empty_fcall_info_cache;
@@ -119,14 +213,20 @@ SWOW_API cat_bool_t swow_watch_dog_run(cat_usec_t quantum, cat_nsec_t threshold,
     }
 
     swatch_dog = (swow_watch_dog_t *) emalloc(sizeof(*swatch_dog));
+    swatch_dog->vm_interrupted = 1;
     swatch_dog->vm_interrupt_ptr = &EG(vm_interrupt);
     swatch_dog->delay = delay;
     swatch_dog->alerter = fcc;
+    swatch_dog->time_slice = time_slice;
     if (zalerter != NULL) {
         ZVAL_COPY(&swatch_dog->zalerter, zalerter);
     } else {
         ZVAL_NULL(&swatch_dog->zalerter);
     }
+    swatch_dog->profiling = 0;
+    swatch_dog->profiling_per_coroutine = 0;
+    swatch_dog->sample_requested = 0;
+    swatch_dog->samples = NULL;
 
     ret = cat_watch_dog_run(&swatch_dog->watch_dog, quantum, threshold, swow_watch_dog_alert_standard);
 
@@ -151,15 +251,85 @@ SWOW_API cat_bool_t swow_watch_dog_stop(void)
     }
 
     zval_ptr_dtor(&swatch_dog->zalerter);
+    if (swatch_dog->samples != NULL) {
+        zend_array_destroy(swatch_dog->samples);
+    }
     efree(swatch_dog);
 
     return cat_true;
 }
 
+SWOW_API cat_bool_t swow_watch_dog_start_profiling(cat_bool_t per_coroutine)
+{
+    swow_watch_dog_t *swatch_dog;
+
+    if (!cat_watch_dog_set_sampler(swow_watch_dog_sampler)) {
+        return cat_false;
+    }
+    swatch_dog = swow_watch_dog_get_current();
+
+    /* samples of the last profiling are discarded */
+    if (swatch_dog->samples == NULL) {
+        zval ztmp;
+        array_init(&ztmp);
+        swatch_dog->samples = Z_ARRVAL(ztmp);
+    } else {
+        zend_hash_clean(swatch_dog->samples);
+    }
+    swatch_dog->profiling_per_coroutine = per_coroutine;
+    swatch_dog->profiling = 1;
+
+    return cat_true;
+}
+
+SWOW_API cat_bool_t swow_watch_dog_stop_profiling(void)
+{
+    swow_watch_dog_t *swatch_dog;
+
+    if (!cat_watch_dog_set_sampler(NULL)) {
+        return cat_false;
+    }
+    swatch_dog = swow_watch_dog_get_current();
+
+    /* samples are kept until the next profiling or watch-dog is stopped */
+    swatch_dog->profiling = 0;
+
+    return cat_true;
+}
+
+SWOW_API HashTable *swow_watch_dog_get_samples(void)
+{
+    swow_watch_dog_t *swatch_dog = swow_watch_dog_get_current();
+
+    return swatch_dog != NULL ? swatch_dog->samples : NULL;
+}
+
+SWOW_API zend_string *swow_watch_dog_get_folded_samples(void)
+{
+    HashTable *samples = swow_watch_dog_get_samples();
+    smart_str str = { 0 };
+    zend_string *stack;
+    zval *zcount;
+
+    if (samples == NULL || zend_hash_num_elements(samples) == 0) {
+        return ZSTR_EMPTY_ALLOC();
+    }
+    ZEND_HASH_FOREACH_STR_KEY_VAL(samples, stack, zcount) {
+        smart_str_append(&str, stack);
+        smart_str_appendc(&str, ' ');
+        smart_str_append_long(&str, Z_LVAL_P(zcount));
+        smart_str_appendc(&str, '\n');
+    } ZEND_HASH_FOREACH_END();
+    smart_str_0(&str);
+
+    return str.s;
+}
+
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_WatchDog_run, ZEND_RETURN_VALUE, 0, IS_VOID, 0)
     ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, quantum, IS_LONG, 0, "0")
     ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, threshold, IS_LONG, 0, "0")
     ZEND_ARG_TYPE_MASK(0, alerter, MAY_BE_NULL | MAY_BE_LONG | MAY_BE_DOUBLE | MAY_BE_CALLABLE, "null")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, timeSlice, IS_LONG, 0, "0")
 ZEND_END_ARG_INFO()
 
 static PHP_METHOD(Swow_WatchDog, run)
@@ -167,16 +337,18 @@ static PHP_METHOD(Swow_WatchDog, run)
     zend_long quantum = 0;
     zend_long threshold = 0;
     zval *zalerter = NULL;
+    zend_long time_slice = 0;
     cat_bool_t ret;
 
-    ZEND_PARSE_PARAMETERS_START(0, 3)
+    ZEND_PARSE_PARAMETERS_START(0, 4)
         Z_PARAM_OPTIONAL
         Z_PARAM_LONG(quantum)
         Z_PARAM_LONG(threshold)
         Z_PARAM_ZVAL(zalerter)
+        Z_PARAM_LONG(time_slice)
     ZEND_PARSE_PARAMETERS_END();
 
-    ret = swow_watch_dog_run(quantum, threshold, zalerter);
+    ret = swow_watch_dog_run(quantum, threshold, zalerter, time_slice);
 
     if (UNEXPECTED(!ret)) {
         swow_throw_exception_with_last(swow_watch_dog_exception_ce);
@@ -193,7 +365,7 @@ static PHP_METHOD(Swow_WatchDog, stop)
 
     ZEND_PARSE_PARAMETERS_NONE();
 
-    ret = cat_watch_dog_stop();
+    ret = swow_watch_dog_stop();
 
     if (UNEXPECTED(!ret)) {
         swow_throw_exception_with_last(swow_watch_dog_exception_ce);
@@ -211,10 +383,104 @@ static PHP_METHOD(Swow_WatchDog, isRunning)
     RETURN_BOOL(cat_watch_dog_is_running());
 }
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_WatchDog_getTimeSlice, ZEND_RETURN_VALUE, 0, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_WatchDog, getTimeSlice)
+{
+    swow_watch_dog_t *swatch_dog = swow_watch_dog_get_current();
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_LONG(swatch_dog != NULL ? swatch_dog->time_slice : -1);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_WatchDog_startProfiling, ZEND_RETURN_VALUE, 0, IS_VOID, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, perCoroutine, _IS_BOOL, 0, "false")
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_WatchDog, startProfiling)
+{
+    zend_bool per_coroutine = 0;
+    cat_bool_t ret;
+
+    ZEND_PARSE_PARAMETERS_START(0, 1)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_BOOL(per_coroutine)
+    ZEND_PARSE_PARAMETERS_END();
+
+    ret = swow_watch_dog_start_profiling(per_coroutine);
+
+    if (UNEXPECTED(!ret)) {
+        swow_throw_exception_with_last(swow_watch_dog_exception_ce);
+        RETURN_THROWS();
+    }
+}
+
+#define arginfo_class_Swow_WatchDog_stopProfiling arginfo_class_Swow_WatchDog_stop
+
+static PHP_METHOD(Swow_WatchDog, stopProfiling)
+{
+    cat_bool_t ret;
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    ret = swow_watch_dog_stop_profiling();
+
+    if (UNEXPECTED(!ret)) {
+        swow_throw_exception_with_last(swow_watch_dog_exception_ce);
+        RETURN_THROWS();
+    }
+}
+
+#define arginfo_class_Swow_WatchDog_isProfiling arginfo_class_Swow_WatchDog_isRunning
+
+static PHP_METHOD(Swow_WatchDog, isProfiling)
+{
+    swow_watch_dog_t *swatch_dog = swow_watch_dog_get_current();
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_BOOL(swatch_dog != NULL && swatch_dog->profiling);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_WatchDog_getSamples, ZEND_RETURN_VALUE, 0, IS_ARRAY, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_WatchDog, getSamples)
+{
+    HashTable *samples;
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    samples = swow_watch_dog_get_samples();
+    if (samples == NULL) {
+        RETURN_EMPTY_ARRAY();
+    }
+
+    RETURN_ARR(zend_array_dup(samples));
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_WatchDog_getFoldedSamples, ZEND_RETURN_VALUE, 0, IS_STRING, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_WatchDog, getFoldedSamples)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_STR(swow_watch_dog_get_folded_samples());
+}
+
 static const zend_function_entry swow_watch_dog_methods[] = {
-    PHP_ME(Swow_WatchDog, run,       arginfo_class_Swow_WatchDog_run,       ZEND_ACC_STATIC | ZEND_ACC_PUBLIC)
-    PHP_ME(Swow_WatchDog, stop,      arginfo_class_Swow_WatchDog_stop,      ZEND_ACC_STATIC | ZEND_ACC_PUBLIC)
-    PHP_ME(Swow_WatchDog, isRunning, arginfo_class_Swow_WatchDog_isRunning, ZEND_ACC_STATIC | ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_WatchDog, run,              arginfo_class_Swow_WatchDog_run,              ZEND_ACC_STATIC | ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_WatchDog, stop,             arginfo_class_Swow_WatchDog_stop,             ZEND_ACC_STATIC | ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_WatchDog, isRunning,        arginfo_class_Swow_WatchDog_isRunning,        ZEND_ACC_STATIC | ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_WatchDog, getTimeSlice,     arginfo_class_Swow_WatchDog_getTimeSlice,     ZEND_ACC_STATIC | ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_WatchDog, startProfiling,   arginfo_class_Swow_WatchDog_startProfiling,   ZEND_ACC_STATIC | ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_WatchDog, stopProfiling,    arginfo_class_Swow_WatchDog_stopProfiling,    ZEND_ACC_STATIC | ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_WatchDog, isProfiling,      arginfo_class_Swow_WatchDog_isProfiling,      ZEND_ACC_STATIC | ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_WatchDog, getSamples,       arginfo_class_Swow_WatchDog_getSamples,       ZEND_ACC_STATIC | ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_WatchDog, getFoldedSamples, arginfo_class_Swow_WatchDog_getFoldedSamples, ZEND_ACC_STATIC | ZEND_ACC_PUBLIC)
     PHP_FE_END
 };
 
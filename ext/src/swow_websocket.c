@@ -18,6 +18,12 @@
 
 #include "swow_websocket.h"
 
+#include "ext/standard/php_random.h"
+
+#ifdef HAVE_SWOW_ZLIB
+#include <zlib.h>
+#endif
+
 SWOW_API zend_class_entry *swow_websocket_opcode_ce;
 
 SWOW_API zend_class_entry *swow_websocket_status_ce;
@@ -25,6 +31,11 @@ SWOW_API zend_class_entry *swow_websocket_status_ce;
 SWOW_API zend_class_entry *swow_websocket_frame_ce;
 SWOW_API zend_object_handlers swow_websocket_frame_handlers;
 
+SWOW_API zend_class_entry *swow_websocket_connection_ce;
+SWOW_API zend_object_handlers swow_websocket_connection_handlers;
+
+SWOW_API zend_class_entry *swow_websocket_exception_ce;
+
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_WebSocket_Opcode_getName, ZEND_RETURN_VALUE, 1, IS_LONG, 0)
     ZEND_ARG_TYPE_INFO(0, opcode, IS_LONG, 0)
 ZEND_END_ARG_INFO()
@@ -511,6 +522,131 @@ static PHP_METHOD(Swow_WebSocket_Frame, unmaskPayloadData)
     RETURN_THIS();
 }
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_WebSocket_Frame_mask, ZEND_RETURN_VALUE, 3, IS_LONG, 0)
+    ZEND_ARG_OBJ_INFO(0, from, Swow\\Buffer, 0)
+    ZEND_ARG_OBJ_INFO(0, to, Swow\\Buffer, 0)
+    ZEND_ARG_TYPE_INFO(0, maskKey, IS_STRING, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, index, IS_LONG, 0, "0")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, length, IS_LONG, 1, "\'$from->getReadableLength()\'")
+ZEND_END_ARG_INFO()
+
+/* mask (or unmask) the readable data of $from into $to (it is in-place if they are the same one),
+ * index is the position of the data in the whole payload, so that payload can be processed in chunks */
+static PHP_METHOD(Swow_WebSocket_Frame, mask)
+{
+    zval *zfrom, *zto;
+    zend_string *mask_key;
+    zend_long index = 0;
+    zend_long length = 0;
+    zend_bool length_is_null = 1;
+    swow_buffer_t *sfrom, *sto;
+    const char *from;
+    char *to;
+    size_t readable_length, writable_size;
+
+    ZEND_PARSE_PARAMETERS_START(3, 5)
+        Z_PARAM_OBJECT_OF_CLASS(zfrom, swow_buffer_ce)
+        Z_PARAM_OBJECT_OF_CLASS(zto, swow_buffer_ce)
+        Z_PARAM_STR(mask_key)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG(index)
+        Z_PARAM_LONG_OR_NULL(length, length_is_null)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(ZSTR_LEN(mask_key) != CAT_WEBSOCKET_MASK_KEY_LENGTH)) {
+        zend_argument_value_error(3, "length should be %u", CAT_WEBSOCKET_MASK_KEY_LENGTH);
+        RETURN_THROWS();
+    }
+    if (UNEXPECTED(index < 0)) {
+        zend_argument_value_error(4, "can not be negative");
+        RETURN_THROWS();
+    }
+    sfrom = swow_buffer_get_from_object(Z_OBJ_P(zfrom));
+    sto = swow_buffer_get_from_object(Z_OBJ_P(zto));
+    SWOW_BUFFER_CHECK_LOCK(sfrom);
+    SWOW_BUFFER_CHECK_LOCK(sto);
+    readable_length = swow_buffer_get_readable_space(sfrom, &from);
+    if (length_is_null) {
+        length = readable_length;
+    } else if (UNEXPECTED(length < 0)) {
+        zend_argument_value_error(5, "can not be negative");
+        RETURN_THROWS();
+    } else if (UNEXPECTED((size_t) length > readable_length)) {
+        swow_throw_exception(swow_buffer_exception_ce, CAT_ENOBUFS, "No enough readable buffer space");
+        RETURN_THROWS();
+    }
+    if (length == 0) {
+        RETURN_LONG(0);
+    }
+
+    if (sto == sfrom) {
+        cat_websocket_mask_ex((char *) from, from, length, ZSTR_VAL(mask_key), index);
+        RETURN_LONG(length);
+    }
+
+    writable_size = swow_buffer_get_writable_space(sto, &to);
+    if (UNEXPECTED((size_t) length > writable_size)) {
+        swow_throw_exception(swow_buffer_exception_ce, CAT_ENOBUFS, "No enough writable buffer space");
+        RETURN_THROWS();
+    }
+    /* copy and mask in one pass */
+    cat_websocket_mask_ex(to, from, length, ZSTR_VAL(mask_key), index);
+    swow_buffer_virtual_write(sto, length);
+
+    RETURN_LONG(length);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_WebSocket_Frame_getMaskKernel, ZEND_RETURN_VALUE, 0, IS_STRING, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_WebSocket_Frame, getMaskKernel)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_STRING(cat_websocket_mask_kernel_name(cat_websocket_mask_kernel_get()));
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_WebSocket_Frame_setMaskKernel, ZEND_RETURN_VALUE, 1, IS_VOID, 0)
+    ZEND_ARG_TYPE_INFO(0, kernel, IS_STRING, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_WebSocket_Frame, setMaskKernel)
+{
+    zend_string *name;
+    cat_websocket_mask_kernel_t kernel;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_STR(name)
+    ZEND_PARSE_PARAMETERS_END();
+
+    for (kernel = CAT_WEBSOCKET_MASK_KERNEL_GENERIC; kernel < CAT_WEBSOCKET_MASK_KERNEL_COUNT; kernel++) {
+        if (strcmp(ZSTR_VAL(name), cat_websocket_mask_kernel_name(kernel)) == 0) {
+            break;
+        }
+    }
+    if (UNEXPECTED(!cat_websocket_mask_kernel_set(kernel))) {
+        zend_argument_value_error(1, "must be one of Swow\\WebSocket\\Frame::getAvailableMaskKernels()");
+        RETURN_THROWS();
+    }
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_WebSocket_Frame_getAvailableMaskKernels, ZEND_RETURN_VALUE, 0, IS_ARRAY, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_WebSocket_Frame, getAvailableMaskKernels)
+{
+    cat_websocket_mask_kernel_t kernel;
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    array_init(return_value);
+    for (kernel = CAT_WEBSOCKET_MASK_KERNEL_GENERIC; kernel < CAT_WEBSOCKET_MASK_KERNEL_COUNT; kernel++) {
+        if (cat_websocket_mask_kernel_is_available(kernel)) {
+            add_next_index_string(return_value, cat_websocket_mask_kernel_name(kernel));
+        }
+    }
+}
+
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_WebSocket_Frame_toString, ZEND_RETURN_VALUE, 0, IS_STRING, 0)
     ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, headerOnly, _IS_BOOL, 0, "false")
 ZEND_END_ARG_INFO()
@@ -635,6 +771,10 @@ static const zend_function_entry swow_websocket_frame_methods[] = {
     PHP_ME(Swow_WebSocket_Frame, getPayloadDataAsString, arginfo_class_Swow_WebSocket_Frame_getPayloadDataAsString, ZEND_ACC_PUBLIC)
     PHP_ME(Swow_WebSocket_Frame, setPayloadData,         arginfo_class_Swow_WebSocket_Frame_setPayloadData,         ZEND_ACC_PUBLIC)
     PHP_ME(Swow_WebSocket_Frame, unmaskPayloadData,      arginfo_class_Swow_WebSocket_Frame_unmaskPayloadData,      ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_WebSocket_Frame, mask,                   arginfo_class_Swow_WebSocket_Frame_mask,                   ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_WebSocket_Frame, getMaskKernel,          arginfo_class_Swow_WebSocket_Frame_getMaskKernel,          ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_WebSocket_Frame, setMaskKernel,          arginfo_class_Swow_WebSocket_Frame_setMaskKernel,          ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_WebSocket_Frame, getAvailableMaskKernels, arginfo_class_Swow_WebSocket_Frame_getAvailableMaskKernels, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Swow_WebSocket_Frame, toString,               arginfo_class_Swow_WebSocket_Frame_toString,               ZEND_ACC_PUBLIC)
     /* magic */
     PHP_ME(Swow_WebSocket_Frame, __toString,             arginfo_class_Swow_WebSocket_Frame___toString,             ZEND_ACC_PUBLIC)
@@ -658,6 +798,1019 @@ static HashTable *swow_websocket_frame_get_gc(ZEND_GET_GC_PARAMATERS)
     ZEND_GET_GC_BUFFER_DONE();
 }
 
+/* connection: messages are reassembled from frames natively,
+ * control frames are handled internally (PING is answered automatically, PONG is ignored),
+ * only the CLOSE frame is returned to the caller */
+
+#define SWOW_WEBSOCKET_INFLATE_CHUNK_SIZE (64 * 1024)
+/* messages shorter than it are sent without compression */
+#define SWOW_WEBSOCKET_DEFLATE_MIN_LENGTH 64
+
+#ifdef HAVE_SWOW_ZLIB
+struct swow_websocket_deflate_s {
+    z_stream deflater;
+    z_stream inflater;
+    /* compressed payload to be sent */
+    cat_buffer_t deflate_buffer;
+    /* compressed payload received */
+    cat_buffer_t inflate_buffer;
+    /* reset the deflater after each message */
+    cat_bool_t no_context_takeover;
+    /* the peer resets its deflater after each message */
+    cat_bool_t peer_no_context_takeover;
+};
+
+static const char swow_websocket_deflate_tail[] = { 0x00, 0x00, (char) 0xff, (char) 0xff };
+#endif
+
+#define SWOW_WEBSOCKET_CONNECTION_FAIL(_status, _code, _format, ...) do { \
+    cat_update_last_error(CAT_EPROTO, _format, ##__VA_ARGS__); \
+    *(_status) = CAT_WEBSOCKET_STATUS_##_code; \
+    return cat_false; \
+} while (0)
+
+static zend_object *swow_websocket_connection_create_object(zend_class_entry *ce)
+{
+    swow_websocket_connection_t *sconnection = swow_object_alloc(swow_websocket_connection_t, ce, swow_websocket_connection_handlers);
+
+    sconnection->socket = NULL;
+    cat_buffer_init(&sconnection->buffer);
+    sconnection->buffer_offset = 0;
+    sconnection->max_message_size = SWOW_WEBSOCKET_DEFAULT_MAX_MESSAGE_SIZE;
+    sconnection->is_server = cat_false;
+    sconnection->receiving = cat_false;
+    sconnection->sending = cat_false;
+    sconnection->close_sent = cat_false;
+    sconnection->deflate = NULL;
+    ZEND_GET_GC_BUFFER_INIT(sconnection);
+
+    return &sconnection->std;
+}
+
+static void swow_websocket_connection_free_object(zend_object *object)
+{
+    swow_websocket_connection_t *sconnection = swow_websocket_connection_get_from_object(object);
+
+#ifdef HAVE_SWOW_ZLIB
+    if (sconnection->deflate != NULL) {
+        swow_websocket_deflate_t *context = sconnection->deflate;
+        (void) deflateEnd(&context->deflater);
+        (void) inflateEnd(&context->inflater);
+        cat_buffer_close(&context->deflate_buffer);
+        cat_buffer_close(&context->inflate_buffer);
+        efree(context);
+    }
+#endif
+    cat_buffer_close(&sconnection->buffer);
+    if (sconnection->socket != NULL) {
+        zend_object_release(sconnection->socket);
+    }
+
+    ZEND_GET_GC_BUFFER_FREE(sconnection);
+    zend_object_std_dtor(&sconnection->std);
+}
+
+static cat_always_inline cat_socket_t *swow_websocket_connection_get_socket(swow_websocket_connection_t *sconnection)
+{
+    return &swow_socket_get_from_object(sconnection->socket)->socket;
+}
+
+/* send a single frame, payload is masked on client side (in-place if payload is writable) */
+static cat_bool_t swow_websocket_connection_send_frame(
+    swow_websocket_connection_t *sconnection, cat_websocket_opcode_t opcode, cat_bool_t rsv1,
+    char *payload, size_t length, cat_bool_t payload_is_writable, cat_timeout_t timeout
+)
+{
+    cat_socket_t *socket = swow_websocket_connection_get_socket(sconnection);
+    char header_buffer[CAT_WEBSOCKET_HEADER_BUFFER_SIZE];
+    cat_websocket_header_t header;
+    cat_socket_write_vector_t vector[2];
+    char *masked_payload = NULL;
+    uint8_t header_length;
+    cat_bool_t ret;
+
+    cat_websocket_header_init(&header);
+    header.opcode = opcode;
+    header.rsv1 = rsv1;
+    header.payload_length = length;
+    if (!sconnection->is_server) {
+        header.mask = 1;
+        (void) php_random_bytes_silent(header.mask_key, CAT_WEBSOCKET_MASK_KEY_LENGTH);
+        if (length > 0) {
+            masked_payload = payload_is_writable ? payload : emalloc(length);
+            cat_websocket_mask_ex(masked_payload, payload, length, header.mask_key, 0);
+            payload = masked_payload;
+        }
+    }
+    header_length = cat_websocket_header_pack(&header, header_buffer, sizeof(header_buffer));
+    CAT_ASSERT(header_length > 0);
+
+    vector[0] = cat_socket_write_vector_init(header_buffer, header_length);
+    vector[1] = cat_socket_write_vector_init(payload, length);
+    ret = cat_socket_write_ex(socket, vector, length > 0 ? 2 : 1, timeout);
+
+    if (masked_payload != NULL && !payload_is_writable) {
+        efree(masked_payload);
+    }
+
+    return ret;
+}
+
+static cat_bool_t swow_websocket_connection_send_close(swow_websocket_connection_t *sconnection, cat_websocket_status_code_t code, const char *reason, size_t reason_length, cat_timeout_t timeout)
+{
+    char payload[CAT_WEBSOCKET_CONTROL_FRAME_MAX_PAYLOAD_LENGTH];
+    size_t length = 0;
+
+    if (code != 0) {
+        payload[0] = (char) (code >> 8);
+        payload[1] = (char) (code & 0xff);
+        length = CAT_WEBSOCKET_STATUS_CODE_LENGTH + reason_length;
+        CAT_ASSERT(length <= sizeof(payload));
+        memcpy(payload + CAT_WEBSOCKET_STATUS_CODE_LENGTH, reason, reason_length);
+    }
+    sconnection->close_sent = cat_true;
+
+    return swow_websocket_connection_send_frame(sconnection, CAT_WEBSOCKET_OPCODE_CLOSE, cat_false, payload, length, cat_true, timeout);
+}
+
+#ifdef HAVE_SWOW_ZLIB
+static cat_bool_t swow_websocket_connection_deflate(swow_websocket_connection_t *sconnection, const char *data, size_t length, size_t *out_length)
+{
+    swow_websocket_deflate_t *context = sconnection->deflate;
+    z_stream *stream = &context->deflater;
+    cat_buffer_t *buffer = &context->deflate_buffer;
+    /* sync flush appends an empty stored block (5 bytes) */
+    size_t size = deflateBound(stream, length) + 16;
+    int ret;
+
+    if (buffer->size < size && !cat_buffer_realloc(buffer, size)) {
+        return cat_false;
+    }
+    stream->next_in = (Bytef *) data;
+    stream->avail_in = (uInt) length;
+    stream->next_out = (Bytef *) buffer->value;
+    stream->avail_out = (uInt) buffer->size;
+    while (1) {
+        ret = deflate(stream, Z_SYNC_FLUSH);
+        if (UNEXPECTED(ret != Z_OK && ret != Z_BUF_ERROR)) {
+            cat_update_last_error(CAT_EPROTO, "Deflate failed: %s", stream->msg != NULL ? stream->msg : zError(ret));
+            return cat_false;
+        }
+        if (stream->avail_in == 0 && stream->avail_out != 0) {
+            break;
+        }
+        /* unlikely (more than the bound) */
+        size = (char *) stream->next_out - buffer->value;
+        if (!cat_buffer_extend(buffer, buffer->size + 1)) {
+            return cat_false;
+        }
+        stream->next_out = (Bytef *) buffer->value + size;
+        stream->avail_out = (uInt) (buffer->size - size);
+    }
+    size = (char *) stream->next_out - buffer->value;
+    /* the tail of sync flush must be removed (RFC 7692 section 7.2.1) */
+    CAT_ASSERT(size >= sizeof(swow_websocket_deflate_tail));
+    CAT_ASSERT(memcmp(buffer->value + size - sizeof(swow_websocket_deflate_tail), swow_websocket_deflate_tail, sizeof(swow_websocket_deflate_tail)) == 0);
+    *out_length = size - sizeof(swow_websocket_deflate_tail);
+    if (context->no_context_takeover) {
+        (void) deflateReset(stream);
+    }
+
+    return cat_true;
+}
+
+static cat_bool_t swow_websocket_connection_inflate(
+    swow_websocket_connection_t *sconnection, swow_buffer_t *sbuffer, size_t *length,
+    const char *data, size_t data_length, cat_websocket_utf8_state_t *utf8_state,
+    cat_websocket_status_code_t *status
+)
+{
+    z_stream *stream = &sconnection->deflate->inflater;
+
+    do {
+        uInt chunk_length = (uInt) CAT_MIN(data_length, UINT_MAX);
+        stream->next_in = (Bytef *) data;
+        stream->avail_in = chunk_length;
+        do {
+            /* one more byte to detect whether it is too big */
+            size_t size = CAT_MIN(sconnection->max_message_size - *length + 1, SWOW_WEBSOCKET_INFLATE_CHUNK_SIZE);
+            size_t produced;
+            char *ptr;
+            int ret;
+            if (UNEXPECTED(!swow_buffer_reserve_writable_space(sbuffer, *length + size))) {
+                return cat_false;
+            }
+            (void) swow_buffer_get_writable_space(sbuffer, &ptr);
+            ptr += *length;
+            stream->next_out = (Bytef *) ptr;
+            stream->avail_out = (uInt) size;
+            ret = inflate(stream, Z_SYNC_FLUSH);
+            if (ret == Z_STREAM_END) {
+                /* peer finished the stream with a final block, start a new one */
+                (void) inflateReset(stream);
+            } else if (UNEXPECTED(ret != Z_OK && ret != Z_BUF_ERROR)) {
+                SWOW_WEBSOCKET_CONNECTION_FAIL(status, INVALID_FRAME_PAYLOAD_DATA, "Invalid compressed data (%s)", stream->msg != NULL ? stream->msg : zError(ret));
+            }
+            produced = size - stream->avail_out;
+            if (utf8_state != NULL && UNEXPECTED(!cat_websocket_utf8_validate(utf8_state, ptr, produced))) {
+                SWOW_WEBSOCKET_CONNECTION_FAIL(status, INVALID_FRAME_PAYLOAD_DATA, "Invalid UTF-8 sequence in text message");
+            }
+            *length += produced;
+            if (UNEXPECTED(*length > sconnection->max_message_size)) {
+                SWOW_WEBSOCKET_CONNECTION_FAIL(status, MESSAGE_TOO_BIG, "Message is too big (max %zu)", sconnection->max_message_size);
+            }
+        } while (stream->avail_in > 0 || stream->avail_out == 0);
+        data += chunk_length;
+        data_length -= chunk_length;
+    } while (data_length > 0);
+
+    return cat_true;
+}
+#endif
+
+static cat_bool_t swow_websocket_connection_send_message(swow_websocket_connection_t *sconnection, cat_websocket_opcode_t opcode, const char *data, size_t length, cat_timeout_t timeout)
+{
+#ifdef HAVE_SWOW_ZLIB
+    /* control frames must not be compressed, small messages are not worth it */
+    if (sconnection->deflate != NULL && !cat_websocket_opcode_is_control(opcode) &&
+        length >= SWOW_WEBSOCKET_DEFLATE_MIN_LENGTH && length <= UINT_MAX) {
+        size_t compressed_length;
+        if (UNEXPECTED(!swow_websocket_connection_deflate(sconnection, data, length, &compressed_length))) {
+            return cat_false;
+        }
+        return swow_websocket_connection_send_frame(
+            sconnection, opcode, cat_true,
+            sconnection->deflate->deflate_buffer.value, compressed_length, cat_true, timeout
+        );
+    }
+#endif
+    return swow_websocket_connection_send_frame(sconnection, opcode, cat_false, (char *) data, length, cat_false, timeout);
+}
+
+/* make sure that there are at least size bytes read ahead */
+static cat_bool_t swow_websocket_connection_fill(swow_websocket_connection_t *sconnection, size_t size, cat_timeout_t timeout)
+{
+    cat_buffer_t *buffer = &sconnection->buffer;
+    size_t length = buffer->length - sconnection->buffer_offset;
+
+    while (length < size) {
+        ssize_t n;
+        if (sconnection->buffer_offset > 0) {
+            memmove(buffer->value, buffer->value + sconnection->buffer_offset, length);
+            buffer->length = length;
+            sconnection->buffer_offset = 0;
+        }
+        if (buffer->size < size && !cat_buffer_extend(buffer, CAT_MAX(size, CAT_BUFFER_DEFAULT_SIZE))) {
+            return cat_false;
+        }
+        n = cat_socket_recv_ex(
+            swow_websocket_connection_get_socket(sconnection),
+            buffer->value + buffer->length, buffer->size - buffer->length, timeout
+        );
+        if (UNEXPECTED(n <= 0)) {
+            if (n == 0) {
+                cat_update_last_error(CAT_ECONNRESET, "Connection closed by peer");
+            }
+            return cat_false;
+        }
+        buffer->length += n;
+        length += n;
+    }
+
+    return cat_true;
+}
+
+static cat_bool_t swow_websocket_connection_recv_header(swow_websocket_connection_t *sconnection, cat_websocket_header_t *header, cat_timeout_t timeout)
+{
+    cat_buffer_t *buffer = &sconnection->buffer;
+
+    while (1) {
+        size_t length = buffer->length - sconnection->buffer_offset;
+        uint8_t header_length = 0;
+        if (length > 0) {
+            header_length = cat_websocket_header_unpack(header, buffer->value + sconnection->buffer_offset, length);
+        }
+        if (header_length > 0) {
+            sconnection->buffer_offset += header_length;
+            return cat_true;
+        }
+        if (UNEXPECTED(!swow_websocket_connection_fill(sconnection, length + 1, timeout))) {
+            return cat_false;
+        }
+    }
+}
+
+/* payload is unmasked while copying from the read-ahead buffer,
+ * large payload is read into the destination directly */
+static cat_bool_t swow_websocket_connection_recv_payload(swow_websocket_connection_t *sconnection, char *to, size_t length, const char *mask_key, cat_timeout_t timeout)
+{
+    cat_buffer_t *buffer = &sconnection->buffer;
+    size_t n = CAT_MIN(buffer->length - sconnection->buffer_offset, length);
+
+    if (length - n > 0 && length - n <= CAT_BUFFER_DEFAULT_SIZE / 2) {
+        if (UNEXPECTED(!swow_websocket_connection_fill(sconnection, length, timeout))) {
+            return cat_false;
+        }
+        n = length;
+    }
+    if (n > 0) {
+        const char *from = buffer->value + sconnection->buffer_offset;
+        if (mask_key != NULL) {
+            cat_websocket_mask_ex(to, from, n, mask_key, 0);
+        } else {
+            memcpy(to, from, n);
+        }
+        sconnection->buffer_offset += n;
+    }
+    if (n < length) {
+        ssize_t ret = cat_socket_read_ex(swow_websocket_connection_get_socket(sconnection), to + n, length - n, timeout);
+        if (UNEXPECTED(ret != (ssize_t) (length - n))) {
+            return cat_false;
+        }
+        if (mask_key != NULL) {
+            cat_websocket_mask_ex(to + n, to + n, length - n, mask_key, n);
+        }
+    }
+
+    return cat_true;
+}
+
+/* message is written at the offset of the buffer (offset is not changed) */
+static cat_bool_t swow_websocket_connection_recv_message(
+    swow_websocket_connection_t *sconnection, swow_buffer_t *sbuffer,
+    cat_websocket_opcode_t *opcode, cat_websocket_status_code_t *status, cat_timeout_t timeout
+)
+{
+    cat_websocket_header_t header;
+    /* opcode of the message in progress */
+    cat_websocket_opcode_t message_opcode = CAT_WEBSOCKET_OPCODE_CONTINUATION;
+    cat_bool_t compressed = cat_false;
+    cat_websocket_utf8_state_t utf8_state = CAT_WEBSOCKET_UTF8_ACCEPT;
+    size_t length = 0;
+
+    while (1) {
+        const char *mask_key;
+        size_t payload_length;
+        char *ptr;
+
+        if (UNEXPECTED(!swow_websocket_connection_recv_header(sconnection, &header, timeout))) {
+            return cat_false;
+        }
+        if (UNEXPECTED(header.mask != sconnection->is_server)) {
+            if (sconnection->is_server) {
+                SWOW_WEBSOCKET_CONNECTION_FAIL(status, PROTOCOL_ERROR, "Frames from client must be masked");
+            } else {
+                SWOW_WEBSOCKET_CONNECTION_FAIL(status, PROTOCOL_ERROR, "Frames from server must not be masked");
+            }
+        }
+        if (UNEXPECTED(header.rsv2 || header.rsv3)) {
+            SWOW_WEBSOCKET_CONNECTION_FAIL(status, PROTOCOL_ERROR, "Reserved bits must be 0");
+        }
+        if (UNEXPECTED(!cat_websocket_opcode_is_valid(header.opcode))) {
+            SWOW_WEBSOCKET_CONNECTION_FAIL(status, PROTOCOL_ERROR, "Unknown opcode 0x%x", header.opcode);
+        }
+        mask_key = header.mask ? header.mask_key : NULL;
+
+        if (cat_websocket_opcode_is_control(header.opcode)) {
+            char payload[CAT_WEBSOCKET_CONTROL_FRAME_MAX_PAYLOAD_LENGTH];
+            payload_length = (size_t) header.payload_length;
+            if (UNEXPECTED(!header.fin || header.rsv1 || header.payload_length > sizeof(payload))) {
+                SWOW_WEBSOCKET_CONNECTION_FAIL(status, PROTOCOL_ERROR, "Control frames must not be fragmented, compressed or longer than %u", CAT_WEBSOCKET_CONTROL_FRAME_MAX_PAYLOAD_LENGTH);
+            }
+            if (UNEXPECTED(!swow_websocket_connection_recv_payload(sconnection, payload, payload_length, mask_key, timeout))) {
+                return cat_false;
+            }
+            if (header.opcode == CAT_WEBSOCKET_OPCODE_PING) {
+                if (!sconnection->close_sent &&
+                    UNEXPECTED(!swow_websocket_connection_send_frame(sconnection, CAT_WEBSOCKET_OPCODE_PONG, cat_false, payload, payload_length, cat_true, timeout))) {
+                    return cat_false;
+                }
+                continue;
+            }
+            if (header.opcode == CAT_WEBSOCKET_OPCODE_PONG) {
+                continue;
+            }
+            /* close: the message in progress (if any) is discarded */
+            CAT_ASSERT(header.opcode == CAT_WEBSOCKET_OPCODE_CLOSE);
+            if (payload_length > 0) {
+                cat_websocket_status_code_t code;
+                if (UNEXPECTED(payload_length < CAT_WEBSOCKET_STATUS_CODE_LENGTH)) {
+                    SWOW_WEBSOCKET_CONNECTION_FAIL(status, PROTOCOL_ERROR, "Invalid close frame payload");
+                }
+                code = (((uint8_t) payload[0]) << 8) | ((uint8_t) payload[1]);
+                if (UNEXPECTED(!cat_websocket_status_code_is_valid(code))) {
+                    SWOW_WEBSOCKET_CONNECTION_FAIL(status, PROTOCOL_ERROR, "Invalid close code %u", code);
+                }
+                if (UNEXPECTED(!cat_websocket_utf8_check(payload + CAT_WEBSOCKET_STATUS_CODE_LENGTH, payload_length - CAT_WEBSOCKET_STATUS_CODE_LENGTH))) {
+                    SWOW_WEBSOCKET_CONNECTION_FAIL(status, INVALID_FRAME_PAYLOAD_DATA, "Invalid UTF-8 sequence in close reason");
+                }
+                if (UNEXPECTED(!swow_buffer_reserve_writable_space(sbuffer, payload_length))) {
+                    return cat_false;
+                }
+                (void) swow_buffer_get_writable_space(sbuffer, &ptr);
+                memcpy(ptr, payload, payload_length);
+                swow_buffer_virtual_write_no_seek(sbuffer, payload_length);
+            }
+            if (!sconnection->close_sent) {
+                /* echo the status code, it does not matter if peer has gone */
+                (void) swow_websocket_connection_send_frame(
+                    sconnection, CAT_WEBSOCKET_OPCODE_CLOSE, cat_false, payload,
+                    CAT_MIN(payload_length, CAT_WEBSOCKET_STATUS_CODE_LENGTH), cat_true, timeout
+                );
+                sconnection->close_sent = cat_true;
+            }
+            *opcode = CAT_WEBSOCKET_OPCODE_CLOSE;
+            return cat_true;
+        }
+
+        if (header.opcode == CAT_WEBSOCKET_OPCODE_CONTINUATION) {
+            if (UNEXPECTED(message_opcode == CAT_WEBSOCKET_OPCODE_CONTINUATION)) {
+                SWOW_WEBSOCKET_CONNECTION_FAIL(status, PROTOCOL_ERROR, "Unexpected continuation frame");
+            }
+            if (UNEXPECTED(header.rsv1)) {
+                SWOW_WEBSOCKET_CONNECTION_FAIL(status, PROTOCOL_ERROR, "RSV1 must be 0 on continuation frames");
+            }
+        } else {
+            if (UNEXPECTED(message_opcode != CAT_WEBSOCKET_OPCODE_CONTINUATION)) {
+                SWOW_WEBSOCKET_CONNECTION_FAIL(status, PROTOCOL_ERROR, "Expected continuation frame, got %s", cat_websocket_opcode_name(header.opcode));
+            }
+            if (UNEXPECTED(header.rsv1 && sconnection->deflate == NULL)) {
+                SWOW_WEBSOCKET_CONNECTION_FAIL(status, PROTOCOL_ERROR, "RSV1 must be 0 without extensions");
+            }
+            message_opcode = header.opcode;
+            compressed = header.rsv1;
+        }
+        if (UNEXPECTED(header.payload_length > sconnection->max_message_size - length)) {
+            SWOW_WEBSOCKET_CONNECTION_FAIL(status, MESSAGE_TOO_BIG, "Message is too big (max %zu)", sconnection->max_message_size);
+        }
+        payload_length = (size_t) header.payload_length;
+
+#ifdef HAVE_SWOW_ZLIB
+        if (compressed) {
+            swow_websocket_deflate_t *context = sconnection->deflate;
+            cat_buffer_t *buffer = &context->inflate_buffer;
+            if (payload_length > 0) {
+                if (buffer->size < payload_length && UNEXPECTED(!cat_buffer_extend(buffer, payload_length))) {
+                    return cat_false;
+                }
+                if (UNEXPECTED(!swow_websocket_connection_recv_payload(sconnection, buffer->value, payload_length, mask_key, timeout))) {
+                    return cat_false;
+                }
+            }
+            if (payload_length > 0 && UNEXPECTED(!swow_websocket_connection_inflate(
+                sconnection, sbuffer, &length, buffer->value, payload_length,
+                message_opcode == CAT_WEBSOCKET_OPCODE_TEXT ? &utf8_state : NULL, status
+            ))) {
+                return cat_false;
+            }
+            if (header.fin) {
+                if (UNEXPECTED(!swow_websocket_connection_inflate(
+                    sconnection, sbuffer, &length, swow_websocket_deflate_tail, sizeof(swow_websocket_deflate_tail),
+                    message_opcode == CAT_WEBSOCKET_OPCODE_TEXT ? &utf8_state : NULL, status
+                ))) {
+                    return cat_false;
+                }
+                if (context->peer_no_context_takeover) {
+                    (void) inflateReset(&context->inflater);
+                }
+            }
+        } else
+#endif
+        if (payload_length > 0) {
+            if (UNEXPECTED(!swow_buffer_reserve_writable_space(sbuffer, length + payload_length))) {
+                return cat_false;
+            }
+            (void) swow_buffer_get_writable_space(sbuffer, &ptr);
+            ptr += length;
+            if (UNEXPECTED(!swow_websocket_connection_recv_payload(sconnection, ptr, payload_length, mask_key, timeout))) {
+                return cat_false;
+            }
+            if (message_opcode == CAT_WEBSOCKET_OPCODE_TEXT &&
+                UNEXPECTED(!cat_websocket_utf8_validate(&utf8_state, ptr, payload_length))) {
+                SWOW_WEBSOCKET_CONNECTION_FAIL(status, INVALID_FRAME_PAYLOAD_DATA, "Invalid UTF-8 sequence in text message");
+            }
+            length += payload_length;
+        }
+
+        if (header.fin) {
+            if (UNEXPECTED(utf8_state != CAT_WEBSOCKET_UTF8_ACCEPT)) {
+                SWOW_WEBSOCKET_CONNECTION_FAIL(status, INVALID_FRAME_PAYLOAD_DATA, "Incomplete UTF-8 sequence in text message");
+            }
+            swow_buffer_virtual_write_no_seek(sbuffer, length);
+            *opcode = message_opcode;
+            return cat_true;
+        }
+    }
+}
+
+#define getThisConnection() (swow_websocket_connection_get_from_object(Z_OBJ_P(ZEND_THIS)))
+
+#define SWOW_WEBSOCKET_CONNECTION_GETTER(_sconnection) \
+    swow_websocket_connection_t *_sconnection = getThisConnection(); \
+    do { \
+        if (UNEXPECTED(_sconnection->socket == NULL)) { \
+            zend_throw_error(NULL, "%s has not been constructed", ZEND_THIS_NAME); \
+            RETURN_THROWS(); \
+        } \
+    } while (0)
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_class_Swow_WebSocket_Connection___construct, 0, ZEND_RETURN_VALUE, 1)
+    ZEND_ARG_OBJ_INFO(0, socket, Swow\\Socket, 0)
+    ZEND_ARG_OBJ_INFO_WITH_DEFAULT_VALUE(0, buffer, Swow\\Buffer, 1, "null")
+ZEND_END_ARG_INFO()
+
+/* readable data of buffer is the data that has been read ahead (e.g. by HTTP parser) */
+static PHP_METHOD(Swow_WebSocket_Connection, __construct)
+{
+    swow_websocket_connection_t *sconnection = getThisConnection();
+    zval *zsocket, *zbuffer = NULL;
+
+    if (UNEXPECTED(sconnection->socket != NULL)) {
+        zend_throw_error(NULL, "%s can only construct once", ZEND_THIS_NAME);
+        RETURN_THROWS();
+    }
+
+    ZEND_PARSE_PARAMETERS_START(1, 2)
+        Z_PARAM_OBJECT_OF_CLASS(zsocket, swow_socket_ce)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_OBJECT_OF_CLASS_EX(zbuffer, swow_buffer_ce, 1, 0)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (zbuffer != NULL) {
+        swow_buffer_t *sbuffer = swow_buffer_get_from_object(Z_OBJ_P(zbuffer));
+        const char *ptr;
+        size_t length;
+        SWOW_BUFFER_CHECK_LOCK(sbuffer);
+        length = swow_buffer_get_readable_space(sbuffer, &ptr);
+        if (length > 0) {
+            if (UNEXPECTED(!cat_buffer_alloc(&sconnection->buffer, CAT_MAX(length, CAT_BUFFER_DEFAULT_SIZE)))) {
+                swow_throw_exception_with_last(swow_websocket_exception_ce);
+                RETURN_THROWS();
+            }
+            memcpy(sconnection->buffer.value, ptr, length);
+            sconnection->buffer.length = length;
+            swow_buffer_virtual_read(sbuffer, length);
+        }
+    }
+    GC_ADDREF(Z_OBJ_P(zsocket));
+    sconnection->socket = Z_OBJ_P(zsocket);
+    sconnection->is_server = cat_socket_is_session(swow_websocket_connection_get_socket(sconnection));
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_OBJ_INFO_EX(arginfo_class_Swow_WebSocket_Connection_getSocket, ZEND_RETURN_VALUE, 0, Swow\\Socket, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_WebSocket_Connection, getSocket)
+{
+    SWOW_WEBSOCKET_CONNECTION_GETTER(sconnection);
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    GC_ADDREF(sconnection->socket);
+    RETURN_OBJ(sconnection->socket);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_WebSocket_Connection_getMaxMessageSize, ZEND_RETURN_VALUE, 0, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_WebSocket_Connection, getMaxMessageSize)
+{
+    SWOW_WEBSOCKET_CONNECTION_GETTER(sconnection);
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_LONG(sconnection->max_message_size);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_THIS_INFO_EX(arginfo_class_Swow_WebSocket_Connection_setMaxMessageSize, 1)
+    ZEND_ARG_TYPE_INFO(0, maxMessageSize, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_WebSocket_Connection, setMaxMessageSize)
+{
+    SWOW_WEBSOCKET_CONNECTION_GETTER(sconnection);
+    zend_long max_message_size;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_LONG(max_message_size)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(max_message_size <= 0)) {
+        zend_argument_value_error(1, "must be greater than 0");
+        RETURN_THROWS();
+    }
+    sconnection->max_message_size = max_message_size;
+
+    RETURN_THIS();
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_WebSocket_Connection_isPerMessageDeflateSupported, ZEND_RETURN_VALUE, 0, _IS_BOOL, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_WebSocket_Connection, isPerMessageDeflateSupported)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+#ifdef HAVE_SWOW_ZLIB
+    RETURN_TRUE;
+#else
+    RETURN_FALSE;
+#endif
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_THIS_INFO_EX(arginfo_class_Swow_WebSocket_Connection_enablePerMessageDeflate, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, noContextTakeover, _IS_BOOL, 0, "false")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, peerNoContextTakeover, _IS_BOOL, 0, "false")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, maxWindowBits, IS_LONG, 0, "15")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, level, IS_LONG, 0, "-1")
+ZEND_END_ARG_INFO()
+
+/* parameters are the result of negotiation (RFC 7692),
+ * maxWindowBits is for our deflater (inflater always accepts 15) */
+static PHP_METHOD(Swow_WebSocket_Connection, enablePerMessageDeflate)
+{
+    SWOW_WEBSOCKET_CONNECTION_GETTER(sconnection);
+    zend_bool no_context_takeover = 0;
+    zend_bool peer_no_context_takeover = 0;
+    zend_long max_window_bits = 15;
+    zend_long level = -1;
+#ifdef HAVE_SWOW_ZLIB
+    swow_websocket_deflate_t *context;
+#endif
+
+    ZEND_PARSE_PARAMETERS_START(0, 4)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_BOOL(no_context_takeover)
+        Z_PARAM_BOOL(peer_no_context_takeover)
+        Z_PARAM_LONG(max_window_bits)
+        Z_PARAM_LONG(level)
+    ZEND_PARSE_PARAMETERS_END();
+
+#ifndef HAVE_SWOW_ZLIB
+    (void) sconnection;
+    swow_throw_exception(swow_websocket_exception_ce, CAT_ENOTSUP, "Swow was built without zlib");
+    RETURN_THROWS();
+#else
+    /* zlib does not support raw deflate with 8 window bits */
+    if (UNEXPECTED(max_window_bits < 9 || max_window_bits > 15)) {
+        zend_argument_value_error(3, "must be between 9 and 15");
+        RETURN_THROWS();
+    }
+    if (UNEXPECTED(level < -1 || level > 9)) {
+        zend_argument_value_error(4, "must be between -1 and 9");
+        RETURN_THROWS();
+    }
+    if (UNEXPECTED(sconnection->deflate != NULL)) {
+        swow_throw_exception(swow_websocket_exception_ce, CAT_EALREADY, "Per-message deflate has been enabled");
+        RETURN_THROWS();
+    }
+    context = ecalloc(1, sizeof(*context));
+    if (UNEXPECTED(deflateInit2(&context->deflater, level, Z_DEFLATED, -max_window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK)) {
+        efree(context);
+        swow_throw_exception(swow_websocket_exception_ce, CAT_ENOMEM, "Deflate init failed");
+        RETURN_THROWS();
+    }
+    if (UNEXPECTED(inflateInit2(&context->inflater, -15) != Z_OK)) {
+        (void) deflateEnd(&context->deflater);
+        efree(context);
+        swow_throw_exception(swow_websocket_exception_ce, CAT_ENOMEM, "Inflate init failed");
+        RETURN_THROWS();
+    }
+    cat_buffer_init(&context->deflate_buffer);
+    cat_buffer_init(&context->inflate_buffer);
+    context->no_context_takeover = no_context_takeover;
+    context->peer_no_context_takeover = peer_no_context_takeover;
+    sconnection->deflate = context;
+
+    RETURN_THIS();
+#endif
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_WebSocket_Connection_isPerMessageDeflateEnabled, ZEND_RETURN_VALUE, 0, _IS_BOOL, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_WebSocket_Connection, isPerMessageDeflateEnabled)
+{
+    SWOW_WEBSOCKET_CONNECTION_GETTER(sconnection);
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_BOOL(sconnection->deflate != NULL);
+}
+
+#define SWOW_WEBSOCKET_CONNECTION_CHECK_BUSY(_sconnection, _field, _action) do { \
+    if (UNEXPECTED((_sconnection)->_field)) { \
+        swow_throw_exception(swow_websocket_exception_ce, CAT_ELOCKED, "Connection is " #_field " in another coroutine, unable to " _action); \
+        RETURN_THROWS(); \
+    } \
+} while (0)
+
+static void swow_websocket_connection_throw_failure(swow_websocket_connection_t *sconnection, cat_websocket_status_code_t status, cat_timeout_t timeout)
+{
+    char *message;
+
+    if (status == 0) {
+        swow_throw_exception_with_last(swow_socket_exception_ce);
+        return;
+    }
+    message = estrdup(cat_get_last_error_message());
+    /* fail the connection (RFC 6455 section 7.1.7) */
+    if (!sconnection->close_sent) {
+        (void) swow_websocket_connection_send_close(sconnection, status, NULL, 0, timeout);
+    }
+    swow_throw_exception(swow_websocket_exception_ce, status, "%s", message);
+    efree(message);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_WebSocket_Connection_recvMessage, ZEND_RETURN_VALUE, 1, IS_LONG, 0)
+    ZEND_ARG_OBJ_INFO(0, buffer, Swow\\Buffer, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, timeout, IS_LONG, 1, "\'$this->getSocket()->getReadTimeout()\'")
+ZEND_END_ARG_INFO()
+
+/* the whole message is written at the offset of buffer (offset is not changed),
+ * returns the opcode (TEXT, BINARY or CLOSE) */
+static PHP_METHOD(Swow_WebSocket_Connection, recvMessage)
+{
+    SWOW_WEBSOCKET_CONNECTION_GETTER(sconnection);
+    zval *zbuffer;
+    zend_long timeout;
+    zend_bool timeout_is_null = 1;
+    swow_buffer_t *sbuffer;
+    cat_websocket_opcode_t opcode = CAT_WEBSOCKET_OPCODE_CONTINUATION;
+    cat_websocket_status_code_t status = 0;
+    cat_bool_t ret;
+
+    ZEND_PARSE_PARAMETERS_START(1, 2)
+        Z_PARAM_OBJECT_OF_CLASS(zbuffer, swow_buffer_ce)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG_OR_NULL(timeout, timeout_is_null)
+    ZEND_PARSE_PARAMETERS_END();
+
+    SWOW_WEBSOCKET_CONNECTION_CHECK_BUSY(sconnection, receiving, "receive");
+    if (timeout_is_null) {
+        timeout = cat_socket_get_read_timeout(swow_websocket_connection_get_socket(sconnection));
+    }
+    sbuffer = swow_buffer_get_from_object(Z_OBJ_P(zbuffer));
+
+    SWOW_BUFFER_LOCK(sbuffer);
+    GC_ADDREF(&sconnection->std);
+    sconnection->receiving = cat_true;
+    ret = swow_websocket_connection_recv_message(sconnection, sbuffer, &opcode, &status, timeout);
+    sconnection->receiving = cat_false;
+    SWOW_BUFFER_UNLOCK(sbuffer);
+
+    if (UNEXPECTED(!ret)) {
+        swow_websocket_connection_throw_failure(sconnection, status, cat_socket_get_write_timeout(swow_websocket_connection_get_socket(sconnection)));
+        zend_object_release(&sconnection->std);
+        RETURN_THROWS();
+    }
+    zend_object_release(&sconnection->std);
+
+    RETURN_LONG(opcode);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_THIS_INFO_EX(arginfo_class_Swow_WebSocket_Connection_sendMessage, 1)
+    ZEND_ARG_TYPE_INFO(0, data, IS_STRING, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, opcode, IS_LONG, 0, "Swow\\WebSocket\\Opcode::TEXT")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, timeout, IS_LONG, 1, "\'$this->getSocket()->getWriteTimeout()\'")
+ZEND_END_ARG_INFO()
+
+/* the message is sent in a single frame (compressed if per-message deflate is enabled) */
+static PHP_METHOD(Swow_WebSocket_Connection, sendMessage)
+{
+    SWOW_WEBSOCKET_CONNECTION_GETTER(sconnection);
+    zend_string *data;
+    zend_long opcode = CAT_WEBSOCKET_OPCODE_TEXT;
+    zend_long timeout;
+    zend_bool timeout_is_null = 1;
+    cat_bool_t ret;
+
+    ZEND_PARSE_PARAMETERS_START(1, 3)
+        Z_PARAM_STR(data)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG(opcode)
+        Z_PARAM_LONG_OR_NULL(timeout, timeout_is_null)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(opcode == CAT_WEBSOCKET_OPCODE_CONTINUATION || opcode < 0 || opcode > 0xf ||
+                   !cat_websocket_opcode_is_valid((cat_websocket_opcode_t) opcode))) {
+        zend_argument_value_error(2, "must be a valid opcode except CONTINUATION");
+        RETURN_THROWS();
+    }
+    if (UNEXPECTED(cat_websocket_opcode_is_control(opcode) && ZSTR_LEN(data) > CAT_WEBSOCKET_CONTROL_FRAME_MAX_PAYLOAD_LENGTH)) {
+        zend_argument_value_error(1, "length of control frame payload must be less than or equal to %u", CAT_WEBSOCKET_CONTROL_FRAME_MAX_PAYLOAD_LENGTH);
+        RETURN_THROWS();
+    }
+    SWOW_WEBSOCKET_CONNECTION_CHECK_BUSY(sconnection, sending, "send");
+    if (timeout_is_null) {
+        timeout = cat_socket_get_write_timeout(swow_websocket_connection_get_socket(sconnection));
+    }
+
+    GC_ADDREF(&sconnection->std);
+    sconnection->sending = cat_true;
+    if (opcode == CAT_WEBSOCKET_OPCODE_CLOSE) {
+        sconnection->close_sent = cat_true;
+    }
+    ret = swow_websocket_connection_send_message(sconnection, opcode, ZSTR_VAL(data), ZSTR_LEN(data), timeout);
+    sconnection->sending = cat_false;
+    zend_object_release(&sconnection->std);
+
+    if (UNEXPECTED(!ret)) {
+        swow_throw_exception_with_last(swow_socket_exception_ce);
+        RETURN_THROWS();
+    }
+
+    RETURN_THIS();
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_THIS_INFO_EX(arginfo_class_Swow_WebSocket_Connection_sendClose, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, code, IS_LONG, 0, "Swow\\WebSocket\\Status::NORMAL_CLOSURE")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, reason, IS_STRING, 0, "\'\'")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, timeout, IS_LONG, 1, "\'$this->getSocket()->getWriteTimeout()\'")
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_WebSocket_Connection, sendClose)
+{
+    SWOW_WEBSOCKET_CONNECTION_GETTER(sconnection);
+    zend_long code = CAT_WEBSOCKET_STATUS_NORMAL_CLOSURE;
+    zend_string *reason = NULL;
+    zend_long timeout;
+    zend_bool timeout_is_null = 1;
+    cat_bool_t ret;
+
+    ZEND_PARSE_PARAMETERS_START(0, 3)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG(code)
+        Z_PARAM_STR(reason)
+        Z_PARAM_LONG_OR_NULL(timeout, timeout_is_null)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(code < 0 || code > UINT16_MAX || !cat_websocket_status_code_is_valid((cat_websocket_status_code_t) code))) {
+        zend_argument_value_error(1, "is not a valid status code");
+        RETURN_THROWS();
+    }
+    if (reason != NULL && UNEXPECTED(ZSTR_LEN(reason) > CAT_WEBSOCKET_CONTROL_FRAME_MAX_PAYLOAD_LENGTH - CAT_WEBSOCKET_STATUS_CODE_LENGTH)) {
+        zend_argument_value_error(2, "length must be less than or equal to %u", CAT_WEBSOCKET_CONTROL_FRAME_MAX_PAYLOAD_LENGTH - CAT_WEBSOCKET_STATUS_CODE_LENGTH);
+        RETURN_THROWS();
+    }
+    SWOW_WEBSOCKET_CONNECTION_CHECK_BUSY(sconnection, sending, "send");
+    if (timeout_is_null) {
+        timeout = cat_socket_get_write_timeout(swow_websocket_connection_get_socket(sconnection));
+    }
+
+    GC_ADDREF(&sconnection->std);
+    sconnection->sending = cat_true;
+    ret = swow_websocket_connection_send_close(
+        sconnection, (cat_websocket_status_code_t) code,
+        reason != NULL ? ZSTR_VAL(reason) : NULL, reason != NULL ? ZSTR_LEN(reason) : 0, timeout
+    );
+    sconnection->sending = cat_false;
+    zend_object_release(&sconnection->std);
+
+    if (UNEXPECTED(!ret)) {
+        swow_throw_exception_with_last(swow_socket_exception_ce);
+        RETURN_THROWS();
+    }
+
+    RETURN_THIS();
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_WebSocket_Connection_broadcast, ZEND_RETURN_VALUE, 2, IS_ARRAY, 0)
+    ZEND_ARG_TYPE_INFO(0, targets, IS_ARRAY, 0)
+    ZEND_ARG_TYPE_INFO(0, data, IS_STRING, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, opcode, IS_LONG, 0, "Swow\\WebSocket\\Opcode::TEXT")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, highWaterMark, IS_LONG, 0, "Swow\\WebSocket\\Connection::DEFAULT_BROADCAST_HIGH_WATER_MARK")
+ZEND_END_ARG_INFO()
+
+/* targets are server side connections or sockets (WebSocket handshake has been done),
+ * the frame is encoded once and shared by all targets, writes are queued without waiting,
+ * targets which have more pending data than highWaterMark are skipped (0 means never skip),
+ * returns the error codes of the failed targets (with the same keys as targets) */
+static PHP_METHOD(Swow_WebSocket_Connection, broadcast)
+{
+    HashTable *targets;
+    zend_string *data;
+    zend_long opcode = CAT_WEBSOCKET_OPCODE_TEXT;
+    zend_long high_water_mark = SWOW_WEBSOCKET_DEFAULT_BROADCAST_HIGH_WATER_MARK;
+    char header_buffer[CAT_WEBSOCKET_HEADER_BUFFER_SIZE];
+    cat_websocket_header_t header;
+    cat_socket_write_vector_t vector[2];
+    cat_socket_shared_data_t *shared;
+    zend_string *key;
+    zend_ulong index;
+    zval *ztarget, zerror;
+
+    ZEND_PARSE_PARAMETERS_START(2, 4)
+        Z_PARAM_ARRAY_HT(targets)
+        Z_PARAM_STR(data)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG(opcode)
+        Z_PARAM_LONG(high_water_mark)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(opcode == CAT_WEBSOCKET_OPCODE_CONTINUATION || opcode < 0 || opcode > 0xf ||
+                   !cat_websocket_opcode_is_valid((cat_websocket_opcode_t) opcode))) {
+        zend_argument_value_error(3, "must be a valid opcode except CONTINUATION");
+        RETURN_THROWS();
+    }
+    if (UNEXPECTED(cat_websocket_opcode_is_control(opcode) && ZSTR_LEN(data) > CAT_WEBSOCKET_CONTROL_FRAME_MAX_PAYLOAD_LENGTH)) {
+        zend_argument_value_error(2, "length of control frame payload must be less than or equal to %u", CAT_WEBSOCKET_CONTROL_FRAME_MAX_PAYLOAD_LENGTH);
+        RETURN_THROWS();
+    }
+    if (UNEXPECTED(high_water_mark < 0)) {
+        zend_argument_value_error(4, "must be greater than or equal to 0");
+        RETURN_THROWS();
+    }
+    /* check all targets before sending anything */
+    ZEND_HASH_FOREACH_VAL(targets, ztarget) {
+        ZVAL_DEREF(ztarget);
+        if (UNEXPECTED(Z_TYPE_P(ztarget) != IS_OBJECT ||
+            (!instanceof_function(Z_OBJCE_P(ztarget), swow_socket_ce) &&
+             !instanceof_function(Z_OBJCE_P(ztarget), swow_websocket_connection_ce)))) {
+            zend_argument_type_error(1, "must be an array of Swow\\Socket or Swow\\WebSocket\\Connection, %s found", zend_zval_type_name(ztarget));
+            RETURN_THROWS();
+        }
+    } ZEND_HASH_FOREACH_END();
+
+    /* server side frames are not masked, so they can be shared */
+    cat_websocket_header_init(&header);
+    header.opcode = opcode;
+    header.payload_length = ZSTR_LEN(data);
+    vector[0] = cat_socket_write_vector_init(header_buffer, cat_websocket_header_pack(&header, header_buffer, sizeof(header_buffer)));
+    vector[1] = cat_socket_write_vector_init(ZSTR_VAL(data), ZSTR_LEN(data));
+    shared = cat_socket_shared_data_create(vector, CAT_ARRAY_SIZE(vector));
+    if (UNEXPECTED(shared == NULL)) {
+        swow_throw_exception_with_last(swow_websocket_exception_ce);
+        RETURN_THROWS();
+    }
+
+    array_init(return_value);
+    ZEND_HASH_FOREACH_KEY_VAL(targets, index, key, ztarget) {
+        cat_socket_t *socket;
+        ZVAL_DEREF(ztarget);
+        if (instanceof_function(Z_OBJCE_P(ztarget), swow_websocket_connection_ce)) {
+            swow_websocket_connection_t *sconnection = swow_websocket_connection_get_from_object(Z_OBJ_P(ztarget));
+            if (UNEXPECTED(sconnection->socket == NULL)) {
+                cat_update_last_error(CAT_EBADF, "Connection has not been constructed");
+                goto _failed;
+            }
+            if (UNEXPECTED(!sconnection->is_server)) {
+                cat_update_last_error(CAT_ENOTSUP, "Client side connection must mask frames");
+                goto _failed;
+            }
+            if (UNEXPECTED(sconnection->close_sent)) {
+                cat_update_last_error(CAT_EPIPE, "Connection is closing");
+                goto _failed;
+            }
+            socket = swow_websocket_connection_get_socket(sconnection);
+        } else {
+            socket = &swow_socket_get_from_object(Z_OBJ_P(ztarget))->socket;
+        }
+        if (EXPECTED(cat_socket_write_shared(socket, shared, (size_t) high_water_mark))) {
+            continue;
+        }
+        _failed:
+        ZVAL_LONG(&zerror, cat_get_last_error_code());
+        if (key != NULL) {
+            zend_hash_update(Z_ARRVAL_P(return_value), key, &zerror);
+        } else {
+            zend_hash_index_update(Z_ARRVAL_P(return_value), index, &zerror);
+        }
+    } ZEND_HASH_FOREACH_END();
+
+    cat_socket_shared_data_release(shared);
+}
+
+static const zend_function_entry swow_websocket_connection_methods[] = {
+    PHP_ME(Swow_WebSocket_Connection, __construct,                  arginfo_class_Swow_WebSocket_Connection___construct,                  ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_WebSocket_Connection, getSocket,                    arginfo_class_Swow_WebSocket_Connection_getSocket,                    ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_WebSocket_Connection, getMaxMessageSize,            arginfo_class_Swow_WebSocket_Connection_getMaxMessageSize,            ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_WebSocket_Connection, setMaxMessageSize,            arginfo_class_Swow_WebSocket_Connection_setMaxMessageSize,            ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_WebSocket_Connection, isPerMessageDeflateSupported, arginfo_class_Swow_WebSocket_Connection_isPerMessageDeflateSupported, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_WebSocket_Connection, enablePerMessageDeflate,      arginfo_class_Swow_WebSocket_Connection_enablePerMessageDeflate,      ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_WebSocket_Connection, isPerMessageDeflateEnabled,   arginfo_class_Swow_WebSocket_Connection_isPerMessageDeflateEnabled,   ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_WebSocket_Connection, recvMessage,                  arginfo_class_Swow_WebSocket_Connection_recvMessage,                  ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_WebSocket_Connection, sendMessage,                  arginfo_class_Swow_WebSocket_Connection_sendMessage,                  ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_WebSocket_Connection, sendClose,                    arginfo_class_Swow_WebSocket_Connection_sendClose,                    ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_WebSocket_Connection, broadcast,                    arginfo_class_Swow_WebSocket_Connection_broadcast,                    ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_FE_END
+};
+
+static HashTable *swow_websocket_connection_get_gc(ZEND_GET_GC_PARAMATERS)
+{
+    swow_websocket_connection_t *sconnection = swow_websocket_connection_get_from_object(Z7_OBJ_P(object));
+    zval ztmp;
+
+    if (sconnection->socket == NULL) {
+        ZEND_GET_GC_RETURN_EMPTY();
+    }
+
+    ZEND_GET_GC_BUFFER_CREATE(sconnection, 1);
+    ZVAL_OBJ(&ztmp, sconnection->socket);
+    ZEND_GET_GC_BUFFER_ADD(&ztmp);
+    ZEND_GET_GC_BUFFER_DONE();
+}
+
 int swow_websocket_module_init(INIT_FUNC_ARGS)
 {
 #define SWOW_WEBSOCKET_REGISTER_LONG_CONSTANT(name) \
@@ -715,5 +1868,21 @@ int swow_websocket_module_init(INIT_FUNC_ARGS)
         zend_declare_class_constant_stringl(swow_websocket_frame_ce, ZEND_STRL("PONG"), (const char *) &frame, CAT_WEBSOCKET_HEADER_LENGTH);
     } while (0);
 
+    swow_websocket_connection_ce = swow_register_internal_class(
+        "Swow\\WebSocket\\Connection", NULL, swow_websocket_connection_methods,
+        &swow_websocket_connection_handlers, NULL,
+        cat_false, cat_false, cat_false,
+        swow_websocket_connection_create_object,
+        swow_websocket_connection_free_object,
+        XtOffsetOf(swow_websocket_connection_t, std)
+    );
+    swow_websocket_connection_handlers.get_gc = swow_websocket_connection_get_gc;
+    zend_declare_class_constant_long(swow_websocket_connection_ce, ZEND_STRL("DEFAULT_MAX_MESSAGE_SIZE"), SWOW_WEBSOCKET_DEFAULT_MAX_MESSAGE_SIZE);
+    zend_declare_class_constant_long(swow_websocket_connection_ce, ZEND_STRL("DEFAULT_BROADCAST_HIGH_WATER_MARK"), SWOW_WEBSOCKET_DEFAULT_BROADCAST_HIGH_WATER_MARK);
+
+    swow_websocket_exception_ce = swow_register_internal_class(
+        "Swow\\WebSocket\\Exception", swow_exception_ce, NULL, NULL, NULL, cat_true, cat_true, cat_true, NULL, NULL, 0
+    );
+
     return SUCCESS;
 }
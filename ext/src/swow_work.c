@@ -0,0 +1,904 @@
+/*
+  +--------------------------------------------------------------------------+
+  | Swow                                                                     |
+  +--------------------------------------------------------------------------+
+  | Licensed under the Apache License, Version 2.0 (the "License");          |
+  | you may not use this file except in compliance with the License.         |
+  | You may obtain a copy of the License at                                  |
+  | http://www.apache.org/licenses/LICENSE-2.0                               |
+  | Unless required by applicable law or agreed to in writing, software      |
+  | distributed under the License is distributed on an "AS IS" BASIS,        |
+  | WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. |
+  | See the License for the specific language governing permissions and      |
+  | limitations under the License. See accompanying LICENSE file.            |
+  +--------------------------------------------------------------------------+
+  | Author: Twosee <twosee@php.net>                                          |
+  +--------------------------------------------------------------------------+
+ */
+
+#include "swow_work.h"
+#include "swow_buffer.h"
+
+#include "ext/hash/php_hash.h"
+#if PHP_VERSION_ID >= 70300
+#include "ext/pcre/php_pcre.h"
+#endif
+
+#ifdef HAVE_SWOW_ZLIB
+#include <zlib.h>
+#endif
+
+SWOW_API zend_class_entry *swow_work_ce;
+SWOW_API zend_object_handlers swow_work_handlers;
+
+SWOW_API zend_class_entry *swow_work_exception_ce;
+
+static cat_work_pool_t *swow_work_pool_get(zend_string *name)
+{
+    cat_work_pool_t *pool = cat_work_pool_get(ZSTR_VAL(name));
+
+    if (UNEXPECTED(pool == NULL)) {
+        swow_throw_exception(swow_work_exception_ce, CAT_ENOENT, "Work pool \"%s\" does not exist", ZSTR_VAL(name));
+    }
+
+    return pool;
+}
+
+static cat_bool_t swow_work_kind_check(zend_long kind)
+{
+    if (UNEXPECTED(kind < 0 || kind >= CAT_WORK_KIND_COUNT)) {
+        zend_argument_value_error(1, "is unknown");
+        return cat_false;
+    }
+
+    return cat_true;
+}
+
+static void swow_work_histogram_to_array(zval *zhistogram, const uint64_t *histogram)
+{
+    size_t i;
+
+    array_init_size(zhistogram, CAT_WORK_POOL_HISTOGRAM_SIZE);
+    for (i = 0; i < CAT_WORK_POOL_HISTOGRAM_SIZE; i++) {
+        add_next_index_long(zhistogram, histogram[i]);
+    }
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Work_createPool, ZEND_RETURN_VALUE, 2, IS_VOID, 0)
+    ZEND_ARG_TYPE_INFO(0, name, IS_STRING, 0)
+    ZEND_ARG_TYPE_INFO(0, size, IS_LONG, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, maxQueueSize, IS_LONG, 0, "0")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, priority, IS_LONG, 0, "0")
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Work, createPool)
+{
+    zend_string *name;
+    zend_long size;
+    zend_long max_queue_size = 0;
+    zend_long priority = 0;
+    cat_work_pool_t *pool;
+
+    ZEND_PARSE_PARAMETERS_START(2, 4)
+        Z_PARAM_STR(name)
+        Z_PARAM_LONG(size)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG(max_queue_size)
+        Z_PARAM_LONG(priority)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(size <= 0)) {
+        zend_argument_value_error(2, "must be greater than 0");
+        RETURN_THROWS();
+    }
+    if (UNEXPECTED(max_queue_size < 0)) {
+        zend_argument_value_error(3, "can not be negative");
+        RETURN_THROWS();
+    }
+    if (UNEXPECTED(priority < -20 || priority > 19)) {
+        zend_argument_value_error(4, "must be between -20 and 19");
+        RETURN_THROWS();
+    }
+
+    pool = cat_work_pool_create(ZSTR_VAL(name), size, max_queue_size, (int) priority);
+
+    if (UNEXPECTED(pool == NULL)) {
+        swow_throw_exception_with_last(swow_work_exception_ce);
+        RETURN_THROWS();
+    }
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Work_closePool, ZEND_RETURN_VALUE, 1, IS_VOID, 0)
+    ZEND_ARG_TYPE_INFO(0, name, IS_STRING, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Work, closePool)
+{
+    zend_string *name;
+    cat_work_pool_t *pool;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_STR(name)
+    ZEND_PARSE_PARAMETERS_END();
+
+    pool = swow_work_pool_get(name);
+    if (UNEXPECTED(pool == NULL)) {
+        RETURN_THROWS();
+    }
+
+    if (UNEXPECTED(!cat_work_pool_close(pool))) {
+        swow_throw_exception_with_last(swow_work_exception_ce);
+        RETURN_THROWS();
+    }
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Work_getPools, ZEND_RETURN_VALUE, 0, IS_ARRAY, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Work, getPools)
+{
+    size_t i, count;
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    count = cat_work_pool_get_count();
+    array_init_size(return_value, (uint32_t) count);
+    for (i = 0; i < count; i++) {
+        add_next_index_string(return_value, cat_work_pool_get_name(cat_work_pool_get_by_index(i)));
+    }
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Work_getPool, ZEND_RETURN_VALUE, 1, IS_STRING, 0)
+    ZEND_ARG_TYPE_INFO(0, kind, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Work, getPool)
+{
+    zend_long kind;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_LONG(kind)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(!swow_work_kind_check(kind))) {
+        RETURN_THROWS();
+    }
+
+    RETURN_STRING(cat_work_pool_get_name(cat_work_get_pool((cat_work_kind_t) kind)));
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Work_setPool, ZEND_RETURN_VALUE, 2, IS_VOID, 0)
+    ZEND_ARG_TYPE_INFO(0, kind, IS_LONG, 0)
+    ZEND_ARG_TYPE_INFO(0, name, IS_STRING, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Work, setPool)
+{
+    zend_long kind;
+    zend_string *name;
+    cat_work_pool_t *pool;
+
+    ZEND_PARSE_PARAMETERS_START(2, 2)
+        Z_PARAM_LONG(kind)
+        Z_PARAM_STR(name)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(!swow_work_kind_check(kind))) {
+        RETURN_THROWS();
+    }
+    pool = swow_work_pool_get(name);
+    if (UNEXPECTED(pool == NULL)) {
+        RETURN_THROWS();
+    }
+
+    cat_work_set_pool((cat_work_kind_t) kind, pool);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Work_setPoolMaxQueueSize, ZEND_RETURN_VALUE, 2, IS_VOID, 0)
+    ZEND_ARG_TYPE_INFO(0, name, IS_STRING, 0)
+    ZEND_ARG_TYPE_INFO(0, maxQueueSize, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Work, setPoolMaxQueueSize)
+{
+    zend_string *name;
+    zend_long max_queue_size;
+    cat_work_pool_t *pool;
+
+    ZEND_PARSE_PARAMETERS_START(2, 2)
+        Z_PARAM_STR(name)
+        Z_PARAM_LONG(max_queue_size)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(max_queue_size < 0)) {
+        zend_argument_value_error(2, "can not be negative");
+        RETURN_THROWS();
+    }
+    pool = swow_work_pool_get(name);
+    if (UNEXPECTED(pool == NULL)) {
+        RETURN_THROWS();
+    }
+
+    cat_work_pool_set_max_queue_size(pool, max_queue_size);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Work_getPoolStats, ZEND_RETURN_VALUE, 0, IS_ARRAY, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, name, IS_STRING, 0, "\"default\"")
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Work, getPoolStats)
+{
+    zend_string *name = NULL;
+    cat_work_pool_t *pool;
+    cat_work_pool_stats_t stats;
+    zval zhistogram;
+
+    ZEND_PARSE_PARAMETERS_START(0, 1)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_STR(name)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (name == NULL) {
+        pool = cat_work_pool_get_default();
+    } else {
+        pool = swow_work_pool_get(name);
+        if (UNEXPECTED(pool == NULL)) {
+            RETURN_THROWS();
+        }
+    }
+
+    cat_work_pool_get_stats(pool, &stats);
+
+    array_init(return_value);
+    add_assoc_string(return_value, "name", cat_work_pool_get_name(pool));
+    add_assoc_long(return_value, "size", stats.size);
+    add_assoc_long(return_value, "max_queue_size", stats.max_queue_size);
+    add_assoc_long(return_value, "priority", cat_work_pool_get_priority(pool));
+    add_assoc_long(return_value, "queue_size", stats.queue_size);
+    add_assoc_long(return_value, "running", stats.running);
+    add_assoc_long(return_value, "submitted", stats.submitted);
+    add_assoc_long(return_value, "completed", stats.completed);
+    add_assoc_long(return_value, "canceled", stats.canceled);
+    add_assoc_long(return_value, "rejected", stats.rejected);
+    /* in microseconds */
+    add_assoc_long(return_value, "queue_wait_time", stats.queue_wait_time / 1000);
+    add_assoc_long(return_value, "run_time", stats.run_time / 1000);
+    swow_work_histogram_to_array(&zhistogram, stats.queue_wait_histogram);
+    add_assoc_zval(return_value, "queue_wait_histogram", &zhistogram);
+    swow_work_histogram_to_array(&zhistogram, stats.run_time_histogram);
+    add_assoc_zval(return_value, "run_time_histogram", &zhistogram);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Work_resetPoolStats, ZEND_RETURN_VALUE, 0, IS_VOID, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, name, IS_STRING, 0, "\"default\"")
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Work, resetPoolStats)
+{
+    zend_string *name = NULL;
+    cat_work_pool_t *pool;
+
+    ZEND_PARSE_PARAMETERS_START(0, 1)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_STR(name)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (name == NULL) {
+        pool = cat_work_pool_get_default();
+    } else {
+        pool = swow_work_pool_get(name);
+        if (UNEXPECTED(pool == NULL)) {
+            RETURN_THROWS();
+        }
+    }
+
+    cat_work_pool_reset_stats(pool);
+}
+
+/* kernels: run on the buffer memory directly on the thread pool,
+ * buffers are locked and referenced until the work is done
+ * (which may be later than the return of the method on timeout or cancellation) */
+
+typedef struct swow_work_task_s swow_work_task_t;
+
+typedef void (*swow_work_task_handler_t)(swow_work_task_t *task);
+
+struct swow_work_task_s {
+    /* run on the thread */
+    swow_work_task_handler_t handler;
+    /* run on the loop thread */
+    swow_work_task_handler_t dtor;
+    swow_buffer_t *input;
+    swow_buffer_t *output;
+    const char *input_ptr;
+    size_t input_length;
+    char *output_ptr;
+    size_t output_size;
+    size_t output_length;
+    /* set by handler */
+    int error;
+    const char *message;
+    union {
+        struct {
+            const php_hash_ops *ops;
+            void *context;
+            unsigned char *digest;
+        } hash;
+        struct {
+            cat_bool_t decompress;
+            int level;
+            int window_bits;
+        } zlib;
+#if PHP_VERSION_ID >= 70300
+        struct {
+            pcre_cache_entry *pce;
+            size_t limit;
+            /* pairs of [start, end) */
+            PCRE2_SIZE *offsets;
+            size_t count;
+        } regex;
+#endif
+    } u;
+};
+
+static swow_work_task_t *swow_work_task_create(swow_work_task_handler_t handler, swow_work_task_handler_t dtor, swow_buffer_t *input, swow_buffer_t *output)
+{
+    swow_work_task_t *task;
+
+    SWOW_BUFFER_CHECK_LOCK_EX(input, return NULL);
+    if (output != NULL) {
+        if (UNEXPECTED(output == input)) {
+            zend_argument_value_error(2, "can not be the same as input buffer");
+            return NULL;
+        }
+        SWOW_BUFFER_CHECK_LOCK_EX(output, return NULL);
+    }
+
+    task = (swow_work_task_t *) ecalloc(1, sizeof(*task));
+    task->handler = handler;
+    task->dtor = dtor;
+    task->input = input;
+    task->input_length = swow_buffer_get_readable_space(input, &task->input_ptr);
+    SWOW_BUFFER_LOCK(input);
+    GC_ADDREF(&input->std);
+    if (output != NULL) {
+        task->output = output;
+        task->output_size = swow_buffer_get_writable_space(output, &task->output_ptr);
+        SWOW_BUFFER_LOCK(output);
+        GC_ADDREF(&output->std);
+    }
+
+    return task;
+}
+
+static void swow_work_task_free(cat_data_t *data)
+{
+    swow_work_task_t *task = (swow_work_task_t *) data;
+
+    if (task->dtor != NULL) {
+        task->dtor(task);
+    }
+    SWOW_BUFFER_UNLOCK(task->input);
+    zend_object_release(&task->input->std);
+    if (task->output != NULL) {
+        SWOW_BUFFER_UNLOCK(task->output);
+        zend_object_release(&task->output->std);
+    }
+    efree(task);
+}
+
+static void swow_work_task_handler(cat_data_t *data)
+{
+    swow_work_task_t *task = (swow_work_task_t *) data;
+
+    task->handler(task);
+}
+
+static void swow_work_task_set_error(swow_work_task_t *task, int error, const char *message)
+{
+    task->error = error;
+    task->message = message;
+}
+
+/* task will be freed if it fails */
+static cat_bool_t swow_work_task_run(swow_work_task_t *task, zend_string *pool_name, zend_long timeout)
+{
+    cat_work_pool_t *pool = NULL;
+
+    if (pool_name != NULL) {
+        pool = swow_work_pool_get(pool_name);
+        if (UNEXPECTED(pool == NULL)) {
+            swow_work_task_free(task);
+            return cat_false;
+        }
+    }
+    if (UNEXPECTED(!cat_work_ex(pool, swow_work_task_handler, swow_work_task_free, task, timeout))) {
+        swow_throw_exception_with_last(swow_work_exception_ce);
+        return cat_false;
+    }
+    if (UNEXPECTED(task->error != 0)) {
+        swow_throw_exception(swow_work_exception_ce, task->error, "%s", task->message);
+        swow_work_task_free(task);
+        return cat_false;
+    }
+
+    return cat_true;
+}
+
+#define SWOW_WORK_TASK_ARG_INFO(name) \
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, name, IS_STRING, 1, "null") \
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, timeout, IS_LONG, 0, "-1")
+
+#define SWOW_WORK_TASK_PARAMETERS(pool_name, timeout) \
+        Z_PARAM_STR_EX(pool_name, 1, 0) \
+        Z_PARAM_LONG(timeout)
+
+/* hash */
+
+static void swow_work_hash_handler(swow_work_task_t *task)
+{
+    const php_hash_ops *ops = task->u.hash.ops;
+    const unsigned char *ptr = (const unsigned char *) task->input_ptr;
+    size_t length = task->input_length;
+
+#if PHP_VERSION_ID >= 80100
+    ops->hash_init(task->u.hash.context, NULL);
+#else
+    ops->hash_init(task->u.hash.context);
+#endif
+    /* update function may only accept 32-bit length on old versions */
+    while (length > 0) {
+        size_t n = CAT_MIN(length, 1U << 30);
+        ops->hash_update(task->u.hash.context, ptr, n);
+        ptr += n;
+        length -= n;
+    }
+    ops->hash_final(task->u.hash.digest, task->u.hash.context);
+}
+
+static void swow_work_hash_dtor(swow_work_task_t *task)
+{
+    efree(task->u.hash.context);
+    efree(task->u.hash.digest);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Work_hash, ZEND_RETURN_VALUE, 2, IS_STRING, 0)
+    ZEND_ARG_OBJ_INFO(0, buffer, Swow\\Buffer, 0)
+    ZEND_ARG_TYPE_INFO(0, algo, IS_STRING, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, binary, _IS_BOOL, 0, "false")
+    SWOW_WORK_TASK_ARG_INFO(pool)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Work, hash)
+{
+    zval *zbuffer;
+    zend_string *algo;
+    zend_bool binary = 0;
+    zend_string *pool_name = NULL;
+    zend_long timeout = -1;
+    const php_hash_ops *ops;
+    swow_work_task_t *task;
+    zend_string *digest;
+
+    ZEND_PARSE_PARAMETERS_START(2, 5)
+        Z_PARAM_OBJECT_OF_CLASS(zbuffer, swow_buffer_ce)
+        Z_PARAM_STR(algo)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_BOOL(binary)
+        SWOW_WORK_TASK_PARAMETERS(pool_name, timeout)
+    ZEND_PARSE_PARAMETERS_END();
+
+#if PHP_VERSION_ID >= 80000
+    ops = php_hash_fetch_ops(algo);
+#else
+    ops = php_hash_fetch_ops(ZSTR_VAL(algo), ZSTR_LEN(algo));
+#endif
+    if (UNEXPECTED(ops == NULL)) {
+        zend_argument_value_error(2, "must be a valid hashing algorithm");
+        RETURN_THROWS();
+    }
+
+    task = swow_work_task_create(swow_work_hash_handler, swow_work_hash_dtor, swow_buffer_get_from_object(Z_OBJ_P(zbuffer)), NULL);
+    if (UNEXPECTED(task == NULL)) {
+        RETURN_THROWS();
+    }
+    task->u.hash.ops = ops;
+#if PHP_VERSION_ID >= 80100
+    task->u.hash.context = php_hash_alloc_context(ops);
+#else
+    task->u.hash.context = ecalloc(1, ops->context_size);
+#endif
+    task->u.hash.digest = (unsigned char *) emalloc(ops->digest_size);
+
+    if (UNEXPECTED(!swow_work_task_run(task, pool_name, timeout))) {
+        RETURN_THROWS();
+    }
+
+    if (binary) {
+        digest = zend_string_init((const char *) task->u.hash.digest, ops->digest_size, 0);
+    } else {
+        digest = zend_string_alloc(ops->digest_size * 2, 0);
+        php_hash_bin2hex(ZSTR_VAL(digest), task->u.hash.digest, ops->digest_size);
+        ZSTR_VAL(digest)[ZSTR_LEN(digest)] = '\0';
+    }
+    swow_work_task_free(task);
+
+    RETURN_STR(digest);
+}
+
+/* zlib */
+
+#ifdef HAVE_SWOW_ZLIB
+static void swow_work_zlib_handler(swow_work_task_t *task)
+{
+    cat_bool_t decompress = task->u.zlib.decompress;
+    size_t in_left = task->input_length;
+    size_t out_left = task->output_size;
+    z_stream stream;
+    int ret;
+
+    memset(&stream, 0, sizeof(stream));
+    if (decompress) {
+        ret = inflateInit2(&stream, task->u.zlib.window_bits);
+    } else {
+        ret = deflateInit2(&stream, task->u.zlib.level, Z_DEFLATED, task->u.zlib.window_bits, 8, Z_DEFAULT_STRATEGY);
+    }
+    if (UNEXPECTED(ret != Z_OK)) {
+        swow_work_task_set_error(task, ret == Z_MEM_ERROR ? CAT_ENOMEM : CAT_EINVAL, "Zlib stream init failed");
+        return;
+    }
+    stream.next_in = (Bytef *) task->input_ptr;
+    stream.next_out = (Bytef *) task->output_ptr;
+    while (1) {
+        /* avail_in/avail_out are 32-bit */
+        if (stream.avail_in == 0 && in_left > 0) {
+            stream.avail_in = (uInt) CAT_MIN(in_left, UINT_MAX);
+            in_left -= stream.avail_in;
+        }
+        if (stream.avail_out == 0 && out_left > 0) {
+            stream.avail_out = (uInt) CAT_MIN(out_left, UINT_MAX);
+            out_left -= stream.avail_out;
+        }
+        if (decompress) {
+            ret = inflate(&stream, in_left == 0 ? Z_FINISH : Z_NO_FLUSH);
+        } else {
+            ret = deflate(&stream, in_left == 0 ? Z_FINISH : Z_NO_FLUSH);
+        }
+        if (ret == Z_STREAM_END) {
+            break;
+        }
+        if (ret == Z_OK) {
+            continue;
+        }
+        if (ret == Z_BUF_ERROR && stream.avail_out == 0 && out_left == 0) {
+            swow_work_task_set_error(task, CAT_ENOBUFS, "No enough writable buffer space");
+        } else if (ret == Z_BUF_ERROR) {
+            swow_work_task_set_error(task, CAT_EPROTO, "Unexpected end of compressed data");
+        } else if (ret == Z_MEM_ERROR) {
+            swow_work_task_set_error(task, CAT_ENOMEM, "Zlib out of memory");
+        } else {
+            swow_work_task_set_error(task, CAT_EPROTO, "Zlib data error");
+        }
+        break;
+    }
+    task->output_length = ((char *) stream.next_out) - task->output_ptr;
+    if (decompress) {
+        (void) inflateEnd(&stream);
+    } else {
+        (void) deflateEnd(&stream);
+    }
+}
+#endif
+
+#define SWOW_WORK_ZLIB_ENCODING_RAW     (-0xf)
+#define SWOW_WORK_ZLIB_ENCODING_GZIP    0x1f
+#define SWOW_WORK_ZLIB_ENCODING_DEFLATE 0x0f
+
+static PHP_METHOD_EX(Swow_Work, zlib, cat_bool_t decompress)
+{
+    zval *zinput, *zoutput;
+    zend_long level = -1;
+    zend_long encoding = SWOW_WORK_ZLIB_ENCODING_RAW;
+    zend_string *pool_name = NULL;
+    zend_long timeout = -1;
+#ifdef HAVE_SWOW_ZLIB
+    swow_work_task_t *task;
+    size_t output_length;
+#endif
+
+    if (!decompress) {
+        ZEND_PARSE_PARAMETERS_START(2, 6)
+            Z_PARAM_OBJECT_OF_CLASS(zinput, swow_buffer_ce)
+            Z_PARAM_OBJECT_OF_CLASS(zoutput, swow_buffer_ce)
+            Z_PARAM_OPTIONAL
+            Z_PARAM_LONG(level)
+            Z_PARAM_LONG(encoding)
+            SWOW_WORK_TASK_PARAMETERS(pool_name, timeout)
+        ZEND_PARSE_PARAMETERS_END();
+    } else {
+        ZEND_PARSE_PARAMETERS_START(2, 5)
+            Z_PARAM_OBJECT_OF_CLASS(zinput, swow_buffer_ce)
+            Z_PARAM_OBJECT_OF_CLASS(zoutput, swow_buffer_ce)
+            Z_PARAM_OPTIONAL
+            Z_PARAM_LONG(encoding)
+            SWOW_WORK_TASK_PARAMETERS(pool_name, timeout)
+        ZEND_PARSE_PARAMETERS_END();
+    }
+
+#ifndef HAVE_SWOW_ZLIB
+    swow_throw_exception(swow_work_exception_ce, CAT_ENOTSUP, "Swow was built without zlib");
+    RETURN_THROWS();
+#else
+    if (UNEXPECTED(level < -1 || level > 9)) {
+        zend_argument_value_error(3, "must be between -1 and 9");
+        RETURN_THROWS();
+    }
+    if (UNEXPECTED(encoding != SWOW_WORK_ZLIB_ENCODING_RAW &&
+                   encoding != SWOW_WORK_ZLIB_ENCODING_GZIP &&
+                   encoding != SWOW_WORK_ZLIB_ENCODING_DEFLATE)) {
+        zend_argument_value_error(decompress ? 3 : 4, "must be one of Swow\\Work::ENCODING_*");
+        RETURN_THROWS();
+    }
+
+    task = swow_work_task_create(
+        swow_work_zlib_handler, NULL,
+        swow_buffer_get_from_object(Z_OBJ_P(zinput)),
+        swow_buffer_get_from_object(Z_OBJ_P(zoutput))
+    );
+    if (UNEXPECTED(task == NULL)) {
+        RETURN_THROWS();
+    }
+    if (UNEXPECTED(task->output_size == 0)) {
+        swow_work_task_free(task);
+        swow_throw_exception(swow_work_exception_ce, CAT_ENOBUFS, "No enough writable buffer space");
+        RETURN_THROWS();
+    }
+    task->u.zlib.decompress = decompress;
+    task->u.zlib.level = (int) level;
+    /* auto-detect gzip or zlib header on decompression */
+    task->u.zlib.window_bits = (decompress && encoding != SWOW_WORK_ZLIB_ENCODING_RAW) ? 0x2f : (int) encoding;
+
+    if (UNEXPECTED(!swow_work_task_run(task, pool_name, timeout))) {
+        RETURN_THROWS();
+    }
+
+    output_length = task->output_length;
+    swow_work_task_free(task);
+    swow_buffer_virtual_write_no_seek(swow_buffer_get_from_object(Z_OBJ_P(zoutput)), output_length);
+
+    RETURN_LONG(output_length);
+#endif
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Work_deflate, ZEND_RETURN_VALUE, 2, IS_LONG, 0)
+    ZEND_ARG_OBJ_INFO(0, input, Swow\\Buffer, 0)
+    ZEND_ARG_OBJ_INFO(0, output, Swow\\Buffer, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, level, IS_LONG, 0, "-1")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, encoding, IS_LONG, 0, "Swow\\Work::ENCODING_RAW")
+    SWOW_WORK_TASK_ARG_INFO(pool)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Work, deflate)
+{
+    PHP_METHOD_CALL(Swow_Work, zlib, cat_false);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Work_inflate, ZEND_RETURN_VALUE, 2, IS_LONG, 0)
+    ZEND_ARG_OBJ_INFO(0, input, Swow\\Buffer, 0)
+    ZEND_ARG_OBJ_INFO(0, output, Swow\\Buffer, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, encoding, IS_LONG, 0, "Swow\\Work::ENCODING_RAW")
+    SWOW_WORK_TASK_ARG_INFO(pool)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Work, inflate)
+{
+    PHP_METHOD_CALL(Swow_Work, zlib, cat_true);
+}
+
+/* regex */
+
+#if PHP_VERSION_ID >= 70300
+static void swow_work_match_handler(swow_work_task_t *task)
+{
+    pcre2_code *re = php_pcre_pce_re(task->u.regex.pce);
+    const PCRE2_SPTR subject = (PCRE2_SPTR) task->input_ptr;
+    const PCRE2_SIZE length = task->input_length;
+    size_t limit = task->u.regex.limit;
+    size_t count = 0, size = 0;
+    PCRE2_SIZE *offsets = NULL, *ovector, start = 0;
+    pcre2_match_data *match_data;
+    uint32_t options = 0, compile_options = 0;
+    int ret;
+
+    (void) pcre2_pattern_info(re, PCRE2_INFO_ALLOPTIONS, &compile_options);
+    /* NULL general context means malloc(), which is thread-safe */
+    match_data = pcre2_match_data_create_from_pattern(re, NULL);
+    if (UNEXPECTED(match_data == NULL)) {
+        swow_work_task_set_error(task, CAT_ENOMEM, "Regex match data create failed");
+        return;
+    }
+    ovector = pcre2_get_ovector_pointer(match_data);
+    while (limit == 0 || count < limit) {
+        ret = pcre2_match(re, subject, length, start, options, match_data, NULL);
+        if (ret == PCRE2_ERROR_NOMATCH) {
+            if (options == 0 || start >= length) {
+                break;
+            }
+            /* empty match at last position, move on by one character */
+            start++;
+            if (compile_options & PCRE2_UTF) {
+                while (start < length && (subject[start] & 0xc0) == 0x80) {
+                    start++;
+                }
+            }
+            options = 0;
+            continue;
+        }
+        if (UNEXPECTED(ret < 0)) {
+            swow_work_task_set_error(task, CAT_EINVAL, "Regex match failed");
+            break;
+        }
+        if (count == size) {
+            PCRE2_SIZE *new_offsets;
+            size = size == 0 ? 8 : size * 2;
+            new_offsets = (PCRE2_SIZE *) cat_sys_realloc(offsets, size * 2 * sizeof(*offsets));
+            if (UNEXPECTED(new_offsets == NULL)) {
+                swow_work_task_set_error(task, CAT_ENOMEM, "No memory for regex matches");
+                break;
+            }
+            offsets = new_offsets;
+        }
+        offsets[count * 2] = ovector[0];
+        offsets[count * 2 + 1] = ovector[1];
+        count++;
+        start = ovector[1];
+        /* try a non-empty match at the same position after an empty one (like preg_match_all) */
+        options = ovector[0] == ovector[1] ? (PCRE2_NOTEMPTY_ATSTART | PCRE2_ANCHORED) : 0;
+    }
+    pcre2_match_data_free(match_data);
+    task->u.regex.offsets = offsets;
+    task->u.regex.count = count;
+}
+
+static void swow_work_match_dtor(swow_work_task_t *task)
+{
+    php_pcre_pce_decref(task->u.regex.pce);
+    if (task->u.regex.offsets != NULL) {
+        cat_sys_free(task->u.regex.offsets);
+    }
+}
+#endif
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Work_matchAll, ZEND_RETURN_VALUE, 2, IS_ARRAY, 0)
+    ZEND_ARG_OBJ_INFO(0, buffer, Swow\\Buffer, 0)
+    ZEND_ARG_TYPE_INFO(0, pattern, IS_STRING, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, limit, IS_LONG, 0, "0")
+    SWOW_WORK_TASK_ARG_INFO(pool)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Work, matchAll)
+{
+    zval *zbuffer;
+    zend_string *pattern;
+    zend_long limit = 0;
+    zend_string *pool_name = NULL;
+    zend_long timeout = -1;
+#if PHP_VERSION_ID >= 70300
+    pcre_cache_entry *pce;
+    swow_work_task_t *task;
+    size_t offset, i;
+#endif
+
+    ZEND_PARSE_PARAMETERS_START(2, 5)
+        Z_PARAM_OBJECT_OF_CLASS(zbuffer, swow_buffer_ce)
+        Z_PARAM_STR(pattern)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG(limit)
+        SWOW_WORK_TASK_PARAMETERS(pool_name, timeout)
+    ZEND_PARSE_PARAMETERS_END();
+
+#if PHP_VERSION_ID < 70300
+    swow_throw_exception(swow_work_exception_ce, CAT_ENOTSUP, "Regex work requires PCRE2 (PHP >= 7.3)");
+    RETURN_THROWS();
+#else
+    if (UNEXPECTED(limit < 0)) {
+        zend_argument_value_error(3, "can not be negative");
+        RETURN_THROWS();
+    }
+    /* compile (or fetch from the cache) on the main thread */
+    pce = pcre_get_compiled_regex_cache(pattern);
+    if (UNEXPECTED(pce == NULL)) {
+        /* warning has been emitted */
+        swow_throw_exception(swow_work_exception_ce, CAT_EINVAL, "Regex compilation failed");
+        RETURN_THROWS();
+    }
+
+    task = swow_work_task_create(swow_work_match_handler, NULL, swow_buffer_get_from_object(Z_OBJ_P(zbuffer)), NULL);
+    if (UNEXPECTED(task == NULL)) {
+        RETURN_THROWS();
+    }
+    /* keep it alive even if it is evicted from the cache */
+    php_pcre_pce_incref(pce);
+    task->dtor = swow_work_match_dtor;
+    task->u.regex.pce = pce;
+    task->u.regex.limit = (size_t) limit;
+
+    if (UNEXPECTED(!swow_work_task_run(task, pool_name, timeout))) {
+        RETURN_THROWS();
+    }
+
+    /* offsets are relative to the buffer */
+    offset = task->input->offset;
+    array_init_size(return_value, (uint32_t) task->u.regex.count);
+    for (i = 0; i < task->u.regex.count; i++) {
+        zval zmatch;
+        array_init_size(&zmatch, 2);
+        add_next_index_long(&zmatch, offset + task->u.regex.offsets[i * 2]);
+        add_next_index_long(&zmatch, task->u.regex.offsets[i * 2 + 1] - task->u.regex.offsets[i * 2]);
+        add_next_index_zval(return_value, &zmatch);
+    }
+    swow_work_task_free(task);
+#endif
+}
+
+static const zend_function_entry swow_work_methods[] = {
+    PHP_ME(Swow_Work, createPool,          arginfo_class_Swow_Work_createPool,          ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Work, closePool,           arginfo_class_Swow_Work_closePool,           ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Work, getPools,            arginfo_class_Swow_Work_getPools,            ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Work, getPool,             arginfo_class_Swow_Work_getPool,             ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Work, setPool,             arginfo_class_Swow_Work_setPool,             ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Work, setPoolMaxQueueSize, arginfo_class_Swow_Work_setPoolMaxQueueSize, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Work, getPoolStats,        arginfo_class_Swow_Work_getPoolStats,        ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Work, resetPoolStats,      arginfo_class_Swow_Work_resetPoolStats,      ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Work, hash,                arginfo_class_Swow_Work_hash,                ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Work, deflate,             arginfo_class_Swow_Work_deflate,             ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Work, inflate,             arginfo_class_Swow_Work_inflate,             ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Work, matchAll,            arginfo_class_Swow_Work_matchAll,            ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_FE_END
+};
+
+int swow_work_module_init(INIT_FUNC_ARGS)
+{
+    if (!cat_work_module_init()) {
+        return FAILURE;
+    }
+
+    swow_work_ce = swow_register_internal_class(
+        "Swow\\Work", NULL, swow_work_methods,
+        &swow_work_handlers, NULL,
+        cat_false, cat_false, cat_false,
+        swow_create_object_deny, NULL, 0
+    );
+    zend_declare_class_constant_long(swow_work_ce, ZEND_STRL("KIND_CPU"), CAT_WORK_KIND_CPU);
+    zend_declare_class_constant_long(swow_work_ce, ZEND_STRL("KIND_FS"), CAT_WORK_KIND_FS);
+    zend_declare_class_constant_long(swow_work_ce, ZEND_STRL("KIND_DNS"), CAT_WORK_KIND_DNS);
+    zend_declare_class_constant_stringl(swow_work_ce, ZEND_STRL("DEFAULT_POOL"), ZEND_STRL(CAT_WORK_POOL_DEFAULT_NAME));
+    zend_declare_class_constant_long(swow_work_ce, ZEND_STRL("HISTOGRAM_SIZE"), CAT_WORK_POOL_HISTOGRAM_SIZE);
+    zend_declare_class_constant_long(swow_work_ce, ZEND_STRL("ENCODING_RAW"), SWOW_WORK_ZLIB_ENCODING_RAW);
+    zend_declare_class_constant_long(swow_work_ce, ZEND_STRL("ENCODING_GZIP"), SWOW_WORK_ZLIB_ENCODING_GZIP);
+    zend_declare_class_constant_long(swow_work_ce, ZEND_STRL("ENCODING_DEFLATE"), SWOW_WORK_ZLIB_ENCODING_DEFLATE);
+
+    swow_work_exception_ce = swow_register_internal_class(
+        "Swow\\Work\\Exception", swow_exception_ce, NULL, NULL, NULL, cat_true, cat_true, cat_true, NULL, NULL, 0
+    );
+
+    return SUCCESS;
+}
+
+int swow_work_runtime_init(INIT_FUNC_ARGS)
+{
+    if (!cat_work_runtime_init()) {
+        return FAILURE;
+    }
+
+    return SUCCESS;
+}
+
+int swow_work_runtime_shutdown(INIT_FUNC_ARGS)
+{
+    if (!cat_work_runtime_shutdown()) {
+        return FAILURE;
+    }
+
+    return SUCCESS;
+}
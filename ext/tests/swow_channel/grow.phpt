@@ -0,0 +1,58 @@
+--TEST--
+swow_channel: storage of buffered channel grows while the ring is wrapped
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Channel;
+
+/* 64K bytes are preallocated, that is 4096 zvals, capacity must be larger than it */
+const PREALLOC_COUNT = 64 * 1024 / 16;
+const CAPACITY = PREALLOC_COUNT * 8;
+
+$channel = new Channel(CAPACITY);
+$pushed = 0;
+$popped = 0;
+
+/* fill the preallocated ring, then pop some of them so that head is not 0 */
+for ($n = 0; $n < PREALLOC_COUNT; $n++) {
+    $channel->push($pushed++);
+}
+for ($n = 0; $n < 100; $n++) {
+    Assert::same($channel->pop(), $popped++);
+}
+/* the ring is wrapped and full, then it grows (several times) with interleaved pops */
+while ($pushed < CAPACITY) {
+    $channel->push($pushed++);
+    if ($pushed % 3 === 0) {
+        Assert::same($channel->pop(), $popped++);
+    }
+}
+Assert::same($channel->getLength(), $pushed - $popped);
+while ($popped < $pushed) {
+    Assert::same($channel->pop(), $popped++);
+}
+Assert::true($channel->isEmpty());
+
+/* strings are kept as they are after storage moved */
+$popped = 0;
+for ($n = 0; $n < CAPACITY; $n++) {
+    $channel->push("value-{$n}");
+    if ($n % 5 === 0) {
+        Assert::same($channel->pop(), 'value-' . $popped++);
+    }
+}
+while ($popped < CAPACITY) {
+    Assert::same($channel->pop(), 'value-' . $popped++);
+}
+Assert::true($channel->isEmpty());
+
+echo 'Done' . PHP_LF;
+
+?>
+--EXPECT--
+Done
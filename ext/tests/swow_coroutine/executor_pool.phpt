@@ -0,0 +1,64 @@
+--TEST--
+swow_coroutine: executor pool
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Coroutine;
+
+const N = 100;
+
+/* disabled by default */
+$stats = Coroutine::getExecutorPoolStats();
+Assert::same($stats['size'], 0);
+Assert::same($stats['count'], 0);
+
+Coroutine::setExecutorPoolSize(8);
+
+$coroutines = [];
+for ($n = N; $n--;) {
+    $coroutines[] = Coroutine::run(function () {
+        Coroutine::yield();
+    });
+}
+foreach ($coroutines as $coroutine) {
+    $coroutine->resume();
+}
+$coroutines = [];
+Assert::same(Coroutine::getExecutorPoolStats()['count'], 8);
+
+/* steady state: every coroutine reuses an executor */
+$stats = Coroutine::getExecutorPoolStats();
+$hits = $stats['hits'];
+$misses = $stats['misses'];
+for ($n = N; $n--;) {
+    Coroutine::run(function () {
+        /* the executor works as well as a fresh one even if it needs more stack pages */
+        $f = function (int $n) use (&$f) { return $n === 0 ? 0 : $f($n - 1) + 1; };
+        Assert::same($f(1000), 1000);
+    });
+}
+$stats = Coroutine::getExecutorPoolStats();
+Assert::same($stats['hits'] - $hits, N);
+Assert::same($stats['misses'], $misses);
+Assert::same($stats['count'], 8);
+
+/* it is shrunk with size */
+Coroutine::setExecutorPoolSize(4);
+Assert::same(Coroutine::getExecutorPoolStats()['count'], 4);
+Assert::same(Coroutine::clearExecutorPool(), 4);
+Assert::same(Coroutine::getExecutorPoolStats()['count'], 0);
+
+Assert::throws(function () {
+    Coroutine::setExecutorPoolSize(-1);
+}, ValueError::class);
+
+echo 'Done' . PHP_LF;
+
+?>
+--EXPECT--
+Done
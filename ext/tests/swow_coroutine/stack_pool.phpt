@@ -0,0 +1,59 @@
+--TEST--
+swow_coroutine: stack pool
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Coroutine;
+
+const N = 100;
+
+Coroutine::setStackPoolWatermarks(4, 8);
+
+$coroutines = [];
+for ($n = N; $n--;) {
+    $coroutines[] = Coroutine::run(function () {
+        Coroutine::yield();
+    });
+}
+foreach ($coroutines as $coroutine) {
+    $coroutine->resume();
+}
+$coroutines = [];
+
+$stats = Coroutine::getStackPoolStats();
+Assert::same($stats['low_watermark'], 4);
+Assert::same($stats['high_watermark'], 8);
+Assert::lessThanEq($stats['hot_count'], 4);
+Assert::lessThanEq($stats['hot_count'] + $stats['cold_count'], 8);
+
+/* steady state: every coroutine reuses an idle stack */
+$hits = $stats['hits'];
+$misses = $stats['misses'];
+for ($n = N; $n--;) {
+    Coroutine::run(function () { });
+}
+$stats = Coroutine::getStackPoolStats();
+Assert::same($stats['hits'] - $hits, N);
+Assert::same($stats['misses'], $misses);
+
+Assert::greaterThan(Coroutine::clearStackPool(), 0);
+$stats = Coroutine::getStackPoolStats();
+Assert::same($stats['hot_count'] + $stats['cold_count'], 0);
+
+try {
+    Coroutine::setStackPoolWatermarks(8, 4);
+} catch (Swow\Coroutine\Exception $exception) {
+    echo $exception->getMessage() . PHP_LF;
+}
+
+echo 'Done' . PHP_LF;
+
+?>
+--EXPECT--
+Stack pool low watermark (8) should not be greater than high watermark (4)
+Done
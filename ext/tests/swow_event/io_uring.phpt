@@ -0,0 +1,74 @@
+--TEST--
+swow_event: io_uring read path
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+if (!Swow\Event::isIoUringAvailable()) {
+    skip('io_uring is not available');
+}
+try {
+    Swow\Event::setIoUringEnabled(true);
+} catch (Swow\Exception $exception) {
+    skip($exception->getMessage());
+}
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Coroutine;
+use Swow\Event;
+use Swow\Socket;
+use Swow\Sync\WaitReference;
+
+Assert::false(Event::isIoUringEnabled());
+Event::setIoUringEnabled(true);
+Assert::true(Event::isIoUringEnabled());
+Event::resetIoUringStats();
+
+$randoms = getRandomBytesArray(TEST_MAX_REQUESTS, TEST_MAX_LENGTH);
+$server = new Socket(Socket::TYPE_TCP);
+$server->bind('127.0.0.1')->listen();
+$wr = new WaitReference();
+Coroutine::run(function () use ($server, $wr, $randoms) {
+    $connection = $server->accept();
+    foreach ($randoms as $random) {
+        Assert::same($connection->readString(strlen($random)), $random);
+    }
+    /* interrupted by timeout, kernel must give the buffer back */
+    Assert::throws(function () use ($connection) {
+        try {
+            $connection->recvString(TEST_MAX_LENGTH, 1);
+        } catch (Socket\Exception $exception) {
+            Assert::same($exception->getCode(), Swow\Errno\ETIMEDOUT);
+            throw $exception;
+        }
+    }, Socket\Exception::class);
+    $connection->close();
+});
+
+$client = new Socket(Socket::TYPE_TCP);
+$client->connect($server->getSockAddress(), $server->getSockPort());
+foreach ($randoms as $random) {
+    $client->sendString($random);
+    /* let the reader wait on the ring */
+    msleep(0);
+}
+
+WaitReference::wait($wr);
+$client->close();
+$server->close();
+
+$stats = Event::getIoUringStats();
+Assert::greaterThan($stats['submitted'], 0);
+Assert::greaterThan($stats['canceled'], 0);
+Assert::greaterThan($stats['completed'], 0);
+
+Event::setIoUringEnabled(false);
+Assert::false(Event::isIoUringEnabled());
+
+echo 'Done' . PHP_LF;
+
+?>
+--EXPECT--
+Done
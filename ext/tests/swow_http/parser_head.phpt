@@ -0,0 +1,91 @@
+--TEST--
+swow_http: parse the whole head at once
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Buffer;
+use Swow\Http\Parser;
+
+$request = "POST /foo?bar=baz HTTP/1.1\r\n" .
+    "Host: example.com\r\n" .
+    "Content-Length: 5\r\n" .
+    "X-Custom: a\r\n" .
+    "x-custom: b\r\n" .
+    "X-Empty:\r\n" .
+    "CONNECTION: keep-alive\r\n" .
+    "\r\n" .
+    'hello';
+
+$parser = (new Parser())
+    ->setType(Parser::TYPE_REQUEST)
+    ->setEvents(Parser::EVENT_BODY | Parser::EVENT_MESSAGE_COMPLETE);
+
+/* incomplete head, nothing is consumed */
+$buffer = new Buffer();
+$buffer->write(substr($request, 0, 40))->rewind();
+Assert::same($parser->executeHead($buffer), Parser::EVENT_NONE);
+Assert::same($buffer->tell(), 0);
+Assert::same($parser->getHeaderCount(), 0);
+
+$buffer->clear();
+$buffer->write($request)->rewind();
+Assert::same($parser->executeHead($buffer), Parser::EVENT_HEADERS_COMPLETE);
+Assert::same($buffer->tell(), strpos($request, 'hello'));
+/* it does not refer to the buffer */
+$buffer->clear();
+$buffer->write(str_repeat('x', strlen($request)))->rewind();
+
+Assert::same($parser->getMethod(), 'POST');
+Assert::same($parser->getUriOrReasonPhrase(), '/foo?bar=baz');
+Assert::same($parser->getHeaderCount(), 6);
+Assert::same($parser->getKnownHeader(Parser::HEADER_HOST), 'example.com');
+Assert::same($parser->getKnownHeader(Parser::HEADER_CONTENT_LENGTH), '5');
+Assert::same($parser->getKnownHeader(Parser::HEADER_COOKIE), null);
+Assert::same($parser->getHeader('connection'), 'keep-alive');
+Assert::same($parser->getHeader('X-CUSTOM'), 'a');
+Assert::same($parser->getHeader('x-empty'), '');
+Assert::same($parser->getHeader('x-none'), null);
+Assert::true($parser->hasHeader('Host'));
+Assert::false($parser->hasHeader('x-none'));
+Assert::same($parser->getHeaderValues('x-custom'), ['a', 'b']);
+Assert::same($parser->getHeaders(), [
+    'Host' => ['example.com'],
+    'Content-Length' => ['5'],
+    'X-Custom' => ['a', 'b'],
+    'X-Empty' => [''],
+    'CONNECTION' => ['keep-alive'],
+]);
+Assert::same($parser->getHeaderNames(), [
+    'host' => 'Host',
+    'content-length' => 'Content-Length',
+    'x-custom' => 'X-Custom',
+    'x-empty' => 'X-Empty',
+    'connection' => 'CONNECTION',
+]);
+
+/* the body is parsed as usual */
+$buffer->clear();
+$buffer->write('hello')->rewind();
+Assert::same($parser->execute($buffer, $data), Parser::EVENT_BODY);
+Assert::same($data, 'hello');
+Assert::same($parser->execute($buffer), Parser::EVENT_MESSAGE_COMPLETE);
+$parser->reset();
+Assert::same($parser->getHeaderCount(), 0);
+
+/* errors */
+$buffer->clear();
+$buffer->write("GET / HTTP/1.1\r\nBad Header\r\n\r\n")->rewind();
+Assert::throws(function () use ($parser, $buffer) {
+    $parser->executeHead($buffer);
+}, Parser\Exception::class);
+
+echo 'Done' . PHP_LF;
+
+?>
+--EXPECT--
+Done
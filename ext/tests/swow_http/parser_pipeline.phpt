@@ -0,0 +1,62 @@
+--TEST--
+swow_http: parse pipelined requests
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Buffer;
+use Swow\Http\Parser;
+
+$requests = "GET /1 HTTP/1.1\r\nHost: a\r\n\r\n" .
+    "POST /2 HTTP/1.1\r\nContent-Length: 3\r\n\r\nabc" .
+    "GET /3 HTTP/1.1\r\n\r\n" .
+    "GET /4 HTTP/1.1\r\nHo";
+
+$buffer = new Buffer();
+$buffer->write($requests)->rewind();
+
+/* the end of message is always reported even if it is not in the events */
+$parser = (new Parser())->setType(Parser::TYPE_REQUEST)->setEvents(Parser::EVENT_BODY);
+$uris = [];
+$bodies = [];
+while (true) {
+    $event = $parser->executeHead($buffer);
+    if ($event === Parser::EVENT_NONE) {
+        break;
+    }
+    $uris[] = $parser->getUriOrReasonPhrase();
+    $body = '';
+    while (!$parser->isCompleted()) {
+        if ($parser->execute($buffer, $data) === Parser::EVENT_BODY) {
+            $body .= $data;
+        }
+    }
+    $bodies[] = $body;
+    $parser->reset();
+}
+Assert::same($uris, ['/1', '/2', '/3']);
+Assert::same($bodies, ['', 'abc', '']);
+/* the incomplete one is left in the buffer */
+Assert::same($buffer->read(), "GET /4 HTTP/1.1\r\nHo");
+
+/* without head mode */
+$buffer->rewind();
+$parser->reset();
+$count = 0;
+while (($event = $parser->execute($buffer)) !== Parser::EVENT_NONE) {
+    if ($event === Parser::EVENT_MESSAGE_COMPLETE) {
+        $count++;
+    }
+}
+Assert::same($count, 3);
+Assert::true($buffer->eof());
+
+echo 'Done' . PHP_LF;
+
+?>
+--EXPECT--
+Done
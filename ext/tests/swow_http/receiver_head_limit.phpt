@@ -0,0 +1,65 @@
+--TEST--
+swow_http: head length limit of receiver
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Http\Exception as HttpException;
+use Swow\Http\Server;
+use Swow\Http\Status;
+use Swow\Socket;
+
+$server = new Server();
+$server->bind('127.0.0.1')->listen();
+$server->setMaxHeaderLength(1024);
+
+function sendAndExpect(Server $server, string $request, int $statusCode): void
+{
+    $client = new Socket(Socket::TYPE_TCP);
+    $client->connect($server->getSockAddress(), $server->getSockPort());
+    $session = $server->acceptSession();
+    /* the whole head arrives in one read */
+    $client->sendString($request);
+    Assert::throws(function () use ($session, $statusCode) {
+        try {
+            $session->recvHttpRequest();
+        } catch (HttpException $exception) {
+            Assert::same($exception->getCode(), $statusCode);
+            throw $exception;
+        }
+    }, HttpException::class);
+    $session->close();
+    $client->close();
+}
+
+$uri = '/' . str_repeat('x', 2048);
+$header = 'X-Large: ' . str_repeat('x', 2048) . "\r\n";
+
+/* complete heads */
+sendAndExpect($server, "GET {$uri} HTTP/1.1\r\n\r\n", Status::REQUEST_URI_TOO_LARGE);
+sendAndExpect($server, "GET / HTTP/1.1\r\n{$header}\r\n", Status::REQUEST_HEADER_FIELDS_TOO_LARGE);
+/* incomplete heads */
+sendAndExpect($server, "GET {$uri}", Status::REQUEST_URI_TOO_LARGE);
+sendAndExpect($server, "GET / HTTP/1.1\r\n{$header}", Status::REQUEST_HEADER_FIELDS_TOO_LARGE);
+
+/* heads within the limit are accepted */
+$client = new Socket(Socket::TYPE_TCP);
+$client->connect($server->getSockAddress(), $server->getSockPort());
+$session = $server->acceptSession();
+$client->sendString("GET /foo HTTP/1.1\r\nHost: example.com\r\n\r\n");
+$request = $session->recvHttpRequest();
+Assert::same($request->getUri()->getPath(), '/foo');
+$session->close();
+$client->close();
+
+$server->close();
+
+echo 'Done' . PHP_LF;
+
+?>
+--EXPECT--
+Done
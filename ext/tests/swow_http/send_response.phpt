@@ -0,0 +1,57 @@
+--TEST--
+swow_http: send response with head and body vector
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Buffer;
+use Swow\Coroutine;
+use Swow\Socket;
+use function Swow\Http\packResponse;
+use function Swow\Http\sendResponse;
+
+$server = new Socket(Socket::TYPE_TCP);
+$server->bind('127.0.0.1')->listen();
+$client = new Socket(Socket::TYPE_TCP);
+$client->connect($server->getSockAddress(), $server->getSockPort());
+$session = $server->accept();
+
+$headers = ['Content-Type' => 'text/plain', 'X-Multi' => ['a', 'b']];
+$body = getRandomBytes(TEST_MAX_LENGTH * 1024);
+
+/* string body */
+sendResponse($session, 200, $headers + ['Content-Length' => strlen('Hello Swow')], 'Hello Swow');
+$expected = packResponse(200, $headers + ['Content-Length' => strlen('Hello Swow')], 'Hello Swow');
+Assert::same($client->readString(strlen($expected)), $expected);
+
+/* no body, custom reason phrase and protocol version */
+sendResponse($session, 404, [], '', 'Nothing', '1.0');
+Assert::same($client->readString(strlen("HTTP/1.0 404 Nothing\r\n\r\n")), "HTTP/1.0 404 Nothing\r\n\r\n");
+
+/* the whole content of buffer is sent no matter where its offset is,
+ * and a large head is packed out of the stack */
+$buffer = new Buffer();
+$buffer->write($body);
+Assert::true($buffer->eof());
+$largeHeaders = ['X-Large' => str_repeat('x', 4096)] + $headers;
+$expected = packResponse(200, $largeHeaders, $body);
+Coroutine::run(function () use ($session, $largeHeaders, $buffer): void {
+    sendResponse($session, 200, $largeHeaders, $buffer);
+    Assert::same($buffer->getLength(), TEST_MAX_LENGTH * 1024);
+});
+Assert::same($client->readString(strlen($expected)), $expected);
+
+/* invalid body */
+Assert::throws(function () use ($session) {
+    sendResponse($session, 200, [], new stdClass());
+}, TypeError::class);
+
+echo 'Done' . PHP_LF;
+
+?>
+--EXPECT--
+Done
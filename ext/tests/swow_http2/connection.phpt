@@ -0,0 +1,137 @@
+--TEST--
+swow_http2: serve a connection with raw frames
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Coroutine;
+use Swow\Http\Server\Request;
+use Swow\Http2;
+use Swow\Http2\Connection;
+use Swow\Http2\ErrorCode;
+use Swow\Http2\Flag;
+use Swow\Http2\FrameType;
+use Swow\Http2\Hpack;
+use Swow\Http2\Setting;
+use Swow\Http2\Stream;
+use Swow\Socket;
+use Swow\Sync\WaitReference;
+
+function sendFrame(Socket $socket, int $type, int $flags, int $streamId, string $payload = ''): void
+{
+    $socket->sendString(Connection::packFrame($type, $flags, $streamId, $payload));
+}
+
+/**
+ * @return array [type, flags, stream id, payload]
+ */
+function recvFrame(Socket $socket): array
+{
+    $header = unpack('Nhead/Cflags/NstreamId', $socket->readString(Http2\FRAME_HEADER_LENGTH));
+    $length = $header['head'] >> 8;
+
+    return [$header['head'] & 0xff, $header['flags'], $header['streamId'], $length > 0 ? $socket->readString($length) : ''];
+}
+
+function sync(Socket $socket): void
+{
+    sendFrame($socket, FrameType::PING, Flag::NONE, 0, 'swowping');
+    Assert::same(recvFrame($socket), [FrameType::PING, Flag::ACK, 0, 'swowping']);
+}
+
+$server = new Socket(Socket::TYPE_TCP);
+$server->bind('127.0.0.1')->listen();
+$client = new Socket(Socket::TYPE_TCP);
+$client->connect($server->getSockAddress(), $server->getSockPort());
+
+$connection = new Connection($server->accept(), static function (Request $request, Stream $stream): void {
+    switch ($request->getPath()) {
+        case '/echo':
+            $stream->respond(['content-type' => 'text/plain'], $request->getBodyAsString());
+            break;
+        case '/large':
+            $stream->respond(str_repeat('x', 40));
+            break;
+        case '/throw':
+            throw new RuntimeException('Unexpected failure');
+    }
+});
+$wr = new WaitReference();
+Coroutine::run(static function () use ($connection, $wr): void {
+    $connection->serve();
+});
+
+$encoder = new Hpack();
+$decoder = new Hpack();
+
+/* preface, SETTINGS and SETTINGS ACK, streams of client only have 16 bytes window */
+$client->sendString(Http2\CONNECTION_PREFACE);
+sendFrame($client, FrameType::SETTINGS, Flag::NONE, 0, Connection::packSettings([Setting::INITIAL_WINDOW_SIZE => 16]));
+[$type, $flags, $streamId, $payload] = recvFrame($client);
+Assert::same([$type, $flags, $streamId], [FrameType::SETTINGS, Flag::NONE, 0]);
+Assert::same(unpack('nid/Nvalue', $payload), ['id' => Setting::MAX_CONCURRENT_STREAMS, 'value' => Connection::DEFAULT_MAX_CONCURRENT_STREAMS]);
+Assert::same(recvFrame($client), [FrameType::SETTINGS, Flag::ACK, 0, '']);
+sendFrame($client, FrameType::SETTINGS, Flag::ACK, 0);
+
+/* HEADERS + CONTINUATION + DATA request, HEADERS + DATA response */
+$block = $encoder->encode([':method' => 'POST', ':scheme' => 'http', ':path' => '/echo', ':authority' => 'localhost', 'content-length' => '5']);
+sendFrame($client, FrameType::HEADERS, Flag::NONE, 1, substr($block, 0, 4));
+sendFrame($client, FrameType::CONTINUATION, Flag::END_HEADERS, 1, substr($block, 4));
+sendFrame($client, FrameType::DATA, Flag::END_STREAM, 1, 'hello');
+[$type, $flags, $streamId, $payload] = recvFrame($client);
+Assert::same([$type, $flags, $streamId], [FrameType::HEADERS, Flag::END_HEADERS, 1]);
+Assert::same($decoder->decode($payload), [
+    [':status', '200'],
+    ['server', 'swow'],
+    ['content-type', 'text/plain'],
+    ['content-length', '5'],
+]);
+Assert::same(recvFrame($client), [FrameType::DATA, Flag::END_STREAM, 1, 'hello']);
+
+/* the response body is sent as far as the stream window allows, the rest is sent after WINDOW_UPDATE */
+sendFrame($client, FrameType::HEADERS, Flag::END_HEADERS | Flag::END_STREAM, 3, $encoder->encode([':method' => 'GET', ':scheme' => 'http', ':path' => '/large', ':authority' => 'localhost']));
+[$type, $flags, $streamId, $payload] = recvFrame($client);
+Assert::same([$type, $flags, $streamId], [FrameType::HEADERS, Flag::END_HEADERS, 3]);
+Assert::same($decoder->decode($payload)[0], [':status', '200']);
+Assert::same(recvFrame($client), [FrameType::DATA, Flag::NONE, 3, str_repeat('x', 16)]);
+sync($client);
+sendFrame($client, FrameType::WINDOW_UPDATE, Flag::NONE, 3, pack('N', 64));
+Assert::same(recvFrame($client), [FrameType::DATA, Flag::END_STREAM, 3, str_repeat('x', 24)]);
+
+/* unexpected exception of handler is a stream error */
+sendFrame($client, FrameType::HEADERS, Flag::END_HEADERS | Flag::END_STREAM, 5, $encoder->encode([':method' => 'GET', ':scheme' => 'http', ':path' => '/throw', ':authority' => 'localhost']));
+Assert::same(recvFrame($client), [FrameType::RST_STREAM, Flag::NONE, 5, pack('N', ErrorCode::INTERNAL_ERROR)]);
+
+/* stream is closed by RST_STREAM from peer */
+sendFrame($client, FrameType::HEADERS, Flag::END_HEADERS, 7, $encoder->encode([':method' => 'POST', ':scheme' => 'http', ':path' => '/echo', ':authority' => 'localhost']));
+sync($client);
+Assert::same($connection->getStreamCount(), 1);
+sendFrame($client, FrameType::RST_STREAM, Flag::NONE, 7, pack('N', ErrorCode::CANCEL));
+sync($client);
+Assert::same($connection->getStreamCount(), 0);
+
+/* new streams are ignored after GOAWAY from peer */
+sendFrame($client, FrameType::GOAWAY, Flag::NONE, 0, pack('NN', 0, ErrorCode::NO_ERROR));
+sendFrame($client, FrameType::HEADERS, Flag::END_HEADERS | Flag::END_STREAM, 9, $encoder->encode([':method' => 'GET', ':scheme' => 'http', ':path' => '/echo', ':authority' => 'localhost']));
+sync($client);
+Assert::same($connection->getStreamCount(), 0);
+
+/* connection error results in GOAWAY */
+sendFrame($client, FrameType::CONTINUATION, Flag::END_HEADERS, 9);
+Assert::same(recvFrame($client), [FrameType::GOAWAY, Flag::NONE, 0, pack('NN', 9, ErrorCode::PROTOCOL_ERROR) . 'Unexpected CONTINUATION frame']);
+WaitReference::wait($wr);
+Assert::true($connection->isClosed());
+
+$connection->getSocket()->close();
+$client->close();
+$server->close();
+
+echo 'Done' . PHP_LF;
+
+?>
+--EXPECT--
+Done
@@ -0,0 +1,106 @@
+--TEST--
+swow_http2: HPACK
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Http2;
+use Swow\Http2\ErrorCode;
+use Swow\Http2\FrameType;
+use Swow\Http2\Hpack;
+
+/* RFC 7541 Appendix C.3 (without Huffman) and C.4 (with Huffman), they share the same headers */
+$requests = [
+    [
+        [[':method', 'GET'], [':scheme', 'http'], [':path', '/'], [':authority', 'www.example.com']],
+        '828684410f7777772e6578616d706c652e636f6d',
+        '828684418cf1e3c2e5f23a6ba0ab90f4ff',
+        57,
+    ],
+    [
+        [[':method', 'GET'], [':scheme', 'http'], [':path', '/'], [':authority', 'www.example.com'], ['cache-control', 'no-cache']],
+        '828684be58086e6f2d6361636865',
+        '828684be5886a8eb10649cbf',
+        110,
+    ],
+    [
+        [[':method', 'GET'], [':scheme', 'https'], [':path', '/index.html'], [':authority', 'www.example.com'], ['custom-key', 'custom-value']],
+        '828785bf400a637573746f6d2d6b65790c637573746f6d2d76616c7565',
+        '828785bf408825a849e95ba97d7f8925a849e95bb8e8b4bf',
+        164,
+    ],
+];
+foreach ([1, 2] as $column) {
+    $decoder = new Hpack();
+    foreach ($requests as $request) {
+        Assert::same($decoder->decode(hex2bin($request[$column])), $request[0]);
+        Assert::same($decoder->getSize(), $request[3]);
+    }
+    Assert::same($decoder->getCount(), 3);
+}
+
+$encoder = new Hpack();
+foreach ($requests as $request) {
+    Assert::same(bin2hex($encoder->encode(array_column($request[0], 1, 0))), $request[2]);
+}
+$encoder = new Hpack();
+Assert::same(bin2hex($encoder->encode([':method' => 'GET', ':scheme' => 'http', ':path' => '/', ':authority' => 'www.example.com'], Hpack::FLAG_NO_HUFFMAN)), $requests[0][1]);
+
+/* round trip, names are lowercased and multiple values are kept in order */
+$encoder = new Hpack();
+$decoder = new Hpack();
+for ($n = 0; $n < 3; $n++) {
+    $block = $encoder->encode([
+        ':status' => '200',
+        'Content-Type' => 'text/plain',
+        'set-cookie' => ['a=1', 'b=2'],
+        'x-binary' => "\x00\xff\r\n",
+        'x-empty' => '',
+        'authorization' => 'secret',
+    ]);
+    Assert::same($decoder->decode($block), [
+        [':status', '200'],
+        ['content-type', 'text/plain'],
+        ['set-cookie', 'a=1'],
+        ['set-cookie', 'b=2'],
+        ['x-binary', "\x00\xff\r\n"],
+        ['x-empty', ''],
+        ['authorization', 'secret'],
+    ]);
+    Assert::same($decoder->getSize(), $encoder->getSize());
+}
+/* sensitive header is never indexed */
+Assert::true(strpos($encoder->encode(['authorization' => 'secret'], Hpack::FLAG_NO_HUFFMAN), 'secret') !== false);
+
+/* table size update is emitted and applied */
+$encoder->updateSize(0);
+Assert::same($decoder->decode($encoder->encode(['x-foo' => 'bar'])), [['x-foo', 'bar']]);
+Assert::same($encoder->getSize(), 0);
+Assert::same($decoder->getSize(), 0);
+Assert::same($decoder->getMaxSize(), 0);
+
+/* errors */
+Assert::throws(function () {
+    (new Hpack())->decode("\xbe");
+}, Http2\Exception::class);
+Assert::throws(function () use ($requests) {
+    (new Hpack())->decode(hex2bin($requests[2][1]), 64);
+}, Http2\Exception::class);
+Assert::throws(function () {
+    /* table size update exceeds the limit */
+    (new Hpack())->setSizeLimit(100)->decode("\x3f\xe1\x1f");
+}, Http2\Exception::class);
+
+Assert::same(FrameType::getName(FrameType::WINDOW_UPDATE), 'WINDOW_UPDATE');
+Assert::same(ErrorCode::getName(ErrorCode::ENHANCE_YOUR_CALM), 'ENHANCE_YOUR_CALM');
+Assert::same(Http2\CONNECTION_PREFACE, "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n");
+
+echo 'Done' . PHP_LF;
+
+?>
+--EXPECT--
+Done
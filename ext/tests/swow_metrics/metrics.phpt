@@ -0,0 +1,75 @@
+--TEST--
+swow_metrics: coroutine stats and runtime snapshot
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Channel;
+use Swow\Coroutine;
+use Swow\Metrics;
+use Swow\Socket;
+
+Assert::false(Metrics::isEnabled());
+Assert::same(Metrics::snapshot()['event']['rounds'], 0);
+
+Metrics::enable();
+Assert::true(Metrics::isEnabled());
+
+$server = new Socket(Socket::TYPE_TCP);
+$server->bind('127.0.0.1')->listen();
+$client = new Socket(Socket::TYPE_TCP);
+$client->connect($server->getSockAddress(), $server->getSockPort());
+$session = $server->accept();
+
+$channel = new Channel();
+$coroutine = Coroutine::run(function () use ($channel, $client): void {
+    usleep(1000);
+    $channel->pop();
+    Assert::same($client->readString(strlen('Hello Swow')), 'Hello Swow');
+});
+usleep(2000);
+$channel->push(true);
+usleep(2000);
+$session->sendString('Hello Swow');
+usleep(1000);
+Assert::false($coroutine->isAvailable());
+
+$stats = $coroutine->getStats();
+Assert::greaterThan($stats['run_time'], 0);
+Assert::greaterThan($stats['switches'], 2);
+Assert::same(array_keys($stats['wait_time']), ['other', 'io', 'timer', 'channel']);
+Assert::greaterThan($stats['wait_time']['timer'], 0);
+Assert::greaterThan($stats['wait_time']['channel'], 0);
+Assert::greaterThan($stats['wait_time']['io'], 0);
+Assert::same($stats['bytes_read'], strlen('Hello Swow'));
+Assert::same($stats['bytes_written'], 0);
+Assert::same(Coroutine::getCurrent()->getStats()['bytes_written'], strlen('Hello Swow'));
+
+$snapshot = Metrics::snapshot();
+Assert::true($snapshot['enabled']);
+Assert::greaterThan($snapshot['coroutine']['switches'], 0);
+Assert::greaterThan($snapshot['event']['rounds'], 0);
+Assert::greaterThan($snapshot['event']['busy_time'], 0);
+Assert::same(count($snapshot['event']['latency_histogram']), Metrics::HISTOGRAM_SIZE);
+Assert::same(array_sum($snapshot['event']['latency_histogram']), $snapshot['event']['rounds']);
+Assert::same(array_sum($snapshot['event']['run_queue_histogram']), $snapshot['event']['rounds']);
+Assert::greaterThan($snapshot['memory']['usage'], 0);
+
+Metrics::reset();
+Assert::same(Metrics::snapshot()['event']['rounds'], 0);
+
+Metrics::disable();
+Assert::false(Metrics::isEnabled());
+$switches = Coroutine::getCurrent()->getStats()['switches'];
+usleep(1000);
+Assert::same(Coroutine::getCurrent()->getStats()['switches'], $switches);
+
+echo 'Done' . PHP_LF;
+
+?>
+--EXPECT--
+Done
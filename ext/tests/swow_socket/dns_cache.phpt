@@ -0,0 +1,85 @@
+--TEST--
+swow_socket: dns cache
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Coroutine;
+use Swow\Socket;
+use Swow\Sync\WaitReference;
+
+$server = new Socket(Socket::TYPE_TCP);
+$server->bind('127.0.0.1')->listen();
+$port = $server->getSockPort();
+Coroutine::run(function () use ($server) {
+    try {
+        while (true) {
+            $server->accept()->close();
+        }
+    } catch (Socket\Exception $exception) {
+        /* server closed */
+    }
+});
+
+Assert::greaterThan(Socket::getGlobalDnsCacheSize(), 0);
+Socket::flushDnsCache();
+Socket::resetDnsCacheStats();
+
+/* concurrent lookups of the same name are coalesced into one resolution */
+$wr = new WaitReference();
+for ($n = 0; $n < TEST_MAX_CONCURRENCY_LOW; $n++) {
+    Coroutine::run(function () use ($port, $wr) {
+        $client = new Socket(Socket::TYPE_TCP4);
+        $client->connect('localhost', $port);
+        $client->close();
+    });
+}
+WaitReference::wait($wr);
+$stats = Socket::getDnsCacheStats();
+Assert::same($stats['misses'], 1);
+Assert::same($stats['coalesced'], TEST_MAX_CONCURRENCY_LOW - 1);
+Assert::same($stats['count'], 1);
+
+/* then it hits the cache */
+$client = new Socket(Socket::TYPE_TCP4);
+$client->connect('localhost', $port);
+$client->close();
+Assert::same(Socket::getDnsCacheStats()['hits'], 1);
+
+/* expired */
+Socket::setGlobalDnsCacheTtl(1);
+Socket::flushDnsCache();
+Assert::same(Socket::getDnsCacheStats()['count'], 0);
+(new Socket(Socket::TYPE_TCP4))->connect('localhost', $port)->close();
+msleep(10);
+(new Socket(Socket::TYPE_TCP4))->connect('localhost', $port)->close();
+Assert::same(Socket::getDnsCacheStats()['misses'], 3);
+Socket::setGlobalDnsCacheTtl(30 * 1000);
+
+/* disabled */
+$size = Socket::getGlobalDnsCacheSize();
+Socket::setGlobalDnsCacheSize(0);
+Assert::same(Socket::getDnsCacheStats()['count'], 0);
+Socket::resetDnsCacheStats();
+(new Socket(Socket::TYPE_TCP4))->connect('localhost', $port)->close();
+Assert::same(Socket::getDnsCacheStats()['misses'], 0);
+Socket::setGlobalDnsCacheSize($size);
+
+try {
+    Socket::setGlobalDnsCacheSize(-1);
+} catch (ValueError $error) {
+    echo 'ValueError' . PHP_LF;
+}
+
+$server->close();
+
+echo 'Done' . PHP_LF;
+
+?>
+--EXPECT--
+ValueError
+Done
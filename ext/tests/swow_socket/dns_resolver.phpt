@@ -0,0 +1,107 @@
+--TEST--
+swow_socket: dns resolver
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Coroutine;
+use Swow\Socket;
+
+/* a stand-in DNS server which only knows "swow.test" (A 127.0.0.1) */
+$dns = new Socket(Socket::TYPE_UDP);
+$dns->bind('127.0.0.1');
+Coroutine::run(function () use ($dns) {
+    try {
+        while (true) {
+            $query = $dns->recvStringFrom(512, $address, $port);
+            $offset = 12;
+            $labels = [];
+            while (($length = ord($query[$offset])) !== 0) {
+                $labels[] = substr($query, $offset + 1, $length);
+                $offset += $length + 1;
+            }
+            $type = unpack('n', $query, $offset + 1)[1];
+            $question = substr($query, 12, $offset + 5 - 12);
+            $name = implode('.', $labels);
+            if ($name === 'swow.test') {
+                $answers = $type === 1 ? [pack('nnnNnC4', 0xc00c, 1, 1, 60, 4, 127, 0, 0, 1)] : [];
+                $rcode = 0;
+            } else {
+                $answers = [];
+                $rcode = 3; /* NXDOMAIN */
+            }
+            $header = substr($query, 0, 2) . pack('nnnnn', 0x8180 | $rcode, 1, count($answers), 0, 0);
+            $dns->sendStringTo($header . $question . implode('', $answers), $address, $port);
+        }
+    } catch (Socket\Exception $exception) {
+        /* server closed */
+    }
+});
+
+$server = new Socket(Socket::TYPE_TCP);
+$server->bind('127.0.0.1')->listen();
+Coroutine::run(function () use ($server) {
+    try {
+        while (true) {
+            $server->accept()->close();
+        }
+    } catch (Socket\Exception $exception) {
+        /* server closed */
+    }
+});
+
+$resolvConf = tempnam(sys_get_temp_dir(), 'swow_resolv_conf');
+$hosts = tempnam(sys_get_temp_dir(), 'swow_hosts');
+file_put_contents($resolvConf, "search test\noptions ndots:1 timeout:1 attempts:1\n");
+file_put_contents($hosts, "127.0.0.1 swow.hosts\n");
+
+$cacheSize = Socket::getGlobalDnsCacheSize();
+Socket::setGlobalDnsCacheSize(0);
+Socket::loadDnsResolverConfig($resolvConf, $hosts);
+Socket::setDnsResolverNameservers([[$dns->getSockAddress(), $dns->getSockPort()]]);
+Socket::setDnsResolverEnabled(true);
+Assert::true(Socket::isDnsResolverEnabled());
+
+/* search domain */
+(new Socket(Socket::TYPE_TCP4))->connect('swow', $server->getSockPort())->close();
+(new Socket(Socket::TYPE_TCP4))->connect('swow.test', $server->getSockPort())->close();
+$stats = Socket::getDnsResolverStats();
+Assert::greaterThan($stats['queries'], 0);
+
+/* hosts */
+(new Socket(Socket::TYPE_TCP4))->connect('swow.hosts', $server->getSockPort())->close();
+Assert::same(Socket::getDnsResolverStats()['hosts_hits'], 1);
+
+Assert::throws(function () use ($server): void {
+    try {
+        (new Socket(Socket::TYPE_TCP4))->connect('nonexistent.test', $server->getSockPort());
+    } catch (Socket\Exception $exception) {
+        Assert::same($exception->getCode(), Swow\Errno\EAI_NONAME);
+        throw $exception;
+    }
+}, Socket\Exception::class);
+
+try {
+    Socket::setDnsResolverNameservers(['localhost']);
+} catch (ValueError $error) {
+    echo 'ValueError' . PHP_LF;
+}
+
+Socket::setDnsResolverEnabled(false);
+Socket::loadDnsResolverConfig();
+Socket::setGlobalDnsCacheSize($cacheSize);
+unlink($resolvConf);
+unlink($hosts);
+$dns->close();
+$server->close();
+
+echo 'Done' . PHP_LF;
+
+?>
+--EXPECT--
+ValueError
+Done
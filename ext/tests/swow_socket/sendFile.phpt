@@ -0,0 +1,61 @@
+--TEST--
+swow_socket: sendFile
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Coroutine;
+use Swow\Socket;
+use Swow\Sync\WaitReference;
+
+$content = str_repeat(getRandomBytes(TEST_MAX_LENGTH), 1024);
+$path = sys_get_temp_dir() . '/swow_socket_send_file_' . getmypid();
+file_put_contents($path, $content);
+
+$server = new Socket(Socket::TYPE_TCP);
+$server->bind('127.0.0.1')->listen();
+$wr = new WaitReference();
+Coroutine::run(function () use ($server, $path, $content, $wr) {
+    $connection = $server->accept();
+    /* whole file by path */
+    Assert::same($connection->sendFile($path), strlen($content));
+    /* part of file by stream, and data written after it must keep the order */
+    $file = fopen($path, 'rb');
+    Assert::same($connection->sendFile($file, 1, 100), 100);
+    fclose($file);
+    $connection->sendString('END');
+    /* length is beyond EOF */
+    Assert::same($connection->sendFile($path, strlen($content) - 1, 100), 1);
+    $connection->close();
+});
+
+$client = new Socket(Socket::TYPE_TCP);
+$client->connect($server->getSockAddress(), $server->getSockPort());
+/* let the sender wait for writable */
+msleep(10);
+Assert::same($client->readString(strlen($content)), $content);
+Assert::same($client->readString(103), substr($content, 1, 100) . 'END');
+Assert::same($client->readString(1), substr($content, -1));
+Assert::same($client->recvString(), '');
+WaitReference::wait($wr);
+
+Assert::throws(function () use ($path) {
+    try {
+        (new Socket(Socket::TYPE_UDP))->sendFile($path);
+    } catch (Socket\Exception $exception) {
+        Assert::same($exception->getCode(), Swow\Errno\EMISUSE);
+        throw $exception;
+    }
+}, Socket\Exception::class);
+
+unlink($path);
+
+echo 'Done' . PHP_LF;
+
+?>
+--EXPECT--
+Done
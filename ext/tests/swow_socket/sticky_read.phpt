@@ -0,0 +1,62 @@
+--TEST--
+swow_socket: sticky read
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Coroutine;
+use Swow\Socket;
+use Swow\Sync\WaitReference;
+
+$randoms = getRandomBytesArray(TEST_MAX_REQUESTS, TEST_MAX_LENGTH);
+$server = new Socket(Socket::TYPE_TCP);
+$server->bind('127.0.0.1')->listen();
+Assert::false(Socket::getGlobalStickyRead());
+Socket::setGlobalStickyRead(true);
+$wr = new WaitReference();
+Coroutine::run(function () use ($server, $wr, $randoms) {
+    $connection = $server->accept();
+    Assert::true($connection->isStickyRead());
+    foreach ($randoms as $random) {
+        /* data arrives while we are sleeping */
+        msleep(1);
+        Assert::same($connection->peekString(1), $random[0]);
+        Assert::same($connection->readString(strlen($random)), $random);
+        $connection->sendString('ok');
+    }
+    $connection->setStickyRead(false);
+    Assert::false($connection->isStickyRead());
+    Assert::same($connection->recvString(), '');
+    $connection->close();
+});
+
+$client = new Socket(Socket::TYPE_TCP);
+$client->connect($server->getSockAddress(), $server->getSockPort());
+foreach ($randoms as $random) {
+    $client->sendString($random);
+    Assert::same($client->readString(2), 'ok');
+}
+$client->close();
+
+WaitReference::wait($wr);
+$server->close();
+Socket::setGlobalStickyRead(false);
+
+Assert::throws(function () {
+    try {
+        (new Socket(Socket::TYPE_UDP))->setStickyRead();
+    } catch (Socket\Exception $exception) {
+        Assert::same($exception->getCode(), Swow\Errno\ENOTSUP);
+        throw $exception;
+    }
+}, Socket\Exception::class);
+
+echo 'Done' . PHP_LF;
+
+?>
+--EXPECT--
+Done
@@ -0,0 +1,62 @@
+--TEST--
+swow_socket: try write and write stats
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Coroutine;
+use Swow\Socket;
+use Swow\Sync\WaitReference;
+
+$randoms = getRandomBytesArray(TEST_MAX_REQUESTS * 2, TEST_MAX_LENGTH);
+$server = new Socket(Socket::TYPE_TCP);
+$server->bind('127.0.0.1')->listen();
+$wr = new WaitReference();
+Coroutine::run(function () use ($server, $wr, $randoms) {
+    $connection = $server->accept();
+    foreach ($randoms as $random) {
+        Assert::same($connection->readString(strlen($random)), $random);
+    }
+    $connection->close();
+});
+
+$client = new Socket(Socket::TYPE_TCP);
+$client->connect($server->getSockAddress(), $server->getSockPort());
+Assert::false(Socket::getGlobalTryWrite());
+Socket::resetWriteStats();
+
+/* inline write request */
+for ($n = 0; $n < TEST_MAX_REQUESTS; $n++) {
+    $client->sendString($randoms[$n]);
+}
+$stats = Socket::getWriteStats();
+Assert::same($stats['inline_requests'], TEST_MAX_REQUESTS);
+Assert::same($stats['direct_writes'], 0);
+
+/* direct write */
+Socket::setGlobalTryWrite(true);
+for (; $n < TEST_MAX_REQUESTS * 2; $n++) {
+    $client->sendString($randoms[$n]);
+}
+$stats = Socket::getWriteStats();
+Assert::greaterThan($stats['direct_writes'], 0);
+/* every write is either done directly or served by a write request */
+Assert::same(
+    $stats['direct_writes'] + $stats['inline_requests'] + $stats['pooled_requests'] + $stats['allocated_requests'],
+    TEST_MAX_REQUESTS * 2
+);
+Socket::setGlobalTryWrite(false);
+
+WaitReference::wait($wr);
+$client->close();
+$server->close();
+
+echo 'Done' . PHP_LF;
+
+?>
+--EXPECT--
+Done
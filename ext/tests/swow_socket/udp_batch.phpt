@@ -0,0 +1,85 @@
+--TEST--
+swow_socket: udp batch
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Coroutine;
+use Swow\Socket;
+
+$server = new Socket(Socket::TYPE_UDP);
+$server->bind('127.0.0.1', 0);
+Coroutine::run(function () use ($server) {
+    while (true) {
+        $datagrams = $server->recvBatch(Socket::DEFAULT_BATCH_COUNT, TEST_MAX_LENGTH_LOW);
+        Assert::greaterThan(count($datagrams), 0);
+        foreach ($datagrams as $datagram) {
+            if ($datagram[0] === '') {
+                break 2;
+            }
+        }
+        /* tuples can be sent back as they are */
+        Assert::same($server->sendBatch($datagrams), count($datagrams));
+    }
+});
+
+$client = new Socket(Socket::TYPE_UDP);
+$randoms = getRandomBytesArray(TEST_MAX_REQUESTS, TEST_MAX_LENGTH_LOW);
+$datagrams = [];
+foreach ($randoms as $random) {
+    $datagrams[] = [$random, $server->getSockAddress(), $server->getSockPort()];
+}
+Assert::same($client->sendBatch($datagrams), TEST_MAX_REQUESTS);
+$n = 0;
+while ($n < TEST_MAX_REQUESTS) {
+    foreach ($client->recvBatch(TEST_MAX_REQUESTS, TEST_MAX_LENGTH_LOW) as [$packet, $ip, $port]) {
+        Assert::same($packet, $randoms[$n++]);
+        Assert::same($ip, $server->getSockAddress());
+        Assert::same($port, $server->getSockPort());
+    }
+}
+
+/* connected */
+$client->connect($server->getSockAddress(), $server->getSockPort());
+Assert::same($client->sendBatch(['']), 1);
+
+/* timeout */
+Assert::throws(function () use ($client): void {
+    try {
+        $client->recvBatch(1, 1, 10);
+    } catch (Socket\Exception $exception) {
+        Assert::same($exception->getCode(), Swow\Errno\ETIMEDOUT);
+        Assert::same($exception->getReturnValue(), []);
+        throw $exception;
+    }
+}, Socket\Exception::class);
+
+/* truncated datagrams are reported */
+$peer = new Socket(Socket::TYPE_UDP);
+$peer->bind('127.0.0.1', 0);
+$sender = new Socket(Socket::TYPE_UDP);
+$sender->sendStringTo('0123456789abcdef', $peer->getSockAddress(), $peer->getSockPort());
+$sender->sendStringTo('01234567', $peer->getSockAddress(), $peer->getSockPort());
+$datagrams = [];
+while (count($datagrams) < 2) {
+    array_push($datagrams, ...$peer->recvBatch(2, 8));
+}
+Assert::same(array_column($datagrams, 0), ['01234567', '01234567']);
+Assert::same(array_column($datagrams, 3), [true, false]);
+$sender->close();
+$peer->close();
+
+/* huge arguments are clamped instead of being allocated */
+Assert::throws(function () use ($client): void {
+    $client->recvBatch(PHP_INT_MAX, PHP_INT_MAX, 10);
+}, Socket\Exception::class);
+
+echo 'Done' . PHP_LF;
+
+?>
+--EXPECT--
+Done
@@ -0,0 +1,73 @@
+--TEST--
+swow_stream: file io
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Coroutine;
+use Swow\Event;
+use Swow\Sync\WaitReference;
+use Swow\Work;
+
+$fsPool = Work::getPool(Work::KIND_FS);
+$completed = Work::getPoolStats($fsPool)['completed'];
+
+$wr = new WaitReference();
+for ($c = 0; $c < TEST_MAX_CONCURRENCY; $c++) {
+    Coroutine::run(function () use ($c, $wr) {
+        $path = sys_get_temp_dir() . '/swow_stream_file_io_' . getmypid() . '_' . $c;
+        /* large enough to go through the thread-pool */
+        $content = str_repeat(getRandomBytes(TEST_MAX_LENGTH), 1024);
+        Assert::same(file_put_contents($path, $content), strlen($content));
+        Assert::same(file_get_contents($path), $content);
+
+        $file = fopen($path, 'r+b');
+        Assert::same(fstat($file)['size'], strlen($content));
+        /* small reads are done synchronously */
+        Assert::same(fread($file, 3), substr($content, 0, 3));
+        Assert::same(fread($file, strlen($content)), substr($content, 3));
+        Assert::same(fseek($file, 0, SEEK_END), 0);
+        Assert::same(fwrite($file, $content), strlen($content));
+        if (function_exists('fsync')) {
+            Assert::true(fsync($file));
+            Assert::true(fdatasync($file));
+        }
+        Assert::same(fstat($file)['size'], strlen($content) * 2);
+        fclose($file);
+        Assert::same(file_get_contents($path), $content . $content);
+
+        unlink($path);
+    });
+}
+WaitReference::wait($wr);
+
+/* large reads and writes went through the thread-pool (if io_uring is not used instead) */
+if (!Event::isIoUringEnabled()) {
+    Assert::greaterThan(Work::getPoolStats($fsPool)['completed'], $completed);
+}
+
+/* reads of the PHP stream chunk size go asynchronously as well */
+$path = sys_get_temp_dir() . '/swow_stream_file_io_' . getmypid();
+file_put_contents($path, str_repeat('x', 8192 * 4));
+$file = fopen($path, 'rb');
+$completed = Work::getPoolStats($fsPool)['completed'];
+Assert::same(strlen(fgets($file)), 8192 * 4);
+if (!Event::isIoUringEnabled()) {
+    Assert::greaterThan(Work::getPoolStats($fsPool)['completed'], $completed);
+}
+fclose($file);
+unlink($path);
+
+/* errors are the same as before */
+Assert::false(@fopen(sys_get_temp_dir() . '/swow_stream_file_io_not_exists', 'r'));
+Assert::contains(error_get_last()['message'], 'No such file or directory');
+
+echo 'Done' . PHP_LF;
+
+?>
+--EXPECT--
+Done
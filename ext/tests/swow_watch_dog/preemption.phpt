@@ -0,0 +1,55 @@
+--TEST--
+swow_watch_dog: preemption
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+skip_if_in_valgrind();
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Coroutine;
+use Swow\WatchDog;
+
+function busy(float $seconds): void
+{
+    $until = microtime(true) + $seconds;
+    while (microtime(true) < $until) {
+        continue;
+    }
+}
+
+Assert::same(WatchDog::getTimeSlice(), -1);
+WatchDog::run(1 * 1000 * 1000, 0, 0, 5 * 1000 * 1000);
+Assert::same(WatchDog::getTimeSlice(), 5 * 1000 * 1000);
+
+$main = Coroutine::getCurrent();
+Assert::same($main->getTimeSlice(), 0);
+
+$count = 0;
+$ticker = Coroutine::run(function () use (&$count) {
+    while (true) {
+        usleep(1000);
+        $count++;
+    }
+});
+
+/* never preempted */
+Assert::same($main->setTimeSlice(-1), $main);
+busy(0.05);
+Assert::same($count, 0);
+
+/* preempted after the time slice of watch-dog */
+$main->setTimeSlice(0);
+busy(0.05);
+Assert::greaterThan($count, 0);
+
+$ticker->kill();
+WatchDog::stop();
+
+echo 'Done' . PHP_LF;
+
+?>
+--EXPECT--
+Done
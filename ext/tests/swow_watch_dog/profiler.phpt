@@ -0,0 +1,71 @@
+--TEST--
+swow_watch_dog: profiler
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+skip_if_in_valgrind();
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Coroutine;
+use Swow\WatchDog;
+
+function busy(float $seconds): int
+{
+    $count = 0;
+    $until = microtime(true) + $seconds;
+    while (microtime(true) < $until) {
+        $count++;
+    }
+
+    return $count;
+}
+
+Assert::throws(function () {
+    WatchDog::startProfiling();
+}, WatchDog\Exception::class);
+
+/* sample at 1000 Hz (there is only main coroutine, so it never alerts) */
+WatchDog::run(1 * 1000 * 1000);
+WatchDog::startProfiling(true);
+Assert::true(WatchDog::isProfiling());
+(function (): void {
+    busy(0.1);
+})();
+WatchDog::stopProfiling();
+Assert::false(WatchDog::isProfiling());
+
+$id = Coroutine::getCurrent()->getId();
+$samples = WatchDog::getSamples();
+Assert::greaterThan(count($samples), 0);
+$found = false;
+foreach ($samples as $stack => $count) {
+    Assert::greaterThan($count, 0);
+    if (preg_match("/^coroutine#{$id};\\{main\\};\\{closure\\};busy(;microtime)?$/", $stack)) {
+        $found = true;
+    }
+}
+Assert::true($found);
+foreach (explode("\n", rtrim(WatchDog::getFoldedSamples())) as $line) {
+    Assert::same(preg_match('/^\S+ \d+$/', $line), 1);
+}
+
+/* samples are not attributed to coroutines by default */
+WatchDog::startProfiling();
+busy(0.1);
+WatchDog::stopProfiling();
+Assert::true(count(array_filter(array_keys(WatchDog::getSamples()), static function (string $stack): bool {
+    return strpos($stack, '{main};busy') === 0;
+})) > 0);
+
+WatchDog::stop();
+Assert::same(WatchDog::getSamples(), []);
+Assert::same(WatchDog::getFoldedSamples(), '');
+
+echo 'Done' . PHP_LF;
+
+?>
+--EXPECT--
+Done
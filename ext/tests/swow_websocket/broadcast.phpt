@@ -0,0 +1,102 @@
+--TEST--
+swow_websocket: broadcast
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Buffer;
+use Swow\Coroutine;
+use Swow\Http\Server;
+use Swow\Http\Server\WebSocketFrame;
+use Swow\Socket;
+use Swow\Sync\WaitReference;
+use Swow\WebSocket\Connection;
+use Swow\WebSocket\Opcode;
+use const Swow\Errno\EAGAIN;
+use const Swow\Errno\ENOTCONN;
+use const Swow\Errno\ENOTSUP;
+
+$server = new Socket(Socket::TYPE_TCP);
+$server->bind('127.0.0.1')->listen();
+
+$clients = [];
+$sessions = [];
+for ($n = 0; $n < TEST_MAX_CONCURRENCY; $n++) {
+    $client = new Socket(Socket::TYPE_TCP);
+    $client->connect($server->getSockAddress(), $server->getSockPort());
+    $clients[] = new Connection($client);
+    $sessions["session-{$n}"] = new Connection($server->accept());
+}
+
+/* per-target failures are reported with the keys of targets */
+$failures = Connection::broadcast(
+    $sessions + ['idle' => new Socket(Socket::TYPE_TCP), 'client' => $clients[0]],
+    'Hello Swow'
+);
+Assert::same($failures, ['idle' => ENOTCONN, 'client' => ENOTSUP]);
+
+$wr = new WaitReference();
+foreach ($clients as $client) {
+    Coroutine::run(function () use ($client, $wr) {
+        $buffer = new Buffer();
+        Assert::same($client->recvMessage($buffer), Opcode::TEXT);
+        Assert::same($buffer->toString(), 'Hello Swow');
+    });
+}
+WaitReference::wait($wr);
+
+$random = getRandomBytes(TEST_MAX_LENGTH);
+Assert::same(Connection::broadcast($sessions, $random, Opcode::BINARY), []);
+foreach ($clients as $client) {
+    Coroutine::run(function () use ($client, $random, $wr) {
+        $buffer = new Buffer();
+        Assert::same($client->recvMessage($buffer), Opcode::BINARY);
+        Assert::same($buffer->toString(), $random);
+    });
+}
+WaitReference::wait($wr);
+
+/* slow consumers are skipped by the high-water mark */
+$session = reset($sessions);
+$huge = str_repeat('x', 32 * 1024 * 1024);
+Assert::same(Connection::broadcast([$session], $huge, Opcode::BINARY, 0), []);
+Assert::greaterThan($session->getSocket()->getWriteQueueSize(), 0);
+Assert::same(Connection::broadcast([$session], 'skipped', Opcode::TEXT, 1), [EAGAIN]);
+/* the rest will be sent after draining */
+Assert::same(Connection::broadcast([$session], 'queued', Opcode::TEXT, 0), []);
+$client = $clients[0];
+$client->setMaxMessageSize(strlen($huge));
+$buffer = new Buffer();
+Assert::same($client->recvMessage($buffer), Opcode::BINARY);
+Assert::same($buffer->getLength(), strlen($huge));
+$buffer->clear();
+Assert::same($client->recvMessage($buffer), Opcode::TEXT);
+Assert::same($buffer->toString(), 'queued');
+
+/* fragmented or compressed frames can not be shared by targets */
+$httpServer = new Server();
+Assert::throws(function () use ($httpServer) {
+    $httpServer->broadcastMessage((new WebSocketFrame())->setFin(0), []);
+}, InvalidArgumentException::class);
+Assert::throws(function () use ($httpServer) {
+    $httpServer->broadcastMessage((new WebSocketFrame())->setFin(1)->setRSV1(1), []);
+}, InvalidArgumentException::class);
+$httpServer->close();
+
+foreach ($clients as $client) {
+    $client->getSocket()->close();
+}
+foreach ($sessions as $session) {
+    $session->getSocket()->close();
+}
+$server->close();
+
+echo 'Done' . PHP_LF;
+
+?>
+--EXPECT--
+Done
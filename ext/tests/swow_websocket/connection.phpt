@@ -0,0 +1,175 @@
+--TEST--
+swow_websocket: connection
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Buffer;
+use Swow\Channel;
+use Swow\Coroutine;
+use Swow\Socket;
+use Swow\Sync\WaitReference;
+use Swow\WebSocket;
+use Swow\WebSocket\Connection;
+use Swow\WebSocket\Opcode;
+use Swow\WebSocket\Status;
+use const Swow\Errno\ECANCELED;
+
+function packMaskedFrame(bool $fin, int $opcode, string $payload): string
+{
+    $length = strlen($payload);
+    $header = chr(($fin ? 0x80 : 0) | $opcode);
+    if ($length <= WebSocket\EXT8_MAX_LENGTH) {
+        $header .= chr(0x80 | $length);
+    } elseif ($length <= WebSocket\EXT16_MAX_LENGTH) {
+        $header .= chr(0x80 | WebSocket\EXT16_LENGTH) . pack('n', $length);
+    } else {
+        $header .= chr(0x80 | WebSocket\EXT64_LENGTH) . pack('J', $length);
+    }
+    $maskKey = getRandomBytes(WebSocket\MASK_KEY_LENGTH);
+    $mask = substr(str_repeat($maskKey, intdiv($length, 4) + 1), 0, $length);
+
+    return $header . $maskKey . ($payload ^ $mask);
+}
+
+function recvMessage(Connection $connection, ?int &$opcode = null): string
+{
+    $buffer = new Buffer();
+    $opcode = $connection->recvMessage($buffer);
+
+    return $buffer->toString();
+}
+
+$deflate = Connection::isPerMessageDeflateSupported();
+
+$server = new Socket(Socket::TYPE_TCP);
+$results = new Channel(4);
+Coroutine::run(function () use ($server, $results) {
+    $server->bind('127.0.0.1')->listen();
+    try {
+        while (true) {
+            $session = $server->accept();
+            Coroutine::run(function () use ($session, $results) {
+                /* emulate the extension negotiation of handshake */
+                $deflate = $session->readString(1) === 'D';
+                $connection = new Connection($session);
+                Assert::same($connection->getSocket(), $session);
+                if ($deflate) {
+                    $connection->enablePerMessageDeflate();
+                }
+                $result = Status::NORMAL_CLOSURE;
+                try {
+                    while (true) {
+                        $message = recvMessage($connection, $opcode);
+                        if ($opcode === Opcode::CLOSE) {
+                            break;
+                        }
+                        $connection->sendMessage($message, $opcode);
+                    }
+                } catch (WebSocket\Exception $exception) {
+                    $result = $exception->getCode();
+                }
+                $session->close();
+                $results->push($result);
+            });
+        }
+    } catch (Socket\Exception $exception) {
+        Assert::same($exception->getCode(), ECANCELED);
+    }
+});
+
+function connect(Socket $server, bool $deflate): Connection
+{
+    $socket = new Socket(Socket::TYPE_TCP);
+    $socket->connect($server->getSockAddress(), $server->getSockPort());
+    $socket->sendString($deflate ? 'D' : 'N');
+    $connection = new Connection($socket);
+    if ($deflate) {
+        $connection->enablePerMessageDeflate();
+    }
+
+    return $connection;
+}
+
+$wr = new WaitReference();
+Coroutine::run(function () use ($server, $deflate, $wr) {
+    $connection = connect($server, $deflate);
+    Assert::same($connection->getMaxMessageSize(), Connection::DEFAULT_MAX_MESSAGE_SIZE);
+    Assert::same($connection->isPerMessageDeflateEnabled(), $deflate);
+
+    /* echo */
+    foreach ([0, 1, 125, 126, 65535, 65536, TEST_MAX_LENGTH] as $length) {
+        $binary = getRandomBytes($length);
+        Assert::same(recvMessage($connection->sendMessage($binary, Opcode::BINARY), $opcode), $binary);
+        Assert::same($opcode, Opcode::BINARY);
+        $text = str_repeat('Swow 🚀 ', intdiv($length, 8) + 1);
+        Assert::same(recvMessage($connection->sendMessage($text), $opcode), $text);
+        Assert::same($opcode, Opcode::TEXT);
+    }
+
+    /* close handshake */
+    $connection->sendClose(Status::GOING_AWAY, 'bye');
+    Assert::same(recvMessage($connection, $opcode), pack('n', Status::GOING_AWAY) . 'bye');
+    Assert::same($opcode, Opcode::CLOSE);
+    $connection->getSocket()->close();
+});
+
+Coroutine::run(function () use ($server, $wr) {
+    $connection = connect($server, false);
+    $socket = $connection->getSocket();
+
+    /* fragmented text (with UTF-8 sequence split between frames) and interleaved ping */
+    $socket->sendString(
+        packMaskedFrame(false, Opcode::TEXT, "Hello \xF0\x9F") .
+        packMaskedFrame(true, Opcode::PING, 'ping') .
+        packMaskedFrame(false, Opcode::CONTINUATION, "\x9A\x80 ") .
+        packMaskedFrame(true, Opcode::CONTINUATION, 'Swow')
+    );
+    /* pong is consumed silently */
+    Assert::same(recvMessage($connection, $opcode), "Hello \u{1F680} Swow");
+    Assert::same($opcode, Opcode::TEXT);
+
+    /* invalid UTF-8 */
+    $connection->sendMessage("\xC0\xAF");
+    Assert::same(recvMessage($connection, $opcode), pack('n', Status::INVALID_FRAME_PAYLOAD_DATA));
+    Assert::same($opcode, Opcode::CLOSE);
+    $socket->close();
+});
+
+Coroutine::run(function () use ($server, $wr) {
+    $connection = connect($server, false);
+    /* unexpected continuation */
+    $connection->getSocket()->sendString(packMaskedFrame(true, Opcode::CONTINUATION, 'foo'));
+    Assert::same(recvMessage($connection, $opcode), pack('n', Status::PROTOCOL_ERROR));
+    Assert::same($opcode, Opcode::CLOSE);
+    $connection->getSocket()->close();
+});
+
+Coroutine::run(function () use ($server, $wr) {
+    $connection = connect($server, false);
+    /* servers reject unmasked frames */
+    $connection->getSocket()->sendString(chr(0x80 | Opcode::TEXT) . chr(3) . 'foo');
+    Assert::same(recvMessage($connection, $opcode), pack('n', Status::PROTOCOL_ERROR));
+    Assert::same($opcode, Opcode::CLOSE);
+    $connection->getSocket()->close();
+});
+
+WaitReference::wait($wr);
+$server->close();
+
+$codes = [];
+for ($n = 0; $n < 4; $n++) {
+    $codes[] = $results->pop();
+}
+sort($codes);
+Assert::same($codes, [Status::NORMAL_CLOSURE, Status::PROTOCOL_ERROR, Status::PROTOCOL_ERROR, Status::INVALID_FRAME_PAYLOAD_DATA]);
+
+echo 'Done' . PHP_LF;
+
+?>
+--EXPECT--
+Done
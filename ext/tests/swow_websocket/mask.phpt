@@ -0,0 +1,78 @@
+--TEST--
+swow_websocket: mask kernels
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Buffer;
+use Swow\WebSocket\Frame;
+
+function maskReference(string $data, string $maskKey, int $index = 0): string
+{
+    $result = '';
+    for ($i = 0; $i < strlen($data); $i++) {
+        $result .= $data[$i] ^ $maskKey[($index + $i) % 4];
+    }
+    return $result;
+}
+
+$kernels = Frame::getAvailableMaskKernels();
+Assert::contains($kernels, 'generic');
+Assert::oneOf(Frame::getMaskKernel(), $kernels);
+
+$maskKey = getRandomBytes(4);
+$data = getRandomBytes(1024 + 77 + 3);
+
+foreach ($kernels as $kernel) {
+    Frame::setMaskKernel($kernel);
+    Assert::same(Frame::getMaskKernel(), $kernel);
+    foreach ([0, 1, 15, 16, 33, 63, 64, 65, 255, 256, 1024 + 77] as $length) {
+        /* unaligned source and destination */
+        foreach ([0, 1, 3] as $skip) {
+            $expected = maskReference(substr($data, $skip, $length), $maskKey, $skip);
+            $from = new Buffer(strlen($data));
+            $from->write($data)->seek($skip);
+            $to = new Buffer(strlen($data) + 8);
+            $to->write(str_repeat("\0", $skip + 1));
+            Assert::same(Frame::mask($from, $to, $maskKey, $skip, $length), $length);
+            Assert::same($to->getLength(), $skip + 1 + $length);
+            Assert::same(substr($to->toString(), $skip + 1), $expected);
+            /* in-place */
+            Assert::same(Frame::mask($from, $from, $maskKey, $skip, $length), $length);
+            Assert::same(substr($from->toString(), $skip, $length), $expected);
+        }
+    }
+}
+
+/* masking in chunks is the same as masking at once */
+$payload = (new Buffer(strlen($data)))->write($data)->rewind();
+$chunked = new Buffer(strlen($data));
+for ($index = 0; $index < strlen($data); $index += 100) {
+    $chunk = (new Buffer(100))->write(substr($data, $index, 100))->rewind();
+    Frame::mask($chunk, $chunked, $maskKey, $index);
+}
+Frame::mask($payload, $payload, $maskKey);
+Assert::same($chunked->toString(), $payload->toString());
+
+try {
+    Frame::mask($payload, new Buffer(1), $maskKey);
+    Assert::true(false);
+} catch (Buffer\Exception $exception) {
+    Assert::same($exception->getCode(), Swow\Errno\ENOBUFS);
+}
+try {
+    Frame::setMaskKernel('unknown');
+    Assert::true(false);
+} catch (Error $exception) {
+    Assert::contains($exception->getMessage(), 'getAvailableMaskKernels');
+}
+
+echo 'Done' . PHP_LF;
+
+?>
+--EXPECT--
+Done
@@ -0,0 +1,67 @@
+--TEST--
+swow_work: kernels
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Buffer;
+use Swow\Coroutine;
+use Swow\Sync\WaitReference;
+use Swow\Work;
+
+$data = str_repeat(getRandomBytes(TEST_MAX_LENGTH) . 'swow', 64);
+$input = new Buffer(strlen($data));
+$input->write($data)->rewind();
+
+Work::createPool('cpu', 2);
+
+/* hash */
+$wr = new WaitReference();
+foreach (['md5', 'sha1', 'sha256', 'crc32b'] as $algo) {
+    Coroutine::run(function () use ($data, $algo, $wr) {
+        Assert::same(Work::hash((new Buffer(strlen($data)))->write($data)->rewind(), $algo), hash($algo, $data));
+        Assert::same(Work::hash((new Buffer(strlen($data)))->write($data)->rewind(), $algo, true, 'cpu'), hash($algo, $data, true));
+    });
+}
+WaitReference::wait($wr);
+try {
+    Work::hash($input, 'unknown');
+    Assert::true(false);
+} catch (Error $exception) {
+    Assert::contains($exception->getMessage(), 'hashing algorithm');
+}
+
+/* regex */
+$text = 'foo=1; bar=22; baz=333';
+$matches = Work::matchAll((new Buffer(strlen($text)))->write($text)->rewind(), '/\w+=(\d+)/');
+preg_match_all('/\w+=(\d+)/', $text, $expected, PREG_OFFSET_CAPTURE);
+Assert::same(count($matches), 3);
+foreach ($matches as $i => [$offset, $length]) {
+    Assert::same($offset, $expected[0][$i][1]);
+    Assert::same(substr($text, $offset, $length), $expected[0][$i][0]);
+}
+Assert::count(Work::matchAll((new Buffer(strlen($text)))->write($text)->rewind(), '/\d+/', 2), 2);
+
+/* buffers are locked during the work */
+$buffer = (new Buffer(strlen($data)))->write($data)->rewind();
+$coroutine = Coroutine::run(function () use ($buffer) {
+    Work::hash($buffer, 'sha512', false, 'cpu');
+});
+if ($coroutine->isAlive()) {
+    try {
+        $buffer->write('x');
+        Assert::true(false);
+    } catch (Buffer\Exception $exception) {
+        Assert::same($exception->getCode(), Swow\Errno\ELOCKED);
+    }
+}
+
+echo 'Done' . PHP_LF;
+
+?>
+--EXPECT--
+Done
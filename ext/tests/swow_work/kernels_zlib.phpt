@@ -0,0 +1,50 @@
+--TEST--
+swow_work: zlib kernels
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+try {
+    /* invalid level is rejected after zlib availability is checked */
+    Swow\Work::deflate(new Swow\Buffer(1), new Swow\Buffer(1), 100);
+} catch (Swow\Work\Exception $exception) {
+    skip('Swow was built without zlib', $exception->getCode() === Swow\Errno\ENOTSUP);
+} catch (ValueError $error) {
+    /* zlib is available */
+}
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Buffer;
+use Swow\Work;
+
+$data = str_repeat(getRandomBytes(TEST_MAX_LENGTH) . 'swow', 64);
+$input = new Buffer(strlen($data));
+$input->write($data)->rewind();
+
+foreach ([Work::ENCODING_RAW, Work::ENCODING_GZIP, Work::ENCODING_DEFLATE] as $encoding) {
+    $compressed = new Buffer(strlen($data) + 1024);
+    $length = Work::deflate($input, $compressed, 6, $encoding);
+    Assert::greaterThan($length, 0);
+    Assert::same($compressed->getLength(), $length);
+    $decompressed = new Buffer(strlen($data));
+    Assert::same(Work::inflate($compressed, $decompressed, $encoding), strlen($data));
+    Assert::same($decompressed->toString(), $data);
+    if ($encoding === Work::ENCODING_RAW && function_exists('gzinflate')) {
+        Assert::same(gzinflate($compressed->toString()), $data);
+    }
+    /* output space is not enough */
+    try {
+        Work::inflate($compressed, new Buffer(strlen($data) - 1), $encoding);
+        Assert::true(false);
+    } catch (Work\Exception $exception) {
+        Assert::same($exception->getCode(), Swow\Errno\ENOBUFS);
+    }
+}
+
+echo 'Done' . PHP_LF;
+
+?>
+--EXPECT--
+Done
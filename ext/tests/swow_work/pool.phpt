@@ -0,0 +1,81 @@
+--TEST--
+swow_work: pool
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Coroutine;
+use Swow\Work;
+use Swow\Sync\WaitReference;
+
+Assert::same(Work::getPools(), [Work::DEFAULT_POOL]);
+Assert::same(Work::getPool(Work::KIND_FS), Work::DEFAULT_POOL);
+
+Work::createPool('fs', 2);
+Work::createPool('dns', 1, 8, 5);
+Assert::same(Work::getPools(), [Work::DEFAULT_POOL, 'fs', 'dns']);
+try {
+    Work::createPool('fs', 1);
+    Assert::true(false);
+} catch (Work\Exception $exception) {
+    Assert::same($exception->getCode(), Swow\Errno\EEXIST);
+}
+
+Work::setPool(Work::KIND_FS, 'fs');
+Work::setPool(Work::KIND_DNS, 'dns');
+Assert::same(Work::getPool(Work::KIND_FS), 'fs');
+Assert::same(Work::getPool(Work::KIND_DNS), 'dns');
+
+/* file io goes to the dedicated pool */
+$wr = new WaitReference();
+for ($c = 0; $c < TEST_MAX_CONCURRENCY_LOW; $c++) {
+    Coroutine::run(function () use ($c, $wr) {
+        $path = sys_get_temp_dir() . '/swow_work_pool_' . getmypid() . '_' . $c;
+        $content = str_repeat(getRandomBytes(TEST_MAX_LENGTH), 1024);
+        Assert::same(file_put_contents($path, $content), strlen($content));
+        Assert::same(file_get_contents($path), $content);
+        unlink($path);
+    });
+}
+WaitReference::wait($wr);
+
+$stats = Work::getPoolStats('fs');
+Assert::same($stats['name'], 'fs');
+Assert::same($stats['size'], 2);
+Assert::same($stats['queue_size'], 0);
+Assert::same($stats['running'], 0);
+Assert::greaterThan($stats['submitted'], 0);
+Assert::same($stats['completed'], $stats['submitted']);
+Assert::count($stats['queue_wait_histogram'], Work::HISTOGRAM_SIZE);
+Assert::same(array_sum($stats['run_time_histogram']), $stats['completed']);
+Assert::same(Work::getPoolStats('dns')['priority'], 5);
+Assert::same(Work::getPoolStats('dns')['max_queue_size'], 8);
+
+Work::resetPoolStats('fs');
+Assert::same(Work::getPoolStats('fs')['submitted'], 0);
+
+/* pools can be closed after they are drained, and kinds fall back to the default one */
+Work::closePool('fs');
+Assert::same(Work::getPool(Work::KIND_FS), Work::DEFAULT_POOL);
+try {
+    Work::getPoolStats('fs');
+    Assert::true(false);
+} catch (Work\Exception $exception) {
+    Assert::same($exception->getCode(), Swow\Errno\ENOENT);
+}
+try {
+    Work::closePool(Work::DEFAULT_POOL);
+    Assert::true(false);
+} catch (Work\Exception $exception) {
+    Assert::same($exception->getCode(), Swow\Errno\EINVAL);
+}
+
+echo 'Done' . PHP_LF;
+
+?>
+--EXPECT--
+Done
@@ -208,6 +208,22 @@ namespace Swow
          */
         public function getElapsedAsString(): string { }
 
+        /**
+         * @return array
+         */
+        public function getStats(): array { }
+
+        /**
+         * @return int
+         */
+        public function getTimeSlice(): int { }
+
+        /**
+         * @param int $timeSlice [required]
+         * @return $this
+         */
+        public function setTimeSlice(int $timeSlice) { }
+
         /**
          * @return int
          */
@@ -329,6 +345,39 @@ namespace Swow
          */
         public static function getAll(): array { }
 
+        /**
+         * @param int $lowWatermark [required]
+         * @param int $highWatermark [required]
+         * @return void
+         */
+        public static function setStackPoolWatermarks(int $lowWatermark, int $highWatermark): void { }
+
+        /**
+         * @return array
+         */
+        public static function getStackPoolStats(): array { }
+
+        /**
+         * @return int
+         */
+        public static function clearStackPool(): int { }
+
+        /**
+         * @param int $size [required]
+         * @return void
+         */
+        public static function setExecutorPoolSize(int $size): void { }
+
+        /**
+         * @return array
+         */
+        public static function getExecutorPoolStats(): array { }
+
+        /**
+         * @return int
+         */
+        public static function clearExecutorPool(): int { }
+
         /**
          * @return array
          */
@@ -426,6 +475,32 @@ namespace Swow
          * @return void
          */
         public static function wait(): void { }
+
+        /**
+         * @return bool
+         */
+        public static function isIoUringAvailable(): bool { }
+
+        /**
+         * @return bool
+         */
+        public static function isIoUringEnabled(): bool { }
+
+        /**
+         * @param bool $enable [required]
+         * @return void
+         */
+        public static function setIoUringEnabled(bool $enable): void { }
+
+        /**
+         * @return array
+         */
+        public static function getIoUringStats(): array { }
+
+        /**
+         * @return void
+         */
+        public static function resetIoUringStats(): void { }
     }
 }
 
@@ -630,6 +705,7 @@ namespace Swow
     {
         public const INVALID_FD = -1;
         public const DEFAULT_BACKLOG = 128;
+        public const DEFAULT_BATCH_COUNT = 64;
         public const TYPE_FLAG_STREAM = 1;
         public const TYPE_FLAG_DGRAM = 2;
         public const TYPE_FLAG_INET = 16;
@@ -694,6 +770,11 @@ namespace Swow
          */
         public function getFd(): int { }
 
+        /**
+         * @return int
+         */
+        public function getWriteQueueSize(): int { }
+
         /**
          * @return int
          */
@@ -982,6 +1063,30 @@ namespace Swow
          */
         public function sendStringTo(string $string, $address = null, $port = null, ?int $timeout = null, int $offset = 0, int $length = 0) { }
 
+        /**
+         * @param int $count [optional] = \Swow\Socket::DEFAULT_BATCH_COUNT
+         * @param null|int $size [optional] = null
+         * @param null|int $timeout [optional] = $this->getReadTimeout()
+         * @return array
+         */
+        public function recvBatch(int $count = \Swow\Socket::DEFAULT_BATCH_COUNT, ?int $size = null, ?int $timeout = null): array { }
+
+        /**
+         * @param array $datagrams [required]
+         * @param null|int $timeout [optional] = $this->getWriteTimeout()
+         * @return int
+         */
+        public function sendBatch(array $datagrams, ?int $timeout = null): int { }
+
+        /**
+         * @param mixed $file [required]
+         * @param int $offset [optional] = 0
+         * @param int $length [optional] = 0
+         * @param null|int $timeout [optional] = $this->getWriteTimeout()
+         * @return int
+         */
+        public function sendFile($file, int $offset = 0, int $length = 0, ?int $timeout = null): int { }
+
         /**
          * @return bool
          */
@@ -997,6 +1102,11 @@ namespace Swow
          */
         public function isEstablished(): bool { }
 
+        /**
+         * @return bool
+         */
+        public function isStickyRead(): bool { }
+
         /**
          * @return $this
          */
@@ -1058,6 +1168,12 @@ namespace Swow
          */
         public function setTcpAcceptBalance(bool $enable) { }
 
+        /**
+         * @param bool $enable [optional]
+         * @return $this
+         */
+        public function setStickyRead(bool $enable) { }
+
         /**
          * @return array
          */
@@ -1134,6 +1250,120 @@ namespace Swow
          * @return mixed
          */
         public static function setGlobalWriteTimeout(int $timeout) { }
+
+        /**
+         * @return bool
+         */
+        public static function getGlobalTryWrite(): bool { }
+
+        /**
+         * @param bool $enable [required]
+         * @return void
+         */
+        public static function setGlobalTryWrite(bool $enable): void { }
+
+        /**
+         * @return bool
+         */
+        public static function getGlobalStickyRead(): bool { }
+
+        /**
+         * @param bool $enable [required]
+         * @return void
+         */
+        public static function setGlobalStickyRead(bool $enable): void { }
+
+        /**
+         * @return array
+         */
+        public static function getWriteStats(): array { }
+
+        /**
+         * @return void
+         */
+        public static function resetWriteStats(): void { }
+
+        /**
+         * @return int
+         */
+        public static function getGlobalDnsCacheSize(): int { }
+
+        /**
+         * @param int $size [required]
+         * @return void
+         */
+        public static function setGlobalDnsCacheSize(int $size): void { }
+
+        /**
+         * @return int
+         */
+        public static function getGlobalDnsCacheTtl(): int { }
+
+        /**
+         * @param int $ttl [required]
+         * @return void
+         */
+        public static function setGlobalDnsCacheTtl(int $ttl): void { }
+
+        /**
+         * @return int
+         */
+        public static function getGlobalDnsCacheNegativeTtl(): int { }
+
+        /**
+         * @param int $ttl [required]
+         * @return void
+         */
+        public static function setGlobalDnsCacheNegativeTtl(int $ttl): void { }
+
+        /**
+         * @return void
+         */
+        public static function flushDnsCache(): void { }
+
+        /**
+         * @return array
+         */
+        public static function getDnsCacheStats(): array { }
+
+        /**
+         * @return void
+         */
+        public static function resetDnsCacheStats(): void { }
+
+        /**
+         * @return bool
+         */
+        public static function isDnsResolverEnabled(): bool { }
+
+        /**
+         * @param bool $enable [required]
+         * @return void
+         */
+        public static function setDnsResolverEnabled(bool $enable): void { }
+
+        /**
+         * @param string|null $resolvConf [optional] = null
+         * @param string|null $hosts [optional] = null
+         * @return void
+         */
+        public static function loadDnsResolverConfig(?string $resolvConf = null, ?string $hosts = null): void { }
+
+        /**
+         * @param array $nameservers [required]
+         * @return void
+         */
+        public static function setDnsResolverNameservers(array $nameservers): void { }
+
+        /**
+         * @return array
+         */
+        public static function getDnsResolverStats(): array { }
+
+        /**
+         * @return void
+         */
+        public static function resetDnsResolverStats(): void { }
     }
 }
 
@@ -1192,9 +1422,10 @@ namespace Swow
          * @param int $quantum [optional] = 0
          * @param int $threshold [optional] = 0
          * @param callable|int|float|null $alerter [optional] = null
+         * @param int $timeSlice [optional] = 0
          * @return void
          */
-        public static function run(int $quantum = 0, int $threshold = 0, $alerter = null): void { }
+        public static function run(int $quantum = 0, int $threshold = 0, $alerter = null, int $timeSlice = 0): void { }
 
         /**
          * @return void
@@ -1205,6 +1436,178 @@ namespace Swow
          * @return bool
          */
         public static function isRunning(): bool { }
+
+        /**
+         * @return int
+         */
+        public static function getTimeSlice(): int { }
+
+        /**
+         * @param bool $perCoroutine [optional] = false
+         * @return void
+         */
+        public static function startProfiling(bool $perCoroutine = false): void { }
+
+        /**
+         * @return void
+         */
+        public static function stopProfiling(): void { }
+
+        /**
+         * @return bool
+         */
+        public static function isProfiling(): bool { }
+
+        /**
+         * @return array
+         */
+        public static function getSamples(): array { }
+
+        /**
+         * @return string
+         */
+        public static function getFoldedSamples(): string { }
+    }
+}
+
+namespace Swow
+{
+    class Work
+    {
+        public const KIND_CPU = 0;
+        public const KIND_FS = 1;
+        public const KIND_DNS = 2;
+        public const DEFAULT_POOL = 'default';
+        public const HISTOGRAM_SIZE = 24;
+        public const ENCODING_RAW = -15;
+        public const ENCODING_GZIP = 31;
+        public const ENCODING_DEFLATE = 15;
+
+        /**
+         * @param string $name [required]
+         * @param int $size [required]
+         * @param int $maxQueueSize [optional] = 0
+         * @param int $priority [optional] = 0
+         * @return void
+         */
+        public static function createPool(string $name, int $size, int $maxQueueSize = 0, int $priority = 0): void { }
+
+        /**
+         * @param string $name [required]
+         * @return void
+         */
+        public static function closePool(string $name): void { }
+
+        /**
+         * @return array
+         */
+        public static function getPools(): array { }
+
+        /**
+         * @param int $kind [required]
+         * @return string
+         */
+        public static function getPool(int $kind): string { }
+
+        /**
+         * @param int $kind [required]
+         * @param string $name [required]
+         * @return void
+         */
+        public static function setPool(int $kind, string $name): void { }
+
+        /**
+         * @param string $name [required]
+         * @param int $maxQueueSize [required]
+         * @return void
+         */
+        public static function setPoolMaxQueueSize(string $name, int $maxQueueSize): void { }
+
+        /**
+         * @param string $name [optional] = "default"
+         * @return array
+         */
+        public static function getPoolStats(string $name = "default"): array { }
+
+        /**
+         * @param string $name [optional] = "default"
+         * @return void
+         */
+        public static function resetPoolStats(string $name = "default"): void { }
+
+        /**
+         * @param \Swow\Buffer $buffer [required]
+         * @param string $algo [required]
+         * @param bool $binary [optional] = false
+         * @param null|string $pool [optional] = null
+         * @param int $timeout [optional] = -1
+         * @return string
+         */
+        public static function hash(\Swow\Buffer $buffer, string $algo, bool $binary = false, ?string $pool = null, int $timeout = -1): string { }
+
+        /**
+         * @param \Swow\Buffer $input [required]
+         * @param \Swow\Buffer $output [required]
+         * @param int $level [optional] = -1
+         * @param int $encoding [optional] = Swow\Work::ENCODING_RAW
+         * @param null|string $pool [optional] = null
+         * @param int $timeout [optional] = -1
+         * @return int
+         */
+        public static function deflate(\Swow\Buffer $input, \Swow\Buffer $output, int $level = -1, int $encoding = \Swow\Work::ENCODING_RAW, ?string $pool = null, int $timeout = -1): int { }
+
+        /**
+         * @param \Swow\Buffer $input [required]
+         * @param \Swow\Buffer $output [required]
+         * @param int $encoding [optional] = Swow\Work::ENCODING_RAW
+         * @param null|string $pool [optional] = null
+         * @param int $timeout [optional] = -1
+         * @return int
+         */
+        public static function inflate(\Swow\Buffer $input, \Swow\Buffer $output, int $encoding = \Swow\Work::ENCODING_RAW, ?string $pool = null, int $timeout = -1): int { }
+
+        /**
+         * @param \Swow\Buffer $buffer [required]
+         * @param string $pattern [required]
+         * @param int $limit [optional] = 0
+         * @param null|string $pool [optional] = null
+         * @param int $timeout [optional] = -1
+         * @return array
+         */
+        public static function matchAll(\Swow\Buffer $buffer, string $pattern, int $limit = 0, ?string $pool = null, int $timeout = -1): array { }
+    }
+}
+
+namespace Swow
+{
+    class Metrics
+    {
+        public const HISTOGRAM_SIZE = 24;
+
+        /**
+         * @return void
+         */
+        public static function enable(): void { }
+
+        /**
+         * @return void
+         */
+        public static function disable(): void { }
+
+        /**
+         * @return bool
+         */
+        public static function isEnabled(): bool { }
+
+        /**
+         * @return array
+         */
+        public static function snapshot(): array { }
+
+        /**
+         * @return void
+         */
+        public static function reset(): void { }
     }
 }
 
@@ -1353,6 +1756,16 @@ namespace Swow\WatchDog
     class Exception extends \Swow\Exception { }
 }
 
+namespace Swow\Work
+{
+    class Exception extends \Swow\Exception { }
+}
+
+namespace Swow\Metrics
+{
+    class Exception extends \Swow\Exception { }
+}
+
 namespace Swow\Http
 {
     class Status
@@ -1449,6 +1862,38 @@ namespace Swow\Http
         public const EVENT_CHUNK_COMPLETE = 33554432;
         public const EVENTS_NONE = 0;
         public const EVENTS_ALL = 67043334;
+        public const HEADER_HOST = 1;
+        public const HEADER_CONNECTION = 2;
+        public const HEADER_CONTENT_LENGTH = 3;
+        public const HEADER_CONTENT_TYPE = 4;
+        public const HEADER_CONTENT_ENCODING = 5;
+        public const HEADER_TRANSFER_ENCODING = 6;
+        public const HEADER_KEEP_ALIVE = 7;
+        public const HEADER_UPGRADE = 8;
+        public const HEADER_EXPECT = 9;
+        public const HEADER_ACCEPT = 10;
+        public const HEADER_ACCEPT_ENCODING = 11;
+        public const HEADER_ACCEPT_LANGUAGE = 12;
+        public const HEADER_AUTHORIZATION = 13;
+        public const HEADER_COOKIE = 14;
+        public const HEADER_SET_COOKIE = 15;
+        public const HEADER_USER_AGENT = 16;
+        public const HEADER_REFERER = 17;
+        public const HEADER_ORIGIN = 18;
+        public const HEADER_DATE = 19;
+        public const HEADER_SERVER = 20;
+        public const HEADER_LOCATION = 21;
+        public const HEADER_CACHE_CONTROL = 22;
+        public const HEADER_IF_MODIFIED_SINCE = 23;
+        public const HEADER_IF_NONE_MATCH = 24;
+        public const HEADER_RANGE = 25;
+        public const HEADER_X_FORWARDED_FOR = 26;
+        public const HEADER_SEC_WEBSOCKET_KEY = 27;
+        public const HEADER_SEC_WEBSOCKET_VERSION = 28;
+        public const HEADER_SEC_WEBSOCKET_PROTOCOL = 29;
+        public const HEADER_SEC_WEBSOCKET_EXTENSIONS = 30;
+        public const HEADER_SEC_WEBSOCKET_ACCEPT = 31;
+        public const HEADER_HTTP2_SETTINGS = 32;
 
         /**
          * @return int
@@ -1479,6 +1924,56 @@ namespace Swow\Http
          */
         public function execute(\Swow\Buffer $buffer, &$data = null): int { }
 
+        /**
+         * @param \Swow\Buffer $buffer [required]
+         * @return int
+         */
+        public function executeHead(\Swow\Buffer $buffer): int { }
+
+        /**
+         * @return int
+         */
+        public function getHeaderCount(): int { }
+
+        /**
+         * @return string
+         */
+        public function getUriOrReasonPhrase(): string { }
+
+        /**
+         * @param string $name [required]
+         * @return bool
+         */
+        public function hasHeader(string $name): bool { }
+
+        /**
+         * @param string $name [required]
+         * @return null|string
+         */
+        public function getHeader(string $name): ?string { }
+
+        /**
+         * @param string $name [required]
+         * @return array
+         */
+        public function getHeaderValues(string $name): array { }
+
+        /**
+         * @param int $id [required]
+         * @return null|string
+         */
+        public function getKnownHeader(int $id): ?string { }
+
+        /**
+         * @return array
+         */
+        public function getHeaders(): array { }
+
+        /**
+         * @return array
+         */
+        public function getHeaderNames(): array { }
+
         /**
          * @return int
          */
@@ -1602,6 +2097,21 @@ namespace Swow\Http
      function packResponse(int $statusCode = 0, array $headers = [], string $body = '', string $reasonPhrase = '', string $protocolVersion = ''): string { }
 }
 
+namespace Swow\Http
+{
+    /**
+     * @param \Swow\Socket $socket
+     * @param int $statusCode [optional] = 0
+     * @param array $headers [optional] = []
+     * @param string|\Swow\Buffer $body [optional] = ''
+     * @param string $reasonPhrase [optional] = ''
+     * @param string $protocolVersion [optional] = ''
+     * @param int|null $timeout [optional] = $socket->getWriteTimeout()
+     * @return void
+     */
+     function sendResponse(\Swow\Socket $socket, int $statusCode = 0, array $headers = [], $body = '', string $reasonPhrase = '', string $protocolVersion = '', ?int $timeout = null): void { }
+}
+
 namespace Swow\Http\Parser
 {
     class Exception extends \Swow\Exception { }
@@ -1807,6 +2317,32 @@ namespace Swow\WebSocket
          */
         public function unmaskPayloadData() { }
 
+        /**
+         * @param \Swow\Buffer $from [required]
+         * @param \Swow\Buffer $to [required]
+         * @param string $maskKey [required]
+         * @param int $index [optional] = 0
+         * @param null|int $length [optional] = $from->getReadableLength()
+         * @return int
+         */
+        public static function mask(\Swow\Buffer $from, \Swow\Buffer $to, string $maskKey, int $index = 0, ?int $length = null): int { }
+
+        /**
+         * @return string
+         */
+        public static function getMaskKernel(): string { }
+
+        /**
+         * @param string $kernel [required]
+         * @return void
+         */
+        public static function setMaskKernel(string $kernel): void { }
+
+        /**
+         * @return array
+         */
+        public static function getAvailableMaskKernels(): array { }
+
         /**
          * @param bool $headerOnly [optional] = false
          * @return string
@@ -1825,6 +2361,247 @@ namespace Swow\WebSocket
     }
 }
 
+namespace Swow\WebSocket
+{
+    class Connection
+    {
+        public const DEFAULT_MAX_MESSAGE_SIZE = 16777216;
+        public const DEFAULT_BROADCAST_HIGH_WATER_MARK = 1048576;
+
+        /**
+         * @param \Swow\Socket $socket [required]
+         * @param null|\Swow\Buffer $buffer [optional] = null
+         */
+        public function __construct(\Swow\Socket $socket, ?\Swow\Buffer $buffer = null) { }
+
+        /**
+         * @return \Swow\Socket
+         */
+        public function getSocket(): \Swow\Socket { }
+
+        /**
+         * @return int
+         */
+        public function getMaxMessageSize(): int { }
+
+        /**
+         * @param int $maxMessageSize [required]
+         * @return $this
+         */
+        public function setMaxMessageSize(int $maxMessageSize) { }
+
+        /**
+         * @return bool
+         */
+        public static function isPerMessageDeflateSupported(): bool { }
+
+        /**
+         * @param bool $noContextTakeover [optional] = false
+         * @param bool $peerNoContextTakeover [optional] = false
+         * @param int $maxWindowBits [optional] = 15
+         * @param int $level [optional] = -1
+         * @return $this
+         */
+        public function enablePerMessageDeflate(bool $noContextTakeover = false, bool $peerNoContextTakeover = false, int $maxWindowBits = 15, int $level = -1) { }
+
+        /**
+         * @return bool
+         */
+        public function isPerMessageDeflateEnabled(): bool { }
+
+        /**
+         * @param \Swow\Buffer $buffer [required]
+         * @param null|int $timeout [optional] = $this->getSocket()->getReadTimeout()
+         * @return int
+         */
+        public function recvMessage(\Swow\Buffer $buffer, ?int $timeout = null): int { }
+
+        /**
+         * @param string $data [required]
+         * @param int $opcode [optional] = \Swow\WebSocket\Opcode::TEXT
+         * @param null|int $timeout [optional] = $this->getSocket()->getWriteTimeout()
+         * @return $this
+         */
+        public function sendMessage(string $data, int $opcode = \Swow\WebSocket\Opcode::TEXT, ?int $timeout = null) { }
+
+        /**
+         * @param int $code [optional] = \Swow\WebSocket\Status::NORMAL_CLOSURE
+         * @param string $reason [optional] = ''
+         * @param null|int $timeout [optional] = $this->getSocket()->getWriteTimeout()
+         * @return $this
+         */
+        public function sendClose(int $code = \Swow\WebSocket\Status::NORMAL_CLOSURE, string $reason = '', ?int $timeout = null) { }
+
+        /**
+         * @param array $targets [required]
+         * @param string $data [required]
+         * @param int $opcode [optional] = \Swow\WebSocket\Opcode::TEXT
+         * @param int $highWaterMark [optional] = \Swow\WebSocket\Connection::DEFAULT_BROADCAST_HIGH_WATER_MARK
+         * @return array
+         */
+        public static function broadcast(array $targets, string $data, int $opcode = \Swow\WebSocket\Opcode::TEXT, int $highWaterMark = \Swow\WebSocket\Connection::DEFAULT_BROADCAST_HIGH_WATER_MARK): array { }
+    }
+}
+
+namespace Swow\WebSocket
+{
+    class Exception extends \Swow\Exception { }
+}
+
+namespace Swow\Http2
+{
+    const CONNECTION_PREFACE = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+    const ALPN_PROTOCOL = 'h2';
+    const FRAME_HEADER_LENGTH = 9;
+    const DEFAULT_HEADER_TABLE_SIZE = 4096;
+    const DEFAULT_WINDOW_SIZE = 65535;
+    const MAX_WINDOW_SIZE = 2147483647;
+    const DEFAULT_MAX_FRAME_SIZE = 16384;
+    const MAX_MAX_FRAME_SIZE = 16777215;
+    const MAX_STREAM_ID = 2147483647;
+    const SETTINGS_ENTRY_LENGTH = 6;
+}
+
+namespace Swow\Http2
+{
+    class FrameType
+    {
+        public const DATA = 0;
+        public const HEADERS = 1;
+        public const PRIORITY = 2;
+        public const RST_STREAM = 3;
+        public const SETTINGS = 4;
+        public const PUSH_PROMISE = 5;
+        public const PING = 6;
+        public const GOAWAY = 7;
+        public const WINDOW_UPDATE = 8;
+        public const CONTINUATION = 9;
+
+        /**
+         * @param int $type [required]
+         * @return string
+         */
+        public static function getName(int $type): string { }
+    }
+}
+
+namespace Swow\Http2
+{
+    class Flag
+    {
+        public const NONE = 0;
+        public const END_STREAM = 1;
+        public const ACK = 1;
+        public const END_HEADERS = 4;
+        public const PADDED = 8;
+        public const PRIORITY = 32;
+    }
+}
+
+namespace Swow\Http2
+{
+    class Setting
+    {
+        public const HEADER_TABLE_SIZE = 1;
+        public const ENABLE_PUSH = 2;
+        public const MAX_CONCURRENT_STREAMS = 3;
+        public const INITIAL_WINDOW_SIZE = 4;
+        public const MAX_FRAME_SIZE = 5;
+        public const MAX_HEADER_LIST_SIZE = 6;
+    }
+}
+
+namespace Swow\Http2
+{
+    class ErrorCode
+    {
+        public const NO_ERROR = 0;
+        public const PROTOCOL_ERROR = 1;
+        public const INTERNAL_ERROR = 2;
+        public const FLOW_CONTROL_ERROR = 3;
+        public const SETTINGS_TIMEOUT = 4;
+        public const STREAM_CLOSED = 5;
+        public const FRAME_SIZE_ERROR = 6;
+        public const REFUSED_STREAM = 7;
+        public const CANCEL = 8;
+        public const COMPRESSION_ERROR = 9;
+        public const CONNECT_ERROR = 10;
+        public const ENHANCE_YOUR_CALM = 11;
+        public const INADEQUATE_SECURITY = 12;
+        public const HTTP_1_1_REQUIRED = 13;
+
+        /**
+         * @param int $code [required]
+         * @return string
+         */
+        public static function getName(int $code): string { }
+
+        /**
+         * @param int $code [required]
+         * @return string
+         */
+        public static function getDescription(int $code): string { }
+    }
+}
+
+namespace Swow\Http2
+{
+    class Hpack
+    {
+        public const FLAG_NONE = 0;
+        public const FLAG_NO_INDEX = 1;
+        public const FLAG_NEVER_INDEX = 2;
+        public const FLAG_NO_HUFFMAN = 4;
+        public const DEFAULT_MAX_HEADER_LIST_SIZE = 65536;
+
+        /**
+         * @param array $headers [required]
+         * @param int $flags [optional] = \Swow\Http2\Hpack::FLAG_NONE
+         * @return string
+         */
+        public function encode(array $headers, int $flags = \Swow\Http2\Hpack::FLAG_NONE): string { }
+
+        /**
+         * @param string $headerBlock [required]
+         * @param int $maxHeaderListSize [optional] = \Swow\Http2\Hpack::DEFAULT_MAX_HEADER_LIST_SIZE
+         * @return array
+         */
+        public function decode(string $headerBlock, int $maxHeaderListSize = \Swow\Http2\Hpack::DEFAULT_MAX_HEADER_LIST_SIZE): array { }
+
+        /**
+         * @return int
+         */
+        public function getSize(): int { }
+
+        /**
+         * @return int
+         */
+        public function getMaxSize(): int { }
+
+        /**
+         * @return int
+         */
+        public function getCount(): int { }
+
+        /**
+         * @param int $sizeLimit [required]
+         * @return $this
+         */
+        public function setSizeLimit(int $sizeLimit) { }
+
+        /**
+         * @param int $maxSize [required]
+         * @return $this
+         */
+        public function updateSize(int $maxSize) { }
+    }
+}
+
+namespace Swow\Http2
+{
+    class Exception extends \Swow\Exception { }
+}
+
 namespace Swow\Errno
 {
     const E2BIG = -7;
@@ -64,27 +64,24 @@ trait ReceiverTrait
             /* all data has been parsed, clear them */
             $buffer->clear();
         }
-        $data = '';
         $uriOrReasonPhrase = '';
-        $headerName = '';
         $headers = [];
         $headerNames = [];
         $shouldKeepAlive = false;
         $contentLength = 0;
-        $headerLength = 0;
         $headersComplete = false;
         $body = null;
         try {
             while (true) {
                 if ($expectMore) {
-                    $this->recvData($buffer);
+                    $this->recvMore();
                 }
                 while (true) {
                     if (!$headersComplete) {
-                        $event = $parser->execute($buffer, $data);
-                        $headerLength += $parser->getParsedLength();
-                        if ($headerLength > $maxHeaderLength) {
-                            throw new HttpException(HttpStatus::REQUEST_HEADER_FIELDS_TOO_LARGE);
+                        /* the whole head is parsed at once (nothing is consumed until it is complete) */
+                        $event = $parser->executeHead($buffer);
+                        if ($event === HttpParser::EVENT_NONE && $buffer->getReadableLength() > $maxHeaderLength) {
+                            throw new HttpException($this->getIncompleteHeadTooLargeStatus($isRequest));
                         }
                     } else {
                         $event = $parser->execute($buffer);
@@ -98,7 +95,7 @@ trait ReceiverTrait
                                 $newSize = $buffer->getSize() * 2;
                                 /* we need bigger buffer to handle the large filed (or throw error) */
                                 if ($newSize > $this->maxBufferSize) {
-                                    throw new HttpException(empty($uriOrReasonPhrase) ? HttpStatus::REQUEST_URI_TOO_LARGE : HttpStatus::REQUEST_HEADER_FIELDS_TOO_LARGE);
+                                    throw new HttpException($this->getIncompleteHeadTooLargeStatus($isRequest));
                                 }
                                 $buffer->realloc($newSize);
                             }
@@ -112,25 +109,17 @@ trait ReceiverTrait
                     }
                     if (!$headersComplete) {
                         switch ($event) {
-                            case HttpParser::EVENT_HEADER_FIELD:
-                            {
-                                $headerName = $data;
-                                break;
-                            }
-                            case HttpParser::EVENT_HEADER_VALUE:
-                            {
-                                $headers[$headerName][] = $data;
-                                $headerNames[strtolower($headerName)] = $headerName;
-                                break;
-                            }
-                            case HttpParser::EVENT_URL:
-                            case HttpParser::EVENT_STATUS:
-                            {
-                                $uriOrReasonPhrase = $data;
-                                break;
-                            }
                             case HttpParser::EVENT_HEADERS_COMPLETE:
                             {
+                                $uriOrReasonPhrase = $parser->getUriOrReasonPhrase();
+                                /* the head may arrive complete in one read, so its length is checked here too */
+                                if ($parser->getParsedLength() > $maxHeaderLength) {
+                                    throw new HttpException($isRequest && strlen($uriOrReasonPhrase) > $maxHeaderLength ?
+                                        HttpStatus::REQUEST_URI_TOO_LARGE :
+                                        HttpStatus::REQUEST_HEADER_FIELDS_TOO_LARGE);
+                                }
+                                $headers = $parser->getHeaders();
+                                $headerNames = $parser->getHeaderNames();
                                 $defaultKeepAlive = $parser->getMajorVersion() !== 1 || $parser->getMinorVersion() !== 0;
                                 $shouldKeepAlive = $parser->shouldKeepAlive();
                                 $this->keepAlive = $shouldKeepAlive !== $defaultKeepAlive ? $shouldKeepAlive : null;
@@ -194,4 +183,31 @@ trait ReceiverTrait
 
         return $result;
     }
+
+    /**
+     * If the request line has not been terminated yet, it is the URI that is too large
+     */
+    protected function getIncompleteHeadTooLargeStatus(bool $isRequest): int
+    {
+        if ($isRequest && strpos($this->buffer->peek(), "\n") === false) {
+            return HttpStatus::REQUEST_URI_TOO_LARGE;
+        }
+
+        return HttpStatus::REQUEST_HEADER_FIELDS_TOO_LARGE;
+    }
+
+    /**
+     * Append more data after the unparsed data (e.g. the rest of pipelined requests) in the buffer
+     */
+    protected function recvMore(): void
+    {
+        $buffer = $this->buffer;
+        $offset = $buffer->tell();
+        $buffer->seek(0, SEEK_END);
+        try {
+            $this->recvData($buffer);
+        } finally {
+            $buffer->seek($offset);
+        }
+    }
 }
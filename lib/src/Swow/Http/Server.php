@@ -16,7 +16,7 @@ namespace Swow\Http;
 use Swow\Http\Server\Session;
 use Swow\Http\Server\WebSocketFrame;
 use Swow\Socket;
-use Swow\Socket\Exception as SocketException;
+use Swow\WebSocket\Connection as WebSocketConnection;
 
 class Server extends Socket
 {
@@ -47,28 +47,31 @@ class Server extends Socket
         return $session;
     }
 
-    public function broadcastMessage(WebSocketFrame $frame, array $targets = null)
+    /**
+     * The frame is encoded once and shared by all targets (writes are queued without waiting),
+     * targets which have more pending data than $highWaterMark are skipped (0 means never skip),
+     * only unfragmented and uncompressed frames can be broadcast (FIN is set and RSV bits are clear)
+     * @param Session[]|null $targets
+     * @return int[] error codes of the failed targets
+     */
+    public function broadcastMessage(WebSocketFrame $frame, array $targets = null, int $highWaterMark = WebSocketConnection::DEFAULT_BROADCAST_HIGH_WATER_MARK): array
     {
-        if ($targets = null) {
-            $targets = $this->sessions;
+        if (!$frame->getFin() || $frame->getRSV1() || $frame->getRSV2() || $frame->getRSV3()) {
+            throw new \InvalidArgumentException('Fragmented or compressed frames can not be broadcast');
         }
-        if ($frame->getPayloadLength() <= Buffer::PAGE_SIZE) {
-            $frame = $frame->toString();
-        }
-        foreach ($targets as $target) {
-            if ($target->getType() !== $target::TYPE_WEBSOCKET) {
-                continue;
-            }
-            try {
-                if (is_string($frame)) {
-                    $target->sendString($frame);
-                } else {
-                    $target->sendWebSocketFrame($frame);
-                }
-            } catch (SocketException $exception) {
-                /* ignore */
-            }
+        if ($targets === null) {
+            $targets = $this->sessions;
         }
+        $targets = array_filter($targets, static function (Session $target): bool {
+            return $target->getType() === $target::TYPE_WEBSOCKET;
+        });
+
+        return WebSocketConnection::broadcast(
+            $targets,
+            $frame->getPayloadDataAsString(),
+            $frame->getOpcode(),
+            $highWaterMark
+        );
     }
 
     public function offline(int $fd)
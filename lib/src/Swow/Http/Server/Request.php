@@ -61,6 +61,10 @@ class Request extends \Swow\Http\ServerRequest
 
     public function getUpgrade(): int
     {
+        if ($this->method === 'PRI' && $this->protocolVersion === '2.0') {
+            /* it is the beginning of HTTP/2 connection preface (with prior knowledge) */
+            return static::UPGRADE_H2C;
+        }
         if ($this->upgrade === false) {
             return static::UPGRADE_NONE;
         }
@@ -13,20 +13,24 @@ declare(strict_types=1);
 
 namespace Swow\Http\Server;
 
+use Swow\Buffer;
 use Swow\Http\Exception as HttpException;
 use Swow\Http\Parser as HttpParser;
 use Swow\Http\ReceiverTrait;
 use Swow\Http\Server;
 use Swow\Http\Status as HttpStatus;
+use Swow\Http2;
 use Swow\Socket;
 use Swow\WebSocket;
 use function Swow\Http\packResponse;
+use function Swow\Http\sendResponse;
 
 class Session extends Socket
 {
     use ReceiverTrait {
         __construct as receiverConstruct;
         execute as receiverExecute;
+        recvMore as receiverRecvMore;
     }
 
     public const TYPE_HTTP = 1 << 0;
@@ -60,6 +64,23 @@ class Session extends Socket
      */
     protected $keepAlive = false;
 
+    /**
+     * @var null|WebSocket\Connection
+     */
+    protected $webSocketConnection;
+
+    /**
+     * @var null|Http2\Connection
+     */
+    protected $http2Connection;
+
+    /**
+     * Responses of pipelined requests, they are sent by one write
+     * after all requests in the buffer have been handled
+     * @var string[]
+     */
+    protected $pendingResponses = [];
+
     /**
      * @noinspection PhpMissingParentConstructorInspection
      */
@@ -120,14 +141,76 @@ class Session extends Socket
      */
     public function sendHttpResponse(Response $response)
     {
-        $this->write([
-            $response->toString(true),
-            $response->getBodyAsString(),
-        ]);
+        return $this->sendResponseVector(
+            $response->getStatusCode(),
+            $response->getStandardHeaders(),
+            $response->hasBody() ? $response->getBody() : '',
+            $response->getReasonPhrase(),
+            $response->getProtocolVersion()
+        );
+    }
+
+    /**
+     * Send the response without concatenating its head and body,
+     * only the head is packed, and the body (string or the whole content of Buffer) is written as it is
+     * @param Buffer|string $body
+     * @return $this
+     */
+    public function sendResponseVector(int $statusCode, array $headers = [], $body = '', string $reasonPhrase = '', string $protocolVersion = '')
+    {
+        if (($this->type === static::TYPE_HTTP && !$this->buffer->eof()) || $this->pendingResponses) {
+            /* it will be sent with pipelined responses later, so the buffer must be copied */
+            return $this->sendResponse([
+                packResponse($statusCode, $headers, '', $reasonPhrase, $protocolVersion),
+                $body instanceof Buffer ? $body->toString() : $body,
+            ]);
+        }
+        sendResponse($this, $statusCode, $headers, $body, $reasonPhrase, $protocolVersion);
+
+        return $this;
+    }
+
+    /**
+     * @return $this
+     */
+    protected function sendResponse(array $vector)
+    {
+        if ($this->type === static::TYPE_HTTP && !$this->buffer->eof()) {
+            /* there are more pipelined requests, send it later with their responses */
+            array_push($this->pendingResponses, ...$vector);
+
+            return $this;
+        }
+        if ($this->pendingResponses) {
+            $vector = array_merge($this->pendingResponses, $vector);
+            $this->pendingResponses = [];
+        }
+        $this->write($vector);
+
+        return $this;
+    }
+
+    /**
+     * @return $this
+     */
+    public function flushResponses()
+    {
+        if ($this->pendingResponses) {
+            $vector = $this->pendingResponses;
+            $this->pendingResponses = [];
+            $this->write($vector);
+        }
 
         return $this;
     }
 
+    protected function recvMore(): void
+    {
+        /* peer may wait for responses before sending the rest */
+        $this->flushResponses();
+        $this->receiverRecvMore();
+    }
+
     protected function generateResponseHeaders(string $body): array
     {
         $headers = [];
@@ -158,7 +241,7 @@ class Session extends Socket
                     }
                 }
                 $headers += $this->generateResponseHeaders($body);
-                $this->write([packResponse($statusCode, $headers), $body]);
+                $this->sendResponseVector($statusCode, $headers, $body);
                 break;
             }
             case static::TYPE_WEBSOCKET:
@@ -177,10 +260,11 @@ class Session extends Socket
                 if ($message === '') {
                     $message = HttpStatus::getReasonPhrase($code);
                 }
-                $this->write([
-                    packResponse($code, $this->generateResponseHeaders($message)),
-                    "<html lang=\"en\"><body><h2>HTTP {$code} {$message}</h2><hr><i>Powered by Swow</i></body></html>\r\n",
-                ]);
+                $this->sendResponseVector(
+                    $code,
+                    $this->generateResponseHeaders($message),
+                    "<html lang=\"en\"><body><h2>HTTP {$code} {$message}</h2><hr><i>Powered by Swow</i></body></html>\r\n"
+                );
                 break;
             }
             case static::TYPE_WEBSOCKET:
@@ -219,14 +303,151 @@ class Session extends Socket
             'Sec-WebSocket-Version' => WebSocket\VERSION,
         ];
 
+        $deflateOptions = null;
+        if (WebSocket\Connection::isPerMessageDeflateSupported()) {
+            $deflateOptions = $this->negotiatePerMessageDeflate($request->getHeaderLine('sec-websocket-extensions'));
+            if ($deflateOptions !== null) {
+                $headers['Sec-WebSocket-Extensions'] = array_pop($deflateOptions);
+            }
+        }
+
         if ($response === null) {
             $this->respond($statusCode, $headers);
         } else {
             $this->sendHttpResponse($response->setStatus($statusCode)->setHeaders($headers));
         }
+        $this->flushResponses();
 
         $this->upgraded(static::TYPE_WEBSOCKET);
 
+        /* data left in buffer (if any) belongs to the WebSocket stream */
+        $this->webSocketConnection = new WebSocket\Connection($this, $this->buffer);
+        if ($deflateOptions !== null) {
+            $this->webSocketConnection->enablePerMessageDeflate(...$deflateOptions);
+        }
+
+        return $this;
+    }
+
+    /**
+     * Accept the first acceptable permessage-deflate offer (RFC 7692)
+     * @return null|array arguments of enablePerMessageDeflate() with the response extension at the end
+     */
+    protected function negotiatePerMessageDeflate(string $extensions): ?array
+    {
+        foreach (explode(',', $extensions) as $offer) {
+            $params = array_map('trim', explode(';', $offer));
+            if (strtolower(array_shift($params)) !== 'permessage-deflate') {
+                continue;
+            }
+            $noContextTakeover = false;
+            $peerNoContextTakeover = false;
+            $maxWindowBits = 15;
+            $response = ['permessage-deflate'];
+            foreach ($params as $param) {
+                $pair = array_map('trim', explode('=', $param, 2));
+                $name = strtolower($pair[0]);
+                $value = isset($pair[1]) ? trim($pair[1], '"') : null;
+                switch ($name) {
+                    case 'server_no_context_takeover':
+                        $noContextTakeover = true;
+                        $response[] = $name;
+                        break;
+                    case 'client_no_context_takeover':
+                        $peerNoContextTakeover = true;
+                        $response[] = $name;
+                        break;
+                    case 'server_max_window_bits':
+                        if (!ctype_digit((string) $value) || $value < 9 || $value > 15) {
+                            /* zlib can not deflate with 8 window bits, decline this offer */
+                            continue 3;
+                        }
+                        $maxWindowBits = (int) $value;
+                        $response[] = "{$name}={$maxWindowBits}";
+                        break;
+                    case 'client_max_window_bits':
+                        /* our inflater always accepts 15 window bits */
+                        break;
+                    default:
+                        continue 3;
+                }
+            }
+
+            return [$noContextTakeover, $peerNoContextTakeover, $maxWindowBits, -1, implode('; ', $response)];
+        }
+
+        return null;
+    }
+
+    public function getWebSocketConnection(): WebSocket\Connection
+    {
+        if ($this->webSocketConnection === null) {
+            throw new HttpException(HttpStatus::BAD_REQUEST, 'Session has not been upgraded to WebSocket');
+        }
+
+        return $this->webSocketConnection;
+    }
+
+    /**
+     * Upgrade to HTTP/2 by h2c upgrade (RFC 7540 Section 3.2) or with prior knowledge (Section 3.4),
+     * then serve the requests of the connection until it is closed,
+     * every request is handled by handler in its own coroutine
+     * @param callable $handler function (Request $request, Http2\Stream $stream): void
+     * @return $this
+     */
+    public function upgradeToHttp2(Request $request, callable $handler)
+    {
+        $connection = (new Http2\Connection($this, $handler, $this->buffer))
+            ->setMaxHeaderListSize($this->server->getMaxHeaderLength())
+            ->setMaxContentLength($this->server->getMaxContentLength());
+        if ($request->getMethod() === 'PRI') {
+            /* "PRI * HTTP/2.0\r\n\r\n" has been parsed, the rest must be "SM\r\n\r\n" */
+            $preface = substr(Http2\CONNECTION_PREFACE, strlen("PRI * HTTP/2.0\r\n\r\n"));
+        } else {
+            if (!$request->hasHeader('http2-settings')) {
+                throw new HttpException(HttpStatus::BAD_REQUEST, 'Missing HTTP2-Settings');
+            }
+            $connection->upgrade($request);
+            $this->respond(HttpStatus::SWITCHING_PROTOCOLS, [
+                'Connection' => 'Upgrade',
+                'Upgrade' => 'h2c',
+            ]);
+            $this->flushResponses();
+            $preface = Http2\CONNECTION_PREFACE;
+        }
+
+        $this->upgraded(static::TYPE_HTTP2);
+        $this->http2Connection = $connection;
+        $connection->serve($preface);
+
+        return $this;
+    }
+
+    public function getHttp2Connection(): Http2\Connection
+    {
+        if ($this->http2Connection === null) {
+            throw new HttpException(HttpStatus::BAD_REQUEST, 'Session has not been upgraded to HTTP/2');
+        }
+
+        return $this->http2Connection;
+    }
+
+    /**
+     * Receive a whole (reassembled and decompressed) message
+     * @return int opcode of the message (TEXT, BINARY or CLOSE)
+     */
+    public function recvWebSocketMessage(Buffer $buffer, ?int $timeout = null): int
+    {
+        return $this->getWebSocketConnection()->recvMessage($buffer, $timeout);
+    }
+
+    /**
+     * @return $this
+     */
+    public function sendWebSocketMessage(string $data, int $opcode = WebSocket\Opcode::TEXT, ?int $timeout = null)
+    {
+        $this->getWebSocketConnection()->sendMessage($data, $opcode, $timeout);
+
         return $this;
     }
 
@@ -293,6 +514,13 @@ class Session extends Socket
 
     public function close(): bool
     {
+        if ($this->pendingResponses) {
+            try {
+                $this->flushResponses();
+            } catch (Socket\Exception $exception) {
+                /* peer has gone, nothing we can do */
+            }
+        }
         $ret = parent::close();
         $this->offline();
 
@@ -0,0 +1,849 @@
+<?php
+/**
+ * This file is part of Swow
+ *
+ * @link     https://github.com/swow/swow
+ * @contact  twosee <twosee@php.net>
+ *
+ * For the full copyright and license information,
+ * please view the LICENSE file that was distributed with this source code
+ */
+
+declare(strict_types=1);
+
+namespace Swow\Http2;
+
+use Swow\Buffer;
+use Swow\Coroutine;
+use Swow\Http\Exception as HttpException;
+use Swow\Http\Server\Request;
+use Swow\Http\Status as HttpStatus;
+use Swow\Socket;
+use Throwable;
+use const Swow\Errno\EMSGSIZE;
+
+/**
+ * Server side HTTP/2 connection (RFC 7540),
+ * every request stream is handled by its own coroutine
+ */
+class Connection
+{
+    public const DEFAULT_MAX_CONCURRENT_STREAMS = 128;
+
+    public const DEFAULT_MAX_CONTENT_LENGTH = 8 * 1024 * 1024;
+
+    /* the header block limit is much bigger than the max header list size, because it is compressed */
+    protected const MAX_HEADER_BLOCK_SIZE_FACTOR = 4;
+
+    /* they are meaningless in HTTP/2 (RFC 7540 Section 8.1.2.2) */
+    public const CONNECTION_SPECIFIC_HEADERS = [
+        'connection' => true,
+        'keep-alive' => true,
+        'proxy-connection' => true,
+        'transfer-encoding' => true,
+        'upgrade' => true,
+    ];
+
+    /**
+     * @var Socket
+     */
+    protected $socket;
+
+    /**
+     * @var Buffer
+     */
+    protected $buffer;
+
+    /**
+     * @var callable function (Request $request, Stream $stream): void
+     */
+    protected $handler;
+
+    /**
+     * @var Hpack
+     */
+    protected $encoder;
+
+    /**
+     * @var Hpack
+     */
+    protected $decoder;
+
+    /**
+     * @var Stream[]
+     */
+    protected $streams = [];
+
+    /**
+     * @var int the largest stream id that has been opened by peer
+     */
+    protected $lastStreamId = 0;
+
+    /**
+     * @var int
+     */
+    protected $maxConcurrentStreams = self::DEFAULT_MAX_CONCURRENT_STREAMS;
+
+    /**
+     * @var int
+     */
+    protected $maxHeaderListSize = Hpack::DEFAULT_MAX_HEADER_LIST_SIZE;
+
+    /**
+     * @var int
+     */
+    protected $maxContentLength = self::DEFAULT_MAX_CONTENT_LENGTH;
+
+    /**
+     * @var int
+     */
+    protected $remoteInitialWindowSize = DEFAULT_WINDOW_SIZE;
+
+    /**
+     * @var int
+     */
+    protected $remoteMaxFrameSize = DEFAULT_MAX_FRAME_SIZE;
+
+    /**
+     * @var int connection level window for sending DATA frames
+     */
+    protected $sendWindow = DEFAULT_WINDOW_SIZE;
+
+    /**
+     * @var int connection level window for receiving DATA frames
+     */
+    protected $recvWindow = DEFAULT_WINDOW_SIZE;
+
+    /**
+     * @var Stream[] streams which are waiting for the connection window
+     */
+    protected $blockedStreams = [];
+
+    /**
+     * @var string[] frames are written by whoever is writing (in order), so HPACK states keep in sync
+     */
+    protected $writeQueue = [];
+
+    /**
+     * @var bool
+     */
+    protected $writing = false;
+
+    /**
+     * @var bool
+     */
+    protected $goingAway = false;
+
+    /**
+     * @var bool
+     */
+    protected $closed = false;
+
+    public function __construct(Socket $socket, callable $handler, ?Buffer $buffer = null)
+    {
+        $this->socket = $socket;
+        $this->handler = $handler;
+        /* data left in buffer (if any) belongs to HTTP/2 */
+        $this->buffer = $buffer ?? new Buffer();
+        $this->encoder = new Hpack();
+        $this->decoder = new Hpack();
+    }
+
+    public function getSocket(): Socket
+    {
+        return $this->socket;
+    }
+
+    public function getMaxConcurrentStreams(): int
+    {
+        return $this->maxConcurrentStreams;
+    }
+
+    /**
+     * @return $this
+     */
+    public function setMaxConcurrentStreams(int $maxConcurrentStreams)
+    {
+        $this->maxConcurrentStreams = $maxConcurrentStreams;
+
+        return $this;
+    }
+
+    public function getMaxHeaderListSize(): int
+    {
+        return $this->maxHeaderListSize;
+    }
+
+    /**
+     * @return $this
+     */
+    public function setMaxHeaderListSize(int $maxHeaderListSize)
+    {
+        $this->maxHeaderListSize = $maxHeaderListSize;
+
+        return $this;
+    }
+
+    public function getMaxContentLength(): int
+    {
+        return $this->maxContentLength;
+    }
+
+    /**
+     * @return $this
+     */
+    public function setMaxContentLength(int $maxContentLength)
+    {
+        $this->maxContentLength = $maxContentLength;
+
+        return $this;
+    }
+
+    public function getRemoteMaxFrameSize(): int
+    {
+        return $this->remoteMaxFrameSize;
+    }
+
+    public function getStreamCount(): int
+    {
+        return count($this->streams);
+    }
+
+    /**
+     * Take over the HTTP/1.1 request which asked for upgrading to h2c (RFC 7540 Section 3.2),
+     * it becomes the half-closed stream 1, and it will be handled after serve() is called
+     * @return $this
+     */
+    public function upgrade(Request $request)
+    {
+        $settings = base64_decode(strtr($request->getHeaderLine('http2-settings'), '-_', '+/'), true);
+        if ($settings === false || strlen($settings) % SETTINGS_ENTRY_LENGTH !== 0) {
+            throw new HttpException(HttpStatus::BAD_REQUEST, 'Invalid HTTP2-Settings');
+        }
+        /* they are acknowledged implicitly by the 101 response */
+        $this->applySettings($settings);
+        $stream = $this->streams[1] = new Stream($this, 1, $this->remoteInitialWindowSize);
+        $stream->setRequest($request->setProtocolVersion('2.0'))->onEnd();
+        $this->lastStreamId = 1;
+
+        return $this;
+    }
+
+    /**
+     * Serve until the connection is closed by peer or by a connection error
+     * @param string $preface the part of client connection preface which has not been consumed,
+     *                        e.g. "SM\r\n\r\n" if "PRI * HTTP/2.0" has been parsed as an HTTP/1 request
+     */
+    public function serve(string $preface = CONNECTION_PREFACE): void
+    {
+        try {
+            if ($preface !== '' && $this->recvBytes(strlen($preface)) !== $preface) {
+                throw new Exception('Invalid connection preface', ErrorCode::PROTOCOL_ERROR);
+            }
+            /* server connection preface */
+            $this->send([static::packFrame(FrameType::SETTINGS, Flag::NONE, 0, static::packSettings([
+                Setting::MAX_CONCURRENT_STREAMS => $this->maxConcurrentStreams,
+                Setting::MAX_HEADER_LIST_SIZE => $this->maxHeaderListSize,
+            ]))]);
+            foreach ($this->streams as $stream) {
+                /* the upgraded one */
+                $this->dispatch($stream);
+            }
+            [, $type, $flags] = $this->recvFrameHeader();
+            if ($type !== FrameType::SETTINGS || ($flags & Flag::ACK)) {
+                throw new Exception('The first frame must be SETTINGS', ErrorCode::PROTOCOL_ERROR);
+            }
+            $this->buffer->seek(-FRAME_HEADER_LENGTH, SEEK_CUR);
+            while (true) {
+                $this->handleFrame();
+            }
+        } catch (Exception $exception) {
+            /* connection error, code is the HTTP/2 error code */
+            $this->goAway($exception->getCode(), $exception->getMessage());
+        } catch (Socket\Exception $exception) {
+            /* peer has gone */
+        } finally {
+            $this->close();
+        }
+    }
+
+    protected function handleFrame(): void
+    {
+        [$length, $type, $flags, $streamId] = $this->recvFrameHeader();
+        $payload = $length > 0 ? $this->recvBytes($length) : '';
+        switch ($type) {
+            case FrameType::DATA:
+                $this->handleData($flags, $streamId, $payload);
+                break;
+            case FrameType::HEADERS:
+                $this->handleHeaders($flags, $streamId, $payload);
+                break;
+            case FrameType::PRIORITY:
+                if ($streamId === 0) {
+                    throw new Exception('PRIORITY frame on stream 0', ErrorCode::PROTOCOL_ERROR);
+                }
+                if ($length !== 5) {
+                    $this->resetStream($streamId, ErrorCode::FRAME_SIZE_ERROR);
+                }
+                /* priority is not supported, streams are scheduled by coroutines fairly */
+                break;
+            case FrameType::RST_STREAM:
+                if ($streamId === 0 || $streamId > $this->lastStreamId) {
+                    throw new Exception('RST_STREAM frame on idle stream', ErrorCode::PROTOCOL_ERROR);
+                }
+                if ($length !== 4) {
+                    throw new Exception('Invalid RST_STREAM frame', ErrorCode::FRAME_SIZE_ERROR);
+                }
+                if (isset($this->streams[$streamId])) {
+                    $this->streams[$streamId]->onReset(unpack('N', $payload)[1]);
+                }
+                break;
+            case FrameType::SETTINGS:
+                $this->handleSettings($flags, $streamId, $payload);
+                break;
+            case FrameType::PUSH_PROMISE:
+                throw new Exception('Client must not push', ErrorCode::PROTOCOL_ERROR);
+            case FrameType::PING:
+                if ($streamId !== 0) {
+                    throw new Exception('PING frame on stream', ErrorCode::PROTOCOL_ERROR);
+                }
+                if ($length !== 8) {
+                    throw new Exception('Invalid PING frame', ErrorCode::FRAME_SIZE_ERROR);
+                }
+                if (!($flags & Flag::ACK)) {
+                    $this->send([static::packFrame(FrameType::PING, Flag::ACK, 0, $payload)]);
+                }
+                break;
+            case FrameType::GOAWAY:
+                if ($streamId !== 0) {
+                    throw new Exception('GOAWAY frame on stream', ErrorCode::PROTOCOL_ERROR);
+                }
+                /* peer will close the connection after the active streams are done */
+                $this->goingAway = true;
+                break;
+            case FrameType::WINDOW_UPDATE:
+                $this->handleWindowUpdate($streamId, $payload);
+                break;
+            case FrameType::CONTINUATION:
+                throw new Exception('Unexpected CONTINUATION frame', ErrorCode::PROTOCOL_ERROR);
+            default:
+                /* unknown frame types must be ignored */
+                break;
+        }
+    }
+
+    protected function handleData(int $flags, int $streamId, string $payload): void
+    {
+        if ($streamId === 0 || $streamId > $this->lastStreamId) {
+            throw new Exception('DATA frame on idle stream', ErrorCode::PROTOCOL_ERROR);
+        }
+        $length = strlen($payload);
+        /* the entire frame payload (including padding) is subject to flow control */
+        $this->recvWindow -= $length;
+        if ($this->recvWindow < 0) {
+            throw new Exception('Connection window exceeded', ErrorCode::FLOW_CONTROL_ERROR);
+        }
+        $this->consume(0, $this->recvWindow);
+        $stream = $this->streams[$streamId] ?? null;
+        if ($stream === null || !$stream->isReceiving()) {
+            $this->resetStream($streamId, ErrorCode::STREAM_CLOSED);
+
+            return;
+        }
+        $data = static::removePadding($flags, $payload);
+        if (!$stream->onData($data, $length, ($flags & Flag::END_STREAM) !== 0)) {
+            return;
+        }
+        if ($flags & Flag::END_STREAM) {
+            $this->dispatch($stream);
+        } else {
+            $this->consume($streamId, $stream->getRecvWindow());
+        }
+    }
+
+    protected function handleHeaders(int $flags, int $streamId, string $payload): void
+    {
+        if ($streamId === 0 || ($streamId & 1) === 0) {
+            throw new Exception('HEADERS frame on invalid stream', ErrorCode::PROTOCOL_ERROR);
+        }
+        $block = static::removePadding($flags, $payload);
+        if ($flags & Flag::PRIORITY) {
+            if (strlen($block) < 5) {
+                throw new Exception('Invalid HEADERS frame', ErrorCode::FRAME_SIZE_ERROR);
+            }
+            $block = substr($block, 5);
+        }
+        /* the header block must be followed by CONTINUATION frames of the same stream immediately */
+        $maxHeaderBlockSize = $this->maxHeaderListSize * static::MAX_HEADER_BLOCK_SIZE_FACTOR;
+        while (!($flags & Flag::END_HEADERS)) {
+            if (strlen($block) > $maxHeaderBlockSize) {
+                throw new Exception('Header block is too large', ErrorCode::ENHANCE_YOUR_CALM);
+            }
+            [, $type, $continuationFlags, $continuationStreamId] = $frameHeader = $this->recvFrameHeader();
+            if ($type !== FrameType::CONTINUATION || $continuationStreamId !== $streamId) {
+                throw new Exception('Header block is interrupted', ErrorCode::PROTOCOL_ERROR);
+            }
+            $block .= $this->recvBytes($frameHeader[0]);
+            $flags |= $continuationFlags & Flag::END_HEADERS;
+        }
+        try {
+            /* it must always be decoded, otherwise the HPACK states will be out of sync */
+            $headers = $this->decoder->decode($block, $this->maxHeaderListSize);
+        } catch (Exception $exception) {
+            if ($exception->getCode() === EMSGSIZE) {
+                throw new Exception($exception->getMessage(), ErrorCode::ENHANCE_YOUR_CALM);
+            }
+            throw new Exception($exception->getMessage(), ErrorCode::COMPRESSION_ERROR);
+        }
+        $endStream = ($flags & Flag::END_STREAM) !== 0;
+
+        $stream = $this->streams[$streamId] ?? null;
+        if ($stream !== null) {
+            /* trailers */
+            if (!$stream->isReceiving()) {
+                $this->resetStream($streamId, ErrorCode::STREAM_CLOSED);
+            } elseif (!$endStream) {
+                $this->resetStream($streamId, ErrorCode::PROTOCOL_ERROR);
+            } elseif ($stream->onTrailers($headers)) {
+                $this->dispatch($stream);
+            }
+
+            return;
+        }
+        if ($streamId <= $this->lastStreamId) {
+            throw new Exception('HEADERS frame on closed stream', ErrorCode::STREAM_CLOSED);
+        }
+        $this->lastStreamId = $streamId;
+        if ($this->goingAway) {
+            return;
+        }
+        if (count($this->streams) >= $this->maxConcurrentStreams) {
+            $this->resetStream($streamId, ErrorCode::REFUSED_STREAM);
+
+            return;
+        }
+        try {
+            $request = $this->createRequest($headers);
+        } catch (Exception $exception) {
+            /* malformed request is a stream error */
+            $this->resetStream($streamId, $exception->getCode());
+
+            return;
+        }
+        $stream = $this->streams[$streamId] = new Stream($this, $streamId, $this->remoteInitialWindowSize);
+        $stream->setRequest($request);
+        if ($request->getContentLength() > $this->maxContentLength) {
+            $stream->refuse(HttpStatus::REQUEST_ENTITY_TOO_LARGE);
+
+            return;
+        }
+        if ($endStream && $stream->onEnd()) {
+            $this->dispatch($stream);
+        }
+    }
+
+    /**
+     * @param array $headers list of [name, value]
+     */
+    protected function createRequest(array $headers): Request
+    {
+        $pseudoHeaders = [];
+        $regularHeaders = [];
+        foreach ($headers as [$name, $value]) {
+            if ($name[0] === ':') {
+                if ($regularHeaders || isset($pseudoHeaders[$name]) ||
+                    !in_array($name, [':method', ':scheme', ':authority', ':path'], true)) {
+                    throw new Exception("Invalid pseudo-header field {$name}", ErrorCode::PROTOCOL_ERROR);
+                }
+                $pseudoHeaders[$name] = $value;
+                continue;
+            }
+            if (isset(static::CONNECTION_SPECIFIC_HEADERS[$name]) ||
+                ($name === 'te' && $value !== 'trailers') ||
+                strtolower($name) !== $name) {
+                throw new Exception("Invalid header field {$name}", ErrorCode::PROTOCOL_ERROR);
+            }
+            $regularHeaders[$name][] = $value;
+        }
+        $method = $pseudoHeaders[':method'] ?? '';
+        $path = $pseudoHeaders[':path'] ?? '';
+        if ($method === '' || ($method !== 'CONNECT' && ($path === '' || !isset($pseudoHeaders[':scheme'])))) {
+            throw new Exception('Missing pseudo-header fields', ErrorCode::PROTOCOL_ERROR);
+        }
+        if (isset($pseudoHeaders[':authority']) && !isset($regularHeaders['host'])) {
+            $regularHeaders = ['host' => [$pseudoHeaders[':authority']]] + $regularHeaders;
+        }
+        if (isset($regularHeaders['cookie'])) {
+            /* cookies may be split for better compression (RFC 7540 Section 8.1.2.5) */
+            $regularHeaders['cookie'] = [implode('; ', $regularHeaders['cookie'])];
+        }
+        $contentLength = $regularHeaders['content-length'][0] ?? '';
+        if ($contentLength !== '' && !ctype_digit($contentLength)) {
+            throw new Exception('Invalid content-length', ErrorCode::PROTOCOL_ERROR);
+        }
+        $headerNames = array_keys($regularHeaders);
+
+        return (new Request())->setHead(
+            $method,
+            $path,
+            '2.0',
+            $regularHeaders,
+            array_combine($headerNames, $headerNames),
+            true,
+            (int) $contentLength,
+            false
+        );
+    }
+
+    protected function handleSettings(int $flags, int $streamId, string $payload): void
+    {
+        if ($streamId !== 0) {
+            throw new Exception('SETTINGS frame on stream', ErrorCode::PROTOCOL_ERROR);
+        }
+        if ($flags & Flag::ACK) {
+            if ($payload !== '') {
+                throw new Exception('Invalid SETTINGS ACK frame', ErrorCode::FRAME_SIZE_ERROR);
+            }
+
+            return;
+        }
+        if (strlen($payload) % SETTINGS_ENTRY_LENGTH !== 0) {
+            throw new Exception('Invalid SETTINGS frame', ErrorCode::FRAME_SIZE_ERROR);
+        }
+        $this->applySettings($payload);
+        $this->send([static::packFrame(FrameType::SETTINGS, Flag::ACK, 0)]);
+    }
+
+    protected function applySettings(string $payload): void
+    {
+        foreach (str_split($payload, SETTINGS_ENTRY_LENGTH) as $entry) {
+            if ($entry === '') {
+                break;
+            }
+            ['id' => $id, 'value' => $value] = unpack('nid/Nvalue', $entry);
+            switch ($id) {
+                case Setting::HEADER_TABLE_SIZE:
+                    /* a larger table only costs us more memory */
+                    $this->encoder->updateSize(min($value, DEFAULT_HEADER_TABLE_SIZE));
+                    break;
+                case Setting::ENABLE_PUSH:
+                    if ($value > 1) {
+                        throw new Exception('Invalid ENABLE_PUSH setting', ErrorCode::PROTOCOL_ERROR);
+                    }
+                    break;
+                case Setting::INITIAL_WINDOW_SIZE:
+                    if ($value > MAX_WINDOW_SIZE) {
+                        throw new Exception('Invalid INITIAL_WINDOW_SIZE setting', ErrorCode::FLOW_CONTROL_ERROR);
+                    }
+                    $delta = $value - $this->remoteInitialWindowSize;
+                    $this->remoteInitialWindowSize = $value;
+                    foreach ($this->streams as $stream) {
+                        if (!$stream->updateSendWindow($delta)) {
+                            throw new Exception('Stream window overflow', ErrorCode::FLOW_CONTROL_ERROR);
+                        }
+                    }
+                    break;
+                case Setting::MAX_FRAME_SIZE:
+                    if ($value < DEFAULT_MAX_FRAME_SIZE || $value > MAX_MAX_FRAME_SIZE) {
+                        throw new Exception('Invalid MAX_FRAME_SIZE setting', ErrorCode::PROTOCOL_ERROR);
+                    }
+                    $this->remoteMaxFrameSize = $value;
+                    break;
+                default:
+                    /* MAX_CONCURRENT_STREAMS only limits pushes, MAX_HEADER_LIST_SIZE is advisory,
+                     * and unknown settings must be ignored */
+                    break;
+            }
+        }
+    }
+
+    protected function handleWindowUpdate(int $streamId, string $payload): void
+    {
+        if (strlen($payload) !== 4) {
+            throw new Exception('Invalid WINDOW_UPDATE frame', ErrorCode::FRAME_SIZE_ERROR);
+        }
+        $increment = unpack('N', $payload)[1] & MAX_WINDOW_SIZE;
+        if ($streamId === 0) {
+            if ($increment === 0) {
+                throw new Exception('Invalid window increment', ErrorCode::PROTOCOL_ERROR);
+            }
+            $this->sendWindow += $increment;
+            if ($this->sendWindow > MAX_WINDOW_SIZE) {
+                throw new Exception('Connection window overflow', ErrorCode::FLOW_CONTROL_ERROR);
+            }
+            $blockedStreams = $this->blockedStreams;
+            $this->blockedStreams = [];
+            foreach ($blockedStreams as $stream) {
+                $stream->notifyWindow();
+            }
+
+            return;
+        }
+        if ($streamId > $this->lastStreamId) {
+            throw new Exception('WINDOW_UPDATE frame on idle stream', ErrorCode::PROTOCOL_ERROR);
+        }
+        $stream = $this->streams[$streamId] ?? null;
+        if ($stream === null) {
+            /* it may be sent before peer knows the stream was closed */
+            return;
+        }
+        if ($increment === 0) {
+            $this->resetStream($streamId, ErrorCode::PROTOCOL_ERROR);
+        } elseif (!$stream->updateSendWindow($increment)) {
+            $this->resetStream($streamId, ErrorCode::FLOW_CONTROL_ERROR);
+        }
+    }
+
+    protected function dispatch(Stream $stream): void
+    {
+        $handler = $this->handler;
+        Coroutine::run(static function () use ($handler, $stream): void {
+            try {
+                $handler($stream->getRequest(), $stream);
+            } catch (HttpException $exception) {
+                if (!$stream->isHeadersSent()) {
+                    $stream->error($exception->getCode(), $exception->getMessage());
+                }
+            } catch (Throwable $throwable) {
+                /* it is a stream error, other streams and the connection are not affected */
+                $stream->reset(ErrorCode::INTERNAL_ERROR);
+            } finally {
+                if (!$stream->isClosed()) {
+                    /* the handler did not finish the response */
+                    $stream->reset(ErrorCode::INTERNAL_ERROR);
+                }
+            }
+        });
+    }
+
+    /**
+     * Send WINDOW_UPDATE after half of the window has been consumed
+     */
+    protected function consume(int $streamId, int $window): void
+    {
+        if ($window >= DEFAULT_WINDOW_SIZE / 2) {
+            return;
+        }
+        $increment = DEFAULT_WINDOW_SIZE - $window;
+        if ($streamId === 0) {
+            $this->recvWindow += $increment;
+        } else {
+            $this->streams[$streamId]->increaseRecvWindow($increment);
+        }
+        $this->send([static::packFrame(FrameType::WINDOW_UPDATE, Flag::NONE, $streamId, pack('N', $increment))]);
+    }
+
+    /**
+     * @return int the allowed size of DATA frame payload, it waits until the window is available
+     */
+    public function acquireSendWindow(Stream $stream, int $size): int
+    {
+        while (true) {
+            if ($this->closed) {
+                throw new Exception('Connection has been closed', ErrorCode::CANCEL);
+            }
+            $available = min($size, $this->sendWindow, $stream->getSendWindow(), $this->remoteMaxFrameSize);
+            if ($available > 0) {
+                $this->sendWindow -= $available;
+
+                return $available;
+            }
+            if ($this->sendWindow <= 0) {
+                $this->blockedStreams[$stream->getId()] = $stream;
+            }
+            $stream->waitWindow();
+        }
+    }
+
+    /**
+     * @return $this
+     */
+    public function sendHeaders(int $streamId, array $headers, bool $endStream)
+    {
+        /* encoding and queueing are done without switching, so the HPACK states keep in sync */
+        $block = $this->encoder->encode($headers);
+        $maxFrameSize = $this->remoteMaxFrameSize;
+        $vector = [];
+        $type = FrameType::HEADERS;
+        $flags = $endStream ? Flag::END_STREAM : Flag::NONE;
+        do {
+            $fragment = (string) substr($block, 0, $maxFrameSize);
+            $block = (string) substr($block, $maxFrameSize);
+            if ($block === '') {
+                $flags |= Flag::END_HEADERS;
+            }
+            $vector[] = static::packFrameHeader(strlen($fragment), $type, $flags, $streamId);
+            $vector[] = $fragment;
+            $type = FrameType::CONTINUATION;
+            $flags = Flag::NONE;
+        } while ($block !== '');
+
+        return $this->send($vector);
+    }
+
+    /**
+     * Send a DATA frame, the size must have been acquired by acquireSendWindow()
+     * @return $this
+     */
+    public function sendData(int $streamId, string $data, bool $endStream)
+    {
+        return $this->send([
+            static::packFrameHeader(strlen($data), FrameType::DATA, $endStream ? Flag::END_STREAM : Flag::NONE, $streamId),
+            $data,
+        ]);
+    }
+
+    /**
+     * @return $this
+     */
+    public function resetStream(int $streamId, int $errorCode)
+    {
+        if (isset($this->streams[$streamId])) {
+            $this->streams[$streamId]->onReset($errorCode);
+        }
+
+        return $this->send([static::packFrame(FrameType::RST_STREAM, Flag::NONE, $streamId, pack('N', $errorCode))]);
+    }
+
+    /**
+     * @return $this
+     */
+    public function goAway(int $errorCode = ErrorCode::NO_ERROR, string $debugData = '')
+    {
+        $this->goingAway = true;
+        try {
+            $this->send([static::packFrame(FrameType::GOAWAY, Flag::NONE, 0, pack('NN', $this->lastStreamId, $errorCode) . $debugData)]);
+        } catch (Socket\Exception $exception) {
+            /* peer has gone, nothing we can do */
+        }
+
+        return $this;
+    }
+
+    /**
+     * It is called by Stream
+     */
+    public function onStreamClosed(Stream $stream): void
+    {
+        $id = $stream->getId();
+        unset($this->streams[$id], $this->blockedStreams[$id]);
+    }
+
+    /**
+     * Frames of all streams are written in order by the coroutine which is writing,
+     * so that they are coalesced into fewer writes and writes never conflict
+     * @return $this
+     */
+    protected function send(array $vector)
+    {
+        array_push($this->writeQueue, ...$vector);
+        if ($this->writing) {
+            return $this;
+        }
+        $this->writing = true;
+        try {
+            while ($this->writeQueue) {
+                $vector = $this->writeQueue;
+                $this->writeQueue = [];
+                $this->socket->write($vector);
+            }
+        } finally {
+            $this->writing = false;
+        }
+
+        return $this;
+    }
+
+    /**
+     * @return int[] [length, type, flags, stream id]
+     */
+    protected function recvFrameHeader(): array
+    {
+        $header = unpack('Nhead/Cflags/NstreamId', $this->recvBytes(FRAME_HEADER_LENGTH));
+        $length = $header['head'] >> 8;
+        /* we never change SETTINGS_MAX_FRAME_SIZE */
+        if ($length > DEFAULT_MAX_FRAME_SIZE) {
+            throw new Exception('Frame is too large', ErrorCode::FRAME_SIZE_ERROR);
+        }
+
+        return [$length, $header['head'] & 0xff, $header['flags'], $header['streamId'] & MAX_STREAM_ID];
+    }
+
+    protected function recvBytes(int $length): string
+    {
+        $buffer = $this->buffer;
+        while ($buffer->getReadableLength() < $length) {
+            /* move the unread data to the head and append more after it */
+            if ($buffer->eof()) {
+                $buffer->clear();
+            } else {
+                $buffer->truncate();
+            }
+            if ($buffer->getSize() < $length) {
+                $buffer->realloc($length);
+            }
+            $buffer->seek(0, SEEK_END);
+            try {
+                $this->socket->recvData($buffer);
+            } finally {
+                $buffer->rewind();
+            }
+        }
+
+        return $buffer->read($length);
+    }
+
+    protected static function removePadding(int $flags, string $payload): string
+    {
+        if (!($flags & Flag::PADDED)) {
+            return $payload;
+        }
+        $padLength = $payload !== '' ? ord($payload[0]) : 0;
+        if ($payload === '' || $padLength >= strlen($payload)) {
+            throw new Exception('Invalid padding', ErrorCode::PROTOCOL_ERROR);
+        }
+
+        return (string) substr($payload, 1, strlen($payload) - 1 - $padLength);
+    }
+
+    public static function packFrameHeader(int $length, int $type, int $flags, int $streamId): string
+    {
+        return pack('NCN', ($length << 8) | $type, $flags, $streamId);
+    }
+
+    public static function packFrame(int $type, int $flags, int $streamId, string $payload = ''): string
+    {
+        return static::packFrameHeader(strlen($payload), $type, $flags, $streamId) . $payload;
+    }
+
+    /**
+     * @param int[] $settings id => value
+     */
+    public static function packSettings(array $settings): string
+    {
+        $payload = '';
+        foreach ($settings as $id => $value) {
+            $payload .= pack('nN', $id, $value);
+        }
+
+        return $payload;
+    }
+
+    public function isClosed(): bool
+    {
+        return $this->closed;
+    }
+
+    public function close(): void
+    {
+        if ($this->closed) {
+            return;
+        }
+        $this->closed = true;
+        foreach ($this->streams as $stream) {
+            $stream->onReset(ErrorCode::CANCEL);
+        }
+        $this->streams = [];
+        $this->blockedStreams = [];
+    }
+}
@@ -0,0 +1,432 @@
+<?php
+/**
+ * This file is part of Swow
+ *
+ * @link     https://github.com/swow/swow
+ * @contact  twosee <twosee@php.net>
+ *
+ * For the full copyright and license information,
+ * please view the LICENSE file that was distributed with this source code
+ */
+
+declare(strict_types=1);
+
+namespace Swow\Http2;
+
+use Swow\Channel;
+use Swow\Channel\Exception as ChannelException;
+use Swow\Http\Buffer;
+use Swow\Http\Server\Request;
+use Swow\Http\Server\Response;
+use Swow\Http\Status as HttpStatus;
+
+class Stream
+{
+    /**
+     * @var Connection
+     */
+    protected $connection;
+
+    /**
+     * @var int
+     */
+    protected $id;
+
+    /**
+     * @var Request
+     */
+    protected $request;
+
+    /**
+     * @var null|Buffer
+     */
+    protected $body;
+
+    /**
+     * @var bool the request is being received
+     */
+    protected $receiving = true;
+
+    /**
+     * @var bool
+     */
+    protected $headersSent = false;
+
+    /**
+     * @var bool
+     */
+    protected $closed = false;
+
+    /**
+     * @var int
+     */
+    protected $sendWindow;
+
+    /**
+     * @var int
+     */
+    protected $recvWindow = DEFAULT_WINDOW_SIZE;
+
+    /**
+     * @var null|Channel it is used to wait for WINDOW_UPDATE
+     */
+    protected $windowChannel;
+
+    public function __construct(Connection $connection, int $id, int $sendWindow)
+    {
+        $this->connection = $connection;
+        $this->id = $id;
+        $this->sendWindow = $sendWindow;
+    }
+
+    public function getConnection(): Connection
+    {
+        return $this->connection;
+    }
+
+    public function getId(): int
+    {
+        return $this->id;
+    }
+
+    public function getRequest(): Request
+    {
+        return $this->request;
+    }
+
+    /**
+     * @return $this
+     */
+    public function setRequest(Request $request)
+    {
+        $this->request = $request;
+
+        return $this;
+    }
+
+    public function isReceiving(): bool
+    {
+        return $this->receiving;
+    }
+
+    public function isHeadersSent(): bool
+    {
+        return $this->headersSent;
+    }
+
+    public function isClosed(): bool
+    {
+        return $this->closed;
+    }
+
+    public function getSendWindow(): int
+    {
+        return $this->sendWindow;
+    }
+
+    public function getRecvWindow(): int
+    {
+        return $this->recvWindow;
+    }
+
+    /**
+     * @internal
+     * @return bool false if the window overflows
+     */
+    public function updateSendWindow(int $delta): bool
+    {
+        $this->sendWindow += $delta;
+        if ($this->sendWindow > MAX_WINDOW_SIZE) {
+            return false;
+        }
+        if ($delta > 0) {
+            $this->notifyWindow();
+        }
+
+        return true;
+    }
+
+    /**
+     * @internal
+     */
+    public function increaseRecvWindow(int $increment): void
+    {
+        $this->recvWindow += $increment;
+    }
+
+    /**
+     * @internal
+     * @return bool false if the stream has been reset
+     */
+    public function onData(string $data, int $length, bool $endStream): bool
+    {
+        $this->recvWindow -= $length;
+        if ($this->recvWindow < 0) {
+            $this->connection->resetStream($this->id, ErrorCode::FLOW_CONTROL_ERROR);
+
+            return false;
+        }
+        if ($data !== '') {
+            $body = $this->body ?? ($this->body = new Buffer(0));
+            if ($body->getLength() + strlen($data) > $this->connection->getMaxContentLength()) {
+                $this->refuse(HttpStatus::REQUEST_ENTITY_TOO_LARGE);
+
+                return false;
+            }
+            $body->write($data);
+        }
+
+        return !$endStream || $this->onEnd();
+    }
+
+    /**
+     * @internal
+     * @param array $trailers list of [name, value]
+     * @return bool false if the stream has been reset
+     */
+    public function onTrailers(array $trailers): bool
+    {
+        $request = $this->request;
+        foreach ($trailers as [$name, $value]) {
+            if ($name[0] === ':') {
+                $this->connection->resetStream($this->id, ErrorCode::PROTOCOL_ERROR);
+
+                return false;
+            }
+            $request->setHeader($name, array_merge($request->getHeader($name), [$value]));
+        }
+
+        return $this->onEnd();
+    }
+
+    /**
+     * The request has been received completely (END_STREAM)
+     * @internal
+     * @return bool false if the stream has been reset
+     */
+    public function onEnd(): bool
+    {
+        $this->receiving = false;
+        $request = $this->request;
+        if ($this->body === null && $request->hasBody()) {
+            /* the body of upgraded request has been received by HTTP/1.1 session */
+            return true;
+        }
+        $length = $this->body !== null ? $this->body->getLength() : 0;
+        if ($request->hasHeader('content-length') && (int) $request->getHeaderLine('content-length') !== $length) {
+            /* malformed request (RFC 7540 Section 8.1.2.6) */
+            $this->connection->resetStream($this->id, ErrorCode::PROTOCOL_ERROR);
+
+            return false;
+        }
+        if ($this->body !== null) {
+            $request->setContentLength($length)->setBody($this->body->rewind());
+            $this->body = null;
+        }
+
+        return true;
+    }
+
+    /**
+     * @internal
+     */
+    public function onReset(int $errorCode): void
+    {
+        if ($this->closed) {
+            return;
+        }
+        $this->receiving = false;
+        $this->markClosed();
+    }
+
+    /**
+     * @internal
+     */
+    public function waitWindow(): void
+    {
+        $channel = $this->windowChannel ?? ($this->windowChannel = new Channel(1));
+        try {
+            $channel->pop($this->connection->getSocket()->getWriteTimeout());
+        } catch (ChannelException $exception) {
+            if ($this->closed) {
+                throw new Exception("Stream {$this->id} has been closed", ErrorCode::STREAM_CLOSED);
+            }
+            throw $exception;
+        }
+        if ($this->closed) {
+            throw new Exception("Stream {$this->id} has been closed", ErrorCode::STREAM_CLOSED);
+        }
+    }
+
+    /**
+     * @internal
+     */
+    public function notifyWindow(): void
+    {
+        $channel = $this->windowChannel;
+        if ($channel !== null && $channel->isEmpty()) {
+            $channel->push(true);
+        }
+    }
+
+    /**
+     * @return $this
+     */
+    public function sendHeaders(array $headers, bool $endStream = false)
+    {
+        $this->checkWritable();
+        $this->headersSent = true;
+        $this->connection->sendHeaders($this->id, $headers, $endStream);
+        if ($endStream) {
+            $this->onLocalEnd();
+        }
+
+        return $this;
+    }
+
+    /**
+     * Send data with flow control, it waits until peer has enough window
+     * @return $this
+     */
+    public function sendData(string $data, bool $endStream = false)
+    {
+        $this->checkWritable();
+        $connection = $this->connection;
+        $length = strlen($data);
+        if ($length === 0) {
+            $connection->sendData($this->id, '', $endStream);
+        }
+        for ($offset = 0; $offset < $length; $offset += $size) {
+            $size = $connection->acquireSendWindow($this, $length - $offset);
+            $this->checkWritable();
+            $this->sendWindow -= $size;
+            $chunk = ($offset === 0 && $size === $length) ? $data : substr($data, $offset, $size);
+            $connection->sendData($this->id, $chunk, $endStream && $offset + $size === $length);
+        }
+        if ($endStream) {
+            $this->onLocalEnd();
+        }
+
+        return $this;
+    }
+
+    /**
+     * Arguments are the same as Session::respond(), e.g. respond(200, ['content-type' => 'text/plain'], 'Hello')
+     * @return $this
+     */
+    public function respond(...$args)
+    {
+        $statusCode = HttpStatus::OK;
+        $headers = [];
+        $body = '';
+        foreach ($args as $arg) {
+            if (is_string($arg)) {
+                $body = $arg;
+            } elseif (is_int($arg)) {
+                $statusCode = $arg;
+            } elseif (is_array($arg)) {
+                $headers = $arg;
+            }
+        }
+
+        return $this->sendResponse($statusCode, $headers, $body);
+    }
+
+    /**
+     * @return $this
+     */
+    public function error(int $code, string $message = '')
+    {
+        if ($message === '') {
+            $message = HttpStatus::getReasonPhrase($code);
+        }
+
+        return $this->sendResponse(
+            $code,
+            ['content-type' => 'text/html'],
+            "<html lang=\"en\"><body><h2>HTTP {$code} {$message}</h2><hr><i>Powered by Swow</i></body></html>\r\n"
+        );
+    }
+
+    /**
+     * @return $this
+     */
+    public function sendHttpResponse(Response $response)
+    {
+        return $this->sendResponse($response->getStatusCode(), $response->getHeaders(), $response->getBodyAsString());
+    }
+
+    /**
+     * @return $this
+     */
+    protected function sendResponse(int $statusCode, array $headers, string $body)
+    {
+        $responseHeaders = [':status' => (string) $statusCode, 'server' => 'swow'];
+        foreach ($headers as $name => $value) {
+            $name = strtolower((string) $name);
+            if ($name[0] === ':' || isset($responseHeaders[$name]) && $name !== 'server') {
+                continue;
+            }
+            if (isset(Connection::CONNECTION_SPECIFIC_HEADERS[$name])) {
+                /* connection-specific header fields must not be sent in HTTP/2 */
+                continue;
+            }
+            $responseHeaders[$name] = $value;
+        }
+        $responseHeaders['content-length'] = (string) strlen($body);
+        $this->sendHeaders($responseHeaders, $body === '');
+        if ($body !== '') {
+            $this->sendData($body, true);
+        }
+
+        return $this;
+    }
+
+    /**
+     * Respond before the request body is received completely, and stop receiving it
+     * @internal
+     */
+    public function refuse(int $statusCode): void
+    {
+        $this->sendHeaders([':status' => (string) $statusCode, 'server' => 'swow'], true);
+        /* stop receiving (RFC 7540 Section 8.1) */
+        $this->connection->resetStream($this->id, ErrorCode::NO_ERROR);
+    }
+
+    /**
+     * @return $this
+     */
+    public function reset(int $errorCode = ErrorCode::CANCEL)
+    {
+        if (!$this->closed) {
+            $this->connection->resetStream($this->id, $errorCode);
+        }
+
+        return $this;
+    }
+
+    protected function checkWritable(): void
+    {
+        if ($this->closed) {
+            throw new Exception("Stream {$this->id} has been closed", ErrorCode::STREAM_CLOSED);
+        }
+    }
+
+    protected function onLocalEnd(): void
+    {
+        if (!$this->receiving) {
+            $this->markClosed();
+        }
+        /* else: half-closed (local), the rest of request will be discarded after it is reset */
+    }
+
+    protected function markClosed(): void
+    {
+        $this->closed = true;
+        if ($this->windowChannel !== null) {
+            $this->windowChannel->close();
+            $this->windowChannel = null;
+        }
+        $this->connection->onStreamClosed($this);
+    }
+}